@@ -0,0 +1,674 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/empty.pb.h>
+#include <ignition/msgs/image.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
+#include <ignition/msgs/scene.pb.h>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/msgs/uint32_v.pb.h>
+#include <ignition/msgs/world_control.pb.h>
+#include <ignition/msgs/world_stats.pb.h>
+#include <ignition/transport/Node.hh>
+
+/// \brief Set by the signal handler to stop the server
+static std::atomic<bool> g_stop{false};
+
+/// \brief Command line options
+struct Options
+{
+  /// \brief World name, used in topic and service names
+  std::string world{"default"};
+
+  /// \brief Number of entities in the world
+  unsigned int entities{100u};
+
+  /// \brief Simulation steps per second, each of which publishes poses
+  double poseRate{60.0};
+
+  /// \brief World statistics per second
+  double statsRate{5.0};
+
+  /// \brief Entities deleted and replaced by new ones per second
+  double churn{0.0};
+
+  /// \brief Image topic
+  std::string imageTopic{"/camera"};
+
+  /// \brief Images per second, zero to disable images
+  double imageRate{0.0};
+
+  /// \brief Image width in pixels
+  unsigned int imageWidth{640u};
+
+  /// \brief Image height in pixels
+  unsigned int imageHeight{480u};
+
+  /// \brief Random seed for the entities' layout and motion
+  unsigned int seed{1u};
+
+  /// \brief Seconds to run for, zero to run until interrupted
+  double duration{0.0};
+
+  /// \brief Start paused
+  bool paused{false};
+};
+
+/// \brief An entity moving on a circle
+struct Entity
+{
+  /// \brief Model ID, which is also the ID of its pose
+  uint32_t id{0u};
+
+  /// \brief Link ID
+  uint32_t linkId{0u};
+
+  /// \brief Visual ID
+  uint32_t visualId{0u};
+
+  /// \brief Model name
+  std::string name;
+
+  /// \brief Center of the circle
+  ignition::math::Vector3d center;
+
+  /// \brief Radius of the circle
+  double radius{1.0};
+
+  /// \brief Angular speed, in radians per second
+  double speed{1.0};
+};
+
+/// \brief Stands in for a simulator, serving the scene and publishing the
+/// topics Ignition GUI's plugins subscribe to.
+class WorldServer
+{
+  /// \brief Constructor
+  /// \param[in] _options Options
+  public: explicit WorldServer(const Options &_options);
+
+  /// \brief Advertise services and topics
+  /// \return True if successful
+  public: bool Advertise();
+
+  /// \brief Run until interrupted or the duration has passed
+  public: void Run();
+
+  /// \brief Add a new entity to the world
+  /// \return The new entity
+  private: const Entity &AddEntity();
+
+  /// \brief Fill a model message for an entity
+  /// \param[in] _entity Entity
+  /// \param[out] _msg Model
+  private: void FillModel(const Entity &_entity, ignition::msgs::Model &_msg);
+
+  /// \brief Pose of an entity at the current simulation time
+  /// \param[in] _entity Entity
+  /// \return Pose
+  private: ignition::math::Pose3d EntityPose(const Entity &_entity) const;
+
+  /// \brief Delete the oldest entity and add a new one
+  private: void ReplaceEntity();
+
+  /// \brief Publish all entity poses
+  private: void PublishPoses();
+
+  /// \brief Publish the world statistics
+  /// \param[in] _realTime Time since the server started
+  private: void PublishStats(
+      const std::chrono::steady_clock::duration &_realTime);
+
+  /// \brief Scene service
+  /// \param[in] _req Unused
+  /// \param[out] _rep Scene with all entities
+  /// \return True
+  private: bool OnScene(const ignition::msgs::Empty &_req,
+      ignition::msgs::Scene &_rep);
+
+  /// \brief World control service, which supports pausing, playing and
+  /// stepping
+  /// \param[in] _req Request
+  /// \param[out] _rep True
+  /// \return True
+  private: bool OnControl(const ignition::msgs::WorldControl &_req,
+      ignition::msgs::Boolean &_rep);
+
+  /// \brief Options
+  private: Options options;
+
+  /// \brief Transport node
+  private: ignition::transport::Node node;
+
+  /// \brief Pose publisher
+  private: ignition::transport::Node::Publisher posePub;
+
+  /// \brief Deletion publisher
+  private: ignition::transport::Node::Publisher deletionPub;
+
+  /// \brief Scene update publisher
+  private: ignition::transport::Node::Publisher scenePub;
+
+  /// \brief World statistics publisher
+  private: ignition::transport::Node::Publisher statsPub;
+
+  /// \brief Image publisher
+  private: ignition::transport::Node::Publisher imagePub;
+
+  /// \brief Protects the state below, which services also access
+  private: std::mutex mutex;
+
+  /// \brief Entities, oldest first
+  private: std::deque<Entity> entities;
+
+  /// \brief ID of the light, which is never deleted
+  private: uint32_t lightId{1u};
+
+  /// \brief Next entity ID
+  private: uint32_t nextId{2u};
+
+  /// \brief Generates the entities' layout and motion
+  private: std::mt19937 random;
+
+  /// \brief Number of simulation steps run
+  private: uint64_t iterations{0u};
+
+  /// \brief Whether simulation is paused
+  private: bool paused{false};
+
+  /// \brief Steps to run while paused
+  private: uint64_t pendingSteps{0u};
+
+  /// \brief Images published in turn
+  private: std::vector<ignition::msgs::Image> images;
+};
+
+/////////////////////////////////////////////////
+/// \brief Convert seconds to a time message
+/// \param[in] _seconds Seconds
+/// \param[out] _msg Time
+static void setTime(const double _seconds, ignition::msgs::Time *_msg)
+{
+  auto sec = static_cast<int64_t>(_seconds);
+  _msg->set_sec(sec);
+  _msg->set_nsec(static_cast<int32_t>((_seconds - sec) * 1e9));
+}
+
+/////////////////////////////////////////////////
+WorldServer::WorldServer(const Options &_options)
+  : options(_options), random(_options.seed), paused(_options.paused)
+{
+  for (unsigned int i = 0; i < this->options.entities; ++i)
+    this->AddEntity();
+
+  // Two images are generated up front, so publishing doesn't cost more than
+  // it would for a real camera
+  if (this->options.imageRate > 0.0)
+  {
+    auto width = this->options.imageWidth;
+    auto height = this->options.imageHeight;
+    for (unsigned int i = 0; i < 2u; ++i)
+    {
+      ignition::msgs::Image msg;
+      msg.set_width(width);
+      msg.set_height(height);
+      msg.set_step(width * 3);
+      msg.set_pixel_format_type(ignition::msgs::PixelFormatType::RGB_INT8);
+
+      std::string data(width * height * 3, '\0');
+      for (unsigned int y = 0; y < height; ++y)
+      {
+        for (unsigned int x = 0; x < width; ++x)
+        {
+          auto pixel = &data[(y * width + x) * 3];
+          pixel[0] = static_cast<char>((x + i * 64) & 0xff);
+          pixel[1] = static_cast<char>((y + i * 64) & 0xff);
+          pixel[2] = static_cast<char>(((x + y) / 2) & 0xff);
+        }
+      }
+      msg.set_data(std::move(data));
+
+      this->images.push_back(std::move(msg));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+bool WorldServer::Advertise()
+{
+  auto prefix = "/world/" + this->options.world;
+
+  if (!this->node.Advertise(prefix + "/scene/info", &WorldServer::OnScene,
+      this))
+  {
+    std::cerr << "Failed to advertise [" << prefix << "/scene/info]"
+              << std::endl;
+    return false;
+  }
+
+  if (!this->node.Advertise(prefix + "/control", &WorldServer::OnControl,
+      this))
+  {
+    std::cerr << "Failed to advertise [" << prefix << "/control]"
+              << std::endl;
+    return false;
+  }
+
+  this->posePub = this->node.Advertise<ignition::msgs::Pose_V>(
+      prefix + "/pose/info");
+  this->deletionPub = this->node.Advertise<ignition::msgs::UInt32_V>(
+      prefix + "/scene/deletion");
+  this->scenePub = this->node.Advertise<ignition::msgs::Scene>(
+      prefix + "/scene/info");
+  this->statsPub = this->node.Advertise<ignition::msgs::WorldStatistics>(
+      prefix + "/stats");
+
+  if (!this->images.empty())
+  {
+    this->imagePub = this->node.Advertise<ignition::msgs::Image>(
+        this->options.imageTopic);
+  }
+
+  return this->posePub && this->deletionPub && this->scenePub &&
+      this->statsPub && (this->images.empty() || this->imagePub);
+}
+
+/////////////////////////////////////////////////
+void WorldServer::Run()
+{
+  using Clock = std::chrono::steady_clock;
+
+  auto step = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / this->options.poseRate));
+  auto statsPeriod = this->options.statsRate > 0.0 ?
+      1.0 / this->options.statsRate : 0.0;
+  auto imagePeriod = this->options.imageRate > 0.0 ?
+      1.0 / this->options.imageRate : 0.0;
+  auto churnPeriod = this->options.churn > 0.0 ?
+      1.0 / this->options.churn : 0.0;
+
+  double nextStats{0.0};
+  double nextImage{0.0};
+  double nextChurn{churnPeriod};
+  uint64_t imageCount{0u};
+
+  auto start = Clock::now();
+  auto next = start;
+  while (!g_stop)
+  {
+    auto realTime = Clock::now() - start;
+    auto elapsed = std::chrono::duration<double>(realTime).count();
+    if (this->options.duration > 0.0 && elapsed >= this->options.duration)
+      break;
+
+    bool stepped{false};
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (!this->paused || this->pendingSteps > 0u)
+      {
+        ++this->iterations;
+        if (this->paused)
+          --this->pendingSteps;
+        stepped = true;
+      }
+    }
+
+    // Entities are replaced in real time, so the load doesn't depend on
+    // whether the world is paused
+    while (churnPeriod > 0.0 && elapsed >= nextChurn)
+    {
+      this->ReplaceEntity();
+      nextChurn += churnPeriod;
+    }
+
+    if (stepped)
+      this->PublishPoses();
+
+    if (statsPeriod > 0.0 && elapsed >= nextStats)
+    {
+      this->PublishStats(realTime);
+      nextStats += statsPeriod;
+    }
+
+    if (imagePeriod > 0.0 && elapsed >= nextImage)
+    {
+      auto &image = this->images[imageCount++ % this->images.size()];
+      setTime(elapsed, image.mutable_header()->mutable_stamp());
+      this->imagePub.Publish(image);
+      nextImage += imagePeriod;
+    }
+
+    next += step;
+    std::this_thread::sleep_until(next);
+  }
+}
+
+/////////////////////////////////////////////////
+const Entity &WorldServer::AddEntity()
+{
+  std::uniform_real_distribution<double> position(-20.0, 20.0);
+  std::uniform_real_distribution<double> radius(0.5, 2.0);
+  std::uniform_real_distribution<double> speed(-1.5, 1.5);
+
+  Entity entity;
+  entity.id = this->nextId++;
+  entity.linkId = this->nextId++;
+  entity.visualId = this->nextId++;
+  entity.name = "entity_" + std::to_string(entity.id);
+  entity.center.Set(position(this->random), position(this->random), 0.5);
+  entity.radius = radius(this->random);
+  entity.speed = speed(this->random);
+
+  this->entities.push_back(entity);
+  return this->entities.back();
+}
+
+/////////////////////////////////////////////////
+void WorldServer::FillModel(const Entity &_entity,
+    ignition::msgs::Model &_msg)
+{
+  _msg.set_id(_entity.id);
+  _msg.set_name(_entity.name);
+  ignition::msgs::Set(_msg.mutable_pose(), this->EntityPose(_entity));
+
+  auto link = _msg.add_link();
+  link->set_id(_entity.linkId);
+  link->set_name("link");
+
+  auto visual = link->add_visual();
+  visual->set_id(_entity.visualId);
+  visual->set_name("visual");
+  visual->set_parent_name(_entity.name + "::link");
+
+  auto geometry = visual->mutable_geometry();
+  geometry->set_type(ignition::msgs::Geometry::BOX);
+  ignition::msgs::Set(geometry->mutable_box()->mutable_size(),
+      ignition::math::Vector3d(0.5, 0.5, 0.5));
+
+  auto material = visual->mutable_material();
+  auto hue = static_cast<float>(_entity.id % 7) / 7.0f;
+  ignition::msgs::Set(material->mutable_diffuse(),
+      ignition::math::Color(hue, 0.5f, 1.0f - hue));
+  ignition::msgs::Set(material->mutable_ambient(),
+      ignition::math::Color(hue, 0.5f, 1.0f - hue));
+}
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d WorldServer::EntityPose(const Entity &_entity) const
+{
+  auto simTime = this->iterations / this->options.poseRate;
+  auto angle = simTime * _entity.speed;
+  return ignition::math::Pose3d(
+      _entity.center.X() + _entity.radius * std::cos(angle),
+      _entity.center.Y() + _entity.radius * std::sin(angle),
+      _entity.center.Z(), 0, 0, angle);
+}
+
+/////////////////////////////////////////////////
+void WorldServer::ReplaceEntity()
+{
+  ignition::msgs::UInt32_V deletion;
+  ignition::msgs::Scene scene;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->entities.empty())
+      return;
+
+    deletion.add_data(this->entities.front().id);
+    this->entities.pop_front();
+
+    this->FillModel(this->AddEntity(), *scene.add_model());
+    scene.set_name(this->options.world);
+  }
+
+  this->deletionPub.Publish(deletion);
+  this->scenePub.Publish(scene);
+}
+
+/////////////////////////////////////////////////
+void WorldServer::PublishPoses()
+{
+  ignition::msgs::Pose_V msg;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    setTime(this->iterations / this->options.poseRate,
+        msg.mutable_header()->mutable_stamp());
+
+    for (const auto &entity : this->entities)
+    {
+      auto pose = msg.add_pose();
+      ignition::msgs::Set(pose, this->EntityPose(entity));
+      pose->set_id(entity.id);
+      pose->set_name(entity.name);
+    }
+  }
+
+  // Wall clock publication time, which Scene3D uses to measure how long
+  // poses take to reach the screen
+  auto data = msg.mutable_header()->add_data();
+  data->set_key("publish_time");
+  data->add_value(std::to_string(std::chrono::duration_cast<
+      std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count()));
+
+  this->posePub.Publish(msg);
+}
+
+/////////////////////////////////////////////////
+void WorldServer::PublishStats(
+    const std::chrono::steady_clock::duration &_realTime)
+{
+  ignition::msgs::WorldStatistics msg;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto simTime = this->iterations / this->options.poseRate;
+    auto realTime = std::chrono::duration<double>(_realTime).count();
+
+    setTime(simTime, msg.mutable_header()->mutable_stamp());
+    setTime(simTime, msg.mutable_sim_time());
+    setTime(realTime, msg.mutable_real_time());
+    msg.set_iterations(this->iterations);
+    msg.set_paused(this->paused);
+    msg.set_real_time_factor(realTime > 0.0 ? simTime / realTime : 0.0);
+  }
+
+  this->statsPub.Publish(msg);
+}
+
+/////////////////////////////////////////////////
+bool WorldServer::OnScene(const ignition::msgs::Empty &,
+    ignition::msgs::Scene &_rep)
+{
+  _rep.set_name(this->options.world);
+  ignition::msgs::Set(_rep.mutable_ambient(),
+      ignition::math::Color(0.4f, 0.4f, 0.4f));
+  ignition::msgs::Set(_rep.mutable_background(),
+      ignition::math::Color(0.7f, 0.7f, 0.7f));
+
+  auto light = _rep.add_light();
+  light->set_name("sun");
+  light->set_type(ignition::msgs::Light::DIRECTIONAL);
+  ignition::msgs::Set(light->mutable_diffuse(),
+      ignition::math::Color(0.8f, 0.8f, 0.8f));
+  ignition::msgs::Set(light->mutable_direction(),
+      ignition::math::Vector3d(-0.5, 0.1, -0.9));
+
+  light->set_id(this->lightId);
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  for (const auto &entity : this->entities)
+    this->FillModel(entity, *_rep.add_model());
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool WorldServer::OnControl(const ignition::msgs::WorldControl &_req,
+    ignition::msgs::Boolean &_rep)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+
+  this->paused = _req.pause();
+  if (_req.multi_step() > 0u)
+    this->pendingSteps += _req.multi_step();
+  else if (_req.step())
+    this->pendingSteps += 1u;
+
+  _rep.set_data(true);
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Print usage
+/// \param[in] _name Program name
+static void usage(const std::string &_name)
+{
+  std::cout <<
+    "Usage: " << _name << " [options]\n\n"
+    "Serves the scene and publishes poses, scene updates, world statistics\n"
+    "and images like a simulator would, for load testing Ignition GUI.\n\n"
+    "Options:\n"
+    "  --world arg         World name, used in topic names. [default]\n"
+    "  --entities arg      Number of entities. [100]\n"
+    "  --pose-rate arg     Steps per second, each publishing all poses. [60]\n"
+    "  --stats-rate arg    World statistics per second. [5]\n"
+    "  --churn arg         Entities deleted and replaced per second. [0]\n"
+    "  --image-topic arg   Image topic. [/camera]\n"
+    "  --image-rate arg    Images per second, 0 for none. [0]\n"
+    "  --image-width arg   Image width. [640]\n"
+    "  --image-height arg  Image height. [480]\n"
+    "  --seed arg          Random seed for the entities. [1]\n"
+    "  --duration arg      Seconds to run for, 0 until interrupted. [0]\n"
+    "  --paused            Start paused.\n"
+    "  -h [ --help ]       Print this help message.\n";
+}
+
+/////////////////////////////////////////////////
+/// \brief Parse the command line
+/// \param[in] _argc Argument count
+/// \param[in] _argv Arguments
+/// \param[out] _options Options
+/// \return False if the program should exit
+static bool parse(int _argc, char **_argv, Options &_options)
+{
+  for (int i = 1; i < _argc; ++i)
+  {
+    std::string arg = _argv[i];
+    if (arg == "-h" || arg == "--help")
+    {
+      usage(_argv[0]);
+      return false;
+    }
+
+    if (arg == "--paused")
+    {
+      _options.paused = true;
+      continue;
+    }
+
+    if (i + 1 >= _argc)
+    {
+      std::cerr << "Missing value for [" << arg << "]" << std::endl;
+      usage(_argv[0]);
+      return false;
+    }
+    std::string value = _argv[++i];
+
+    if (arg == "--world")
+      _options.world = value;
+    else if (arg == "--entities")
+      _options.entities = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--pose-rate")
+      _options.poseRate = std::atof(value.c_str());
+    else if (arg == "--stats-rate")
+      _options.statsRate = std::atof(value.c_str());
+    else if (arg == "--churn")
+      _options.churn = std::atof(value.c_str());
+    else if (arg == "--image-topic")
+      _options.imageTopic = value;
+    else if (arg == "--image-rate")
+      _options.imageRate = std::atof(value.c_str());
+    else if (arg == "--image-width")
+      _options.imageWidth = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--image-height")
+      _options.imageHeight = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--seed")
+      _options.seed = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--duration")
+      _options.duration = std::atof(value.c_str());
+    else
+    {
+      std::cerr << "Unknown option [" << arg << "]" << std::endl;
+      usage(_argv[0]);
+      return false;
+    }
+  }
+
+  if (_options.poseRate <= 0.0)
+  {
+    std::cerr << "The pose rate must be positive." << std::endl;
+    return false;
+  }
+
+  if (_options.imageRate > 0.0 &&
+      (_options.imageWidth == 0u || _options.imageHeight == 0u))
+  {
+    std::cerr << "Images need a size." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+int main(int _argc, char **_argv)
+{
+  Options options;
+  if (!parse(_argc, _argv, options))
+    return 1;
+
+  std::signal(SIGINT, [](int) {g_stop = true;});
+  std::signal(SIGTERM, [](int) {g_stop = true;});
+
+  WorldServer server(options);
+  if (!server.Advertise())
+    return 1;
+
+  std::cout << "Serving world [" << options.world << "] with ["
+            << options.entities << "] entities" << std::endl;
+
+  server.Run();
+
+  return 0;
+}
@@ -36,8 +36,14 @@ namespace ignition
   {
     class ApplicationPrivate;
     class Dialog;
+    class FrameTree;
+    class GuiDispatcher;
+    class LogSink;
     class MainWindow;
     class Plugin;
+    class SceneMutationQueue;
+    class StallMonitor;
+    class WorkerPool;
 
     /// \brief Type of window which the application will display
     enum class WindowType : int
@@ -47,7 +53,12 @@ namespace ignition
       kMainWindow = 0,
 
       /// \brief One independent dialog per plugin
-      kDialog = 1
+      kDialog = 1,
+
+      /// \brief No windows, plugins are loaded but not displayed. This is
+      /// used by the helper processes of plugins running out of process.
+      /// \sa Plugin::IsHelper
+      kHeadless = 2
     };
 
     /// \brief An Ignition GUI application loads a QML engine and
@@ -72,6 +83,51 @@ namespace ignition
       /// \return Pointer to QML engine
       public: QQmlApplicationEngine *Engine() const;
 
+      /// \brief Get the worker pool shared by all plugins. Prefer
+      /// Plugin::RunInBackground from within plugins, which takes care of
+      /// cancelling tasks when the plugin is removed.
+      /// \return Pointer to the worker pool, which is null once the
+      /// application starts shutting down.
+      public: WorkerPool *Workers() const;
+
+      /// \brief Get the dispatcher which runs calls posted from other
+      /// threads on the GUI thread, control calls first. Prefer
+      /// Plugin::PostToGuiThread from within plugins, which takes care of
+      /// cancelling calls when the plugin is removed.
+      /// \return Pointer to the dispatcher, which is null once the
+      /// application starts shutting down.
+      public: GuiDispatcher *Dispatcher() const;
+
+      /// \brief Get the queue of changes to 3D scenes, which scene
+      /// renderers such as Scene3D run on their render thread before each
+      /// frame. Plugins which display data in a scene they don't render post
+      /// their changes here.
+      /// \return Pointer to the queue, which is null once the application
+      /// starts shutting down.
+      public: SceneMutationQueue *SceneMutations() const;
+
+      /// \brief Get the coordinate frames of a 3D scene's entities, which
+      /// scene renderers such as Scene3D keep up to date. Plugins query it
+      /// for world poses instead of the render engine.
+      /// \param[in] _scene Name of the scene.
+      /// \return Pointer to the scene's frames, created on first use, which
+      /// is null once the application starts shutting down.
+      public: FrameTree *Frames(const std::string &_scene) const;
+
+      /// \brief Get the monitor which detects GUI thread stalls and keeps
+      /// track of the time spent by each plugin on the GUI thread.
+      /// \return Pointer to the monitor, which is null once the application
+      /// starts shutting down.
+      public: StallMonitor *Monitor() const;
+
+      /// \brief Get the asynchronous log sink which receives Qt's messages.
+      /// \return Pointer to the sink, which is null once the application
+      /// starts shutting down.
+      public: LogSink *Logs() const;
+
+      // Documentation inherited
+      public: bool notify(QObject *_receiver, QEvent *_event) override;
+
       /// \brief Load a plugin from a file name. The plugin file must be in the
       /// path.
       /// If a window has been initialized, the plugin is added to the window.
@@ -151,6 +207,16 @@ namespace ignition
       /// \param[in] _objectName Plugin's object name.
       signals: void PluginAdded(const QString &_objectName);
 
+      /// \brief Notify that one of the application's windows started or
+      /// stopped being exposed, i.e. that it may or may not be seen on the
+      /// screen. Windows aren't exposed while they're hidden, minimized, or,
+      /// on platforms which report it, fully covered by other windows.
+      /// Plugins on that window are suspended while it isn't exposed.
+      /// \param[in] _window Window whose exposure changed, check
+      /// QWindow::isExposed for the new state.
+      /// \sa Plugin::Suspended
+      signals: void WindowExposureChanged(QWindow *_window);
+
       /// \brief Callback when user requests to close a plugin
       public slots: void OnPluginClose();
 
@@ -184,6 +250,14 @@ namespace ignition
       /// initialized.
       private: bool ApplyConfig();
 
+      /// \brief Start tracking a window's exposure.
+      /// \param[in] _window Window to track.
+      /// \sa WindowExposureChanged
+      private: void WatchExposure(QWindow *_window);
+
+      // Documentation inherited
+      protected: bool eventFilter(QObject *_watched, QEvent *_event) override;
+
       /// \internal
       /// \brief Private data pointer
       private: std::unique_ptr<ApplicationPrivate> dataPtr;
@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_BENCHMARK_HH_
+#define IGNITION_GUI_BENCHMARK_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ignition/gui/Export.hh"
+#include "ignition/gui/GuiDispatcher.hh"
+#include "ignition/gui/LatencyHistogram.hh"
+#include "ignition/gui/StallMonitor.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class BenchmarkPrivate;
+
+    /// \brief Run Qt without a display, using the offscreen platform and
+    /// software rendering. Must be called before the Application is
+    /// constructed. Variables already set in the environment are kept, so a
+    /// different platform or renderer can still be chosen.
+    IGNITION_GUI_VISIBLE
+    void useOffscreenPlatform();
+
+    /// \brief Summarize durations.
+    /// \param[in] _samples Durations, in milliseconds, in any order.
+    /// \return Summary, all zeros if there are no samples.
+    IGNITION_GUI_VISIBLE
+    DurationStats durationStats(std::vector<double> _samples);
+
+    /// \brief Results of a benchmark run.
+    struct BenchmarkReport
+    {
+      /// \brief Time taken to start the application and load the config.
+      /// Measured by whoever creates the application, such as
+      /// `ign gui --benchmark`, zero otherwise.
+      std::chrono::steady_clock::duration startup{0};
+
+      /// \brief Number of frames measured, not counting warmup frames.
+      uint64_t frames{0u};
+
+      /// \brief Target frame period.
+      std::chrono::milliseconds framePeriod{0};
+
+      /// \brief Time taken by each frame to handle pending events and
+      /// render the window. Publishing and idle time aren't included.
+      DurationStats frameTimes;
+
+      /// \brief Number of frames which took longer than the frame period.
+      uint64_t slowFrames{0u};
+
+      /// \brief Event loop latency, sampled once per frame. The maximum is
+      /// the highest latency measured, even between samples.
+      DurationStats latency;
+
+      /// \brief Time each plugin spent on the GUI thread.
+      std::vector<GuiThreadTime> plugins;
+
+      /// \brief Time each plugin's background tasks spent on the workers,
+      /// by plugin name.
+      std::map<std::string, std::chrono::steady_clock::duration> workerTimes;
+
+      /// \brief Latencies reported by each plugin through
+      /// Plugin::RecordLatency, by plugin name and then by stage.
+      std::map<std::string, std::map<std::string, DurationStats>> latencies;
+
+      /// \brief CPU time used by the whole process while measuring, on all
+      /// threads. Zero where unsupported.
+      std::chrono::steady_clock::duration cpuTime{0};
+
+      /// \brief Peak resident memory of the process, in bytes. Zero where
+      /// unsupported.
+      uint64_t peakRss{0u};
+
+      /// \brief Control calls run by the dispatcher.
+      DeliveryStats control;
+
+      /// \brief Bulk calls run by the dispatcher.
+      DeliveryStats bulk;
+
+      /// \brief Number of GUI thread stalls.
+      uint64_t stalls{0u};
+
+      /// \brief Messages published on each topic while measuring.
+      std::map<std::string, uint64_t> published;
+    };
+
+    /// \brief Format a report as a human readable table.
+    /// \param[in] _report Report.
+    /// \return Text, ending in a new line.
+    IGNITION_GUI_VISIBLE
+    std::string benchmarkReportText(const BenchmarkReport &_report);
+
+    /// \brief Format a report as JSON, for dashboards. Durations are in
+    /// milliseconds.
+    /// \param[in] _report Report.
+    /// \return JSON object, ending in a new line.
+    IGNITION_GUI_VISIBLE
+    std::string benchmarkReportJson(const BenchmarkReport &_report);
+
+    /// \brief Drives the application's plugins for a fixed number of frames
+    /// while publishing synthetic messages, and measures how the GUI thread
+    /// copes.
+    ///
+    /// Messages are published from the GUI thread at the start of each
+    /// frame. Each publisher publishes a number of messages proportional to
+    /// its rate and the frame period, so runs with the same configuration
+    /// publish the same messages, regardless of how long frames take. Each
+    /// frame then handles pending events and renders the main window, if
+    /// any, and idles for the rest of the frame period.
+    ///
+    /// Benchmarks are usually loaded from a config file, which holds the
+    /// plugins along with a `<benchmark>` element, for example:
+    ///
+    /// ```
+    /// <benchmark>
+    ///   <frames>600</frames>
+    ///   <warmup>60</warmup>
+    ///   <frame_period>16</frame_period>
+    ///   <publisher>
+    ///     <topic>/camera</topic>
+    ///     <type>ignition.msgs.Image</type>
+    ///     <rate>30</rate>
+    ///     <width>1280</width>
+    ///     <height>720</height>
+    ///   </publisher>
+    ///   <publisher>
+    ///     <topic>/stats</topic>
+    ///     <type>ignition.msgs.WorldStatistics</type>
+    ///     <rate>5</rate>
+    ///     <data>iterations: 1</data>
+    ///   </publisher>
+    /// </benchmark>
+    /// ```
+    ///
+    /// Use useOffscreenPlatform to run on machines without a display or GPU.
+    class IGNITION_GUI_VISIBLE Benchmark
+    {
+      /// \brief Constructor. An Application must exist.
+      public: Benchmark();
+
+      /// \brief Destructor
+      public: ~Benchmark();
+
+      /// \brief Load the `<benchmark>` element of a config file, and the
+      /// config's plugins into the application.
+      /// \param[in] _config Path to the config file.
+      /// \return True if successful.
+      public: bool Load(const std::string &_config);
+
+      /// \brief Publish a message built from text.
+      /// \param[in] _topic Topic.
+      /// \param[in] _type Message type, such as "ignition.msgs.StringMsg".
+      /// \param[in] _rate Messages per second.
+      /// \param[in] _data Message in protobuf's text format. Its header
+      /// stamp, if any, is set to the benchmark time when published, and its
+      /// publication time is set with stampPublishTime.
+      /// \return True if the publisher was created.
+      public: bool AddPublisher(const std::string &_topic,
+          const std::string &_type, const double _rate,
+          const std::string &_data = std::string());
+
+      /// \brief Publish synthetic RGB images, with a pattern which changes
+      /// from one image to the next.
+      /// \param[in] _topic Topic.
+      /// \param[in] _rate Images per second.
+      /// \param[in] _width Width in pixels.
+      /// \param[in] _height Height in pixels.
+      /// \return True if the publisher was created.
+      public: bool AddImagePublisher(const std::string &_topic,
+          const double _rate, const unsigned int _width,
+          const unsigned int _height);
+
+      /// \brief Set the number of frames measured.
+      /// \param[in] _frames Frames, defaults to 300.
+      public: void SetFrames(const unsigned int _frames);
+
+      /// \brief Get the number of frames measured.
+      /// \return Frames.
+      public: unsigned int Frames() const;
+
+      /// \brief Set the number of frames run before measuring, giving
+      /// plugins time to subscribe and fill their caches.
+      /// \param[in] _frames Frames, defaults to 30.
+      public: void SetWarmup(const unsigned int _frames);
+
+      /// \brief Get the number of warmup frames.
+      /// \return Frames.
+      public: unsigned int Warmup() const;
+
+      /// \brief Set the target frame period.
+      /// \param[in] _period Period, defaults to 16 ms.
+      public: void SetFramePeriod(const std::chrono::milliseconds &_period);
+
+      /// \brief Get the target frame period.
+      /// \return Period.
+      public: std::chrono::milliseconds FramePeriod() const;
+
+      /// \brief Run the warmup frames, then the measured frames. Must be
+      /// called on the GUI thread.
+      /// \return Report of the measured frames.
+      public: BenchmarkReport Run();
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<BenchmarkPrivate> dataPtr;
+    };
+  }
+}
+#endif
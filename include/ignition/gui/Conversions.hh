@@ -18,7 +18,14 @@
 #ifndef IGNITION_GUI_CONVERSIONS_HH_
 #define IGNITION_GUI_CONVERSIONS_HH_
 
+#include <google/protobuf/repeated_field.h>
+
+#include <cstddef>
+#include <vector>
+
+#include <ignition/msgs/pose.pb.h>
 #include <ignition/msgs/time.pb.h>
+#include <ignition/msgs/vector3d.pb.h>
 #include <ignition/common/Time.hh>
 #include <ignition/math/Color.hh>
 #include <ignition/math/Vector2.hh>
@@ -92,6 +99,56 @@ namespace ignition
     /// \return An ignition::msgs::Time object
     IGNITION_GUI_VISIBLE
     msgs::Time convert(const common::Time &_t);
+
+    /// \brief Narrow an array of doubles to floats, using SIMD
+    /// instructions where available.
+    /// \param[in] _in First of the values to convert.
+    /// \param[in] _count Number of values.
+    /// \param[out] _out Array with room for _count values. May not overlap
+    /// with _in.
+    IGNITION_GUI_VISIBLE
+    void convert(const double *_in, const std::size_t _count, float *_out);
+
+    /// \brief Convert a repeated field of doubles, such as the ranges of a
+    /// msgs::LaserScan, to floats.
+    ///
+    /// The bulk conversions write into a vector which is resized to fit, so
+    /// converting every message into the same vector doesn't allocate once
+    /// its capacity is large enough.
+    /// \param[in] _values Values to convert.
+    /// \param[out] _out One float per value.
+    IGNITION_GUI_VISIBLE
+    void convert(const google::protobuf::RepeatedField<double> &_values,
+        std::vector<float> &_out);
+
+    /// \brief Convert a repeated field of vectors, such as the points of a
+    /// msgs::Marker, to contiguous floats.
+    /// \param[in] _points Vectors to convert.
+    /// \param[out] _out Three floats per vector: X, Y and Z.
+    IGNITION_GUI_VISIBLE
+    void convert(
+        const google::protobuf::RepeatedPtrField<msgs::Vector3d> &_points,
+        std::vector<float> &_out);
+
+    /// \brief Convert a repeated field of vectors to contiguous doubles.
+    /// \param[in] _points Vectors to convert.
+    /// \param[out] _out Three doubles per vector: X, Y and Z.
+    IGNITION_GUI_VISIBLE
+    void convert(
+        const google::protobuf::RepeatedPtrField<msgs::Vector3d> &_points,
+        std::vector<double> &_out);
+
+    /// \brief Convert a repeated field of poses, such as the poses of a
+    /// msgs::Pose_V, to contiguous doubles. Fields are copied as they are,
+    /// so unlike msgs::Convert, orientations aren't normalized and unset
+    /// ones are all zeros. Call math::Pose3d::Correct on poses built from
+    /// the output to get the same poses as msgs::Convert.
+    /// \param[in] _poses Poses to convert.
+    /// \param[out] _out Seven doubles per pose: position X, Y and Z, then
+    /// orientation W, X, Y and Z.
+    IGNITION_GUI_VISIBLE
+    void convert(const google::protobuf::RepeatedPtrField<msgs::Pose> &_poses,
+        std::vector<double> &_out);
   }
 }
 #endif
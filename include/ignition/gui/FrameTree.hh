@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_FRAMETREE_HH_
+#define IGNITION_GUI_FRAMETREE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class FrameTreePrivate;
+
+    /// \brief Hierarchy of the coordinate frames of a 3D scene's entities,
+    /// such as models, links and visuals, which answers world pose queries
+    /// from any thread without touching the render engine.
+    ///
+    /// Frames hold their pose relative to their parent. World poses are
+    /// computed when queried and cached until the local pose of the frame
+    /// or one of its ancestors changes, which marks the frame and its
+    /// descendants as dirty. Marking stops at frames which are already
+    /// dirty, so moving an entity many times between queries costs little,
+    /// and querying many frames which didn't move is a lookup each.
+    ///
+    /// Scene renderers such as Scene3D fill the tree of their scene,
+    /// available through Application::Frames, as entities are loaded,
+    /// moved and deleted.
+    ///
+    /// Thread safe.
+    class IGNITION_GUI_VISIBLE FrameTree
+    {
+      /// \brief Parent of frames directly in the world.
+      public: static const unsigned int kWorld;
+
+      /// \brief Constructor.
+      public: FrameTree();
+
+      /// \brief Destructor.
+      public: ~FrameTree();
+
+      /// \brief Add a frame, or replace one with the same id, keeping its
+      /// children.
+      /// \param[in] _id Entity id, not kWorld.
+      /// \param[in] _name Scoped name, such as "model::link".
+      /// \param[in] _localPose Pose relative to the parent.
+      /// \param[in] _parent Id of the parent, which must have been added,
+      /// kWorld for frames directly in the world.
+      /// \return False if the parent is unknown or would be a descendant.
+      public: bool Add(const unsigned int _id, const std::string &_name,
+          const math::Pose3d &_localPose,
+          const unsigned int _parent = kWorld);
+
+      /// \brief Remove a frame and its descendants.
+      /// \param[in] _id Entity id.
+      /// \return Number of frames removed.
+      public: std::size_t Remove(const unsigned int _id);
+
+      /// \brief Remove all frames.
+      public: void Clear();
+
+      /// \brief Set the pose of a frame relative to its parent.
+      /// \param[in] _id Entity id.
+      /// \param[in] _localPose Pose relative to the parent.
+      /// \return False if the frame is unknown.
+      public: bool SetLocalPose(const unsigned int _id,
+          const math::Pose3d &_localPose);
+
+      /// \brief Get the pose of a frame relative to its parent.
+      /// \param[in] _id Entity id.
+      /// \param[out] _localPose Pose relative to the parent.
+      /// \return False if the frame is unknown.
+      public: bool LocalPose(const unsigned int _id,
+          math::Pose3d &_localPose) const;
+
+      /// \brief Get the pose of a frame in the world.
+      /// \param[in] _id Entity id.
+      /// \param[out] _worldPose Pose in the world.
+      /// \return False if the frame is unknown.
+      public: bool WorldPose(const unsigned int _id,
+          math::Pose3d &_worldPose) const;
+
+      /// \brief Get the world poses of many frames at once, which is
+      /// cheaper than querying them one by one.
+      /// \param[in] _ids Entity ids.
+      /// \param[out] _worldPoses Poses in the world, replaced, in the order
+      /// of the ids. Unknown frames get a zero pose.
+      /// \return Number of frames found.
+      public: std::size_t WorldPoses(const std::vector<unsigned int> &_ids,
+          std::vector<math::Pose3d> &_worldPoses) const;
+
+      /// \brief Get the id of a frame from its scoped name.
+      /// \param[in] _name Scoped name, such as "model::link".
+      /// \param[out] _id Entity id.
+      /// \return False if no frame has that name.
+      public: bool Id(const std::string &_name, unsigned int &_id) const;
+
+      /// \brief Get the scoped name of a frame.
+      /// \param[in] _id Entity id.
+      /// \return Scoped name, empty if the frame is unknown.
+      public: std::string Name(const unsigned int _id) const;
+
+      /// \brief Get the parent of a frame.
+      /// \param[in] _id Entity id.
+      /// \return Id of the parent, kWorld if the frame is directly in the
+      /// world or unknown.
+      public: unsigned int Parent(const unsigned int _id) const;
+
+      /// \brief Get the children of a frame.
+      /// \param[in] _id Entity id, kWorld for frames directly in the world.
+      /// \return Ids of the children.
+      public: std::vector<unsigned int> Children(const unsigned int _id)
+          const;
+
+      /// \brief Get the number of frames.
+      /// \return Number of frames.
+      public: std::size_t Count() const;
+
+      /// \brief Get the number of world poses computed so far, as opposed to
+      /// read from the cache.
+      /// \return Number of world poses computed.
+      public: uint64_t Computations() const;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<FrameTreePrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_GUIDISPATCHER_HH_
+#define IGNITION_GUI_GUIDISPATCHER_HH_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "ignition/gui/qt.h"
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class GuiDispatcherPrivate;
+
+    /// \brief Lane of a call posted to the GUI thread through a
+    /// GuiDispatcher.
+    enum class DeliveryLane : int
+    {
+      /// \brief Small updates the user is waiting on, such as service
+      /// replies to button presses or simulation state. These jump ahead of
+      /// bulk calls and are never coalesced.
+      kControl = 0,
+
+      /// \brief Data streams such as images and echoed messages. Calls with
+      /// the same key are coalesced, and they're spread across event loop
+      /// iterations so they can't starve input and painting.
+      kBulk = 1
+    };
+
+    /// \brief Statistics of one lane.
+    struct DeliveryStats
+    {
+      /// \brief Number of calls run.
+      uint64_t count{0u};
+
+      /// \brief Number of calls replaced by a newer call with the same key
+      /// before running.
+      uint64_t coalesced{0u};
+
+      /// \brief Total time calls waited between being posted and running.
+      std::chrono::steady_clock::duration totalWait{0};
+
+      /// \brief Longest time a call waited between being posted and running.
+      std::chrono::steady_clock::duration maxWait{0};
+    };
+
+    /// \brief Runs calls posted from any thread on the GUI thread, giving
+    /// priority to control calls over bulk data.
+    ///
+    /// Control calls are posted to Qt's event queue with a high priority, so
+    /// they're handled before events queued earlier. Bulk calls with the same
+    /// context and key replace each other while waiting, so only the latest
+    /// one runs. Bulk calls are run for at most the bulk budget per event
+    /// loop iteration, and control calls posted meanwhile run first.
+    ///
+    /// Time spent on calls with a context is attributed to the context's
+    /// plugin by the StallMonitor.
+    ///
+    /// The application owns one dispatcher, see Application::Dispatcher.
+    /// Plugins usually don't use this class directly, see
+    /// Plugin::PostToGuiThread.
+    class IGNITION_GUI_VISIBLE GuiDispatcher : public QObject
+    {
+      /// \brief Constructor. Must be called on the GUI thread.
+      public: GuiDispatcher();
+
+      /// \brief Destructor. Calls which haven't run are discarded.
+      public: ~GuiDispatcher() override;
+
+      /// \brief Queue a call on the GUI thread. Can be called from any
+      /// thread.
+      /// \param[in] _context Object the call belongs to, such as a plugin,
+      /// used to coalesce, cancel and attribute calls. May be null.
+      /// \param[in] _func Call to run.
+      /// \param[in] _lane Lane.
+      /// \param[in] _key Bulk calls with the same context and non-empty key
+      /// are coalesced. Ignored for control calls.
+      /// \sa Cancel
+      public: void Post(const QObject *_context, std::function<void()> _func,
+          const DeliveryLane _lane = DeliveryLane::kBulk,
+          const std::string &_key = std::string());
+
+      /// \brief Discard all calls which haven't run yet for a context. Must
+      /// be called on the GUI thread, such as when the context is being
+      /// destroyed.
+      /// \param[in] _context Context given to Post.
+      public: void Cancel(const QObject *_context);
+
+      /// \brief Set how long bulk calls may run in a single event loop
+      /// iteration before the rest are deferred to the next one.
+      /// \param[in] _budget Budget, defaults to 8 ms.
+      public: void SetBulkBudget(const std::chrono::milliseconds &_budget);
+
+      /// \brief Get the bulk budget.
+      /// \return Budget.
+      public: std::chrono::milliseconds BulkBudget() const;
+
+      /// \brief Get the statistics of a lane.
+      /// \param[in] _lane Lane.
+      /// \return Statistics since the dispatcher was created or the last
+      /// ResetStats.
+      public: DeliveryStats Stats(const DeliveryLane _lane) const;
+
+      /// \brief Clear the statistics of both lanes.
+      public: void ResetStats();
+
+      // Documentation inherited
+      protected: bool event(QEvent *_event) override;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<GuiDispatcherPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_INPUTQUEUE_HH_
+#define IGNITION_GUI_INPUTQUEUE_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <ignition/common/MouseEvent.hh>
+#include <ignition/math/Vector2.hh>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class InputQueuePrivate;
+
+    /// \brief A mouse event, possibly standing for several consecutive
+    /// ones which have been coalesced.
+    struct InputEvent
+    {
+      /// \brief The latest of the coalesced events.
+      common::MouseEvent event;
+
+      /// \brief Drag or scroll amount of all the coalesced events, added up.
+      math::Vector2d drag{0, 0};
+
+      /// \brief When the earliest of the coalesced events was received.
+      std::chrono::steady_clock::time_point time;
+
+      /// \brief Number of events coalesced.
+      unsigned int count{1u};
+    };
+
+    /// \brief Passes mouse events from the thread receiving them, usually
+    /// the GUI thread, to a thread consuming them once per frame, such as a
+    /// render thread, without locks.
+    ///
+    /// Presses, releases and any other transitions are kept in order.
+    /// Consecutive moves with the same buttons held are coalesced into one,
+    /// adding up their drags, and so are consecutive scrolls, so the
+    /// consumer handles a handful of events per frame however high the
+    /// input rate is.
+    ///
+    /// Push and Flush must only be called from one thread, and Drain from
+    /// one other thread.
+    class IGNITION_GUI_VISIBLE InputQueue
+    {
+      /// \brief Constructor.
+      /// \param[in] _capacity Number of events which can be waiting to be
+      /// drained, rounded up to a power of two. Events which don't fit are
+      /// kept, coalesced, on the producer's side until there's room.
+      public: explicit InputQueue(const std::size_t _capacity = 1024u);
+
+      /// \brief Destructor.
+      public: ~InputQueue();
+
+      /// \brief Queue an event. Producer only.
+      /// \param[in] _event Event.
+      /// \param[in] _drag Drag or scroll amount since the previous event.
+      /// \param[in] _time When the event was received.
+      public: void Push(const common::MouseEvent &_event,
+          const math::Vector2d &_drag = math::Vector2d::Zero,
+          const std::chrono::steady_clock::time_point &_time =
+              std::chrono::steady_clock::now());
+
+      /// \brief Move events which didn't fit into the queue when they were
+      /// pushed, if there's room now. Producer only, call it regularly, such
+      /// as once per frame, so the last events aren't held back while no
+      /// new events are pushed.
+      public: void Flush();
+
+      /// \brief Take all queued events, coalesced. Consumer only.
+      /// \param[out] _events Events, oldest first. Cleared first, keeping
+      /// its capacity.
+      /// \return Number of events pushed which _events stands for.
+      public: std::size_t Drain(std::vector<InputEvent> &_events);
+
+      /// \brief Get the number of events which can be waiting to be
+      /// drained.
+      /// \return Capacity.
+      public: std::size_t Capacity() const;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<InputQueuePrivate> dataPtr;
+    };
+
+    /// \brief Coalesce an event into the previous one if both are moves
+    /// with the same buttons held, or both are scrolls.
+    /// \param[in, out] _previous Previous event, which takes the latest
+    /// position and the added up drag if coalesced.
+    /// \param[in] _next Following event.
+    /// \return True if coalesced, false if both must be kept.
+    IGNITION_GUI_VISIBLE
+    bool coalesce(InputEvent &_previous, const InputEvent &_next);
+  }
+}
+#endif
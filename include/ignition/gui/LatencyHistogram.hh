@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_LATENCYHISTOGRAM_HH_
+#define IGNITION_GUI_LATENCYHISTOGRAM_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <ignition/msgs/header.pb.h>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class LatencyHistogramPrivate;
+
+    /// \brief Summary of a set of durations.
+    struct DurationStats
+    {
+      /// \brief Number of samples.
+      uint64_t count{0u};
+
+      /// \brief Mean, in milliseconds.
+      double mean{0.0};
+
+      /// \brief Median, in milliseconds.
+      double p50{0.0};
+
+      /// \brief 95th percentile, in milliseconds.
+      double p95{0.0};
+
+      /// \brief 99th percentile, in milliseconds.
+      double p99{0.0};
+
+      /// \brief Maximum, in milliseconds.
+      double max{0.0};
+    };
+
+    /// \brief Set the wall clock time at which a message is published, as
+    /// an entry in its header's data with the key "publish_time" holding
+    /// nanoseconds since the epoch. Unlike the header stamp, which is
+    /// usually simulation time, this can be compared with the time at which
+    /// the message is handled, to measure end-to-end latency. Publishers in
+    /// other processes can set the same entry without this function.
+    /// \param[in, out] _header Header, an existing entry is replaced.
+    /// \param[in] _time Publication time.
+    IGNITION_GUI_VISIBLE
+    void stampPublishTime(msgs::Header &_header,
+        const std::chrono::system_clock::time_point &_time =
+            std::chrono::system_clock::now());
+
+    /// \brief Get the publication time set through stampPublishTime.
+    /// \param[in] _header Header.
+    /// \param[out] _time Publication time.
+    /// \return False if the header doesn't hold a valid publication time.
+    IGNITION_GUI_VISIBLE
+    bool publishTime(const msgs::Header &_header,
+        std::chrono::system_clock::time_point &_time);
+
+    /// \brief Histogram of latencies, with buckets which double in width,
+    /// from under 64 microseconds up to over 4 seconds. Memory use is
+    /// constant however many samples are added. The mean and maximum are
+    /// exact, percentiles are the upper bound of the bucket they fall in.
+    /// Not thread safe.
+    class IGNITION_GUI_VISIBLE LatencyHistogram
+    {
+      /// \brief Constructor
+      public: LatencyHistogram();
+
+      /// \brief Copy constructor
+      /// \param[in] _other Histogram to copy.
+      public: LatencyHistogram(const LatencyHistogram &_other);
+
+      /// \brief Destructor
+      public: ~LatencyHistogram();
+
+      /// \brief Assignment operator
+      /// \param[in] _other Histogram to copy.
+      /// \return Reference to this histogram.
+      public: LatencyHistogram &operator=(const LatencyHistogram &_other);
+
+      /// \brief Add a sample. Negative latencies, which happen when clocks
+      /// aren't in sync, are counted as zero.
+      /// \param[in] _latency Latency.
+      public: void Add(const std::chrono::steady_clock::duration &_latency);
+
+      /// \brief Get the number of samples.
+      /// \return Samples added since construction or the last reset.
+      public: uint64_t Count() const;
+
+      /// \brief Get the number of samples in each bucket.
+      /// \return Counts, the last bucket holds everything over the upper
+      /// bound of the one before it.
+      /// \sa BucketUpperBound
+      public: std::vector<uint64_t> Counts() const;
+
+      /// \brief Get the exclusive upper bound of a bucket.
+      /// \param[in] _bucket Bucket index.
+      /// \return Upper bound, the maximum duration for the last bucket.
+      public: static std::chrono::steady_clock::duration BucketUpperBound(
+          const std::size_t _bucket);
+
+      /// \brief Get a percentile.
+      /// \param[in] _p Fraction of samples, from 0 to 1.
+      /// \return Upper bound of the bucket holding the percentile, but never
+      /// more than the maximum. Zero if there are no samples.
+      public: std::chrono::steady_clock::duration Percentile(
+          const double _p) const;
+
+      /// \brief Summarize the samples.
+      /// \return Summary, all zeros if there are no samples.
+      public: DurationStats Stats() const;
+
+      /// \brief Remove all samples.
+      public: void Reset();
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<LatencyHistogramPrivate> dataPtr;
+    };
+  }
+}
+#endif
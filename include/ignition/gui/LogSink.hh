@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_LOGSINK_HH_
+#define IGNITION_GUI_LOGSINK_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class LogSinkPrivate;
+
+    /// \brief Severity of a log message
+    enum class LogLevel : int
+    {
+      /// \brief Debug message, printed with igndbg
+      kDebug = 0,
+
+      /// \brief Informational message, printed with ignmsg
+      kInfo = 1,
+
+      /// \brief Warning, printed with ignwarn
+      kWarning = 2,
+
+      /// \brief Error, printed with ignerr
+      kError = 3
+    };
+
+    /// \brief A message which went through a LogSink
+    struct LogEntry
+    {
+      /// \brief Sequence number, increasing from 1
+      uint64_t seq{0u};
+
+      /// \brief Severity
+      LogLevel level{LogLevel::kInfo};
+
+      /// \brief When the message was logged
+      std::chrono::system_clock::time_point time;
+
+      /// \brief Message text, UTF-8 encoded
+      std::string text;
+    };
+
+    /// \brief Asynchronous log pipeline.
+    ///
+    /// Each logging thread gets its own lock-free ring of fixed-size records,
+    /// so logging only copies the text and never allocates or locks. A
+    /// background writer drains the rings, collapses messages repeated
+    /// within a time window, prints them through the Ignition console and
+    /// keeps the latest ones in memory, see Entries.
+    ///
+    /// Messages longer than a record are truncated, and messages logged
+    /// while a thread's ring is full are dropped and counted.
+    ///
+    /// The application owns one sink, which receives Qt's messages, see
+    /// Application::Logs.
+    class IGNITION_GUI_VISIBLE LogSink
+    {
+      /// \brief Constructor. Starts the writer thread.
+      public: LogSink();
+
+      /// \brief Destructor. Writes pending messages and stops the writer.
+      public: ~LogSink();
+
+      /// \brief Queue a UTF-8 message.
+      /// \param[in] _level Severity.
+      /// \param[in] _text Text, doesn't need to be null-terminated.
+      /// \param[in] _length Number of bytes in _text.
+      public: void Log(const LogLevel _level, const char *_text,
+          const std::size_t _length);
+
+      /// \brief Queue a UTF-16 message, such as the contents of a QString,
+      /// optionally with a prefix and a context, such as the function which
+      /// logged it.
+      /// \param[in] _level Severity.
+      /// \param[in] _prefix Null-terminated UTF-8 prefix, may be null.
+      /// \param[in] _text UTF-16 text.
+      /// \param[in] _length Number of UTF-16 code units in _text.
+      /// \param[in] _context Null-terminated UTF-8 context, appended in
+      /// parentheses. May be null.
+      public: void Log(const LogLevel _level, const char *_prefix,
+          const char16_t *_text, const std::size_t _length,
+          const char *_context = nullptr);
+
+      /// \brief Block until all messages queued so far have been written.
+      public: void Flush();
+
+      /// \brief Get messages kept in memory, oldest first.
+      /// \param[in] _after Only return messages with a sequence number
+      /// greater than this, so callers can fetch just the new ones.
+      /// \return Messages.
+      public: std::vector<LogEntry> Entries(const uint64_t _after = 0u) const;
+
+      /// \brief Set how many messages are kept in memory.
+      /// \param[in] _size Number of messages, defaults to 1000.
+      public: void SetHistorySize(const std::size_t _size);
+
+      /// \brief Set the window within which identical messages are
+      /// collapsed. The first one is written, and the number of repetitions
+      /// is written once the window expires.
+      /// \param[in] _window Window, zero to disable. Defaults to 1 s.
+      public: void SetRepeatWindow(const std::chrono::milliseconds &_window);
+
+      /// \brief Set whether messages are printed to the console, in
+      /// addition to being kept in memory.
+      /// \param[in] _echo True to print, which is the default.
+      public: void SetEcho(const bool _echo);
+
+      /// \brief Get the number of messages dropped because a ring was full.
+      /// \return Number of dropped messages.
+      public: uint64_t DroppedCount() const;
+
+      /// \brief Get the number of messages collapsed as repetitions.
+      /// \return Number of repeated messages which weren't written.
+      public: uint64_t RepeatedCount() const;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<LogSinkPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -18,17 +18,27 @@
 #define IGNITION_GUI_PLUGIN_HH_
 
 #include <tinyxml2.h>
+#include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
 
+#include <ignition/transport/SubscribeOptions.hh>
+
 #include "ignition/gui/qt.h"
 #include "ignition/gui/Export.hh"
+#include "ignition/gui/GuiDispatcher.hh"
+#include "ignition/gui/LatencyHistogram.hh"
+#include "ignition/gui/Request.hh"
+#include "ignition/gui/WorkerPool.hh"
 
 namespace ignition
 {
   namespace gui
   {
     class PluginPrivate;
+    class SharedRing;
 
     /// \brief Base class for Ignition GUI plugins.
     ///
@@ -54,6 +64,15 @@ namespace ignition
       /// \brief Destructor
       public: virtual ~Plugin();
 
+      /// \brief Stop the plugin's background work: cancel its requests,
+      /// discard its queued tasks and GUI calls, wait for its running tasks
+      /// and stop its helper process. New tasks and GUI calls are ignored
+      /// afterwards. The application calls this before removing a plugin,
+      /// while the derived class' members which its tasks use are still
+      /// alive. It's also called by the destructor, and does nothing if
+      /// called again. Must not be called from the plugin's tasks.
+      public: void Shutdown();
+
       /// \brief Load the plugin with a configuration file.
       /// This loads the default parameters and then calls LoadConfig(), which
       /// should be overridden to load custom parameters.
@@ -86,6 +105,38 @@ namespace ignition
       /// has a parent.
       public: void PostParentChanges();
 
+      /// \brief Get whether the plugin is currently suspended, which happens
+      /// while its card can't be seen, for example when it's hidden,
+      /// collapsed to zero size, or its window isn't exposed on the screen.
+      /// \return True if suspended.
+      /// \sa Suspend
+      /// \sa Resume
+      public: bool Suspended() const;
+
+      /// \brief Notify that the plugin has been suspended or resumed.
+      signals: void SuspendedChanged();
+
+      /// \brief Get whether this instance is a proxy for an instance running
+      /// in a helper process, as requested through the `<separate_process>`
+      /// element of the `<ignition-gui>` block. Proxies only display
+      /// results, which the helper does the heavy work to produce and
+      /// passes through shared memory, see OnHelperData.
+      ///
+      /// If the helper fails to start or exits unexpectedly, the plugin
+      /// falls back to running in this process: it stops being a proxy and
+      /// Resume is called, unless it's suspended, so it can start the work
+      /// its helper was doing.
+      /// \return True if this is a proxy.
+      /// \sa IsHelper
+      public: bool IsProxy() const;
+
+      /// \brief Get whether this instance runs in a helper process on
+      /// behalf of a proxy in the main application. Helpers aren't displayed,
+      /// they write their results to HelperRing instead.
+      /// \return True if this is a helper.
+      /// \sa IsProxy
+      public: bool IsHelper() const;
+
       /// \brief Load the plugin with a configuration file. Override this
       /// on custom plugins to handle custom configurations.
       ///
@@ -97,6 +148,43 @@ namespace ignition
       protected: virtual void LoadConfig(
           const tinyxml2::XMLElement * /*_pluginElem*/) {}
 
+      /// \brief Called on the GUI thread when the plugin's card stops being
+      /// visible. Override this to pause subscriptions, conversions or
+      /// rendering which only serve the display.
+      /// \sa Resume
+      /// \sa Suspended
+      protected: virtual void Suspend() {}
+
+      /// \brief Called on the GUI thread when the plugin's card becomes
+      /// visible again after being suspended. Override this to undo what was
+      /// done in Suspend. Also called when a proxy falls back to running in
+      /// this process, see IsProxy.
+      /// \sa Suspend
+      protected: virtual void Resume() {}
+
+      /// \brief Called on the GUI thread when the memory reported through
+      /// SetMemoryUsage goes over the budget. Override this to drop caches
+      /// and report the new usage.
+      /// \param[in] _budget Budget in bytes.
+      /// \sa MemoryBudget
+      protected: virtual void ShrinkMemory(const uint64_t /*_budget*/) {}
+
+      /// \brief Called on the GUI thread of a proxy when its helper has
+      /// written to the ring. Only the latest slot is delivered, older ones
+      /// are skipped.
+      /// \param[in] _data Slot data, only valid during the call.
+      /// \param[in] _size Number of bytes in the slot.
+      /// \sa IsProxy
+      protected: virtual void OnHelperData(const void * /*_data*/,
+          const std::size_t /*_size*/) {}
+
+      /// \brief Called on the GUI thread of a helper when its proxy sends a
+      /// message with SendToHelper.
+      /// \param[in] _message Message.
+      /// \sa IsHelper
+      protected: virtual void OnProxyMessage(
+          const std::string & /*_message*/) {}
+
       /// \brief Get title
       /// \return Plugin title.
       public: virtual std::string Title() const {return this->title;}
@@ -110,6 +198,147 @@ namespace ignition
       /// parent.
       protected: void DeleteLater();
 
+      /// \brief Get the maximum rate at which messages on a topic should be
+      /// delivered to this plugin, as set through the `<max_rate>` elements
+      /// of the `<ignition-gui>` block. A `<max_rate>` with a `topic`
+      /// attribute takes precedence over one without it.
+      /// \param[in] _topic Topic name.
+      /// \return Maximum number of messages per second, or zero if the rate
+      /// is not limited.
+      public: uint64_t MaxRate(const std::string &_topic) const;
+
+      /// \brief Get the memory held by this plugin's buffers, as reported
+      /// through SetMemoryUsage.
+      /// \return Total tracked memory in bytes.
+      /// \sa MemoryUsageByCategory
+      public: uint64_t MemoryUsage() const;
+
+      /// \brief Get the memory held by this plugin's buffers, per category,
+      /// such as "images" or "textures".
+      /// \return Map of category to bytes.
+      public: std::map<std::string, uint64_t> MemoryUsageByCategory() const;
+
+      /// \brief Get the memory budget set through the `<memory_budget>`
+      /// element of the `<ignition-gui>` block.
+      /// \return Budget in bytes, or zero if there's no budget.
+      /// \sa ShrinkMemory
+      public: uint64_t MemoryBudget() const;
+
+      /// \brief Get the latencies reported through RecordLatency.
+      /// \return Map of stage, such as "pose_to_pixel", to histogram.
+      public: std::map<std::string, LatencyHistogram> Latencies() const;
+
+      /// \brief Remove all latencies reported so far, for example after
+      /// warming up. Can be called from any thread.
+      public: void ResetLatencies();
+
+      /// \brief Get the number of QML objects created for this plugin,
+      /// including its card. Must be called on the GUI thread.
+      /// \return Number of objects.
+      public: unsigned int QmlObjectCount() const;
+
+      /// \brief Get the subscription options which should be used when this
+      /// plugin subscribes to a topic. This applies the rate set through
+      /// `<max_rate>`, so that excess messages are dropped by the transport
+      /// layer before being deserialized.
+      /// \param[in] _topic Topic name.
+      /// \return Options to be passed to transport::Node::Subscribe.
+      /// \sa MaxRate
+      protected: transport::SubscribeOptions SubscribeOptions(
+          const std::string &_topic) const;
+
+      /// \brief Run a task on the application's worker pool, instead of
+      /// creating a thread or blocking the GUI or transport threads. Queued
+      /// tasks are discarded when the plugin is removed, and removal waits
+      /// for running tasks to finish.
+      /// \param[in] _task Task to run on a worker thread.
+      /// \param[in] _onGuiThread Optional continuation, queued on the GUI
+      /// thread once the task finishes. It isn't called if the plugin has
+      /// been deleted by then. High priority tasks queue it in the control
+      /// lane, others in the bulk lane, see PostToGuiThread.
+      /// \param[in] _priority Task priority.
+      /// \sa Application::Workers
+      protected: void RunInBackground(std::function<void()> _task,
+          std::function<void()> _onGuiThread = nullptr,
+          const TaskPriority _priority = TaskPriority::kNormal);
+
+      /// \brief Queue a call on the GUI thread from any thread, such as a
+      /// transport callback. Control calls, such as replies to the user's
+      /// actions, run before bulk data calls queued earlier. Bulk calls with
+      /// the same key replace each other while waiting, so a flood of
+      /// messages only costs one call. Queued calls are discarded when the
+      /// plugin is removed.
+      /// \param[in] _func Call to run on the GUI thread.
+      /// \param[in] _lane Lane, bulk by default.
+      /// \param[in] _key Optional key to coalesce bulk calls.
+      /// \sa Application::Dispatcher
+      protected: void PostToGuiThread(std::function<void()> _func,
+          const DeliveryLane _lane = DeliveryLane::kBulk,
+          const std::string &_key = std::string());
+
+      /// \brief Make an asynchronous service request. Continuations run on
+      /// the GUI thread in the control lane by default. The request is
+      /// cancelled if the plugin is removed first, and its continuations
+      /// don't run.
+      ///
+      ///     this->Request<msgs::Boolean>(node, service, req).Then(
+      ///         [this](const msgs::Boolean &, const RequestStatus _status)
+      ///         {
+      ///           ...
+      ///         });
+      ///
+      /// \param[in] _node Node used to make the request.
+      /// \param[in] _service Service name.
+      /// \param[in] _req Request message.
+      /// \param[in] _timeout Time to wait for a reply, zero to wait forever.
+      /// \return Future reply.
+      /// \sa ignition::gui::request
+      protected: template <typename Rep, typename Req>
+      RequestFuture<Rep> Request(transport::Node &_node,
+          const std::string &_service, const Req &_req,
+          const std::chrono::milliseconds &_timeout =
+              std::chrono::milliseconds(5000))
+      {
+        auto future = gui::request<Rep>(_node, _service, _req, _timeout,
+            guiThreadExecutor(this));
+        this->TrackRequest(future.State());
+        return future;
+      }
+
+      /// \brief Report how much memory one of the plugin's buffers is
+      /// holding, replacing the previous value for that category. Can be
+      /// called from any thread. If this takes the plugin over its budget,
+      /// ShrinkMemory is queued on the GUI thread.
+      /// \param[in] _category Buffer category, such as "images".
+      /// \param[in] _bytes Memory held, in bytes.
+      protected: void SetMemoryUsage(const std::string &_category,
+          const uint64_t _bytes);
+
+      /// \brief Report how long a piece of data took to go through one of
+      /// the plugin's stages, such as from publication to display. Samples
+      /// are kept in a histogram per stage. Can be called from any thread.
+      /// \param[in] _stage Stage name.
+      /// \param[in] _latency Latency.
+      /// \sa Latencies
+      protected: void RecordLatency(const std::string &_stage,
+          const std::chrono::steady_clock::duration &_latency);
+
+      /// \brief Get the ring shared by a proxy and its helper. The helper
+      /// is its only writer, and must not write to it from more than one
+      /// thread at a time.
+      /// \return Pointer to the ring, or null if this is neither a proxy nor
+      /// a helper.
+      /// \sa OnHelperData
+      protected: SharedRing *HelperRing() const;
+
+      /// \brief Send a short control message from a proxy to its helper,
+      /// such as a new topic to subscribe to. Must be called on the GUI
+      /// thread.
+      /// \param[in] _message Message, which can't contain line breaks.
+      /// \return True if the message was sent.
+      /// \sa OnProxyMessage
+      protected: bool SendToHelper(const std::string &_message);
+
       /// \brief Title to be displayed on top of plugin.
       protected: std::string title = "";
 
@@ -129,6 +358,46 @@ namespace ignition
       /// through the <anchor> tag and any state properties.
       private: void ApplyAnchors();
 
+      /// \brief Check the visibility of the card and its window, and suspend
+      /// or resume the plugin accordingly.
+      private slots: void UpdateSuspended();
+
+      /// \brief Suspend or resume the plugin.
+      /// \param[in] _suspend True to suspend.
+      private: void SetSuspended(const bool _suspend);
+
+      /// \brief Keep track of a request, to cancel it when the plugin is
+      /// removed.
+      /// \param[in] _state Request state.
+      private: void TrackRequest(
+          const std::shared_ptr<RequestStateBase> &_state);
+
+      /// \brief Start the helper process of a proxy.
+      private: void StartHelper();
+
+      /// \brief Ask the helper process of a proxy to quit, without waiting
+      /// for it, and stop reading its ring.
+      private: void StopHelper();
+
+      /// \brief Run the plugin in this process after its helper failed to
+      /// start or exited unexpectedly.
+      private: void FallBackFromHelper();
+
+      /// \brief Attach a helper to its proxy's ring and start listening to
+      /// the proxy's messages.
+      private: void AttachToProxy();
+
+      /// \brief Deliver the latest slot written by the helper.
+      private: void ReadFromHelper();
+
+      /// \brief Handle a line received from the proxy.
+      /// \param[in] _line Line without the line break.
+      private: void OnProxyLine(const std::string &_line);
+
+      /// \brief Track the visibility of the window holding the card.
+      /// \param[in] _window New window, may be null.
+      private slots: void OnCardWindowChanged(QQuickWindow *_window);
+
       /// \internal
       /// \brief Pointer to private data
       private: std::unique_ptr<PluginPrivate> dataPtr;
@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_REQUEST_HH_
+#define IGNITION_GUI_REQUEST_HH_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gui/qt.h"
+#include "ignition/gui/Export.hh"
+#include "ignition/gui/GuiDispatcher.hh"
+#include "ignition/gui/WorkerPool.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class RequestStateBasePrivate;
+
+    /// \brief Status of a service request.
+    enum class RequestStatus : int
+    {
+      /// \brief No response yet.
+      kPending = 0,
+
+      /// \brief The service responded successfully.
+      kOk = 1,
+
+      /// \brief The service responded with a failure, or the request
+      /// couldn't be made.
+      kFailed = 2,
+
+      /// \brief No response arrived before the timeout.
+      kTimedOut = 3,
+
+      /// \brief The request was cancelled, such as when its plugin was
+      /// removed. Continuations aren't run.
+      kCancelled = 4
+    };
+
+    /// \brief Runs a continuation somewhere, such as on the GUI thread.
+    /// \sa guiThreadExecutor
+    /// \sa objectThreadExecutor
+    /// \sa workerExecutor
+    /// \sa inlineExecutor
+    using Executor = std::function<void(std::function<void()>)>;
+
+    /// \brief Run continuations on the GUI thread, through the application's
+    /// GuiDispatcher.
+    /// \param[in] _context Object the continuations belong to, such as a
+    /// plugin. Continuations which haven't run yet are discarded when the
+    /// dispatcher cancels the context.
+    /// \param[in] _lane Lane, replies are control calls by default.
+    /// \return Executor.
+    IGNITION_GUI_VISIBLE
+    Executor guiThreadExecutor(const QObject *_context = nullptr,
+        const DeliveryLane _lane = DeliveryLane::kControl);
+
+    /// \brief Run continuations on the thread an object lives in, such as a
+    /// render thread, through its event loop. Continuations are dropped if
+    /// the object is destroyed first.
+    /// \param[in] _object Object living in the target thread.
+    /// \return Executor.
+    IGNITION_GUI_VISIBLE
+    Executor objectThreadExecutor(QObject *_object);
+
+    /// \brief Run continuations on the application's worker pool.
+    /// \param[in] _owner Owner of the tasks, used by WorkerPool::Cancel.
+    /// \param[in] _priority Task priority.
+    /// \return Executor.
+    IGNITION_GUI_VISIBLE
+    Executor workerExecutor(const void *_owner = nullptr,
+        const TaskPriority _priority = TaskPriority::kNormal);
+
+    /// \brief Run continuations right away, on whichever thread completes the
+    /// request, usually a transport thread. Continuations must be short and
+    /// thread-safe. Cancelling the request waits for a running continuation
+    /// to return, so objects it captures can be destroyed right after
+    /// cancelling, but it must not wait on the thread which cancels.
+    /// \return Executor.
+    IGNITION_GUI_VISIBLE
+    Executor inlineExecutor();
+
+    /// \brief State shared by a request and its futures, independent of the
+    /// reply type. Thread-safe.
+    class IGNITION_GUI_VISIBLE RequestStateBase
+      : public std::enable_shared_from_this<RequestStateBase>
+    {
+      /// \brief Constructor
+      public: RequestStateBase();
+
+      /// \brief Destructor
+      public: virtual ~RequestStateBase();
+
+      /// \brief Get the status.
+      /// \return Status, pending until the request finishes.
+      public: RequestStatus Status() const;
+
+      /// \brief Finish the request, unless it has already finished, and run
+      /// its continuations.
+      /// \param[in] _status Final status, not pending.
+      /// \param[in] _store Optional function which stores the reply. Called
+      /// with the state locked, before continuations can see it.
+      /// \return True if this call finished the request.
+      public: bool Finish(const RequestStatus _status,
+          const std::function<void()> &_store = nullptr);
+
+      /// \brief Cancel the request, along with requests linked to it. Its
+      /// continuations won't run, and those already running on other threads
+      /// are waited for.
+      public: void Cancel();
+
+      /// \brief Add a function to be called once the request finishes,
+      /// unless it's cancelled. Called right away if already finished.
+      /// \param[in] _func Function, called on the finishing thread.
+      public: void OnFinished(std::function<void()> _func);
+
+      /// \brief Cancel another request whenever this one is cancelled, such
+      /// as a request chained to this one.
+      /// \param[in] _other Other request.
+      public: void Link(const std::shared_ptr<RequestStateBase> &_other);
+
+      /// \brief Finish as timed out if the request doesn't finish in time.
+      /// The timer runs on the GUI thread.
+      /// \param[in] _timeout Timeout.
+      public: void SetTimeout(const std::chrono::milliseconds &_timeout);
+
+      /// \brief Block until the request finishes. Must not be called on the
+      /// GUI thread, which runs timeouts.
+      /// \param[in] _timeout Maximum time to wait.
+      /// \return Status, which is still pending if the wait timed out.
+      public: RequestStatus Wait(const std::chrono::milliseconds &_timeout);
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<RequestStateBasePrivate> dataPtr;
+    };
+
+    /// \brief State of a request with a reply of a given type.
+    template <typename Rep>
+    class RequestState : public RequestStateBase
+    {
+      /// \brief Reply, set before the request finishes successfully.
+      public: Rep reply;
+    };
+
+    template <typename Rep>
+    class RequestFuture;
+
+    /// \brief Whether a type is a RequestFuture.
+    template <typename T>
+    struct IsRequestFuture : std::false_type {};
+
+    /// \brief Whether a type is a RequestFuture.
+    template <typename Rep>
+    struct IsRequestFuture<RequestFuture<Rep>> : std::true_type {};
+
+    /// \brief The future result of a service request, to which
+    /// continuations can be attached. Copies refer to the same request.
+    /// \sa request
+    template <typename Rep>
+    class RequestFuture
+    {
+      /// \brief Type of the reply.
+      public: using ReplyType = Rep;
+
+      /// \brief Constructor of an invalid future.
+      public: RequestFuture() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _state Request state.
+      /// \param[in] _executor Executor used by Then by default.
+      public: RequestFuture(std::shared_ptr<RequestState<Rep>> _state,
+          Executor _executor)
+        : state(std::move(_state)), executor(std::move(_executor))
+      {
+      }
+
+      /// \brief Get whether the future refers to a request.
+      /// \return True if valid.
+      public: bool Valid() const
+      {
+        return nullptr != this->state;
+      }
+
+      /// \brief Get the request's status.
+      /// \return Status, failed if invalid.
+      public: RequestStatus Status() const
+      {
+        return this->state ? this->state->Status() : RequestStatus::kFailed;
+      }
+
+      /// \brief Get the reply. Only meaningful once the status is ok.
+      /// \return Reply.
+      public: const Rep &Reply() const
+      {
+        return this->state->reply;
+      }
+
+      /// \brief Cancel the request and whatever was chained to it.
+      public: void Cancel()
+      {
+        if (this->state)
+          this->state->Cancel();
+      }
+
+      /// \brief Block until the request finishes. Must not be called on the
+      /// GUI thread.
+      /// \param[in] _timeout Maximum time to wait.
+      /// \return Status, still pending if the wait timed out.
+      public: RequestStatus Wait(const std::chrono::milliseconds &_timeout)
+      {
+        return this->state ? this->state->Wait(_timeout) :
+            RequestStatus::kFailed;
+      }
+
+      /// \brief Get the shared state, such as to cancel it later.
+      /// \return State, null if invalid.
+      public: std::shared_ptr<RequestStateBase> State() const
+      {
+        return this->state;
+      }
+
+      /// \brief Run a function once the request finishes successfully, fails
+      /// or times out. The function receives the reply and the status. If it
+      /// returns another RequestFuture, such as from a follow-up request,
+      /// Then returns a future of that request, so requests can be chained.
+      /// \param[in] _func Function taking (const Rep &, RequestStatus).
+      /// \param[in] _executor Where to run the function. Defaults to the
+      /// executor the future was created with.
+      /// \return Nothing, or a future of the request returned by _func.
+      public: template <typename Func>
+      auto Then(Func _func, Executor _executor = nullptr) const
+      {
+        using Result =
+            std::invoke_result_t<Func, const Rep &, RequestStatus>;
+        static_assert(std::is_void_v<Result> || IsRequestFuture<Result>::value,
+            "Continuations must return void or a RequestFuture.");
+
+        if (!_executor)
+          _executor = this->executor;
+        auto current = this->state;
+
+        if constexpr (std::is_void_v<Result>)
+        {
+          if (!current)
+            return;
+
+          // The state keeps its continuations, which mustn't keep it
+          std::weak_ptr<RequestState<Rep>> weak = current;
+          current->OnFinished([weak, _func, _executor]()
+          {
+            auto finished = weak.lock();
+            if (!finished)
+              return;
+
+            auto run = [finished, _func]()
+            {
+              _func(finished->reply, finished->Status());
+            };
+            if (_executor)
+              _executor(run);
+            else
+              run();
+          });
+        }
+        else
+        {
+          using Next = typename Result::ReplyType;
+          auto next = std::make_shared<RequestState<Next>>();
+          if (!current)
+          {
+            next->Finish(RequestStatus::kFailed);
+            return Result(next, this->executor);
+          }
+          current->Link(next);
+
+          std::weak_ptr<RequestState<Rep>> weak = current;
+          current->OnFinished([weak, next, _func, _executor]()
+          {
+            auto finished = weak.lock();
+            if (!finished)
+              return;
+
+            auto run = [finished, next, _func]()
+            {
+              if (next->Status() != RequestStatus::kPending)
+                return;
+
+              auto inner = _func(finished->reply, finished->Status());
+              auto innerState = std::static_pointer_cast<RequestState<Next>>(
+                  inner.State());
+              if (!innerState)
+              {
+                next->Finish(RequestStatus::kFailed);
+                return;
+              }
+              next->Link(innerState);
+
+              std::weak_ptr<RequestState<Next>> weakInner = innerState;
+              innerState->OnFinished([weakInner, next]()
+              {
+                auto innerFinished = weakInner.lock();
+                if (!innerFinished)
+                  return;
+
+                next->Finish(innerFinished->Status(), [&]()
+                {
+                  next->reply = innerFinished->reply;
+                });
+              });
+            };
+            if (_executor)
+              _executor(run);
+            else
+              run();
+          });
+
+          return Result(next, this->executor);
+        }
+      }
+
+      /// \brief Shared request state
+      private: std::shared_ptr<RequestState<Rep>> state;
+
+      /// \brief Default executor for continuations
+      private: Executor executor;
+    };
+
+    /// \brief Make an asynchronous service request. If the service isn't
+    /// available yet, the request is sent once it's discovered, or times
+    /// out.
+    ///
+    /// Plugins should prefer Plugin::Request, which cancels requests when
+    /// the plugin is removed.
+    /// \param[in] _node Node used to make the request. Replies are dropped
+    /// if it's destroyed first, and the request times out.
+    /// \param[in] _service Service name.
+    /// \param[in] _req Request message.
+    /// \param[in] _timeout Time to wait for a reply, zero to wait forever.
+    /// \param[in] _executor Default executor for continuations, the GUI
+    /// thread if null.
+    /// \return Future reply.
+    template <typename Rep, typename Req>
+    RequestFuture<Rep> request(transport::Node &_node,
+        const std::string &_service, const Req &_req,
+        const std::chrono::milliseconds &_timeout =
+            std::chrono::milliseconds(5000),
+        Executor _executor = nullptr)
+    {
+      if (!_executor)
+        _executor = guiThreadExecutor();
+
+      auto state = std::make_shared<RequestState<Rep>>();
+
+      std::function<void(const Rep &, const bool)> cb =
+          [state](const Rep &_rep, const bool _result)
+      {
+        state->Finish(_result ? RequestStatus::kOk : RequestStatus::kFailed,
+            [&]() {state->reply = _rep;});
+      };
+
+      if (!_node.Request(_service, _req, cb))
+        state->Finish(RequestStatus::kFailed);
+      else if (_timeout.count() > 0)
+        state->SetTimeout(_timeout);
+
+      return RequestFuture<Rep>(state, _executor);
+    }
+  }
+}
+#endif
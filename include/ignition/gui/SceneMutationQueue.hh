@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_SCENEMUTATIONQUEUE_HH_
+#define IGNITION_GUI_SCENEMUTATIONQUEUE_HH_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class SceneMutationQueuePrivate;
+
+    /// \brief Changes queued for 3D scenes by plugins other than the one
+    /// rendering them, such as visuals displaying sensor data.
+    ///
+    /// Render engines must only be used from the thread rendering the
+    /// scene, so instead of touching the scene from the GUI, transport or
+    /// worker threads, plugins post mutations here, and the scene's
+    /// renderer, such as Scene3D, runs them right before rendering each
+    /// frame. Mutations find the scene by name through the render engine.
+    ///
+    /// Mutations outlive the plugins which posted them when the scene
+    /// isn't rendered, so they should hold shared state rather than
+    /// pointers to the plugin.
+    class IGNITION_GUI_VISIBLE SceneMutationQueue
+    {
+      /// \brief Constructor.
+      public: SceneMutationQueue();
+
+      /// \brief Destructor. Mutations which haven't run are discarded.
+      public: ~SceneMutationQueue();
+
+      /// \brief Queue a mutation. Can be called from any thread.
+      /// \param[in] _scene Name of the scene.
+      /// \param[in] _mutation Function run on the scene's render thread.
+      /// \param[in] _key Optional key. A pending mutation of the same scene
+      /// with the same non-empty key is replaced, keeping its place in line,
+      /// so that data arriving faster than frames are rendered only costs
+      /// one mutation per frame.
+      public: void Post(const std::string &_scene,
+          std::function<void()> _mutation,
+          const std::string &_key = std::string());
+
+      /// \brief Run a scene's pending mutations, in the order they were
+      /// posted. Called by the scene's renderer, on its render thread,
+      /// before rendering each frame. Mutations posted while running are
+      /// left for the next call.
+      /// \param[in] _scene Name of the scene.
+      /// \return Number of mutations run.
+      public: std::size_t Run(const std::string &_scene);
+
+      /// \brief Get the number of mutations waiting to run on a scene.
+      /// \param[in] _scene Name of the scene.
+      /// \return Number of pending mutations.
+      public: std::size_t Pending(const std::string &_scene) const;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<SceneMutationQueuePrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -17,6 +17,8 @@
 #ifndef IGNITION_GUI_SEARCHMODEL_HH_
 #define IGNITION_GUI_SEARCHMODEL_HH_
 
+#include <memory>
+
 #include "ignition/gui/Export.hh"
 #include "ignition/gui/qt.h"
 
@@ -24,6 +26,8 @@ namespace ignition
 {
 namespace gui
 {
+  class SearchModelPrivate;
+
   /// \brief Customize the proxy model to display search results.
   ///
   /// Features:
@@ -33,8 +37,32 @@ namespace gui
   ///   applicable
   /// * Items with DataRole::TYPE == "title" are ignored
   ///
+  /// The source model's text is indexed once, lowercased, and kept up to
+  /// date as the source model changes. Each search then takes a single pass
+  /// over the index, which decides whether every row is accepted and
+  /// expanded, so searching large trees takes time proportional to the
+  /// number of rows, whatever their depth.
+  ///
+  /// Words which extend a word of the previous search, as happens while
+  /// typing, are only tested against the rows which matched it. Models with
+  /// at least BackgroundThreshold rows are searched on the application's
+  /// workers, and the result is applied in a single layout change. Until
+  /// then the previous result is kept, and the results of searches which
+  /// have been superseded are dropped.
+  ///
   class IGNITION_GUI_VISIBLE SearchModel : public QSortFilterProxyModel
   {
+    /// \brief Constructor
+    public: SearchModel();
+
+    /// \brief Destructor
+    public: ~SearchModel() override;
+
+    /// \brief Overloaded Qt method. Watch the source model for changes
+    /// which require reindexing it.
+    /// \param[in] _model Source model.
+    public: void setSourceModel(QAbstractItemModel *_model) override;
+
     /// \brief Overloaded Qt method. Customize so we accept rows where:
     /// 1. Each of the words can be found in its ancestors or itself, but not
     /// necessarily all words on the same row, or
@@ -59,35 +87,53 @@ namespace gui
     public: bool filterAcceptsRow(const int _srcRow,
                                   const QModelIndex &_srcParent) const;
 
-    /// \brief Check if row contains the word on itself.
-    /// \param[in] _srcRow Row on the source model.
-    /// \param[in] _srcParent Parent on the source model.
-    /// \param[in] _word Word to be checked.
-    /// \return True if row matches.
-    public: bool FilterAcceptsRowItself(const int _srcRow,
-                                        const QModelIndex &_srcParent,
-                                        const QString &_word) const;
+    /// \brief Get the number of rows in the search index, which covers
+    /// the whole source model. The index is built on the first search.
+    /// \return Number of indexed rows.
+    public: int IndexedRowCount() const;
 
-    /// \brief Check if any of the children is fully accepted.
+    /// \brief Get the number of distinct texts the latest search tested
+    /// its words against. Searches whose words extend the previous
+    /// search's words only test the texts which matched those.
+    /// \return Number of texts tested, zero before the first search.
+    public: int TestedTextCount() const;
+
+    /// \brief Set the number of rows from which searches run in the
+    /// background. Searches only run in the background while there is an
+    /// Application with workers.
+    /// \param[in] _rows Number of rows, zero or less to always search on
+    /// the GUI thread. Defaults to 20000.
+    public: void SetBackgroundThreshold(const int _rows);
+
+    /// \brief Get the number of rows from which searches run in the
+    /// background.
+    /// \return Number of rows.
+    /// \sa SetBackgroundThreshold
+    public: int BackgroundThreshold() const;
+
+    /// \brief Check if a background search hasn't been applied yet.
+    /// \return True while searching in the background.
+    public: bool Searching() const;
+
+    /// \brief Check if any of the children is fully accepted. This walks
+    /// the subtree, use filterAcceptsRow to benefit from the search index.
     /// \param[in] _srcRow Row on the source model.
     /// \param[in] _srcParent Parent on the source model.
     /// \return True if any of the children match.
     public: bool HasAcceptedChildren(const int _srcRow,
                                      const QModelIndex &_srcParent) const;
 
-    /// \brief Check if any of the children accepts a specific word.
-    /// \param[in] _srcParent Parent on the source model.
-    /// \param[in] _word Word to be checked.
-    /// \return True if any of the children match.
-    public: bool HasChildAcceptsItself(const QModelIndex &_srcParent,
-                                       const QString &_word) const;
-
-    /// \brief Set a new search value.
+    /// \brief Set a new search value. Large models are searched in the
+    /// background, see Searching.
     /// \param[in] _search Full search string.
     public: void SetSearch(const QString &_search);
 
     /// \brief Full search string.
     public: QString search;
+
+    /// \internal
+    /// \brief Private data pointer
+    private: std::unique_ptr<SearchModelPrivate> dataPtr;
   };
 }
 }
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_SHAREDIMAGE_HH_
+#define IGNITION_GUI_SHAREDIMAGE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <ignition/msgs/image.pb.h>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class SharedImagePublisherPrivate;
+
+    /// \brief Header of each image written by a SharedImagePublisher,
+    /// followed by the image's pixels.
+    struct SharedImageHeader
+    {
+      /// \brief Width in pixels
+      uint32_t width{0u};
+
+      /// \brief Height in pixels
+      uint32_t height{0u};
+
+      /// \brief Number of bytes per row
+      uint32_t step{0u};
+
+      /// \brief Pixel format, see msgs::PixelFormatType
+      uint32_t pixelFormat{0u};
+
+      /// \brief Timestamp, seconds
+      int64_t sec{0};
+
+      /// \brief Timestamp, nanoseconds
+      int32_t nsec{0};
+
+      /// \brief Unused, keeps the pixels 8-byte aligned
+      uint32_t reserved{0u};
+    };
+
+    /// \brief Publishes images to subscribers on the same machine through
+    /// shared memory, instead of serializing them and copying them through
+    /// sockets.
+    ///
+    /// Pixels are written to a SharedRing, and a small msgs::Image without
+    /// data is published on the topic as a notification. The notification
+    /// carries the image's size, format and timestamp, and the ring's key in
+    /// its header, see SharedImageKey. Subscribers which support shared
+    /// memory, such as the ImageDisplay plugin, read the pixels in place.
+    /// Subscribers on other machines only receive the notifications.
+    ///
+    /// The latest images win: each image overwrites the oldest one which
+    /// isn't being read. Images are only dropped if subscribers are reading
+    /// every slot.
+    class IGNITION_GUI_VISIBLE SharedImagePublisher
+    {
+      /// \brief Constructor
+      public: SharedImagePublisher();
+
+      /// \brief Destructor
+      public: ~SharedImagePublisher();
+
+      /// \brief Create the ring and advertise the topic.
+      /// \param[in] _topic Topic, of type msgs::Image.
+      /// \param[in] _maxImageBytes Size of the largest image, in bytes.
+      /// \param[in] _slotCount Number of images the ring can hold.
+      /// \return True if successful.
+      public: bool Advertise(const std::string &_topic,
+          const std::size_t _maxImageBytes, const std::size_t _slotCount = 3u);
+
+      /// \brief Copy an image's pixels to the ring and notify subscribers.
+      /// \param[in] _msg Image.
+      /// \return True if published, false if dropped.
+      public: bool Publish(const msgs::Image &_msg);
+
+      /// \brief Get memory to write the next image's pixels to, so that
+      /// they don't need to be copied. Must be followed by EndImage.
+      /// \return Pointer to at least the maximum image size given to
+      /// Advertise, or null if every slot is being read.
+      public: void *BeginImage();
+
+      /// \brief Publish the image written to the memory returned by
+      /// BeginImage.
+      /// \param[in] _header Image size, format and timestamp.
+      /// \return True if published.
+      public: bool EndImage(const SharedImageHeader &_header);
+
+      /// \brief Get the ring's key.
+      /// \return Key, empty if not advertised.
+      public: std::string Key() const;
+
+      /// \brief Get the number of images dropped because every slot was
+      /// being read.
+      /// \return Number of dropped images.
+      public: uint64_t DroppedCount() const;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<SharedImagePublisherPrivate> dataPtr;
+    };
+
+    /// \brief Get the key of the SharedRing holding an image's pixels.
+    /// \param[in] _msg Image message.
+    /// \return Key, or empty if the message isn't a notification from a
+    /// SharedImagePublisher.
+    IGNITION_GUI_VISIBLE
+    std::string SharedImageKey(const msgs::Image &_msg);
+  }
+}
+#endif
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_SHAREDRING_HH_
+#define IGNITION_GUI_SHAREDRING_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class SharedRingPrivate;
+
+    /// \brief Ring buffer of fixed-size slots in shared memory, used to pass
+    /// large data, such as images, from one process to another on the same
+    /// machine without serializing or copying it through sockets.
+    ///
+    /// There must be a single writer, and there may be any number of
+    /// readers, which can attach before or after the writer starts writing.
+    /// Each reader keeps its own position, so readers don't take data from
+    /// each other. The latest writes win: the writer never blocks, and
+    /// overwrites the oldest slot which no reader is reading. Readers which
+    /// fall behind skip the writes which were overwritten. Writes are only
+    /// dropped if readers are reading every slot.
+    ///
+    /// Unless disabled, each write also releases a system semaphore, so a
+    /// single reader can block on Wait instead of polling. Other readers
+    /// need to be notified some other way, such as through a topic.
+    ///
+    /// Slots are read in place, the pointer returned by BeginRead is valid
+    /// until EndRead. The writer doesn't touch slots while they're being
+    /// read. A reader which crashes while reading keeps its slot from being
+    /// written again.
+    class IGNITION_GUI_VISIBLE SharedRing
+    {
+      /// \brief Constructor. The ring is invalid until Create or Attach
+      /// succeed.
+      public: SharedRing();
+
+      /// \brief Destructor. Detaches from the shared memory, which is
+      /// released once no process is attached to it anymore.
+      public: ~SharedRing();
+
+      /// \brief Create a new ring.
+      /// \param[in] _key Key other processes use to attach to the ring.
+      /// \param[in] _slotCount Number of slots, at least 2.
+      /// \param[in] _slotSize Maximum number of bytes per slot.
+      /// \param[in] _notify False if readers are notified some other way,
+      /// such as through a topic, and won't call Wait.
+      /// \return True if successful.
+      public: bool Create(const std::string &_key,
+          const std::size_t _slotCount, const std::size_t _slotSize,
+          const bool _notify = true);
+
+      /// \brief Attach to a ring created by another process, or by another
+      /// SharedRing in this process.
+      /// \param[in] _key Key given to Create.
+      /// \return True if successful.
+      public: bool Attach(const std::string &_key);
+
+      /// \brief Get whether the ring has been created or attached to.
+      /// \return True if valid.
+      public: bool Valid() const;
+
+      /// \brief Get the ring's key.
+      /// \return Key, empty if invalid.
+      public: std::string Key() const;
+
+      /// \brief Get the number of slots.
+      /// \return Number of slots, zero if invalid.
+      public: std::size_t SlotCount() const;
+
+      /// \brief Get the maximum number of bytes per slot.
+      /// \return Slot size, zero if invalid.
+      public: std::size_t SlotSize() const;
+
+      /// \brief Get the slot holding the oldest write which isn't being
+      /// read, so the writer can fill it in place. Must be followed by
+      /// EndWrite or AbortWrite.
+      /// \return Pointer to SlotSize bytes, or null if every slot is being
+      /// read or the ring is invalid.
+      public: void *BeginWrite();
+
+      /// \brief Publish the slot returned by BeginWrite and notify the
+      /// readers.
+      /// \param[in] _size Number of bytes written, up to SlotSize.
+      /// \return True if successful.
+      public: bool EndWrite(const std::size_t _size);
+
+      /// \brief Give back the slot returned by BeginWrite without
+      /// publishing it.
+      public: void AbortWrite();
+
+      /// \brief Copy data into the slot holding the oldest write which isn't
+      /// being read, and notify the readers.
+      /// \param[in] _data Data.
+      /// \param[in] _size Number of bytes, up to SlotSize.
+      /// \return True if successful, false if every slot is being read, in
+      /// which case the data is dropped, or if the data doesn't fit.
+      public: bool Write(const void *_data, const std::size_t _size);
+
+      /// \brief Get the oldest slot this reader hasn't read yet, which is
+      /// held until EndRead. Must be followed by EndRead if not null. Never
+      /// waits for the writer: slots being written are skipped, even if
+      /// the writer crashed while writing them.
+      /// \param[out] _size Number of bytes in the slot.
+      /// \param[in] _latest True to skip to the newest slot, skipping
+      /// older ones, such as when only the latest image is displayed.
+      /// \return Pointer to the slot's data, or null if there's nothing to
+      /// read.
+      public: const void *BeginRead(std::size_t &_size,
+          const bool _latest = false);
+
+      /// \brief Release the slot returned by BeginRead, so the writer can
+      /// overwrite it.
+      public: void EndRead();
+
+      /// \brief Block until the writer publishes a slot, or Wake is called.
+      /// There may be nothing to read when this returns, and several slots
+      /// may have been published. On rings created without notifications,
+      /// this just sleeps for a few milliseconds.
+      public: void Wait();
+
+      /// \brief Wake up a reader blocked on Wait, such as when shutting
+      /// down.
+      public: void Wake();
+
+      /// \brief Get the number of writes dropped because every slot was
+      /// being read.
+      /// \return Number of dropped writes.
+      public: uint64_t DroppedCount() const;
+
+      /// \brief Get the number of writes this reader skipped, because they
+      /// were overwritten before being read, including those made before it
+      /// attached, or because it read the latest slot.
+      /// \return Number of skipped writes.
+      public: uint64_t SkippedCount() const;
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<SharedRingPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_STALLMONITOR_HH_
+#define IGNITION_GUI_STALLMONITOR_HH_
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ignition/gui/qt.h"
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class StallMonitorPrivate;
+
+    /// \brief Time spent by a plugin on the GUI thread.
+    struct GuiThreadTime
+    {
+      /// \brief Plugin's unique name.
+      std::string plugin;
+
+      /// \brief Total time spent handling events and queued calls for the
+      /// plugin, not counting nested deliveries to other plugins.
+      std::chrono::steady_clock::duration total{0};
+
+      /// \brief Longest single delivery.
+      std::chrono::steady_clock::duration max{0};
+
+      /// \brief Number of deliveries.
+      uint64_t count{0u};
+
+      /// \brief Number of stalls attributed to the plugin.
+      uint64_t stalls{0u};
+    };
+
+    /// \brief Watches the GUI thread for stalls and keeps track of how much
+    /// time each plugin spends on it.
+    ///
+    /// Every event delivered on the GUI thread, which includes queued slot
+    /// calls and QMetaObject::invokeMethod, is timed and attributed to the
+    /// plugin owning its receiver. Owners are cached per receiver, so the
+    /// object hierarchy is only walked on a receiver's first delivery after
+    /// owners change, or after the receiver is destroyed and its address
+    /// reused. Deliveries don't take any lock: the GUI thread publishes the
+    /// deliveries in progress through atomics, which a watchdog thread
+    /// samples. The watchdog also periodically pings the GUI thread to
+    /// measure the event loop latency, and logs a warning when a single
+    /// delivery takes longer than the threshold. The warning names the
+    /// responsible plugin and lists the deliveries in progress, from the
+    /// outermost to the innermost.
+    ///
+    /// Apart from the threshold, stall count and latencies, the monitor
+    /// must only be used on the GUI thread.
+    ///
+    /// The application owns one monitor, see Application::Monitor.
+    class IGNITION_GUI_VISIBLE StallMonitor
+    {
+      /// \brief Constructor. Must be called on the GUI thread after the
+      /// Qt application has been created. Starts the watchdog thread.
+      public: StallMonitor();
+
+      /// \brief Destructor. Stops the watchdog thread.
+      public: ~StallMonitor();
+
+      /// \brief Set how long a delivery may block the GUI thread before it
+      /// is reported as a stall.
+      /// \param[in] _threshold Stall threshold, defaults to 200 ms.
+      public: void SetThreshold(const std::chrono::milliseconds &_threshold);
+
+      /// \brief Get the stall threshold.
+      /// \return Stall threshold.
+      public: std::chrono::milliseconds Threshold() const;
+
+      /// \brief Attribute an object, and all its descendants, to a plugin.
+      /// \param[in] _object Object such as the plugin, its item or its card.
+      /// \param[in] _plugin Plugin's unique name.
+      public: void AddOwner(const QObject *_object, const std::string &_plugin);
+
+      /// \brief Stop attributing objects to a plugin. The plugin's times are
+      /// kept.
+      /// \param[in] _plugin Plugin's unique name.
+      public: void RemoveOwner(const std::string &_plugin);
+
+      /// \brief Mark the start of an event delivery on the GUI thread.
+      /// Called by Application::notify.
+      /// \param[in] _receiver Object receiving the event.
+      /// \param[in] _event Event being delivered.
+      /// \sa EndDelivery
+      public: void BeginDelivery(const QObject *_receiver,
+          const QEvent *_event);
+
+      /// \brief Mark the end of the innermost delivery started with
+      /// BeginDelivery.
+      public: void EndDelivery();
+
+      /// \brief Get the time spent by each plugin on the GUI thread, sorted
+      /// from the most to the least time.
+      /// \return Times per plugin.
+      public: std::vector<GuiThreadTime> Times() const;
+
+      /// \brief Get the total number of stalls detected.
+      /// \return Number of stalls.
+      public: uint64_t StallCount() const;
+
+      /// \brief Get the latency of the most recent ping to the GUI thread,
+      /// i.e. how long an event posted from another thread waited before
+      /// being handled.
+      /// \return Latest event loop latency.
+      public: std::chrono::steady_clock::duration Latency() const;
+
+      /// \brief Get the highest event loop latency measured since the last
+      /// reset.
+      /// \return Maximum event loop latency.
+      public: std::chrono::steady_clock::duration MaxLatency() const;
+
+      /// \brief Clear all times, counts and latencies.
+      public: void Reset();
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<StallMonitorPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GUI_WORKERPOOL_HH_
+#define IGNITION_GUI_WORKERPOOL_HH_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "ignition/gui/Export.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class WorkerPoolPrivate;
+
+    /// \brief Priority of a task posted to a WorkerPool. Higher priority
+    /// tasks are always picked before lower priority ones.
+    enum class TaskPriority : int
+    {
+      /// \brief Background work which can wait, such as prefetching.
+      kLow = 0,
+
+      /// \brief Default priority.
+      kNormal = 1,
+
+      /// \brief Work the user is waiting on.
+      kHigh = 2
+    };
+
+    /// \brief A fixed-size pool of worker threads shared by the whole
+    /// application, so that the total number of threads stays bounded no
+    /// matter how many plugins are loaded.
+    ///
+    /// Each worker has its own queues. Tasks posted from a worker go to that
+    /// worker's queues, other tasks are distributed round-robin, and idle
+    /// workers steal from the other end of busy workers' queues.
+    ///
+    /// Plugins usually don't use this class directly, see
+    /// Plugin::RunInBackground.
+    class IGNITION_GUI_VISIBLE WorkerPool
+    {
+      /// \brief Constructor.
+      /// \param[in] _threadCount Number of worker threads. If zero, one less
+      /// than the number of hardware threads is used, with a minimum of one.
+      public: explicit WorkerPool(const unsigned int _threadCount = 0u);
+
+      /// \brief Destructor. Tasks which haven't started yet are discarded,
+      /// and running tasks are waited on.
+      public: ~WorkerPool();
+
+      /// \brief Get the number of worker threads.
+      /// \return Number of threads.
+      public: unsigned int ThreadCount() const;
+
+      /// \brief Queue a task to be run on one of the workers.
+      /// \param[in] _task Task to be run.
+      /// \param[in] _priority Task priority.
+      /// \param[in] _owner Optional pointer identifying who owns the task,
+      /// used to cancel it later.
+      /// \sa Cancel
+      public: void Post(std::function<void()> _task,
+          const TaskPriority _priority = TaskPriority::kNormal,
+          const void *_owner = nullptr);
+
+      /// \brief Discard all queued tasks belonging to an owner and block
+      /// until its running tasks have finished. Tasks posted for the owner
+      /// meanwhile, such as by its running tasks, are discarded too, so no
+      /// task of the owner is queued or running once this returns. Must not
+      /// be called from within one of the owner's tasks.
+      /// \param[in] _owner Owner given to Post.
+      public: void Cancel(const void *_owner);
+
+      /// \brief Block until there are no queued or running tasks.
+      public: void WaitForIdle();
+
+      /// \brief Get how long an owner's tasks have been running on the
+      /// workers, added up. Times are forgotten when the owner is cancelled.
+      /// \param[in] _owner Owner given to Post.
+      /// \return Busy time since the owner's first task or the last
+      /// ResetBusyTimes.
+      public: std::chrono::steady_clock::duration BusyTime(
+          const void *_owner) const;
+
+      /// \brief Clear the busy times of all owners.
+      public: void ResetBusyTimes();
+
+      /// \internal
+      /// \brief Private data pointer
+      private: std::unique_ptr<WorkerPoolPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -38,6 +38,25 @@ extern "C" IGNITION_GUI_VISIBLE void cmdConfig(const char *_config);
 /// \brief External hook to execute 'ign gui' from the command line.
 extern "C" IGNITION_GUI_VISIBLE void cmdEmptyWindow();
 
+/// \brief External hook to execute 'ign gui --benchmark' from the command
+/// line. Runs the config's plugins offscreen for a number of frames and
+/// prints a JSON report to the standard output.
+/// \param[in] _config Path to a config file, which may have a <benchmark>
+/// element.
+/// \param[in] _frames Number of frames to measure, overriding the config.
+/// Ignored if empty.
+/// \param[in] _duration Seconds to measure for, overriding the config and
+/// _frames. Ignored if empty.
+/// \return Exit code, zero on success.
+extern "C" IGNITION_GUI_VISIBLE int cmdBenchmark(const char *_config,
+    const char *_frames, const char *_duration);
+
+/// \brief External hook to execute 'ign gui --helper' from the command line.
+/// This runs a plugin in a helper process for a proxy in another Ignition GUI
+/// process, which writes the plugin's configuration and then control
+/// messages to the standard input. It's not meant to be run by hand.
+extern "C" IGNITION_GUI_VISIBLE void cmdHelper();
+
 /// \brief External hook when executing 'ign gui -t' from the command line.
 /// \param[in] _filename Path to a QSS file.
 extern "C" IGNITION_GUI_VISIBLE void cmdSetStyleFromFile(const char *_filename);
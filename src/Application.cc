@@ -16,7 +16,11 @@
  */
 
 #include <tinyxml2.h>
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <queue>
+#include <thread>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/SignalHandler.hh>
@@ -28,13 +32,27 @@
 #include "ignition/gui/Application.hh"
 #include "ignition/gui/config.hh"
 #include "ignition/gui/Dialog.hh"
+#include "ignition/gui/FrameTree.hh"
+#include "ignition/gui/GuiDispatcher.hh"
+#include "ignition/gui/LogSink.hh"
 #include "ignition/gui/MainWindow.hh"
 #include "ignition/gui/Plugin.hh"
+#include "ignition/gui/SceneMutationQueue.hh"
+#include "ignition/gui/StallMonitor.hh"
+#include "ignition/gui/WorkerPool.hh"
 
 namespace ignition
 {
   namespace gui
   {
+    /// \brief Sink which Qt messages are queued on, null while there's no
+    /// application or it's being destroyed.
+    static std::atomic<LogSink *> g_messageSink{nullptr};
+
+    /// \brief Number of Qt messages being queued on g_messageSink, so that
+    /// the sink isn't destroyed under them.
+    static std::atomic<int> g_messageSinkUsers{0};
+
     class ApplicationPrivate
     {
       /// \brief QML engine
@@ -43,6 +61,9 @@ namespace ignition
       /// \brief Pointer to main window
       public: MainWindow *mainWin{nullptr};
 
+      /// \brief Type of window the application was created with
+      public: WindowType windowType{WindowType::kMainWindow};
+
       /// \brief Vector of pointers to dialogs
       public: std::vector<Dialog *> dialogs;
 
@@ -69,6 +90,33 @@ namespace ignition
 
       public: common::SignalHandler signalHandler;
 
+      /// \brief Worker threads shared by all plugins
+      public: std::unique_ptr<WorkerPool> workers;
+
+      /// \brief Detects GUI thread stalls
+      public: std::unique_ptr<StallMonitor> monitor;
+
+      /// \brief Runs calls posted from other threads on the GUI thread
+      public: std::unique_ptr<GuiDispatcher> dispatcher;
+
+      /// \brief Changes to 3D scenes, run by their renderers
+      public: std::unique_ptr<SceneMutationQueue> sceneMutations;
+
+      /// \brief Protects frames and shuttingDown
+      public: std::mutex framesMutex;
+
+      /// \brief Coordinate frames of each 3D scene
+      public: std::map<std::string, std::unique_ptr<FrameTree>> frames;
+
+      /// \brief True once frames can't be created anymore
+      public: bool shuttingDown{false};
+
+      /// \brief Writes Qt messages in the background
+      public: std::unique_ptr<LogSink> logs;
+
+      /// \brief Last known exposure of each of the application's windows
+      public: std::map<QWindow *, bool> exposed;
+
       /// \brief QT message handler that pipes qt messages into our console
       /// system.
       public: static void MessageHandler(QtMsgType _type,
@@ -92,6 +140,18 @@ Application::Application(int &_argc, char **_argv, const WindowType _type)
   // QML engine
   this->dataPtr->engine = new QQmlApplicationEngine();
 
+  // Worker threads
+  this->dataPtr->workers = std::make_unique<WorkerPool>();
+
+  // Stall detection
+  this->dataPtr->monitor = std::make_unique<StallMonitor>();
+
+  // Control versus bulk deliveries to the GUI thread
+  this->dataPtr->dispatcher = std::make_unique<GuiDispatcher>();
+
+  // Changes to 3D scenes from plugins other than their renderers
+  this->dataPtr->sceneMutations = std::make_unique<SceneMutationQueue>();
+
   // Install signal handler for graceful shutdown
   this->dataPtr->signalHandler.AddCallback(
       [](int)  // NOLINT(readability/casting)
@@ -100,8 +160,12 @@ Application::Application(int &_argc, char **_argv, const WindowType _type)
       });
 
   // Handle qt console messages
+  this->dataPtr->logs = std::make_unique<LogSink>();
+  g_messageSink = this->dataPtr->logs.get();
   qInstallMessageHandler(this->dataPtr->MessageHandler);
 
+  this->dataPtr->windowType = _type;
+
   // Default config path
   std::string home;
   common::env(IGN_HOMEDIR, home);
@@ -118,6 +182,10 @@ Application::Application(int &_argc, char **_argv, const WindowType _type)
   {
     // Do nothing, dialogs are initialized as plugins are loaded
   }
+  else if (_type == WindowType::kHeadless)
+  {
+    // Do nothing, plugins aren't displayed
+  }
   else
   {
     ignerr << "Unknown WindowType [" << static_cast<int>(_type) << "]\n";
@@ -159,9 +227,30 @@ Application::~Application()
 
   std::queue<std::shared_ptr<Plugin>> empty;
   std::swap(this->dataPtr->pluginsToAdd, empty);
+  for (auto &plugin : this->dataPtr->pluginsAdded)
+    plugin->Shutdown();
   this->dataPtr->pluginsAdded.clear();
   this->dataPtr->pluginPaths.clear();
   this->dataPtr->pluginPathEnv = "IGN_GUI_PLUGIN_PATH";
+
+  // Plugins have been removed, stop the workers
+  this->dataPtr->workers.reset();
+  this->dataPtr->dispatcher.reset();
+  this->dataPtr->sceneMutations.reset();
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->framesMutex);
+    this->dataPtr->frames.clear();
+    this->dataPtr->shuttingDown = true;
+  }
+  this->dataPtr->monitor.reset();
+
+  // Stop queueing Qt messages, which Qt prints synchronously from now on,
+  // and wait for those being queued before the sink writes them and stops.
+  qInstallMessageHandler(nullptr);
+  g_messageSink = nullptr;
+  while (g_messageSinkUsers > 0)
+    std::this_thread::yield();
+  this->dataPtr->logs.reset();
 }
 
 /////////////////////////////////////////////////
@@ -170,12 +259,70 @@ QQmlApplicationEngine *Application::Engine() const
   return this->dataPtr->engine;
 }
 
+/////////////////////////////////////////////////
+WorkerPool *Application::Workers() const
+{
+  return this->dataPtr->workers.get();
+}
+
+/////////////////////////////////////////////////
+GuiDispatcher *Application::Dispatcher() const
+{
+  return this->dataPtr->dispatcher.get();
+}
+
+/////////////////////////////////////////////////
+SceneMutationQueue *Application::SceneMutations() const
+{
+  return this->dataPtr->sceneMutations.get();
+}
+
+/////////////////////////////////////////////////
+FrameTree *Application::Frames(const std::string &_scene) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->framesMutex);
+  if (this->dataPtr->shuttingDown)
+    return nullptr;
+
+  auto &frames = this->dataPtr->frames[_scene];
+  if (!frames)
+    frames = std::make_unique<FrameTree>();
+  return frames.get();
+}
+
 /////////////////////////////////////////////////
 Application *ignition::gui::App()
 {
   return qobject_cast<Application *>(qGuiApp);
 }
 
+/////////////////////////////////////////////////
+StallMonitor *Application::Monitor() const
+{
+  return this->dataPtr->monitor.get();
+}
+
+/////////////////////////////////////////////////
+LogSink *Application::Logs() const
+{
+  return this->dataPtr->logs.get();
+}
+
+/////////////////////////////////////////////////
+bool Application::notify(QObject *_receiver, QEvent *_event)
+{
+  // The monitor's delivery stack is only touched on the GUI thread
+  auto monitor = this->dataPtr->monitor.get();
+  if (!monitor || QThread::currentThread() != this->thread())
+    return QApplication::notify(_receiver, _event);
+
+  monitor->BeginDelivery(_receiver, _event);
+  auto result = QApplication::notify(_receiver, _event);
+  monitor->EndDelivery();
+
+  return result;
+}
+
 /////////////////////////////////////////////////
 bool Application::RemovePlugin(const std::string &_pluginName)
 {
@@ -240,11 +387,20 @@ bool Application::LoadConfig(const std::string &_config)
   ignmsg << "Loading config [" << _config << "]" << std::endl;
 
   // Clear all previous plugins
-  auto plugins = this->dataPtr->mainWin->findChildren<Plugin *>();
-  for (auto plugin : plugins)
+  if (this->dataPtr->mainWin)
   {
-    auto pluginName = plugin->CardItem()->objectName();
-    this->RemovePlugin(pluginName.toStdString());
+    auto plugins = this->dataPtr->mainWin->findChildren<Plugin *>();
+    for (auto plugin : plugins)
+    {
+      auto pluginName = plugin->CardItem()->objectName();
+      this->RemovePlugin(pluginName.toStdString());
+    }
+  }
+  else if (this->dataPtr->windowType == WindowType::kHeadless)
+  {
+    auto added = this->dataPtr->pluginsAdded;
+    for (auto plugin : added)
+      this->RemovePlugin(plugin);
   }
   if (this->dataPtr->pluginsAdded.size() > 0)
   {
@@ -390,9 +546,22 @@ bool Application::LoadPlugin(const std::string &_filename,
 
   // Add to window or dialog
   if (this->dataPtr->mainWin)
+  {
     this->AddPluginsToWindow();
+  }
+  else if (this->dataPtr->windowType == WindowType::kHeadless)
+  {
+    while (!this->dataPtr->pluginsToAdd.empty())
+    {
+      this->dataPtr->pluginsAdded.push_back(
+          this->dataPtr->pluginsToAdd.front());
+      this->dataPtr->pluginsToAdd.pop();
+    }
+  }
   else
+  {
     this->InitializeDialogs();
+  }
 
   this->PluginAdded(plugin->objectName());
   ignmsg << "Loaded plugin [" << _filename << "] from path [" << pathToLib
@@ -412,6 +581,8 @@ bool Application::InitializeMainWindow()
 
   this->dataPtr->mainWin->setParent(this);
 
+  this->WatchExposure(this->dataPtr->mainWin->QuickWindow());
+
   return true;
 }
 
@@ -485,6 +656,12 @@ bool Application::AddPluginsToWindow()
     this->dataPtr->mainWin->connect(cardItem, SIGNAL(close()),
         this, SLOT(OnPluginClose()));
 
+    // Attribute GUI thread time to the plugin
+    this->dataPtr->monitor->AddOwner(plugin.get(),
+        cardItem->objectName().toStdString());
+    this->dataPtr->monitor->AddOwner(cardItem,
+        cardItem->objectName().toStdString());
+
     ignmsg << "Added plugin [" << plugin->Title() << "] to main window" <<
         std::endl;
   }
@@ -515,6 +692,7 @@ bool Application::InitializeDialogs()
       continue;
 
     this->dataPtr->dialogs.push_back(dialog);
+    this->WatchExposure(dialog->QuickWindow());
 
     cardItem->setParentItem(dialog->RootItem());
 
@@ -531,6 +709,12 @@ bool Application::InitializeDialogs()
     this->dataPtr->mainWin->connect(cardItem, SIGNAL(close()),
         this, SLOT(OnPluginClose()));
 
+    // Attribute GUI thread time to the plugin
+    this->dataPtr->monitor->AddOwner(plugin.get(),
+        cardItem->objectName().toStdString());
+    this->dataPtr->monitor->AddOwner(cardItem,
+        cardItem->objectName().toStdString());
+
     this->dataPtr->pluginsAdded.push_back(plugin);
 
     auto title = QString::fromStdString(plugin->Title());
@@ -543,6 +727,42 @@ bool Application::InitializeDialogs()
   return true;
 }
 
+/////////////////////////////////////////////////
+void Application::WatchExposure(QWindow *_window)
+{
+  this->dataPtr->exposed[_window] = _window->isExposed();
+  _window->installEventFilter(this);
+
+  this->connect(_window, &QObject::destroyed, [this](QObject *_obj)
+  {
+    this->dataPtr->exposed.erase(static_cast<QWindow *>(_obj));
+  });
+}
+
+/////////////////////////////////////////////////
+bool Application::eventFilter(QObject *_watched, QEvent *_event)
+{
+  // Only expose events are received by windows when their exposure changes,
+  // and by then QWindow::isExposed is already up to date.
+  if (_event->type() == QEvent::Expose)
+  {
+    auto window = qobject_cast<QWindow *>(_watched);
+    auto it = this->dataPtr->exposed.find(window);
+    if (window && it != this->dataPtr->exposed.end() &&
+        it->second != window->isExposed())
+    {
+      it->second = window->isExposed();
+
+      igndbg << "Window [" << window->title().toStdString() << "] "
+             << (it->second ? "exposed" : "no longer exposed") << std::endl;
+
+      this->WindowExposureChanged(window);
+    }
+  }
+
+  return QApplication::eventFilter(_watched, _event);
+}
+
 /////////////////////////////////////////////////
 void Application::SetPluginPathEnv(const std::string &_env)
 {
@@ -610,6 +830,15 @@ void Application::OnPluginClose()
 /////////////////////////////////////////////////
 void Application::RemovePlugin(std::shared_ptr<Plugin> _plugin)
 {
+  // Stop background work before the plugin goes away
+  _plugin->Shutdown();
+
+  if (this->dataPtr->monitor && _plugin->CardItem())
+  {
+    this->dataPtr->monitor->RemoveOwner(
+        _plugin->CardItem()->objectName().toStdString());
+  }
+
   this->dataPtr->pluginsAdded.erase(std::remove(
       this->dataPtr->pluginsAdded.begin(),
       this->dataPtr->pluginsAdded.end(), _plugin),
@@ -633,6 +862,40 @@ void Application::RemovePlugin(std::shared_ptr<Plugin> _plugin)
 void ApplicationPrivate::MessageHandler(QtMsgType _type,
     const QMessageLogContext &_context, const QString &_msg)
 {
+  // Queue the message without allocating. Fatal messages abort as soon as
+  // this returns, so they're written right away.
+  ++g_messageSinkUsers;
+  auto logs = g_messageSink.load();
+  if (logs && _type != QtFatalMsg)
+  {
+    LogLevel level;
+    switch (_type)
+    {
+      case QtDebugMsg:
+        level = LogLevel::kDebug;
+        break;
+      case QtInfoMsg:
+        level = LogLevel::kInfo;
+        break;
+      case QtCriticalMsg:
+        level = LogLevel::kError;
+        break;
+      case QtWarningMsg:
+      default:
+        level = LogLevel::kWarning;
+        break;
+    }
+
+    logs->Log(level, "[QT] ", reinterpret_cast<const char16_t *>(_msg.utf16()),
+        _msg.size(), _context.function);
+    --g_messageSinkUsers;
+    return;
+  }
+
+  if (logs)
+    logs->Flush();
+  --g_messageSinkUsers;
+
   std::string msg = "[QT] " + _msg.toStdString();
   if (_context.function)
     msg += std::string("(") + _context.function + ")";
@@ -329,3 +329,53 @@ TEST(ApplicationTest, messageHandler)
   qCritical("This came from qCritical");
 }
 
+
+//////////////////////////////////////////////////
+TEST(ApplicationTest, WindowExposure)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin"));
+
+  auto win = App()->findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+
+  int changes{0};
+  app.connect(&app, &Application::WindowExposureChanged,
+      [&changes, &win](QWindow *_window)
+      {
+        EXPECT_EQ(win->QuickWindow(), _window);
+        ++changes;
+      });
+
+  // Shown
+  win->QuickWindow()->show();
+  QCoreApplication::processEvents();
+
+  EXPECT_TRUE(win->QuickWindow()->isExposed());
+  EXPECT_EQ(1, changes);
+  EXPECT_FALSE(plugin->Suspended());
+
+  // Hidden
+  win->QuickWindow()->hide();
+  QCoreApplication::processEvents();
+
+  EXPECT_FALSE(win->QuickWindow()->isExposed());
+  EXPECT_EQ(2, changes);
+  EXPECT_TRUE(plugin->Suspended());
+
+  // Restored
+  win->QuickWindow()->show();
+  QCoreApplication::processEvents();
+
+  EXPECT_EQ(3, changes);
+  EXPECT_FALSE(plugin->Suspended());
+
+  win->QuickWindow()->close();
+}
@@ -0,0 +1,754 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <tinyxml2.h>
+
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/msgs/Factory.hh>
+#include <ignition/msgs/header.pb.h>
+#include <ignition/msgs/image.pb.h>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Benchmark.hh"
+#include "ignition/gui/MainWindow.hh"
+#include "ignition/gui/Plugin.hh"
+#include "ignition/gui/WorkerPool.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief Publishes synthetic messages on one topic
+    struct SyntheticPublisher
+    {
+      /// \brief Topic
+      std::string topic;
+
+      /// \brief Messages per second
+      double rate{0.0};
+
+      /// \brief Messages published in turn
+      std::vector<std::unique_ptr<google::protobuf::Message>> messages;
+
+      /// \brief Transport publisher
+      transport::Node::Publisher pub;
+
+      /// \brief Messages published so far
+      uint64_t sent{0u};
+
+      /// \brief Messages published before measuring started
+      uint64_t sentBeforeMeasuring{0u};
+    };
+
+    class BenchmarkPrivate
+    {
+      /// \brief Publish the messages due by the end of a frame
+      /// \param[in] _frame Frame number, starting at zero
+      public: void Publish(const unsigned int _frame);
+
+      /// \brief Node used by all publishers
+      public: transport::Node node;
+
+      /// \brief Publishers
+      public: std::vector<SyntheticPublisher> publishers;
+
+      /// \brief Measured frames
+      public: unsigned int frames{300u};
+
+      /// \brief Warmup frames
+      public: unsigned int warmup{30u};
+
+      /// \brief Target frame period
+      public: std::chrono::milliseconds framePeriod{16};
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Set a message's header stamp and publication time, if it has a
+/// header
+/// \param[in] _msg Message
+/// \param[in] _time Stamp
+static void stampHeader(google::protobuf::Message &_msg,
+    const std::chrono::steady_clock::duration &_time)
+{
+  auto field = _msg.GetDescriptor()->FindFieldByName("header");
+  if (!field || field->message_type() != msgs::Header::descriptor())
+    return;
+
+  auto header = static_cast<msgs::Header *>(
+      _msg.GetReflection()->MutableMessage(&_msg, field));
+
+  auto sec = std::chrono::duration_cast<std::chrono::seconds>(_time);
+  header->mutable_stamp()->set_sec(sec.count());
+  header->mutable_stamp()->set_nsec(static_cast<int32_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      _time - sec).count()));
+
+  stampPublishTime(*header);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the CPU time used so far by the process, on all threads
+/// \return CPU time, zero where unsupported
+static std::chrono::steady_clock::duration processCpuTime()
+{
+#ifndef _WIN32
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+        std::chrono::microseconds(
+        usage.ru_utime.tv_usec + usage.ru_stime.tv_usec));
+  }
+#endif
+  return std::chrono::steady_clock::duration::zero();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the peak resident memory of the process
+/// \return Bytes, zero where unsupported
+static uint64_t peakResidentMemory()
+{
+#ifndef _WIN32
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+  {
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024u;
+#endif
+  }
+#endif
+  return 0u;
+}
+
+/////////////////////////////////////////////////
+/// \brief Quote and escape a string for JSON
+/// \param[in] _text Text
+/// \return JSON string
+static std::string jsonString(const std::string &_text)
+{
+  std::ostringstream out;
+  out << '"';
+  for (auto c : _text)
+  {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+    {
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+          << static_cast<int>(c) << std::dec << std::setfill(' ');
+    }
+    else
+      out << c;
+  }
+  out << '"';
+  return out.str();
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert a duration to milliseconds
+/// \param[in] _duration Duration
+/// \return Milliseconds
+static double toMs(const std::chrono::steady_clock::duration &_duration)
+{
+  return std::chrono::duration<double, std::milli>(_duration).count();
+}
+
+/////////////////////////////////////////////////
+/// \brief Mean time a lane's calls waited
+/// \param[in] _stats Lane statistics
+/// \return Milliseconds
+static double meanWaitMs(const DeliveryStats &_stats)
+{
+  return _stats.count == 0u ? 0.0 : toMs(_stats.totalWait) / _stats.count;
+}
+
+/////////////////////////////////////////////////
+void ignition::gui::useOffscreenPlatform()
+{
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  // Qt Quick's software renderer doesn't need OpenGL at all
+  if (qEnvironmentVariableIsEmpty("QT_QUICK_BACKEND"))
+    qputenv("QT_QUICK_BACKEND", "software");
+
+  // Plugins creating their own OpenGL contexts, such as for 3D rendering,
+  // fall back to Mesa's software rasterizer
+  if (qEnvironmentVariableIsEmpty("LIBGL_ALWAYS_SOFTWARE"))
+    qputenv("LIBGL_ALWAYS_SOFTWARE", "1");
+}
+
+/////////////////////////////////////////////////
+DurationStats ignition::gui::durationStats(std::vector<double> _samples)
+{
+  DurationStats stats;
+  if (_samples.empty())
+    return stats;
+
+  std::sort(_samples.begin(), _samples.end());
+
+  auto percentile = [&_samples](const double _p)
+  {
+    return _samples[static_cast<std::size_t>(
+        std::round(_p * (_samples.size() - 1)))];
+  };
+
+  stats.count = _samples.size();
+  stats.mean = std::accumulate(_samples.begin(), _samples.end(), 0.0) /
+      _samples.size();
+  stats.p50 = percentile(0.5);
+  stats.p95 = percentile(0.95);
+  stats.p99 = percentile(0.99);
+  stats.max = _samples.back();
+
+  return stats;
+}
+
+/////////////////////////////////////////////////
+std::string ignition::gui::benchmarkReportText(const BenchmarkReport &_report)
+{
+  auto row = [](std::ostream &_out, const std::string &_name,
+      const DurationStats &_stats)
+  {
+    _out << std::left << std::setw(17) << _name << std::right
+         << "mean " << std::setw(8) << _stats.mean
+         << "  p50 " << std::setw(8) << _stats.p50
+         << "  p95 " << std::setw(8) << _stats.p95
+         << "  p99 " << std::setw(8) << _stats.p99
+         << "  max " << std::setw(8) << _stats.max << std::endl;
+  };
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2);
+
+  if (_report.startup != std::chrono::steady_clock::duration::zero())
+    out << "Startup " << toMs(_report.startup) << " ms" << std::endl;
+
+  out << "Frames " << _report.frames << " at "
+      << _report.framePeriod.count() << " ms, " << _report.slowFrames
+      << " slower than that" << std::endl;
+
+  row(out, "Frame time ms", _report.frameTimes);
+  row(out, "Latency ms", _report.latency);
+
+  out << "Stalls " << _report.stalls << std::endl;
+
+  out << "CPU time " << toMs(_report.cpuTime) << " ms, peak RSS "
+      << _report.peakRss / (1024 * 1024) << " MB" << std::endl;
+
+  out << "Control calls " << _report.control.count
+      << ", wait ms mean " << meanWaitMs(_report.control)
+      << " max " << toMs(_report.control.maxWait) << std::endl;
+
+  out << "Bulk calls " << _report.bulk.count
+      << ", coalesced " << _report.bulk.coalesced
+      << ", wait ms mean " << meanWaitMs(_report.bulk)
+      << " max " << toMs(_report.bulk.maxWait) << std::endl;
+
+  if (!_report.plugins.empty())
+  {
+    out << std::left << std::setw(32) << "Plugin" << std::right
+        << std::setw(12) << "GUI ms" << std::setw(12) << "worker ms"
+        << std::setw(10) << "count" << std::setw(10) << "max ms"
+        << std::setw(8) << "stalls" << std::endl;
+  }
+  for (const auto &time : _report.plugins)
+  {
+    auto worker = _report.workerTimes.find(time.plugin);
+    out << std::left << std::setw(32) << time.plugin << std::right
+        << std::setw(12) << toMs(time.total)
+        << std::setw(12) << (worker == _report.workerTimes.end() ? 0.0 :
+            toMs(worker->second))
+        << std::setw(10) << time.count
+        << std::setw(10) << toMs(time.max) << std::setw(8) << time.stalls
+        << std::endl;
+  }
+
+  for (const auto &plugin : _report.latencies)
+  {
+    for (const auto &stage : plugin.second)
+    {
+      out << plugin.first << " [" << stage.first << "], "
+          << stage.second.count << " samples" << std::endl;
+      row(out, "  Latency ms", stage.second);
+    }
+  }
+
+  for (const auto &published : _report.published)
+  {
+    out << "Published " << published.second << " on [" << published.first
+        << "]" << std::endl;
+  }
+
+  return out.str();
+}
+
+/////////////////////////////////////////////////
+std::string ignition::gui::benchmarkReportJson(const BenchmarkReport &_report)
+{
+  auto stats = [](const DurationStats &_stats)
+  {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3)
+        << "{\"mean\": " << _stats.mean
+        << ", \"p50\": " << _stats.p50
+        << ", \"p95\": " << _stats.p95
+        << ", \"p99\": " << _stats.p99
+        << ", \"max\": " << _stats.max << "}";
+    return out.str();
+  };
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3);
+
+  out << "{" << std::endl
+      << "  \"startup_ms\": " << toMs(_report.startup) << "," << std::endl
+      << "  \"frames\": " << _report.frames << "," << std::endl
+      << "  \"frame_period_ms\": " << _report.framePeriod.count() << ","
+      << std::endl
+      << "  \"slow_frames\": " << _report.slowFrames << "," << std::endl
+      << "  \"frame_time_ms\": " << stats(_report.frameTimes) << ","
+      << std::endl
+      << "  \"latency_ms\": " << stats(_report.latency) << "," << std::endl
+      << "  \"stalls\": " << _report.stalls << "," << std::endl
+      << "  \"cpu_time_ms\": " << toMs(_report.cpuTime) << "," << std::endl
+      << "  \"peak_rss_bytes\": " << _report.peakRss << "," << std::endl;
+
+  out << "  \"control\": {\"count\": " << _report.control.count
+      << ", \"mean_wait_ms\": " << meanWaitMs(_report.control)
+      << ", \"max_wait_ms\": " << toMs(_report.control.maxWait) << "},"
+      << std::endl;
+
+  out << "  \"bulk\": {\"count\": " << _report.bulk.count
+      << ", \"coalesced\": " << _report.bulk.coalesced
+      << ", \"mean_wait_ms\": " << meanWaitMs(_report.bulk)
+      << ", \"max_wait_ms\": " << toMs(_report.bulk.maxWait) << "},"
+      << std::endl;
+
+  out << "  \"plugins\": [";
+  for (std::size_t i = 0; i < _report.plugins.size(); ++i)
+  {
+    const auto &time = _report.plugins[i];
+    auto worker = _report.workerTimes.find(time.plugin);
+    out << (i == 0 ? "" : ",") << std::endl
+        << "    {\"name\": " << jsonString(time.plugin)
+        << ", \"gui_thread_ms\": " << toMs(time.total)
+        << ", \"worker_ms\": " << (worker == _report.workerTimes.end() ?
+            0.0 : toMs(worker->second))
+        << ", \"deliveries\": " << time.count
+        << ", \"max_delivery_ms\": " << toMs(time.max)
+        << ", \"stalls\": " << time.stalls
+        << ", \"latency_ms\": {";
+
+    auto latencies = _report.latencies.find(time.plugin);
+    if (latencies != _report.latencies.end())
+    {
+      bool firstStage{true};
+      for (const auto &stage : latencies->second)
+      {
+        out << (firstStage ? "" : ", ") << jsonString(stage.first) << ": "
+            << stats(stage.second);
+        firstStage = false;
+      }
+    }
+    out << "}}";
+  }
+  out << (_report.plugins.empty() ? "" : "\n  ") << "]," << std::endl;
+
+  out << "  \"published\": {";
+  bool first{true};
+  for (const auto &published : _report.published)
+  {
+    out << (first ? "" : ",") << std::endl
+        << "    " << jsonString(published.first) << ": " << published.second;
+    first = false;
+  }
+  out << (_report.published.empty() ? "" : "\n  ") << "}" << std::endl
+      << "}" << std::endl;
+
+  return out.str();
+}
+
+/////////////////////////////////////////////////
+Benchmark::Benchmark()
+  : dataPtr(new BenchmarkPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+Benchmark::~Benchmark()
+{
+}
+
+/////////////////////////////////////////////////
+bool Benchmark::Load(const std::string &_config)
+{
+  if (!App())
+  {
+    ignerr << "Benchmarks need an application." << std::endl;
+    return false;
+  }
+
+  tinyxml2::XMLDocument doc;
+  if (doc.LoadFile(_config.c_str()))
+  {
+    ignerr << "Failed to load file [" << _config << "]: XMLError"
+           << std::endl;
+    return false;
+  }
+
+  auto benchElem = doc.FirstChildElement("benchmark");
+  if (!benchElem)
+  {
+    ignwarn << "No <benchmark> element in [" << _config
+            << "], using default settings." << std::endl;
+  }
+  else
+  {
+    if (auto elem = benchElem->FirstChildElement("frames"))
+      elem->QueryUnsignedText(&this->dataPtr->frames);
+
+    if (auto elem = benchElem->FirstChildElement("warmup"))
+      elem->QueryUnsignedText(&this->dataPtr->warmup);
+
+    if (auto elem = benchElem->FirstChildElement("frame_period"))
+    {
+      unsigned int period{0u};
+      if (!elem->QueryUnsignedText(&period) && period > 0u)
+        this->SetFramePeriod(std::chrono::milliseconds(period));
+    }
+
+    for (auto pubElem = benchElem->FirstChildElement("publisher");
+        pubElem != nullptr;
+        pubElem = pubElem->NextSiblingElement("publisher"))
+    {
+      std::string topic;
+      if (auto elem = pubElem->FirstChildElement("topic"))
+        topic = elem->GetText() ? elem->GetText() : "";
+
+      std::string type;
+      if (auto elem = pubElem->FirstChildElement("type"))
+        type = elem->GetText() ? elem->GetText() : "";
+
+      double rate{1.0};
+      if (auto elem = pubElem->FirstChildElement("rate"))
+        elem->QueryDoubleText(&rate);
+
+      auto widthElem = pubElem->FirstChildElement("width");
+      auto heightElem = pubElem->FirstChildElement("height");
+      if (type == "ignition.msgs.Image" && widthElem && heightElem)
+      {
+        unsigned int width{0u};
+        unsigned int height{0u};
+        widthElem->QueryUnsignedText(&width);
+        heightElem->QueryUnsignedText(&height);
+        if (!this->AddImagePublisher(topic, rate, width, height))
+          return false;
+        continue;
+      }
+
+      std::string data;
+      if (auto elem = pubElem->FirstChildElement("data"))
+        data = elem->GetText() ? elem->GetText() : "";
+
+      if (!this->AddPublisher(topic, type, rate, data))
+        return false;
+    }
+  }
+
+  return App()->LoadConfig(_config);
+}
+
+/////////////////////////////////////////////////
+bool Benchmark::AddPublisher(const std::string &_topic,
+    const std::string &_type, const double _rate, const std::string &_data)
+{
+  if (_topic.empty() || _rate <= 0.0)
+  {
+    ignerr << "Benchmark publishers need a topic and a positive rate."
+           << std::endl;
+    return false;
+  }
+
+  auto msg = msgs::Factory::New(_type, _data);
+  if (!msg || (msg->DebugString() == "" && _data != ""))
+  {
+    ignerr << "Unable to create message of type [" << _type << "] "
+           << "with data [" << _data << "]." << std::endl;
+    return false;
+  }
+
+  SyntheticPublisher publisher;
+  publisher.topic = _topic;
+  publisher.rate = _rate;
+  publisher.messages.push_back(std::move(msg));
+  publisher.pub = this->dataPtr->node.Advertise(_topic, _type);
+  if (!publisher.pub)
+  {
+    ignerr << "Unable to publish on topic [" << _topic << "] "
+           << "with message type [" << _type << "]." << std::endl;
+    return false;
+  }
+
+  this->dataPtr->publishers.push_back(std::move(publisher));
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool Benchmark::AddImagePublisher(const std::string &_topic,
+    const double _rate, const unsigned int _width, const unsigned int _height)
+{
+  if (_width == 0u || _height == 0u)
+  {
+    ignerr << "Benchmark images need a size." << std::endl;
+    return false;
+  }
+
+  if (!this->AddPublisher(_topic, "ignition.msgs.Image", _rate))
+    return false;
+
+  // Two images are generated up front, so publishing doesn't cost more
+  // than it would for a real camera
+  auto &publisher = this->dataPtr->publishers.back();
+  publisher.messages.clear();
+  for (unsigned int i = 0; i < 2u; ++i)
+  {
+    auto msg = std::make_unique<msgs::Image>();
+    msg->set_width(_width);
+    msg->set_height(_height);
+    msg->set_step(_width * 3);
+    msg->set_pixel_format_type(msgs::PixelFormatType::RGB_INT8);
+
+    std::string data(_width * _height * 3, '\0');
+    for (unsigned int y = 0; y < _height; ++y)
+    {
+      for (unsigned int x = 0; x < _width; ++x)
+      {
+        auto pixel = &data[(y * _width + x) * 3];
+        pixel[0] = static_cast<char>((x + i * 64) & 0xff);
+        pixel[1] = static_cast<char>((y + i * 64) & 0xff);
+        pixel[2] = static_cast<char>(((x + y) / 2) & 0xff);
+      }
+    }
+    msg->set_data(std::move(data));
+
+    publisher.messages.push_back(std::move(msg));
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void Benchmark::SetFrames(const unsigned int _frames)
+{
+  this->dataPtr->frames = _frames;
+}
+
+/////////////////////////////////////////////////
+unsigned int Benchmark::Frames() const
+{
+  return this->dataPtr->frames;
+}
+
+/////////////////////////////////////////////////
+void Benchmark::SetWarmup(const unsigned int _frames)
+{
+  this->dataPtr->warmup = _frames;
+}
+
+/////////////////////////////////////////////////
+unsigned int Benchmark::Warmup() const
+{
+  return this->dataPtr->warmup;
+}
+
+/////////////////////////////////////////////////
+void Benchmark::SetFramePeriod(const std::chrono::milliseconds &_period)
+{
+  this->dataPtr->framePeriod = _period;
+}
+
+/////////////////////////////////////////////////
+std::chrono::milliseconds Benchmark::FramePeriod() const
+{
+  return this->dataPtr->framePeriod;
+}
+
+/////////////////////////////////////////////////
+BenchmarkReport Benchmark::Run()
+{
+  BenchmarkReport report;
+  report.framePeriod = this->dataPtr->framePeriod;
+
+  auto app = App();
+  if (!app)
+  {
+    ignerr << "Benchmarks need an application." << std::endl;
+    return report;
+  }
+
+  auto win = app->findChild<MainWindow *>();
+  auto quickWindow = win ? win->QuickWindow() : nullptr;
+
+  std::vector<double> frameTimes;
+  frameTimes.reserve(this->dataPtr->frames);
+  std::vector<double> latencies;
+  latencies.reserve(this->dataPtr->frames);
+  auto cpuStart = processCpuTime();
+
+  auto total = this->dataPtr->warmup + this->dataPtr->frames;
+  for (unsigned int frame = 0; frame < total; ++frame)
+  {
+    auto measuring = frame >= this->dataPtr->warmup;
+    if (frame == this->dataPtr->warmup)
+    {
+      if (app->Monitor())
+        app->Monitor()->Reset();
+      if (app->Dispatcher())
+        app->Dispatcher()->ResetStats();
+      if (app->Workers())
+        app->Workers()->ResetBusyTimes();
+      for (auto plugin : app->findChildren<Plugin *>())
+        plugin->ResetLatencies();
+      for (auto &publisher : this->dataPtr->publishers)
+        publisher.sentBeforeMeasuring = publisher.sent;
+      cpuStart = processCpuTime();
+    }
+
+    auto frameStart = std::chrono::steady_clock::now();
+
+    this->dataPtr->Publish(frame);
+
+    auto workStart = std::chrono::steady_clock::now();
+
+    QCoreApplication::processEvents();
+
+    // Grabbing renders the window right away, even when it's offscreen
+    if (quickWindow && quickWindow->isVisible())
+      quickWindow->grabWindow();
+
+    auto workEnd = std::chrono::steady_clock::now();
+
+    if (measuring)
+    {
+      auto frameTime = workEnd - workStart;
+      frameTimes.push_back(
+          std::chrono::duration<double, std::milli>(frameTime).count());
+      if (frameTime > this->dataPtr->framePeriod)
+        ++report.slowFrames;
+
+      if (app->Monitor())
+        latencies.push_back(toMs(app->Monitor()->Latency()));
+    }
+
+    // Idle until the next frame, still handling events as they arrive
+    auto deadline = frameStart + this->dataPtr->framePeriod;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+      QCoreApplication::processEvents();
+      std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+          std::chrono::milliseconds(1),
+          deadline - std::chrono::steady_clock::now()));
+    }
+  }
+
+  report.frames = frameTimes.size();
+  report.frameTimes = durationStats(std::move(frameTimes));
+  report.cpuTime = processCpuTime() - cpuStart;
+  report.peakRss = peakResidentMemory();
+
+  if (app->Monitor())
+  {
+    report.latency = durationStats(std::move(latencies));
+    report.latency.max = std::max(report.latency.max,
+        toMs(app->Monitor()->MaxLatency()));
+    report.plugins = app->Monitor()->Times();
+    report.stalls = app->Monitor()->StallCount();
+  }
+
+  for (auto plugin : app->findChildren<Plugin *>())
+  {
+    if (!plugin->CardItem())
+      continue;
+
+    auto name = plugin->CardItem()->objectName().toStdString();
+    if (app->Workers())
+      report.workerTimes[name] = app->Workers()->BusyTime(plugin);
+
+    for (const auto &latency : plugin->Latencies())
+      report.latencies[name][latency.first] = latency.second.Stats();
+  }
+
+  if (app->Dispatcher())
+  {
+    report.control = app->Dispatcher()->Stats(DeliveryLane::kControl);
+    report.bulk = app->Dispatcher()->Stats(DeliveryLane::kBulk);
+  }
+
+  for (const auto &publisher : this->dataPtr->publishers)
+  {
+    report.published[publisher.topic] +=
+        publisher.sent - publisher.sentBeforeMeasuring;
+  }
+
+  return report;
+}
+
+/////////////////////////////////////////////////
+void BenchmarkPrivate::Publish(const unsigned int _frame)
+{
+  auto periodMs = std::chrono::duration<double, std::milli>(
+      this->framePeriod).count();
+  auto stamp = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      this->framePeriod * _frame);
+
+  for (auto &publisher : this->publishers)
+  {
+    auto due = static_cast<uint64_t>(
+        std::floor((_frame + 1) * periodMs * publisher.rate / 1000.0));
+
+    while (publisher.sent < due)
+    {
+      auto &msg = publisher.messages[
+          publisher.sent % publisher.messages.size()];
+      stampHeader(*msg, stamp);
+      publisher.pub.Publish(*msg);
+      ++publisher.sent;
+    }
+  }
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/msgs/image.pb.h>
+#include <ignition/msgs/stringmsg.pb.h>
+#include <ignition/transport/Node.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Benchmark.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(BenchmarkTest, DurationStats)
+{
+  auto empty = durationStats({});
+  EXPECT_EQ(0u, empty.count);
+  EXPECT_DOUBLE_EQ(0.0, empty.max);
+
+  // 100 down to 1, order doesn't matter
+  std::vector<double> samples;
+  for (int i = 100; i > 0; --i)
+    samples.push_back(i);
+
+  auto stats = durationStats(samples);
+  EXPECT_EQ(100u, stats.count);
+  EXPECT_DOUBLE_EQ(50.5, stats.mean);
+  EXPECT_DOUBLE_EQ(51.0, stats.p50);
+  EXPECT_DOUBLE_EQ(95.0, stats.p95);
+  EXPECT_DOUBLE_EQ(99.0, stats.p99);
+  EXPECT_DOUBLE_EQ(100.0, stats.max);
+}
+
+/////////////////////////////////////////////////
+TEST(BenchmarkTest, Json)
+{
+  BenchmarkReport report;
+  report.startup = std::chrono::milliseconds(250);
+  report.frames = 3;
+  report.framePeriod = std::chrono::milliseconds(16);
+  report.frameTimes.p99 = 1.5;
+  report.peakRss = 1024;
+
+  GuiThreadTime time;
+  time.plugin = "Image \"display\"";
+  time.total = std::chrono::milliseconds(2);
+  time.count = 7;
+  report.plugins.push_back(time);
+  report.workerTimes[time.plugin] = std::chrono::milliseconds(3);
+  report.latencies[time.plugin]["pose_to_pixel"].p99 = 4.0;
+  report.published["/camera"] = 4;
+
+  auto json = benchmarkReportJson(report);
+  EXPECT_NE(std::string::npos, json.find("\"startup_ms\": 250.000,"));
+  EXPECT_NE(std::string::npos, json.find("\"frames\": 3,"));
+  EXPECT_NE(std::string::npos, json.find("\"p99\": 1.500"));
+  EXPECT_NE(std::string::npos, json.find("\"peak_rss_bytes\": 1024,"));
+  EXPECT_NE(std::string::npos, json.find(
+      "{\"name\": \"Image \\\"display\\\"\", \"gui_thread_ms\": 2.000, "
+      "\"worker_ms\": 3.000, \"deliveries\": 7,"));
+  EXPECT_NE(std::string::npos, json.find(
+      "\"latency_ms\": {\"pose_to_pixel\": {\"mean\": 0.000, "
+      "\"p50\": 0.000, \"p95\": 0.000, \"p99\": 4.000, \"max\": 0.000}}}"));
+  EXPECT_NE(std::string::npos, json.find("\"/camera\": 4"));
+  EXPECT_EQ('}', json[json.size() - 2]);
+
+  // Empty lists are still valid
+  json = benchmarkReportJson(BenchmarkReport());
+  EXPECT_NE(std::string::npos, json.find("\"plugins\": [],"));
+  EXPECT_NE(std::string::npos, json.find("\"published\": {}"));
+}
+
+/////////////////////////////////////////////////
+TEST(BenchmarkTest, Run)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  std::atomic<int> strings{0};
+  std::atomic<int> images{0};
+  std::atomic<int64_t> lastStamp{-1};
+  std::function<void(const msgs::StringMsg &)> stringCb =
+      [&strings](const msgs::StringMsg &_msg)
+  {
+    EXPECT_EQ("hi", _msg.data());
+    ++strings;
+  };
+  std::function<void(const msgs::Image &)> imageCb =
+      [&images, &lastStamp](const msgs::Image &_msg)
+  {
+    EXPECT_EQ(4u, _msg.width());
+    EXPECT_EQ(2u, _msg.height());
+    EXPECT_EQ(4u * 2u * 3u, _msg.data().size());
+    lastStamp = _msg.header().stamp().sec() * 1000000000LL +
+        _msg.header().stamp().nsec();
+    ++images;
+  };
+
+  transport::Node node;
+  ASSERT_TRUE(node.Subscribe("/benchmark_test_string", stringCb));
+  ASSERT_TRUE(node.Subscribe("/benchmark_test_image", imageCb));
+
+  Benchmark benchmark;
+  EXPECT_EQ(300u, benchmark.Frames());
+  EXPECT_EQ(30u, benchmark.Warmup());
+  EXPECT_EQ(std::chrono::milliseconds(16), benchmark.FramePeriod());
+
+  benchmark.SetFrames(20);
+  benchmark.SetWarmup(5);
+  benchmark.SetFramePeriod(std::chrono::milliseconds(8));
+
+  // One string per frame, one image every other frame
+  EXPECT_TRUE(benchmark.AddPublisher("/benchmark_test_string",
+      "ignition.msgs.StringMsg", 125, "data: \"hi\""));
+  EXPECT_TRUE(benchmark.AddImagePublisher("/benchmark_test_image", 62.5,
+      4, 2));
+
+  EXPECT_FALSE(benchmark.AddPublisher("/benchmark_test_bad",
+      "ignition.msgs.NotAMessage", 10));
+  EXPECT_FALSE(benchmark.AddPublisher("", "ignition.msgs.StringMsg", 10));
+  EXPECT_FALSE(benchmark.AddPublisher("/benchmark_test_bad",
+      "ignition.msgs.StringMsg", 0));
+  EXPECT_FALSE(benchmark.AddImagePublisher("/benchmark_test_bad", 10, 0, 0));
+
+  auto report = benchmark.Run();
+
+  // Counts only depend on the settings
+  EXPECT_EQ(20u, report.frames);
+  EXPECT_EQ(20u, report.frameTimes.count);
+  EXPECT_EQ(std::chrono::milliseconds(8), report.framePeriod);
+  ASSERT_EQ(2u, report.published.size());
+  EXPECT_EQ(20u, report.published["/benchmark_test_string"]);
+  EXPECT_EQ(10u, report.published["/benchmark_test_image"]);
+
+  // Everything published during warmup and measuring
+  for (int i = 0; i < 200 && (strings < 25 || images < 12); ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(25, strings);
+  EXPECT_EQ(12, images);
+
+  // Stamped with the benchmark time of the last image's frame
+  EXPECT_EQ(23 * 8000000LL, lastStamp);
+
+  auto text = benchmarkReportText(report);
+  EXPECT_NE(std::string::npos, text.find("Frames 20 at 8 ms"));
+  EXPECT_NE(std::string::npos, text.find("[/benchmark_test_string]"));
+}
+
+/////////////////////////////////////////////////
+TEST(BenchmarkTest, Load)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  Benchmark benchmark;
+  EXPECT_FALSE(benchmark.Load("_doesnt_exist.config"));
+
+  auto config = std::string(PROJECT_SOURCE_PATH) +
+      "/test/config/benchmark.config";
+  EXPECT_TRUE(benchmark.Load(config));
+  EXPECT_EQ(10u, benchmark.Frames());
+  EXPECT_EQ(2u, benchmark.Warmup());
+  EXPECT_EQ(std::chrono::milliseconds(10), benchmark.FramePeriod());
+
+  auto report = benchmark.Run();
+  EXPECT_EQ(10u, report.frames);
+  EXPECT_EQ(5u, report.published["/benchmark_config_string"]);
+  EXPECT_EQ(2u, report.published["/benchmark_config_image"]);
+}
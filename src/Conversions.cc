@@ -15,6 +15,12 @@
  *
 */
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include <ignition/common/MouseEvent.hh>
 #include <ignition/math/Color.hh>
 
@@ -129,3 +135,95 @@ ignition::msgs::Time ignition::gui::convert(const ignition::common::Time &_t)
   return result;
 }
 
+/////////////////////////////////////////////////
+void ignition::gui::convert(const double *_in, const std::size_t _count,
+    float *_out)
+{
+  std::size_t i{0u};
+
+#if defined(__SSE2__)
+  // Four at a time, two per instruction
+  for (; i + 4 <= _count; i += 4)
+  {
+    auto low = _mm_cvtpd_ps(_mm_loadu_pd(_in + i));
+    auto high = _mm_cvtpd_ps(_mm_loadu_pd(_in + i + 2));
+    _mm_storeu_ps(_out + i, _mm_movelh_ps(low, high));
+  }
+#elif defined(__aarch64__)
+  for (; i + 4 <= _count; i += 4)
+  {
+    auto low = vcvt_f32_f64(vld1q_f64(_in + i));
+    auto high = vcvt_f32_f64(vld1q_f64(_in + i + 2));
+    vst1q_f32(_out + i, vcombine_f32(low, high));
+  }
+#endif
+
+  for (; i < _count; ++i)
+    _out[i] = static_cast<float>(_in[i]);
+}
+
+/////////////////////////////////////////////////
+void ignition::gui::convert(
+    const google::protobuf::RepeatedField<double> &_values,
+    std::vector<float> &_out)
+{
+  _out.resize(_values.size());
+  if (_values.empty())
+    return;
+  convert(_values.data(), _out.size(), _out.data());
+}
+
+/////////////////////////////////////////////////
+void ignition::gui::convert(
+    const google::protobuf::RepeatedPtrField<msgs::Vector3d> &_points,
+    std::vector<float> &_out)
+{
+  _out.resize(_points.size() * 3u);
+  auto out = _out.data();
+  for (const auto &point : _points)
+  {
+    out[0] = static_cast<float>(point.x());
+    out[1] = static_cast<float>(point.y());
+    out[2] = static_cast<float>(point.z());
+    out += 3;
+  }
+}
+
+/////////////////////////////////////////////////
+void ignition::gui::convert(
+    const google::protobuf::RepeatedPtrField<msgs::Vector3d> &_points,
+    std::vector<double> &_out)
+{
+  _out.resize(_points.size() * 3u);
+  auto out = _out.data();
+  for (const auto &point : _points)
+  {
+    out[0] = point.x();
+    out[1] = point.y();
+    out[2] = point.z();
+    out += 3;
+  }
+}
+
+/////////////////////////////////////////////////
+void ignition::gui::convert(
+    const google::protobuf::RepeatedPtrField<msgs::Pose> &_poses,
+    std::vector<double> &_out)
+{
+  _out.resize(_poses.size() * 7u);
+  auto out = _out.data();
+  for (const auto &pose : _poses)
+  {
+    // Sub-messages which aren't set read as their defaults
+    const auto &position = pose.position();
+    const auto &orientation = pose.orientation();
+    out[0] = position.x();
+    out[1] = position.y();
+    out[2] = position.z();
+    out[3] = orientation.w();
+    out[4] = orientation.x();
+    out[5] = orientation.y();
+    out[6] = orientation.z();
+    out += 7;
+  }
+}
@@ -17,9 +17,13 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/MouseEvent.hh>
 #include <ignition/math/Color.hh>
+#include <ignition/msgs/pose_v.pb.h>
+#include <ignition/msgs/Utility.hh>
 
 #include "test_config.h"  // NOLINT(build/include)
 #include "ignition/gui/Conversions.hh"
@@ -172,3 +176,100 @@ TEST(ConversionsTest, Time)
   }
 }
 
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, Doubles)
+{
+  // Covers both the vectorized part and the remainder
+  google::protobuf::RepeatedField<double> values;
+  for (int i = 0; i < 11; ++i)
+    values.Add(i * 0.5 - 1.0);
+  values.Add(12345.678);
+
+  std::vector<float> out;
+  convert(values, out);
+  ASSERT_EQ(12u, out.size());
+  for (int i = 0; i < values.size(); ++i)
+    EXPECT_FLOAT_EQ(static_cast<float>(values.Get(i)), out[i]) << i;
+
+  // The output is resized to fit
+  values.Clear();
+  values.Add(3.0);
+  convert(values, out);
+  ASSERT_EQ(1u, out.size());
+  EXPECT_FLOAT_EQ(3.0f, out[0]);
+
+  values.Clear();
+  convert(values, out);
+  EXPECT_TRUE(out.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, Points)
+{
+  google::protobuf::RepeatedPtrField<msgs::Vector3d> points;
+  msgs::Set(points.Add(), math::Vector3d(1.0, 2.0, 3.0));
+  msgs::Set(points.Add(), math::Vector3d(-4.5, 0.25, 1e-3));
+
+  std::vector<float> floats;
+  convert(points, floats);
+  ASSERT_EQ(6u, floats.size());
+  EXPECT_FLOAT_EQ(1.0f, floats[0]);
+  EXPECT_FLOAT_EQ(2.0f, floats[1]);
+  EXPECT_FLOAT_EQ(3.0f, floats[2]);
+  EXPECT_FLOAT_EQ(-4.5f, floats[3]);
+  EXPECT_FLOAT_EQ(0.25f, floats[4]);
+  EXPECT_FLOAT_EQ(1e-3f, floats[5]);
+
+  std::vector<double> doubles;
+  convert(points, doubles);
+  ASSERT_EQ(6u, doubles.size());
+  EXPECT_DOUBLE_EQ(1e-3, doubles[5]);
+
+  points.Clear();
+  convert(points, floats);
+  EXPECT_TRUE(floats.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, Poses)
+{
+  math::Pose3d first(1, 2, 3, 0.1, 0.2, 0.3);
+  math::Pose3d second(-1, 0.5, 10, 1.5, 0, -0.7);
+
+  msgs::Pose_V msg;
+  msgs::Set(msg.add_pose(), first);
+  msgs::Set(msg.add_pose(), second);
+
+  std::vector<double> data;
+  convert(msg.pose(), data);
+  ASSERT_EQ(14u, data.size());
+
+  // Same as converting one at a time
+  for (int i = 0; i < msg.pose_size(); ++i)
+  {
+    auto expected = msgs::Convert(msg.pose(i));
+    const double *pose = &data[i * 7];
+    EXPECT_EQ(expected, math::Pose3d(pose[0], pose[1], pose[2],
+        pose[3], pose[4], pose[5], pose[6])) << i;
+  }
+
+  // Unset orientations are copied as zeros, and corrected to identity
+  auto unset = msg.add_pose();
+  msgs::Set(unset->mutable_position(), math::Vector3d(4, 5, 6));
+
+  convert(msg.pose(), data);
+  ASSERT_EQ(21u, data.size());
+
+  const double *pose = &data[14];
+  EXPECT_DOUBLE_EQ(0.0, pose[3]);
+  EXPECT_DOUBLE_EQ(0.0, pose[4]);
+  EXPECT_DOUBLE_EQ(0.0, pose[5]);
+  EXPECT_DOUBLE_EQ(0.0, pose[6]);
+
+  math::Pose3d corrected(pose[0], pose[1], pose[2],
+      pose[3], pose[4], pose[5], pose[6]);
+  corrected.Correct();
+  EXPECT_EQ(math::Pose3d(4, 5, 6, 0, 0, 0), corrected);
+  EXPECT_EQ(msgs::Convert(*unset), corrected);
+}
@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ignition/gui/FrameTree.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief A coordinate frame
+    struct Frame
+    {
+      /// \brief Scoped name
+      std::string name;
+
+      /// \brief Parent id
+      unsigned int parent{FrameTree::kWorld};
+
+      /// \brief Children ids
+      std::vector<unsigned int> children;
+
+      /// \brief Pose relative to the parent
+      math::Pose3d localPose;
+
+      /// \brief Cached pose in the world, valid unless dirty
+      math::Pose3d worldPose;
+
+      /// \brief True if the world pose must be computed again. All
+      /// descendants of a dirty frame are dirty.
+      bool dirty{true};
+    };
+
+    class FrameTreePrivate
+    {
+      /// \brief Get a frame's world pose, computing it and its ancestors'
+      /// if dirty. Must be called with the mutex locked.
+      /// \param[in] _frame Frame
+      /// \return World pose
+      public: const math::Pose3d &World(Frame &_frame);
+
+      /// \brief Mark a frame and its descendants dirty. Must be called with
+      /// the mutex locked.
+      /// \param[in] _id Frame id
+      public: void MarkDirty(const unsigned int _id);
+
+      /// \brief Get the children of a frame. Must be called with the mutex
+      /// locked.
+      /// \param[in] _id Frame id, kWorld for the world
+      /// \return Children, null if the frame is unknown
+      public: std::vector<unsigned int> *ChildrenOf(const unsigned int _id);
+
+      /// \brief Protects everything, including the cache which queries
+      /// update
+      public: mutable std::mutex mutex;
+
+      /// \brief Frames by id
+      public: std::unordered_map<unsigned int, Frame> frames;
+
+      /// \brief Frame ids by scoped name
+      public: std::unordered_map<std::string, unsigned int> names;
+
+      /// \brief Frames directly in the world
+      public: std::vector<unsigned int> roots;
+
+      /// \brief Frames left to visit, kept to reuse their capacity
+      public: std::vector<unsigned int> stack;
+
+      /// \brief Number of world poses computed
+      public: uint64_t computations{0u};
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+const unsigned int FrameTree::kWorld{std::numeric_limits<unsigned int>::max()};
+
+/////////////////////////////////////////////////
+const math::Pose3d &FrameTreePrivate::World(Frame &_frame)
+{
+  if (!_frame.dirty)
+    return _frame.worldPose;
+
+  if (_frame.parent == FrameTree::kWorld)
+    _frame.worldPose = _frame.localPose;
+  else
+    _frame.worldPose = _frame.localPose * this->World(
+        this->frames.at(_frame.parent));
+
+  _frame.dirty = false;
+  ++this->computations;
+  return _frame.worldPose;
+}
+
+/////////////////////////////////////////////////
+void FrameTreePrivate::MarkDirty(const unsigned int _id)
+{
+  this->stack.clear();
+  this->stack.push_back(_id);
+  while (!this->stack.empty())
+  {
+    auto &frame = this->frames.at(this->stack.back());
+    this->stack.pop_back();
+
+    // Its descendants are dirty already
+    if (frame.dirty)
+      continue;
+
+    frame.dirty = true;
+    this->stack.insert(this->stack.end(), frame.children.begin(),
+        frame.children.end());
+  }
+}
+
+/////////////////////////////////////////////////
+std::vector<unsigned int> *FrameTreePrivate::ChildrenOf(
+    const unsigned int _id)
+{
+  if (_id == FrameTree::kWorld)
+    return &this->roots;
+
+  auto it = this->frames.find(_id);
+  return it == this->frames.end() ? nullptr : &it->second.children;
+}
+
+/////////////////////////////////////////////////
+FrameTree::FrameTree()
+  : dataPtr(new FrameTreePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+FrameTree::~FrameTree()
+{
+}
+
+/////////////////////////////////////////////////
+bool FrameTree::Add(const unsigned int _id, const std::string &_name,
+    const math::Pose3d &_localPose, const unsigned int _parent)
+{
+  if (_id == kWorld)
+    return false;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto &frames = this->dataPtr->frames;
+
+  auto parentChildren = this->dataPtr->ChildrenOf(_parent);
+  if (!parentChildren)
+    return false;
+
+  // A frame can't be its own ancestor
+  for (auto ancestor = _parent; ancestor != kWorld;
+      ancestor = frames.at(ancestor).parent)
+  {
+    if (ancestor == _id)
+      return false;
+  }
+
+  auto it = frames.find(_id);
+  if (it == frames.end())
+  {
+    it = frames.emplace(_id, Frame()).first;
+  }
+  else
+  {
+    auto &siblings = *this->dataPtr->ChildrenOf(it->second.parent);
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), _id),
+        siblings.end());
+
+    auto name = this->dataPtr->names.find(it->second.name);
+    if (name != this->dataPtr->names.end() && name->second == _id)
+      this->dataPtr->names.erase(name);
+  }
+
+  auto &frame = it->second;
+  frame.name = _name;
+  frame.parent = _parent;
+  frame.localPose = _localPose;
+  parentChildren->push_back(_id);
+  this->dataPtr->names[_name] = _id;
+  this->dataPtr->MarkDirty(_id);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::size_t FrameTree::Remove(const unsigned int _id)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto &frames = this->dataPtr->frames;
+
+  auto it = frames.find(_id);
+  if (it == frames.end())
+    return 0u;
+
+  auto &siblings = *this->dataPtr->ChildrenOf(it->second.parent);
+  siblings.erase(std::remove(siblings.begin(), siblings.end(), _id),
+      siblings.end());
+
+  std::size_t removed{0u};
+  auto &stack = this->dataPtr->stack;
+  stack.clear();
+  stack.push_back(_id);
+  while (!stack.empty())
+  {
+    auto frame = frames.find(stack.back());
+    stack.pop_back();
+    stack.insert(stack.end(), frame->second.children.begin(),
+        frame->second.children.end());
+
+    auto name = this->dataPtr->names.find(frame->second.name);
+    if (name != this->dataPtr->names.end() && name->second == frame->first)
+      this->dataPtr->names.erase(name);
+
+    frames.erase(frame);
+    ++removed;
+  }
+
+  return removed;
+}
+
+/////////////////////////////////////////////////
+void FrameTree::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->frames.clear();
+  this->dataPtr->names.clear();
+  this->dataPtr->roots.clear();
+}
+
+/////////////////////////////////////////////////
+bool FrameTree::SetLocalPose(const unsigned int _id,
+    const math::Pose3d &_localPose)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->frames.find(_id);
+  if (it == this->dataPtr->frames.end())
+    return false;
+
+  it->second.localPose = _localPose;
+  this->dataPtr->MarkDirty(_id);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool FrameTree::LocalPose(const unsigned int _id,
+    math::Pose3d &_localPose) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->frames.find(_id);
+  if (it == this->dataPtr->frames.end())
+    return false;
+
+  _localPose = it->second.localPose;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool FrameTree::WorldPose(const unsigned int _id,
+    math::Pose3d &_worldPose) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->frames.find(_id);
+  if (it == this->dataPtr->frames.end())
+    return false;
+
+  _worldPose = this->dataPtr->World(it->second);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::size_t FrameTree::WorldPoses(const std::vector<unsigned int> &_ids,
+    std::vector<math::Pose3d> &_worldPoses) const
+{
+  _worldPoses.resize(_ids.size());
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  std::size_t found{0u};
+  for (std::size_t i = 0; i < _ids.size(); ++i)
+  {
+    auto it = this->dataPtr->frames.find(_ids[i]);
+    if (it == this->dataPtr->frames.end())
+    {
+      _worldPoses[i] = math::Pose3d::Zero;
+      continue;
+    }
+
+    _worldPoses[i] = this->dataPtr->World(it->second);
+    ++found;
+  }
+  return found;
+}
+
+/////////////////////////////////////////////////
+bool FrameTree::Id(const std::string &_name, unsigned int &_id) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->names.find(_name);
+  if (it == this->dataPtr->names.end())
+    return false;
+
+  _id = it->second;
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string FrameTree::Name(const unsigned int _id) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->frames.find(_id);
+  return it == this->dataPtr->frames.end() ? std::string() : it->second.name;
+}
+
+/////////////////////////////////////////////////
+unsigned int FrameTree::Parent(const unsigned int _id) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->frames.find(_id);
+  return it == this->dataPtr->frames.end() ? kWorld : it->second.parent;
+}
+
+/////////////////////////////////////////////////
+std::vector<unsigned int> FrameTree::Children(const unsigned int _id) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto children = this->dataPtr->ChildrenOf(_id);
+  return children ? *children : std::vector<unsigned int>();
+}
+
+/////////////////////////////////////////////////
+std::size_t FrameTree::Count() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->frames.size();
+}
+
+/////////////////////////////////////////////////
+uint64_t FrameTree::Computations() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->computations;
+}
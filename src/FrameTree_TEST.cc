@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "ignition/gui/FrameTree.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(FrameTreeTest, WorldPoses)
+{
+  FrameTree tree;
+
+  // A model turned a quarter, with a link and a visual
+  EXPECT_TRUE(tree.Add(1, "model", math::Pose3d(1, 0, 0, 0, 0, M_PI / 2)));
+  EXPECT_TRUE(tree.Add(2, "model::link", math::Pose3d(1, 0, 0, 0, 0, 0), 1));
+  EXPECT_TRUE(tree.Add(3, "model::link::visual",
+      math::Pose3d(0, 0, 1, 0, 0, 0), 2));
+  EXPECT_FALSE(tree.Add(4, "orphan", math::Pose3d::Zero, 10));
+  EXPECT_FALSE(tree.Add(1, "model", math::Pose3d::Zero, 3));
+  EXPECT_EQ(3u, tree.Count());
+
+  math::Pose3d pose;
+  EXPECT_TRUE(tree.WorldPose(3, pose));
+  EXPECT_EQ(math::Pose3d(1, 1, 1, 0, 0, M_PI / 2), pose);
+  EXPECT_EQ(3u, tree.Computations());
+
+  // Cached
+  EXPECT_TRUE(tree.WorldPose(2, pose));
+  EXPECT_EQ(math::Pose3d(1, 1, 0, 0, 0, M_PI / 2), pose);
+  EXPECT_EQ(3u, tree.Computations());
+
+  // Moving the model moves its descendants
+  EXPECT_TRUE(tree.SetLocalPose(1, math::Pose3d(0, 5, 0, 0, 0, 0)));
+  EXPECT_TRUE(tree.SetLocalPose(1, math::Pose3d(0, 2, 0, 0, 0, 0)));
+  std::vector<math::Pose3d> poses;
+  EXPECT_EQ(2u, tree.WorldPoses({3, 20, 1}, poses));
+  ASSERT_EQ(3u, poses.size());
+  EXPECT_EQ(math::Pose3d(1, 2, 1, 0, 0, 0), poses[0]);
+  EXPECT_EQ(math::Pose3d::Zero, poses[1]);
+  EXPECT_EQ(math::Pose3d(0, 2, 0, 0, 0, 0), poses[2]);
+  EXPECT_EQ(6u, tree.Computations());
+
+  // Moving the visual doesn't touch its ancestors
+  EXPECT_TRUE(tree.SetLocalPose(3, math::Pose3d(0, 0, 2, 0, 0, 0)));
+  EXPECT_TRUE(tree.WorldPose(3, pose));
+  EXPECT_EQ(math::Pose3d(1, 2, 2, 0, 0, 0), pose);
+  EXPECT_EQ(7u, tree.Computations());
+
+  EXPECT_FALSE(tree.SetLocalPose(20, math::Pose3d::Zero));
+  EXPECT_FALSE(tree.WorldPose(20, pose));
+}
+
+/////////////////////////////////////////////////
+TEST(FrameTreeTest, Hierarchy)
+{
+  FrameTree tree;
+  EXPECT_FALSE(tree.Add(FrameTree::kWorld, "world", math::Pose3d::Zero));
+  tree.Add(1, "model", math::Pose3d::Zero);
+  tree.Add(2, "model::link", math::Pose3d::Zero, 1);
+  tree.Add(3, "model::link::visual", math::Pose3d::Zero, 2);
+  tree.Add(4, "other", math::Pose3d(0, 0, 3, 0, 0, 0));
+
+  unsigned int id{0u};
+  EXPECT_TRUE(tree.Id("model::link", id));
+  EXPECT_EQ(2u, id);
+  EXPECT_FALSE(tree.Id("link", id));
+  EXPECT_EQ("model::link::visual", tree.Name(3));
+  EXPECT_EQ(1u, tree.Parent(2));
+  EXPECT_EQ(FrameTree::kWorld, tree.Parent(1));
+  EXPECT_EQ((std::vector<unsigned int>{1, 4}),
+      tree.Children(FrameTree::kWorld));
+
+  // Replacing a frame keeps its children, moved to the new parent
+  math::Pose3d pose;
+  tree.WorldPose(3, pose);
+  EXPECT_TRUE(tree.Add(2, "other::link", math::Pose3d::Zero, 4));
+  EXPECT_TRUE(tree.Children(1).empty());
+  EXPECT_EQ((std::vector<unsigned int>{2}), tree.Children(4));
+  EXPECT_FALSE(tree.Id("model::link", id));
+  EXPECT_TRUE(tree.WorldPose(3, pose));
+  EXPECT_EQ(math::Pose3d(0, 0, 3, 0, 0, 0), pose);
+
+  // Removing a frame removes its descendants
+  EXPECT_EQ(3u, tree.Remove(4));
+  EXPECT_EQ(0u, tree.Remove(4));
+  EXPECT_EQ(1u, tree.Count());
+  EXPECT_FALSE(tree.Id("other::link", id));
+  EXPECT_EQ((std::vector<unsigned int>{1}),
+      tree.Children(FrameTree::kWorld));
+
+  tree.Clear();
+  EXPECT_EQ(0u, tree.Count());
+  EXPECT_TRUE(tree.Children(FrameTree::kWorld).empty());
+}
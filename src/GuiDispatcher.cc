@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/GuiDispatcher.hh"
+#include "ignition/gui/StallMonitor.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief A call waiting to run on the GUI thread
+    struct QueuedCall
+    {
+      /// \brief Function to run
+      std::function<void()> func;
+
+      /// \brief Context given to GuiDispatcher::Post, may be null
+      const QObject *context{nullptr};
+
+      /// \brief Coalescing key, empty if not coalesced
+      std::string key;
+
+      /// \brief When the call was first posted
+      std::chrono::steady_clock::time_point posted;
+    };
+
+    class GuiDispatcherPrivate
+    {
+      /// \brief Run all queued control calls. Must be called on the GUI
+      /// thread.
+      /// \param[in] _event Event being handled
+      public: void RunControl(const QEvent *_event);
+
+      /// \brief Run a call and update statistics.
+      /// \param[in] _call Call to run
+      /// \param[in] _lane Lane the call was taken from
+      /// \param[in] _event Event being handled
+      public: void Run(QueuedCall &_call, const DeliveryLane _lane,
+          const QEvent *_event);
+
+      /// \brief Event type which runs control calls
+      public: QEvent::Type controlEvent;
+
+      /// \brief Event type which runs bulk calls
+      public: QEvent::Type bulkEvent;
+
+      /// \brief Protects everything below
+      public: mutable std::mutex mutex;
+
+      /// \brief Control calls, oldest first
+      public: std::deque<QueuedCall> control;
+
+      /// \brief Bulk calls, oldest first
+      public: std::deque<QueuedCall> bulk;
+
+      /// \brief Bulk calls with a key, by context and key. Points into bulk,
+      /// whose elements don't move when pushing and popping at the ends.
+      public: std::map<std::pair<const QObject *, std::string>, QueuedCall *>
+          keyed;
+
+      /// \brief Whether a control event has been posted and not handled yet
+      public: bool controlPosted{false};
+
+      /// \brief Whether a bulk event has been posted and not handled yet
+      public: bool bulkPosted{false};
+
+      /// \brief How long bulk calls may run per event loop iteration
+      public: std::chrono::milliseconds bulkBudget{8};
+
+      /// \brief Statistics, indexed by DeliveryLane
+      public: std::array<DeliveryStats, 2> stats;
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+GuiDispatcher::GuiDispatcher()
+  : dataPtr(new GuiDispatcherPrivate)
+{
+  this->dataPtr->controlEvent =
+      static_cast<QEvent::Type>(QEvent::registerEventType());
+  this->dataPtr->bulkEvent =
+      static_cast<QEvent::Type>(QEvent::registerEventType());
+}
+
+/////////////////////////////////////////////////
+GuiDispatcher::~GuiDispatcher()
+{
+}
+
+/////////////////////////////////////////////////
+void GuiDispatcher::Post(const QObject *_context, std::function<void()> _func,
+    const DeliveryLane _lane, const std::string &_key)
+{
+  if (!_func)
+    return;
+
+  QueuedCall call;
+  call.func = std::move(_func);
+  call.context = _context;
+  call.posted = std::chrono::steady_clock::now();
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+    if (_lane == DeliveryLane::kControl)
+    {
+      this->dataPtr->control.push_back(std::move(call));
+      if (this->dataPtr->controlPosted)
+        return;
+      this->dataPtr->controlPosted = true;
+    }
+    else
+    {
+      // Replace the waiting call in place, keeping its position and post
+      // time, so a steady stream can't keep postponing it
+      if (!_key.empty())
+      {
+        auto it = this->dataPtr->keyed.find({_context, _key});
+        if (it != this->dataPtr->keyed.end())
+        {
+          it->second->func = std::move(call.func);
+          ++this->dataPtr->stats[static_cast<int>(_lane)].coalesced;
+          return;
+        }
+        call.key = _key;
+      }
+
+      this->dataPtr->bulk.push_back(std::move(call));
+      if (!_key.empty())
+        this->dataPtr->keyed[{_context, _key}] = &this->dataPtr->bulk.back();
+
+      if (this->dataPtr->bulkPosted)
+        return;
+      this->dataPtr->bulkPosted = true;
+    }
+  }
+
+  // Posted events are sorted by priority, so control events jump ahead of
+  // everything already queued, including other plugins' queued calls
+  if (_lane == DeliveryLane::kControl)
+  {
+    QCoreApplication::postEvent(this, new QEvent(this->dataPtr->controlEvent),
+        Qt::HighEventPriority);
+  }
+  else
+  {
+    QCoreApplication::postEvent(this, new QEvent(this->dataPtr->bulkEvent));
+  }
+}
+
+/////////////////////////////////////////////////
+void GuiDispatcher::Cancel(const QObject *_context)
+{
+  if (nullptr == _context)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  auto matches = [&_context](const QueuedCall &_call)
+  {
+    return _call.context == _context;
+  };
+
+  auto &control = this->dataPtr->control;
+  control.erase(std::remove_if(control.begin(), control.end(), matches),
+      control.end());
+
+  // Erasing from the middle moves elements, so rebuild the keyed index
+  auto &bulk = this->dataPtr->bulk;
+  bulk.erase(std::remove_if(bulk.begin(), bulk.end(), matches), bulk.end());
+
+  this->dataPtr->keyed.clear();
+  for (auto &call : bulk)
+  {
+    if (!call.key.empty())
+      this->dataPtr->keyed[{call.context, call.key}] = &call;
+  }
+}
+
+/////////////////////////////////////////////////
+void GuiDispatcher::SetBulkBudget(const std::chrono::milliseconds &_budget)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->bulkBudget = _budget;
+}
+
+/////////////////////////////////////////////////
+std::chrono::milliseconds GuiDispatcher::BulkBudget() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->bulkBudget;
+}
+
+/////////////////////////////////////////////////
+DeliveryStats GuiDispatcher::Stats(const DeliveryLane _lane) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->stats[static_cast<int>(_lane)];
+}
+
+/////////////////////////////////////////////////
+void GuiDispatcher::ResetStats()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->stats.fill(DeliveryStats());
+}
+
+/////////////////////////////////////////////////
+bool GuiDispatcher::event(QEvent *_event)
+{
+  if (_event->type() == this->dataPtr->controlEvent)
+  {
+    this->dataPtr->RunControl(_event);
+    return true;
+  }
+
+  if (_event->type() != this->dataPtr->bulkEvent)
+    return QObject::event(_event);
+
+  auto start = std::chrono::steady_clock::now();
+  while (true)
+  {
+    // Control calls posted while running bulk calls don't wait for them
+    this->dataPtr->RunControl(_event);
+
+    QueuedCall call;
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+      if (this->dataPtr->bulk.empty())
+      {
+        this->dataPtr->bulkPosted = false;
+        break;
+      }
+
+      // Let input and painting through before running the rest
+      if (std::chrono::steady_clock::now() - start >
+          this->dataPtr->bulkBudget)
+      {
+        QCoreApplication::postEvent(this,
+            new QEvent(this->dataPtr->bulkEvent));
+        break;
+      }
+
+      call = std::move(this->dataPtr->bulk.front());
+      if (!call.key.empty())
+        this->dataPtr->keyed.erase({call.context, call.key});
+      this->dataPtr->bulk.pop_front();
+    }
+
+    this->dataPtr->Run(call, DeliveryLane::kBulk, _event);
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void GuiDispatcherPrivate::RunControl(const QEvent *_event)
+{
+  while (true)
+  {
+    QueuedCall call;
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->control.empty())
+      {
+        this->controlPosted = false;
+        return;
+      }
+
+      call = std::move(this->control.front());
+      this->control.pop_front();
+    }
+
+    this->Run(call, DeliveryLane::kControl, _event);
+  }
+}
+
+/////////////////////////////////////////////////
+void GuiDispatcherPrivate::Run(QueuedCall &_call, const DeliveryLane _lane,
+    const QEvent *_event)
+{
+  auto wait = std::chrono::steady_clock::now() - _call.posted;
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    auto &stats = this->stats[static_cast<int>(_lane)];
+    ++stats.count;
+    stats.totalWait += wait;
+    stats.maxWait = std::max(stats.maxWait, wait);
+  }
+
+  // The event's receiver is the dispatcher, so attribute the call to its
+  // context's plugin explicitly
+  auto monitor = App() ? App()->Monitor() : nullptr;
+  if (monitor && _call.context)
+    monitor->BeginDelivery(_call.context, _event);
+
+  _call.func();
+
+  if (monitor && _call.context)
+    monitor->EndDelivery();
+}
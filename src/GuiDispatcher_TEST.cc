@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/GuiDispatcher.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(GuiDispatcherTest, ControlFirst)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  auto dispatcher = app.Dispatcher();
+  ASSERT_NE(nullptr, dispatcher);
+
+  QObject context;
+  std::vector<std::string> calls;
+
+  // Queued call from another source, posted before everything else
+  QMetaObject::invokeMethod(&context, [&calls] {calls.push_back("queued");},
+      Qt::QueuedConnection);
+
+  dispatcher->Post(&context, [&calls] {calls.push_back("bulk");});
+
+  // Posted from another thread, like a service reply
+  std::thread([&]
+  {
+    dispatcher->Post(&context, [&calls] {calls.push_back("control");},
+        DeliveryLane::kControl);
+  }).join();
+
+  QCoreApplication::processEvents();
+
+  ASSERT_EQ(3u, calls.size());
+  EXPECT_EQ("control", calls[0]);
+  EXPECT_EQ("queued", calls[1]);
+  EXPECT_EQ("bulk", calls[2]);
+
+  EXPECT_EQ(1u, dispatcher->Stats(DeliveryLane::kControl).count);
+  EXPECT_EQ(1u, dispatcher->Stats(DeliveryLane::kBulk).count);
+}
+
+/////////////////////////////////////////////////
+TEST(GuiDispatcherTest, Coalesce)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  auto dispatcher = app.Dispatcher();
+  ASSERT_NE(nullptr, dispatcher);
+
+  QObject context;
+  QObject otherContext;
+  std::vector<int> images;
+  std::vector<int> others;
+  int controls{0};
+
+  for (int i = 0; i < 5; ++i)
+  {
+    dispatcher->Post(&context, [&images, i] {images.push_back(i);},
+        DeliveryLane::kBulk, "image");
+    dispatcher->Post(&otherContext, [&others, i] {others.push_back(i);},
+        DeliveryLane::kBulk, "image");
+
+    // Control calls are never coalesced
+    dispatcher->Post(&context, [&controls] {++controls;},
+        DeliveryLane::kControl, "image");
+  }
+
+  QCoreApplication::processEvents();
+
+  // Only the latest per context and key
+  ASSERT_EQ(1u, images.size());
+  EXPECT_EQ(4, images[0]);
+  ASSERT_EQ(1u, others.size());
+  EXPECT_EQ(4, others[0]);
+  EXPECT_EQ(5, controls);
+
+  EXPECT_EQ(8u, dispatcher->Stats(DeliveryLane::kBulk).coalesced);
+  EXPECT_EQ(0u, dispatcher->Stats(DeliveryLane::kControl).coalesced);
+
+  // Keys are free again once run
+  dispatcher->Post(&context, [&images] {images.push_back(5);},
+      DeliveryLane::kBulk, "image");
+  QCoreApplication::processEvents();
+  ASSERT_EQ(2u, images.size());
+  EXPECT_EQ(5, images[1]);
+}
+
+/////////////////////////////////////////////////
+TEST(GuiDispatcherTest, Cancel)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  auto dispatcher = app.Dispatcher();
+  ASSERT_NE(nullptr, dispatcher);
+
+  QObject cancelled;
+  QObject kept;
+  std::vector<std::string> calls;
+
+  dispatcher->Post(&cancelled, [&calls] {calls.push_back("bulk");});
+  dispatcher->Post(&cancelled, [&calls] {calls.push_back("keyed");},
+      DeliveryLane::kBulk, "key");
+  dispatcher->Post(&cancelled, [&calls] {calls.push_back("control");},
+      DeliveryLane::kControl);
+  dispatcher->Post(&kept, [&calls] {calls.push_back("kept");},
+      DeliveryLane::kBulk, "key");
+
+  dispatcher->Cancel(&cancelled);
+
+  // Coalescing still works for the calls left
+  dispatcher->Post(&kept, [&calls] {calls.push_back("kept latest");},
+      DeliveryLane::kBulk, "key");
+
+  QCoreApplication::processEvents();
+
+  ASSERT_EQ(1u, calls.size());
+  EXPECT_EQ("kept latest", calls[0]);
+}
+
+/////////////////////////////////////////////////
+TEST(GuiDispatcherTest, BulkBudget)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  auto dispatcher = app.Dispatcher();
+  ASSERT_NE(nullptr, dispatcher);
+  EXPECT_EQ(std::chrono::milliseconds(8), dispatcher->BulkBudget());
+
+  dispatcher->SetBulkBudget(std::chrono::milliseconds(1));
+  EXPECT_EQ(std::chrono::milliseconds(1), dispatcher->BulkBudget());
+
+  QObject context;
+  std::vector<std::string> calls;
+
+  // Slow bulk calls, the first one goes over the budget
+  for (int i = 0; i < 3; ++i)
+  {
+    dispatcher->Post(&context, [&]
+    {
+      calls.push_back("bulk");
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+      // Posted while bulk calls are running
+      if (calls.size() == 1u)
+      {
+        dispatcher->Post(&context, [&calls] {calls.push_back("control");},
+            DeliveryLane::kControl);
+      }
+    });
+  }
+
+  for (int i = 0; i < 10 && calls.size() < 4u; ++i)
+    QCoreApplication::processEvents();
+
+  // The control call didn't wait for the remaining bulk calls
+  ASSERT_EQ(4u, calls.size());
+  EXPECT_EQ("bulk", calls[0]);
+  EXPECT_EQ("control", calls[1]);
+  EXPECT_EQ("bulk", calls[2]);
+  EXPECT_EQ("bulk", calls[3]);
+}
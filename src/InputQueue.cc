@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <deque>
+
+#include "ignition/gui/InputQueue.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class InputQueuePrivate
+    {
+      /// \brief Try to queue an event. Producer only.
+      /// \param[in] _event Event.
+      /// \return False if the queue is full.
+      public: bool TryPush(const InputEvent &_event);
+
+      /// \brief Slots, allocated once so that events are copied into them
+      /// without allocating
+      public: std::vector<InputEvent> slots;
+
+      /// \brief Number of slots minus one, for wrapping positions
+      public: std::size_t mask{0u};
+
+      /// \brief Number of events pushed, written by the producer
+      public: std::atomic<std::size_t> head{0u};
+
+      /// \brief Number of events drained, written by the consumer
+      public: std::atomic<std::size_t> tail{0u};
+
+      /// \brief Events which didn't fit, producer only
+      public: std::deque<InputEvent> overflow;
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+bool InputQueuePrivate::TryPush(const InputEvent &_event)
+{
+  auto head = this->head.load(std::memory_order_relaxed);
+  if (head - this->tail.load(std::memory_order_acquire) >= this->slots.size())
+    return false;
+
+  this->slots[head & this->mask] = _event;
+  this->head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool ignition::gui::coalesce(InputEvent &_previous, const InputEvent &_next)
+{
+  const auto &previous = _previous.event;
+  const auto &next = _next.event;
+
+  if (previous.Type() != next.Type())
+    return false;
+
+  if (next.Type() == common::MouseEvent::MOVE)
+  {
+    if (previous.Buttons() != next.Buttons())
+      return false;
+  }
+  else if (next.Type() != common::MouseEvent::SCROLL)
+  {
+    return false;
+  }
+
+  // Modifiers may change what a drag does
+  if (previous.Shift() != next.Shift() ||
+      previous.Control() != next.Control() ||
+      previous.Alt() != next.Alt())
+  {
+    return false;
+  }
+
+  _previous.event = next;
+  _previous.drag += _next.drag;
+  _previous.count += _next.count;
+  return true;
+}
+
+/////////////////////////////////////////////////
+InputQueue::InputQueue(const std::size_t _capacity)
+  : dataPtr(new InputQueuePrivate)
+{
+  std::size_t capacity{1u};
+  while (capacity < _capacity)
+    capacity <<= 1;
+
+  this->dataPtr->slots.resize(capacity);
+  this->dataPtr->mask = capacity - 1;
+}
+
+/////////////////////////////////////////////////
+InputQueue::~InputQueue()
+{
+}
+
+/////////////////////////////////////////////////
+void InputQueue::Push(const common::MouseEvent &_event,
+    const math::Vector2d &_drag,
+    const std::chrono::steady_clock::time_point &_time)
+{
+  InputEvent event;
+  event.event = _event;
+  event.drag = _drag;
+  event.time = _time;
+
+  this->Flush();
+
+  // Behind events which didn't fit, to keep the order
+  auto &overflow = this->dataPtr->overflow;
+  if (!overflow.empty() || !this->dataPtr->TryPush(event))
+  {
+    if (overflow.empty() || !coalesce(overflow.back(), event))
+      overflow.push_back(event);
+  }
+}
+
+/////////////////////////////////////////////////
+void InputQueue::Flush()
+{
+  auto &overflow = this->dataPtr->overflow;
+  while (!overflow.empty() && this->dataPtr->TryPush(overflow.front()))
+    overflow.pop_front();
+}
+
+/////////////////////////////////////////////////
+std::size_t InputQueue::Drain(std::vector<InputEvent> &_events)
+{
+  _events.clear();
+
+  auto tail = this->dataPtr->tail.load(std::memory_order_relaxed);
+  auto head = this->dataPtr->head.load(std::memory_order_acquire);
+
+  std::size_t count{0u};
+  for (; tail != head; ++tail)
+  {
+    const auto &event = this->dataPtr->slots[tail & this->dataPtr->mask];
+    count += event.count;
+    if (_events.empty() || !coalesce(_events.back(), event))
+      _events.push_back(event);
+  }
+
+  this->dataPtr->tail.store(tail, std::memory_order_release);
+  return count;
+}
+
+/////////////////////////////////////////////////
+std::size_t InputQueue::Capacity() const
+{
+  return this->dataPtr->slots.size();
+}
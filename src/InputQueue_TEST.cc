@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "ignition/gui/InputQueue.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Make a mouse event
+/// \param[in] _type Event type
+/// \param[in] _buttons Buttons held
+/// \param[in] _x Horizontal position
+/// \return Event
+common::MouseEvent mouseEvent(const common::MouseEvent::EventType _type,
+    const int _buttons = common::MouseEvent::NO_BUTTON, const int _x = 0)
+{
+  common::MouseEvent event;
+  event.SetType(_type);
+  event.SetButtons(_buttons);
+  event.SetPos(_x, 0);
+  return event;
+}
+
+/////////////////////////////////////////////////
+TEST(InputQueueTest, Coalesce)
+{
+  InputQueue queue(3);
+  EXPECT_EQ(4u, queue.Capacity());
+
+  std::vector<InputEvent> events;
+  EXPECT_EQ(0u, queue.Drain(events));
+  EXPECT_TRUE(events.empty());
+
+  auto start = std::chrono::steady_clock::now();
+  auto left = common::MouseEvent::LEFT;
+  queue.Push(mouseEvent(common::MouseEvent::PRESS, left), {0, 0}, start);
+  queue.Push(mouseEvent(common::MouseEvent::MOVE, left, 1), {1, 0});
+  queue.Push(mouseEvent(common::MouseEvent::MOVE, left, 3), {2, 1});
+  queue.Push(mouseEvent(common::MouseEvent::RELEASE));
+
+  // Moves are coalesced, transitions kept in order
+  EXPECT_EQ(4u, queue.Drain(events));
+  ASSERT_EQ(3u, events.size());
+  EXPECT_EQ(common::MouseEvent::PRESS, events[0].event.Type());
+  EXPECT_EQ(start, events[0].time);
+  EXPECT_EQ(common::MouseEvent::MOVE, events[1].event.Type());
+  EXPECT_EQ(3, events[1].event.Pos().X());
+  EXPECT_EQ(math::Vector2d(3, 1), events[1].drag);
+  EXPECT_EQ(2u, events[1].count);
+  EXPECT_EQ(common::MouseEvent::RELEASE, events[2].event.Type());
+
+  // Moves with different buttons are kept apart
+  auto middle = common::MouseEvent::MIDDLE;
+  queue.Push(mouseEvent(common::MouseEvent::MOVE, left), {1, 1});
+  queue.Push(mouseEvent(common::MouseEvent::MOVE, middle), {1, 1});
+  queue.Push(mouseEvent(common::MouseEvent::SCROLL), {1, 1});
+  queue.Push(mouseEvent(common::MouseEvent::SCROLL), {1, 1});
+  EXPECT_EQ(4u, queue.Drain(events));
+  ASSERT_EQ(3u, events.size());
+  EXPECT_EQ(math::Vector2d(2, 2), events[2].drag);
+}
+
+/////////////////////////////////////////////////
+TEST(InputQueueTest, Overflow)
+{
+  InputQueue queue(2);
+  auto left = common::MouseEvent::LEFT;
+
+  // Two fit, the rest wait on the producer's side, coalesced
+  queue.Push(mouseEvent(common::MouseEvent::PRESS, left));
+  queue.Push(mouseEvent(common::MouseEvent::RELEASE));
+  queue.Push(mouseEvent(common::MouseEvent::PRESS, left));
+  for (int i = 0; i < 10; ++i)
+    queue.Push(mouseEvent(common::MouseEvent::MOVE, left, i), {1, 0});
+  queue.Push(mouseEvent(common::MouseEvent::RELEASE));
+
+  std::vector<InputEvent> events;
+  EXPECT_EQ(2u, queue.Drain(events));
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ(common::MouseEvent::RELEASE, events[1].event.Type());
+
+  // Nothing left until the producer flushes
+  EXPECT_EQ(0u, queue.Drain(events));
+  queue.Flush();
+  EXPECT_EQ(11u, queue.Drain(events));
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ(common::MouseEvent::PRESS, events[0].event.Type());
+  EXPECT_EQ(math::Vector2d(10, 0), events[1].drag);
+
+  queue.Flush();
+  EXPECT_EQ(1u, queue.Drain(events));
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ(common::MouseEvent::RELEASE, events[0].event.Type());
+}
+
+/////////////////////////////////////////////////
+TEST(InputQueueTest, Threads)
+{
+  InputQueue queue(64);
+  const int cycles{2000};
+  const int movesPerCycle{20};
+  auto left = common::MouseEvent::LEFT;
+
+  std::atomic<bool> done{false};
+  std::thread producer([&]()
+  {
+    for (int c = 0; c < cycles; ++c)
+    {
+      queue.Push(mouseEvent(common::MouseEvent::PRESS, left));
+      for (int m = 0; m < movesPerCycle; ++m)
+        queue.Push(mouseEvent(common::MouseEvent::MOVE, left, m), {1, 0});
+      queue.Push(mouseEvent(common::MouseEvent::RELEASE));
+    }
+    while (!done)
+    {
+      queue.Flush();
+      std::this_thread::yield();
+    }
+  });
+
+  // Drained like frames would
+  std::size_t received{0u};
+  double dragged{0.0};
+  int presses{0};
+  int releases{0};
+  bool pressed{false};
+  std::vector<InputEvent> events;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+  while (received < cycles * (movesPerCycle + 2u) &&
+      std::chrono::steady_clock::now() < deadline)
+  {
+    received += queue.Drain(events);
+    for (const auto &event : events)
+    {
+      switch (event.event.Type())
+      {
+        case common::MouseEvent::PRESS:
+          EXPECT_FALSE(pressed);
+          pressed = true;
+          ++presses;
+          break;
+        case common::MouseEvent::RELEASE:
+          EXPECT_TRUE(pressed);
+          pressed = false;
+          ++releases;
+          break;
+        default:
+          EXPECT_TRUE(pressed);
+          dragged += event.drag.X();
+          break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  done = true;
+  producer.join();
+
+  EXPECT_EQ(cycles * (movesPerCycle + 2u), received);
+  EXPECT_EQ(cycles, presses);
+  EXPECT_EQ(cycles, releases);
+  EXPECT_DOUBLE_EQ(cycles * movesPerCycle, dragged);
+}
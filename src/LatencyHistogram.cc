@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "ignition/gui/LatencyHistogram.hh"
+
+/// \brief Upper bound of the first bucket
+static const std::chrono::microseconds kFirstBucket{64};
+
+/// \brief Number of buckets, the first 17 go up to about 4.2 s
+static const std::size_t kBucketCount{18u};
+
+/// \brief Header data key holding the publication time
+static const char kPublishTimeKey[] = "publish_time";
+
+namespace ignition
+{
+  namespace gui
+  {
+    class LatencyHistogramPrivate
+    {
+      /// \brief Samples per bucket
+      public: std::vector<uint64_t> counts =
+          std::vector<uint64_t>(kBucketCount, 0u);
+
+      /// \brief Number of samples
+      public: uint64_t count{0u};
+
+      /// \brief Sum of all samples
+      public: std::chrono::steady_clock::duration total{0};
+
+      /// \brief Largest sample
+      public: std::chrono::steady_clock::duration max{0};
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+void ignition::gui::stampPublishTime(msgs::Header &_header,
+    const std::chrono::system_clock::time_point &_time)
+{
+  auto value = std::to_string(std::chrono::duration_cast<
+      std::chrono::nanoseconds>(_time.time_since_epoch()).count());
+
+  for (auto &data : *_header.mutable_data())
+  {
+    if (data.key() == kPublishTimeKey)
+    {
+      data.clear_value();
+      data.add_value(value);
+      return;
+    }
+  }
+
+  auto data = _header.add_data();
+  data->set_key(kPublishTimeKey);
+  data->add_value(value);
+}
+
+/////////////////////////////////////////////////
+bool ignition::gui::publishTime(const msgs::Header &_header,
+    std::chrono::system_clock::time_point &_time)
+{
+  for (const auto &data : _header.data())
+  {
+    if (data.key() != kPublishTimeKey || data.value_size() == 0)
+      continue;
+
+    try
+    {
+      std::size_t end{0u};
+      auto ns = std::stoll(data.value(0), &end);
+      if (end != data.value(0).size())
+        return false;
+
+      _time = std::chrono::system_clock::time_point(
+          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::nanoseconds(ns)));
+      return true;
+    }
+    catch (...)
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+LatencyHistogram::LatencyHistogram()
+  : dataPtr(new LatencyHistogramPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+LatencyHistogram::LatencyHistogram(const LatencyHistogram &_other)
+  : dataPtr(new LatencyHistogramPrivate(*_other.dataPtr))
+{
+}
+
+/////////////////////////////////////////////////
+LatencyHistogram::~LatencyHistogram()
+{
+}
+
+/////////////////////////////////////////////////
+LatencyHistogram &LatencyHistogram::operator=(const LatencyHistogram &_other)
+{
+  *this->dataPtr = *_other.dataPtr;
+  return *this;
+}
+
+/////////////////////////////////////////////////
+void LatencyHistogram::Add(const std::chrono::steady_clock::duration &_latency)
+{
+  auto latency = std::max(_latency, std::chrono::steady_clock::duration(0));
+
+  std::size_t bucket{0u};
+  while (bucket + 1 < kBucketCount &&
+      latency >= BucketUpperBound(bucket))
+  {
+    ++bucket;
+  }
+
+  ++this->dataPtr->counts[bucket];
+  ++this->dataPtr->count;
+  this->dataPtr->total += latency;
+  this->dataPtr->max = std::max(this->dataPtr->max, latency);
+}
+
+/////////////////////////////////////////////////
+uint64_t LatencyHistogram::Count() const
+{
+  return this->dataPtr->count;
+}
+
+/////////////////////////////////////////////////
+std::vector<uint64_t> LatencyHistogram::Counts() const
+{
+  return this->dataPtr->counts;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration LatencyHistogram::BucketUpperBound(
+    const std::size_t _bucket)
+{
+  if (_bucket + 1 >= kBucketCount)
+    return std::chrono::steady_clock::duration::max();
+
+  return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      kFirstBucket) * (1 << _bucket);
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration LatencyHistogram::Percentile(
+    const double _p) const
+{
+  if (this->dataPtr->count == 0u)
+    return std::chrono::steady_clock::duration::zero();
+
+  // Rank of the sample, counting from 1
+  auto rank = std::max<uint64_t>(1u, static_cast<uint64_t>(
+      std::ceil(std::clamp(_p, 0.0, 1.0) * this->dataPtr->count)));
+
+  uint64_t seen{0u};
+  for (std::size_t bucket = 0; bucket < kBucketCount; ++bucket)
+  {
+    seen += this->dataPtr->counts[bucket];
+    if (seen >= rank)
+      return std::min(BucketUpperBound(bucket), this->dataPtr->max);
+  }
+  return this->dataPtr->max;
+}
+
+/////////////////////////////////////////////////
+DurationStats LatencyHistogram::Stats() const
+{
+  auto toMs = [](const std::chrono::steady_clock::duration &_duration)
+  {
+    return std::chrono::duration<double, std::milli>(_duration).count();
+  };
+
+  DurationStats stats;
+  stats.count = this->dataPtr->count;
+  if (stats.count == 0u)
+    return stats;
+
+  stats.mean = toMs(this->dataPtr->total) / stats.count;
+  stats.p50 = toMs(this->Percentile(0.5));
+  stats.p95 = toMs(this->Percentile(0.95));
+  stats.p99 = toMs(this->Percentile(0.99));
+  stats.max = toMs(this->dataPtr->max);
+  return stats;
+}
+
+/////////////////////////////////////////////////
+void LatencyHistogram::Reset()
+{
+  *this->dataPtr = LatencyHistogramPrivate();
+}
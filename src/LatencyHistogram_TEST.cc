@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include <ignition/msgs/header.pb.h>
+
+#include "ignition/gui/LatencyHistogram.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(LatencyHistogramTest, Buckets)
+{
+  using namespace std::chrono_literals;
+
+  EXPECT_EQ(64us, LatencyHistogram::BucketUpperBound(0));
+  EXPECT_EQ(128us, LatencyHistogram::BucketUpperBound(1));
+  EXPECT_EQ(1024us, LatencyHistogram::BucketUpperBound(4));
+
+  LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.Count());
+  EXPECT_EQ(0u, histogram.Stats().count);
+  EXPECT_EQ(0ns, histogram.Percentile(0.5));
+
+  auto counts = histogram.Counts();
+  ASSERT_FALSE(counts.empty());
+  EXPECT_EQ(std::chrono::steady_clock::duration::max(),
+      LatencyHistogram::BucketUpperBound(counts.size() - 1));
+
+  histogram.Add(-5ms);
+  histogram.Add(10us);
+  histogram.Add(100us);
+  histogram.Add(1ms);
+  histogram.Add(1h);
+
+  EXPECT_EQ(5u, histogram.Count());
+  counts = histogram.Counts();
+  EXPECT_EQ(2u, counts[0]);
+  EXPECT_EQ(1u, counts[1]);
+  EXPECT_EQ(1u, counts[4]);
+  EXPECT_EQ(1u, counts.back());
+
+  // Percentiles are bucket bounds, capped by the maximum
+  EXPECT_EQ(64us, histogram.Percentile(0.2));
+  EXPECT_EQ(128us, histogram.Percentile(0.5));
+  EXPECT_EQ(1024us, histogram.Percentile(0.8));
+  EXPECT_EQ(1h, histogram.Percentile(1.0));
+
+  // Copies are independent
+  auto copy = histogram;
+  histogram.Reset();
+  EXPECT_EQ(0u, histogram.Count());
+  EXPECT_EQ(5u, copy.Count());
+}
+
+/////////////////////////////////////////////////
+TEST(LatencyHistogramTest, Stats)
+{
+  using namespace std::chrono_literals;
+
+  LatencyHistogram histogram;
+  for (int i = 0; i < 99; ++i)
+    histogram.Add(1ms);
+  histogram.Add(20ms);
+
+  auto stats = histogram.Stats();
+  EXPECT_EQ(100u, stats.count);
+  EXPECT_DOUBLE_EQ(1.19, stats.mean);
+  EXPECT_DOUBLE_EQ(1.024, stats.p50);
+  EXPECT_DOUBLE_EQ(1.024, stats.p99);
+  EXPECT_DOUBLE_EQ(20.0, stats.max);
+}
+
+/////////////////////////////////////////////////
+TEST(LatencyHistogramTest, PublishTime)
+{
+  msgs::Header header;
+  std::chrono::system_clock::time_point time;
+  EXPECT_FALSE(publishTime(header, time));
+
+  auto now = std::chrono::system_clock::now();
+  stampPublishTime(header, now);
+  ASSERT_TRUE(publishTime(header, time));
+  EXPECT_EQ(now, time);
+
+  // Stamping again replaces the entry
+  stampPublishTime(header, now + std::chrono::seconds(1));
+  EXPECT_EQ(1, header.data_size());
+  ASSERT_TRUE(publishTime(header, time));
+  EXPECT_EQ(now + std::chrono::seconds(1), time);
+
+  header.mutable_data(0)->set_value(0, "banana");
+  EXPECT_FALSE(publishTime(header, time));
+}
@@ -0,0 +1,588 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gui/LogSink.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief Maximum number of UTF-8 bytes in a record
+    static constexpr std::size_t kRecordBytes = 496;
+
+    /// \brief Number of records in each thread's ring
+    static constexpr std::size_t kRingSize = 256;
+
+    /// \brief A message waiting in a ring
+    struct LogRecord
+    {
+      /// \brief Severity
+      LogLevel level{LogLevel::kInfo};
+
+      /// \brief When the message was logged
+      std::chrono::system_clock::time_point time;
+
+      /// \brief Number of bytes used in text
+      std::size_t length{0u};
+
+      /// \brief UTF-8 text, not null-terminated
+      char text[kRecordBytes];
+    };
+
+    /// \brief Single-producer single-consumer ring owned by one logging
+    /// thread and drained by the writer
+    struct LogRing
+    {
+      /// \brief Records
+      std::array<LogRecord, kRingSize> records;
+
+      /// \brief Index of the next record to be written, only changed by
+      /// the producer
+      std::atomic<std::size_t> head{0u};
+
+      /// \brief Index of the next record to be read, only changed by the
+      /// writer
+      std::atomic<std::size_t> tail{0u};
+
+      /// \brief Set when the producing thread exits
+      std::atomic<bool> orphaned{false};
+    };
+
+    /// \brief Ring of the current thread
+    struct ThreadRing
+    {
+      /// \brief Destructor, lets the writer drop the ring once drained
+      ~ThreadRing()
+      {
+        if (this->ring)
+          this->ring->orphaned = true;
+      }
+
+      /// \brief Identifier of the sink the ring belongs to
+      uint64_t sinkId{0u};
+
+      /// \brief The ring, shared with the sink
+      std::shared_ptr<LogRing> ring;
+    };
+
+    /// \brief State of a message which may be repeated
+    struct Repeat
+    {
+      /// \brief When the message was last written
+      std::chrono::steady_clock::time_point written;
+
+      /// \brief Severity
+      LogLevel level{LogLevel::kInfo};
+
+      /// \brief Repetitions since it was last written
+      uint64_t count{0u};
+    };
+
+    class LogSinkPrivate
+    {
+      /// \brief Writer thread loop
+      public: void Run();
+
+      /// \brief Get the current thread's ring, creating it if needed
+      /// \return The ring
+      public: LogRing &Ring();
+
+      /// \brief Write all queued records
+      public: void Drain();
+
+      /// \brief Write a message, or count it if it's a repetition
+      /// \param[in] _entry Message, its sequence number is assigned here
+      public: void Write(LogEntry &&_entry);
+
+      /// \brief Print and store a message
+      /// \param[in] _entry Message
+      public: void Emit(LogEntry &&_entry);
+
+      /// \brief Report repetitions whose window expired
+      /// \param[in] _all True to report all of them, such as on shutdown
+      public: void SweepRepeats(const bool _all);
+
+      /// \brief Unique identifier, used to tell apart rings of sinks which
+      /// have been destroyed
+      public: uint64_t id{0u};
+
+      /// \brief Rings of all threads which logged
+      public: std::vector<std::shared_ptr<LogRing>> rings;
+
+      /// \brief Protects rings
+      public: std::mutex ringsMutex;
+
+      /// \brief Writer thread
+      public: std::thread writer;
+
+      /// \brief Protects stop and the flush counters
+      public: std::mutex writerMutex;
+
+      /// \brief Wakes up the writer
+      public: std::condition_variable writerCv;
+
+      /// \brief Notified after each writer pass
+      public: std::condition_variable flushedCv;
+
+      /// \brief Set to true to stop the writer
+      public: bool stop{false};
+
+      /// \brief Number of flushes requested
+      public: uint64_t flushRequests{0u};
+
+      /// \brief Number of flushes completed
+      public: uint64_t flushesDone{0u};
+
+      /// \brief Messages kept in memory, only changed by the writer
+      public: std::deque<LogEntry> history;
+
+      /// \brief Maximum size of history
+      public: std::size_t historySize{1000u};
+
+      /// \brief Protects history and historySize
+      public: mutable std::mutex historyMutex;
+
+      /// \brief Sequence number of the latest message
+      public: uint64_t seq{0u};
+
+      /// \brief Recently written messages, keyed by text, only used by the
+      /// writer
+      public: std::unordered_map<std::string, Repeat> repeats;
+
+      /// \brief Window within which repetitions are collapsed, in
+      /// milliseconds
+      public: std::atomic<int64_t> repeatWindow{1000};
+
+      /// \brief Whether to print to the console
+      public: std::atomic<bool> echo{true};
+
+      /// \brief Number of dropped messages
+      public: std::atomic<uint64_t> dropped{0u};
+
+      /// \brief Number of collapsed repetitions
+      public: std::atomic<uint64_t> repeated{0u};
+    };
+
+    /// \brief Ring of the current thread
+    static thread_local ThreadRing tlRing;
+
+    /// \brief Next sink identifier
+    static std::atomic<uint64_t> gNextSinkId{1u};
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Copy null-terminated UTF-8 into a record
+/// \param[in] _text Text, may be null.
+/// \param[in, out] _record Record to append to.
+static void append(const char *_text, LogRecord &_record)
+{
+  if (nullptr == _text)
+    return;
+
+  auto length = std::min(std::strlen(_text), kRecordBytes - _record.length);
+  std::memcpy(_record.text + _record.length, _text, length);
+  _record.length += length;
+}
+
+/////////////////////////////////////////////////
+/// \brief Encode UTF-16 as UTF-8 into a record. Stops at the first code
+/// point which doesn't fit.
+/// \param[in] _text UTF-16 text.
+/// \param[in] _length Number of code units.
+/// \param[in, out] _record Record to append to.
+static void append(const char16_t *_text, const std::size_t _length,
+    LogRecord &_record)
+{
+  auto out = _record.text + _record.length;
+  auto end = _record.text + kRecordBytes;
+
+  for (std::size_t i = 0; i < _length; ++i)
+  {
+    char32_t c = _text[i];
+
+    // Surrogate pair
+    if (c >= 0xD800 && c < 0xDC00 && i + 1 < _length &&
+        _text[i + 1] >= 0xDC00 && _text[i + 1] < 0xE000)
+    {
+      c = 0x10000 + ((c - 0xD800) << 10) + (_text[i + 1] - 0xDC00);
+      ++i;
+    }
+
+    if (c < 0x80)
+    {
+      if (end - out < 1)
+        break;
+      *out++ = static_cast<char>(c);
+    }
+    else if (c < 0x800)
+    {
+      if (end - out < 2)
+        break;
+      *out++ = static_cast<char>(0xC0 | (c >> 6));
+      *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    }
+    else if (c < 0x10000)
+    {
+      if (end - out < 3)
+        break;
+      *out++ = static_cast<char>(0xE0 | (c >> 12));
+      *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+      *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    }
+    else
+    {
+      if (end - out < 4)
+        break;
+      *out++ = static_cast<char>(0xF0 | (c >> 18));
+      *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+      *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+      *out++ = static_cast<char>(0x80 | (c & 0x3F));
+    }
+  }
+
+  _record.length = out - _record.text;
+}
+
+/////////////////////////////////////////////////
+LogSink::LogSink()
+  : dataPtr(new LogSinkPrivate)
+{
+  this->dataPtr->id = gNextSinkId++;
+  this->dataPtr->writer = std::thread(&LogSinkPrivate::Run,
+      this->dataPtr.get());
+}
+
+/////////////////////////////////////////////////
+LogSink::~LogSink()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->writerMutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->writerCv.notify_all();
+
+  if (this->dataPtr->writer.joinable())
+    this->dataPtr->writer.join();
+}
+
+/////////////////////////////////////////////////
+void LogSink::Log(const LogLevel _level, const char *_text,
+    const std::size_t _length)
+{
+  auto &ring = this->dataPtr->Ring();
+
+  auto head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= kRingSize)
+  {
+    ++this->dataPtr->dropped;
+    return;
+  }
+
+  auto &record = ring.records[head % kRingSize];
+  record.level = _level;
+  record.time = std::chrono::system_clock::now();
+  record.length = std::min(_length, kRecordBytes);
+  std::memcpy(record.text, _text, record.length);
+
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+void LogSink::Log(const LogLevel _level, const char *_prefix,
+    const char16_t *_text, const std::size_t _length, const char *_context)
+{
+  auto &ring = this->dataPtr->Ring();
+
+  auto head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= kRingSize)
+  {
+    ++this->dataPtr->dropped;
+    return;
+  }
+
+  auto &record = ring.records[head % kRingSize];
+  record.level = _level;
+  record.time = std::chrono::system_clock::now();
+  record.length = 0u;
+  append(_prefix, record);
+  append(_text, _length, record);
+  if (_context)
+  {
+    append("(", record);
+    append(_context, record);
+    append(")", record);
+  }
+
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+void LogSink::Flush()
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->writerMutex);
+  auto ticket = ++this->dataPtr->flushRequests;
+  this->dataPtr->writerCv.notify_all();
+
+  this->dataPtr->flushedCv.wait(lock, [this, ticket]
+  {
+    return this->dataPtr->flushesDone >= ticket || this->dataPtr->stop;
+  });
+}
+
+/////////////////////////////////////////////////
+std::vector<LogEntry> LogSink::Entries(const uint64_t _after) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->historyMutex);
+
+  // Entries are sorted by sequence number
+  auto it = std::upper_bound(this->dataPtr->history.begin(),
+      this->dataPtr->history.end(), _after,
+      [](const uint64_t _seq, const LogEntry &_entry)
+      {
+        return _seq < _entry.seq;
+      });
+
+  return std::vector<LogEntry>(it, this->dataPtr->history.end());
+}
+
+/////////////////////////////////////////////////
+void LogSink::SetHistorySize(const std::size_t _size)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->historyMutex);
+  this->dataPtr->historySize = _size;
+  while (this->dataPtr->history.size() > _size)
+    this->dataPtr->history.pop_front();
+}
+
+/////////////////////////////////////////////////
+void LogSink::SetRepeatWindow(const std::chrono::milliseconds &_window)
+{
+  this->dataPtr->repeatWindow = _window.count();
+}
+
+/////////////////////////////////////////////////
+void LogSink::SetEcho(const bool _echo)
+{
+  this->dataPtr->echo = _echo;
+}
+
+/////////////////////////////////////////////////
+uint64_t LogSink::DroppedCount() const
+{
+  return this->dataPtr->dropped;
+}
+
+/////////////////////////////////////////////////
+uint64_t LogSink::RepeatedCount() const
+{
+  return this->dataPtr->repeated;
+}
+
+/////////////////////////////////////////////////
+LogRing &LogSinkPrivate::Ring()
+{
+  // Only the first message of each thread allocates
+  if (tlRing.sinkId != this->id)
+  {
+    if (tlRing.ring)
+      tlRing.ring->orphaned = true;
+
+    tlRing.ring = std::make_shared<LogRing>();
+    tlRing.sinkId = this->id;
+
+    std::lock_guard<std::mutex> lock(this->ringsMutex);
+    this->rings.push_back(tlRing.ring);
+  }
+  return *tlRing.ring;
+}
+
+/////////////////////////////////////////////////
+void LogSinkPrivate::Run()
+{
+  std::unique_lock<std::mutex> lock(this->writerMutex);
+  while (!this->stop)
+  {
+    // Producers never wake the writer up, so that logging stays cheap
+    this->writerCv.wait_for(lock, std::chrono::milliseconds(10), [this]
+    {
+      return this->stop || this->flushRequests != this->flushesDone;
+    });
+
+    auto requests = this->flushRequests;
+    lock.unlock();
+
+    this->Drain();
+    this->SweepRepeats(false);
+
+    lock.lock();
+    this->flushesDone = requests;
+    this->flushedCv.notify_all();
+  }
+  lock.unlock();
+
+  this->Drain();
+  this->SweepRepeats(true);
+  this->flushedCv.notify_all();
+}
+
+/////////////////////////////////////////////////
+void LogSinkPrivate::Drain()
+{
+  std::vector<std::shared_ptr<LogRing>> current;
+  {
+    std::lock_guard<std::mutex> lock(this->ringsMutex);
+    current = this->rings;
+  }
+
+  std::vector<LogEntry> batch;
+  for (auto &ring : current)
+  {
+    // Read orphaned before head, so an orphaned ring is only removed after
+    // its last record has been read
+    auto orphaned = ring->orphaned.load();
+    auto head = ring->head.load(std::memory_order_acquire);
+    auto tail = ring->tail.load(std::memory_order_relaxed);
+    for (; tail != head; ++tail)
+    {
+      const auto &record = ring->records[tail % kRingSize];
+
+      LogEntry entry;
+      entry.level = record.level;
+      entry.time = record.time;
+      entry.text.assign(record.text, record.length);
+      batch.push_back(std::move(entry));
+    }
+    ring->tail.store(tail, std::memory_order_release);
+
+    if (orphaned)
+    {
+      std::lock_guard<std::mutex> lock(this->ringsMutex);
+      this->rings.erase(std::remove(this->rings.begin(), this->rings.end(),
+          ring), this->rings.end());
+    }
+  }
+
+  // Interleave threads in the order messages were logged
+  std::stable_sort(batch.begin(), batch.end(),
+      [](const LogEntry &_a, const LogEntry &_b)
+      {
+        return _a.time < _b.time;
+      });
+
+  for (auto &entry : batch)
+    this->Write(std::move(entry));
+}
+
+/////////////////////////////////////////////////
+void LogSinkPrivate::Write(LogEntry &&_entry)
+{
+  auto window = std::chrono::milliseconds(this->repeatWindow.load());
+  if (window.count() > 0)
+  {
+    auto now = std::chrono::steady_clock::now();
+    auto key = std::to_string(static_cast<int>(_entry.level)) + _entry.text;
+    auto it = this->repeats.find(key);
+    if (it != this->repeats.end() && now - it->second.written < window)
+    {
+      ++it->second.count;
+      ++this->repeated;
+      return;
+    }
+
+    // Don't let a flood of distinct messages grow the map indefinitely
+    if (this->repeats.size() > 1000u)
+      this->SweepRepeats(true);
+
+    this->repeats[key] = {now, _entry.level, 0u};
+  }
+
+  this->Emit(std::move(_entry));
+}
+
+/////////////////////////////////////////////////
+void LogSinkPrivate::Emit(LogEntry &&_entry)
+{
+  if (this->echo)
+  {
+    switch (_entry.level)
+    {
+      case LogLevel::kDebug:
+        igndbg << _entry.text << std::endl;
+        break;
+      case LogLevel::kInfo:
+        ignmsg << _entry.text << std::endl;
+        break;
+      case LogLevel::kWarning:
+        ignwarn << _entry.text << std::endl;
+        break;
+      case LogLevel::kError:
+      default:
+        ignerr << _entry.text << std::endl;
+        break;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(this->historyMutex);
+  _entry.seq = ++this->seq;
+  this->history.push_back(std::move(_entry));
+  while (this->history.size() > this->historySize)
+    this->history.pop_front();
+}
+
+/////////////////////////////////////////////////
+void LogSinkPrivate::SweepRepeats(const bool _all)
+{
+  auto now = std::chrono::steady_clock::now();
+  auto window = std::chrono::milliseconds(this->repeatWindow.load());
+
+  for (auto it = this->repeats.begin(); it != this->repeats.end();)
+  {
+    if (!_all && now - it->second.written < window)
+    {
+      ++it;
+      continue;
+    }
+
+    if (it->second.count > 0u)
+    {
+      LogEntry entry;
+      entry.level = it->second.level;
+      entry.time = std::chrono::system_clock::now();
+      entry.text = "Previous message repeated [" +
+          std::to_string(it->second.count) + "] times: " +
+          it->first.substr(1);
+      this->Emit(std::move(entry));
+    }
+    it = this->repeats.erase(it);
+  }
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/LogSink.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Log a null-terminated UTF-8 string
+void log(LogSink &_sink, const LogLevel _level, const char *_text)
+{
+  _sink.Log(_level, _text, std::strlen(_text));
+}
+
+/////////////////////////////////////////////////
+TEST(LogSinkTest, Entries)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  LogSink sink;
+  sink.SetEcho(false);
+
+  EXPECT_TRUE(sink.Entries().empty());
+
+  log(sink, LogLevel::kInfo, "first");
+  log(sink, LogLevel::kWarning, "second");
+  sink.Flush();
+
+  auto entries = sink.Entries();
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ("first", entries[0].text);
+  EXPECT_EQ(LogLevel::kInfo, entries[0].level);
+  EXPECT_EQ("second", entries[1].text);
+  EXPECT_EQ(LogLevel::kWarning, entries[1].level);
+  EXPECT_LT(entries[0].seq, entries[1].seq);
+
+  // Only new entries
+  log(sink, LogLevel::kError, "third");
+  sink.Flush();
+
+  entries = sink.Entries(entries[1].seq);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ("third", entries[0].text);
+
+  // History size
+  sink.SetHistorySize(2u);
+  entries = sink.Entries();
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ("second", entries[0].text);
+}
+
+/////////////////////////////////////////////////
+TEST(LogSinkTest, Utf16)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  LogSink sink;
+  sink.SetEcho(false);
+
+  std::u16string text = u"café 日本 \U0001F600";
+  sink.Log(LogLevel::kInfo, "[QT] ", text.data(), text.size(), "main");
+  sink.Flush();
+
+  auto entries = sink.Entries();
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_EQ(u8"[QT] café 日本 \U0001F600(main)",
+      entries[0].text);
+
+  // Long messages are truncated
+  std::string longText(10000, 'a');
+  log(sink, LogLevel::kInfo, longText.c_str());
+  sink.Flush();
+
+  entries = sink.Entries(entries[0].seq);
+  ASSERT_EQ(1u, entries.size());
+  EXPECT_LT(entries[0].text.size(), longText.size());
+  EXPECT_GT(entries[0].text.size(), 0u);
+}
+
+/////////////////////////////////////////////////
+TEST(LogSinkTest, Repeats)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  LogSink sink;
+  sink.SetEcho(false);
+  sink.SetRepeatWindow(std::chrono::milliseconds(100));
+
+  for (int i = 0; i < 50; ++i)
+    log(sink, LogLevel::kWarning, "binding loop");
+  log(sink, LogLevel::kWarning, "other");
+  sink.Flush();
+
+  auto entries = sink.Entries();
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_EQ("binding loop", entries[0].text);
+  EXPECT_EQ("other", entries[1].text);
+  EXPECT_EQ(49u, sink.RepeatedCount());
+
+  // The repetitions are reported once the window expires
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+  sink.Flush();
+
+  entries = sink.Entries();
+  ASSERT_EQ(3u, entries.size());
+  EXPECT_EQ("Previous message repeated [49] times: binding loop",
+      entries[2].text);
+  EXPECT_EQ(LogLevel::kWarning, entries[2].level);
+
+  // Disabled
+  sink.SetRepeatWindow(std::chrono::milliseconds(0));
+  log(sink, LogLevel::kWarning, "binding loop");
+  log(sink, LogLevel::kWarning, "binding loop");
+  sink.Flush();
+  EXPECT_EQ(5u, sink.Entries().size());
+}
+
+/////////////////////////////////////////////////
+TEST(LogSinkTest, Threads)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  LogSink sink;
+  sink.SetEcho(false);
+  sink.SetRepeatWindow(std::chrono::milliseconds(0));
+  sink.SetHistorySize(10000u);
+
+  const int threadCount = 4;
+  const int msgCount = 200;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&sink, t, msgCount]()
+    {
+      for (int i = 0; i < msgCount; ++i)
+      {
+        auto text = std::to_string(t) + ":" + std::to_string(i);
+        sink.Log(LogLevel::kInfo, text.c_str(), text.size());
+
+        // Give the writer a chance so the rings don't fill up
+        if (i % 50 == 0)
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+  sink.Flush();
+
+  EXPECT_EQ(static_cast<size_t>(threadCount * msgCount),
+      sink.Entries().size() + sink.DroppedCount());
+
+  // Each thread's messages are in order
+  std::vector<int> last(threadCount, -1);
+  for (const auto &entry : sink.Entries())
+  {
+    auto colon = entry.text.find(':');
+    ASSERT_NE(std::string::npos, colon);
+    auto t = std::stoi(entry.text.substr(0, colon));
+    auto i = std::stoi(entry.text.substr(colon + 1));
+    EXPECT_GT(i, last[t]);
+    last[t] = i;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(LogSinkTest, Full)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  LogSink sink;
+  sink.SetEcho(false);
+  sink.SetRepeatWindow(std::chrono::milliseconds(0));
+  sink.SetHistorySize(10000u);
+
+  // Messages which don't fit in the ring before the writer wakes up are
+  // dropped, never blocked on
+  for (int i = 0; i < 5000; ++i)
+    log(sink, LogLevel::kDebug, "flood");
+  sink.Flush();
+
+  EXPECT_EQ(5000u, sink.Entries().size() + sink.DroppedCount());
+  EXPECT_GT(sink.DroppedCount(), 0u);
+}
@@ -15,13 +15,21 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
+#include <utility>
 
 #include <ignition/common/Console.hh>
 #include "ignition/gui/Application.hh"
+#include "ignition/gui/config.hh"
 #include "ignition/gui/Helpers.hh"
 #include "ignition/gui/MainWindow.hh"
 #include "ignition/gui/Plugin.hh"
+#include "ignition/gui/SharedRing.hh"
 
 /// \brief Used to store information about anchors set by the user.
 struct Anchors
@@ -78,6 +86,78 @@ class ignition::gui::PluginPrivate
 
   /// \brief Holds all anchor information
   public: Anchors anchors;
+
+  /// \brief Maximum message rate for topics which don't have a specific rate,
+  /// zero means unlimited.
+  public: uint64_t maxRate{0u};
+
+  /// \brief Maximum message rate per topic, zero means unlimited.
+  public: std::map<std::string, uint64_t> topicMaxRates;
+
+  /// \brief True while the plugin is suspended.
+  public: bool suspended{false};
+
+  /// \brief Connection to the visibility of the card's current window.
+  public: QMetaObject::Connection windowConnection;
+
+  /// \brief Protects memory, memoryBudget and overBudget.
+  public: mutable std::mutex memoryMutex;
+
+  /// \brief Memory reported per category, in bytes.
+  public: std::map<std::string, uint64_t> memory;
+
+  /// \brief Memory budget in bytes, zero means no budget.
+  public: uint64_t memoryBudget{0u};
+
+  /// \brief True while the reported memory is over budget.
+  public: bool overBudget{false};
+
+  /// \brief Protects latencies.
+  public: mutable std::mutex latencyMutex;
+
+  /// \brief Latency histograms per stage.
+  public: std::map<std::string, LatencyHistogram> latencies;
+
+  /// \brief Plugin filename, used in messages before the title is known.
+  public: std::string filename;
+
+  /// \brief True if the plugin's work should run in a helper process.
+  public: bool separateProcess{false};
+
+  /// \brief Number of slots in the ring shared with the helper.
+  public: unsigned int slotCount{3u};
+
+  /// \brief Size of each slot in the ring shared with the helper, in
+  /// megabytes.
+  public: unsigned int slotSize{8u};
+
+  /// \brief Key of the proxy's ring, only set on helpers.
+  public: std::string helperKey;
+
+  /// \brief Ring shared by a proxy and its helper.
+  public: std::unique_ptr<SharedRing> ring;
+
+  /// \brief Helper process, only set on proxies.
+  public: QProcess *helper{nullptr};
+
+  /// \brief Waits for the helper to write to the ring, only on proxies.
+  public: std::thread ringReader;
+
+  /// \brief Set to true to stop ringReader.
+  public: std::atomic<bool> stopReader{false};
+
+  /// \brief True while a read of the ring is queued on the GUI thread.
+  public: std::atomic<bool> readQueued{false};
+
+  /// \brief Protects requests.
+  public: std::mutex requestsMutex;
+
+  /// \brief Requests made through Plugin::Request, cancelled on removal.
+  public: std::vector<std::weak_ptr<RequestStateBase>> requests;
+
+  /// \brief Set once Plugin::Shutdown has been called, after which no new
+  /// background work or GUI calls are accepted.
+  public: std::atomic<bool> shutDown{false};
 };
 
 using namespace ignition;
@@ -91,9 +171,43 @@ Plugin::Plugin() : dataPtr(new PluginPrivate)
 /////////////////////////////////////////////////
 Plugin::~Plugin()
 {
+  // In case the plugin wasn't removed through the application, although by
+  // now the derived class' members are gone
+  this->Shutdown();
+
   delete this->dataPtr->pluginItem;
 }
 
+/////////////////////////////////////////////////
+void Plugin::Shutdown()
+{
+  if (this->dataPtr->shutDown.exchange(true))
+    return;
+
+  // Requests first, so they don't queue more work. Cancelling waits for
+  // running continuations, which may make requests of their own.
+  std::vector<std::weak_ptr<RequestStateBase>> requests;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->requestsMutex);
+    std::swap(requests, this->dataPtr->requests);
+  }
+  for (auto &weak : requests)
+  {
+    if (auto state = weak.lock())
+      state->Cancel();
+  }
+
+  if (App() && App()->Workers())
+    App()->Workers()->Cancel(this);
+
+  this->StopHelper();
+
+  // Once the workers and the helper reader, which may still post calls,
+  // have stopped
+  if (App() && App()->Dispatcher())
+    App()->Dispatcher()->Cancel(this);
+}
+
 /////////////////////////////////////////////////
 void Plugin::Load(const tinyxml2::XMLElement *_pluginElem)
 {
@@ -118,6 +232,7 @@ void Plugin::Load(const tinyxml2::XMLElement *_pluginElem)
 
   // Qml file
   std::string filename = _pluginElem->Attribute("filename");
+  this->dataPtr->filename = filename;
 
   // This let's <filename>.qml use <pluginclass> functions and properties
   this->dataPtr->context = new QQmlContext(App()->Engine()->rootContext());
@@ -143,6 +258,15 @@ void Plugin::Load(const tinyxml2::XMLElement *_pluginElem)
   // Load common configuration
   this->LoadCommonConfig(_pluginElem->FirstChildElement("ignition-gui"));
 
+  // Move the plugin's work to a helper process
+  if (this->dataPtr->separateProcess)
+  {
+    if (this->dataPtr->helperKey.empty())
+      this->StartHelper();
+    else
+      this->AttachToProxy();
+  }
+
   // Load custom configuration
   this->LoadConfig(_pluginElem);
 }
@@ -217,6 +341,59 @@ void Plugin::LoadCommonConfig(const tinyxml2::XMLElement *_ignGuiElem)
     this->dataPtr->cardProperties[key] = variant;
   }
 
+  // Maximum subscription rates
+  for (auto rateElem = _ignGuiElem->FirstChildElement("max_rate");
+      rateElem != nullptr;
+      rateElem = rateElem->NextSiblingElement("max_rate"))
+  {
+    // Parsed as signed, since unsigned parsing wraps negative values around
+    int64_t rate{0};
+    if (rateElem->QueryInt64Text(&rate) != tinyxml2::XML_SUCCESS || rate < 0)
+    {
+      ignwarn << "Invalid <max_rate> for plugin [" << this->title
+              << "], rate must be a non-negative integer." << std::endl;
+      continue;
+    }
+
+    auto topic = rateElem->Attribute("topic");
+    if (nullptr == topic)
+      this->dataPtr->maxRate = rate;
+    else
+      this->dataPtr->topicMaxRates[topic] = rate;
+  }
+
+  // Memory budget
+  if (auto budgetElem = _ignGuiElem->FirstChildElement("memory_budget"))
+  {
+    // Parsed as signed, since unsigned parsing wraps negative values around
+    int64_t budget{0};
+    if (budgetElem->QueryInt64Text(&budget) != tinyxml2::XML_SUCCESS ||
+        budget < 0)
+    {
+      ignwarn << "Invalid <memory_budget> for plugin [" << this->title
+              << "], budget must be a non-negative integer number of "
+              << "megabytes." << std::endl;
+    }
+    else
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->memoryMutex);
+      this->dataPtr->memoryBudget = static_cast<uint64_t>(budget) << 20;
+    }
+  }
+
+  // Separate process
+  if (auto processElem = _ignGuiElem->FirstChildElement("separate_process"))
+  {
+    processElem->QueryBoolText(&this->dataPtr->separateProcess);
+    processElem->QueryUnsignedAttribute("slots", &this->dataPtr->slotCount);
+    processElem->QueryUnsignedAttribute("slot_size",
+        &this->dataPtr->slotSize);
+
+    // Only set by the proxy when starting a helper
+    if (auto key = processElem->Attribute("helper_key"))
+      this->dataPtr->helperKey = key;
+  }
+
   // Anchors
   if (auto anchorElem = _ignGuiElem->FirstChildElement("anchors"))
   {
@@ -365,6 +542,208 @@ bool Plugin::DeleteLaterRequested() const
   return this->dataPtr->deleteLaterRequested;
 }
 
+/////////////////////////////////////////////////
+uint64_t Plugin::MaxRate(const std::string &_topic) const
+{
+  auto it = this->dataPtr->topicMaxRates.find(_topic);
+  if (it != this->dataPtr->topicMaxRates.end())
+    return it->second;
+
+  return this->dataPtr->maxRate;
+}
+
+/////////////////////////////////////////////////
+transport::SubscribeOptions Plugin::SubscribeOptions(
+    const std::string &_topic) const
+{
+  transport::SubscribeOptions opts;
+
+  auto rate = this->MaxRate(_topic);
+  if (rate > 0u)
+    opts.SetMsgsPerSec(rate);
+
+  return opts;
+}
+
+/////////////////////////////////////////////////
+void Plugin::RunInBackground(std::function<void()> _task,
+    std::function<void()> _onGuiThread, const TaskPriority _priority)
+{
+  if (!_task || this->dataPtr->shutDown)
+    return;
+
+  auto lane = _priority == TaskPriority::kHigh ? DeliveryLane::kControl :
+      DeliveryLane::kBulk;
+
+  auto workers = App() ? App()->Workers() : nullptr;
+  if (!workers)
+  {
+    ignwarn << "No worker pool available, running task for plugin ["
+            << this->title << "] on the calling thread." << std::endl;
+    _task();
+
+    // Still queued, since callers may be holding locks the continuation
+    // needs, or not be on the GUI thread at all
+    if (_onGuiThread)
+      this->PostToGuiThread(_onGuiThread, lane);
+    return;
+  }
+
+  workers->Post([this, _task, _onGuiThread, lane]()
+  {
+    _task();
+
+    // The plugin is alive while its tasks run, and the continuation is
+    // cancelled if it's removed before it runs.
+    if (_onGuiThread)
+      this->PostToGuiThread(_onGuiThread, lane);
+  }, _priority, this);
+}
+
+/////////////////////////////////////////////////
+void Plugin::PostToGuiThread(std::function<void()> _func,
+    const DeliveryLane _lane, const std::string &_key)
+{
+  if (!_func || this->dataPtr->shutDown)
+    return;
+
+  auto dispatcher = App() ? App()->Dispatcher() : nullptr;
+  if (!dispatcher)
+  {
+    // Qt drops queued calls whose context object has been destroyed
+    QMetaObject::invokeMethod(this, _func, Qt::QueuedConnection);
+    return;
+  }
+
+  dispatcher->Post(this, std::move(_func), _lane, _key);
+}
+
+/////////////////////////////////////////////////
+void Plugin::TrackRequest(const std::shared_ptr<RequestStateBase> &_state)
+{
+  if (!_state)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->requestsMutex);
+    if (!this->dataPtr->shutDown)
+    {
+      // Forget requests which have finished, so the list doesn't grow
+      auto &requests = this->dataPtr->requests;
+      requests.erase(std::remove_if(requests.begin(), requests.end(),
+          [](const std::weak_ptr<RequestStateBase> &_weak)
+          {
+            auto state = _weak.lock();
+            return !state || state->Status() != RequestStatus::kPending;
+          }), requests.end());
+
+      requests.push_back(_state);
+      return;
+    }
+  }
+
+  // Made by a continuation while shutting down
+  _state->Cancel();
+}
+
+/////////////////////////////////////////////////
+uint64_t Plugin::MemoryUsage() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->memoryMutex);
+
+  uint64_t total{0u};
+  for (const auto &category : this->dataPtr->memory)
+    total += category.second;
+  return total;
+}
+
+/////////////////////////////////////////////////
+std::map<std::string, uint64_t> Plugin::MemoryUsageByCategory() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->memoryMutex);
+  return this->dataPtr->memory;
+}
+
+/////////////////////////////////////////////////
+uint64_t Plugin::MemoryBudget() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->memoryMutex);
+  return this->dataPtr->memoryBudget;
+}
+
+/////////////////////////////////////////////////
+std::map<std::string, LatencyHistogram> Plugin::Latencies() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->latencyMutex);
+  return this->dataPtr->latencies;
+}
+
+/////////////////////////////////////////////////
+void Plugin::ResetLatencies()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->latencyMutex);
+  this->dataPtr->latencies.clear();
+}
+
+/////////////////////////////////////////////////
+void Plugin::RecordLatency(const std::string &_stage,
+    const std::chrono::steady_clock::duration &_latency)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->latencyMutex);
+  this->dataPtr->latencies[_stage].Add(_latency);
+}
+
+/////////////////////////////////////////////////
+unsigned int Plugin::QmlObjectCount() const
+{
+  // The card holds the plugin item, but cards aren't created until the
+  // plugin is added to a window
+  auto root = this->dataPtr->cardItem ? this->dataPtr->cardItem :
+      this->dataPtr->pluginItem;
+  if (!root)
+    return 0u;
+
+  return 1u + root->findChildren<QObject *>().size();
+}
+
+/////////////////////////////////////////////////
+void Plugin::SetMemoryUsage(const std::string &_category,
+    const uint64_t _bytes)
+{
+  uint64_t total{0u};
+  uint64_t budget{0u};
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->memoryMutex);
+    if (_bytes == 0u)
+      this->dataPtr->memory.erase(_category);
+    else
+      this->dataPtr->memory[_category] = _bytes;
+
+    budget = this->dataPtr->memoryBudget;
+    if (budget == 0u)
+      return;
+
+    for (const auto &category : this->dataPtr->memory)
+      total += category.second;
+
+    // Only ask to shrink when crossing the budget, not on every update
+    bool over = total > budget;
+    bool crossed = over && !this->dataPtr->overBudget;
+    this->dataPtr->overBudget = over;
+    if (!crossed)
+      return;
+  }
+
+  ignwarn << "Plugin [" << this->title << "] is using [" << (total >> 20)
+          << "] MB, which is over its budget of [" << (budget >> 20)
+          << "] MB. Asking it to shrink." << std::endl;
+
+  QMetaObject::invokeMethod(this, [this, budget]()
+  {
+    this->ShrinkMemory(budget);
+  }, Qt::QueuedConnection);
+}
+
 /////////////////////////////////////////////////
 QQuickItem *Plugin::PluginItem() const
 {
@@ -444,6 +823,21 @@ QQuickItem *Plugin::CardItem() const
 
   this->dataPtr->cardItem = cardItem;
 
+  // Suspend while the card can't be seen
+  this->connect(cardItem, &QQuickItem::visibleChanged, this,
+      &Plugin::UpdateSuspended);
+  this->connect(cardItem, &QQuickItem::widthChanged, this,
+      &Plugin::UpdateSuspended);
+  this->connect(cardItem, &QQuickItem::heightChanged, this,
+      &Plugin::UpdateSuspended);
+  this->connect(cardItem, &QQuickItem::windowChanged, this,
+      &Plugin::OnCardWindowChanged);
+  if (App())
+  {
+    this->connect(App(), &Application::WindowExposureChanged, this,
+        &Plugin::UpdateSuspended);
+  }
+
   return cardItem;
 }
 
@@ -550,3 +944,330 @@ void Plugin::ApplyAnchors()
   this->CardItem()->setProperty("anchored", true);
 }
 
+
+/////////////////////////////////////////////////
+bool Plugin::Suspended() const
+{
+  return this->dataPtr->suspended;
+}
+
+/////////////////////////////////////////////////
+void Plugin::OnCardWindowChanged(QQuickWindow *_window)
+{
+  this->disconnect(this->dataPtr->windowConnection);
+
+  if (_window)
+  {
+    this->dataPtr->windowConnection = this->connect(_window,
+        &QWindow::visibilityChanged, this, &Plugin::UpdateSuspended);
+  }
+
+  this->UpdateSuspended();
+}
+
+/////////////////////////////////////////////////
+void Plugin::UpdateSuspended()
+{
+  auto cardItem = this->dataPtr->cardItem;
+  if (!cardItem)
+    return;
+
+  // Cards are only suspended once they've been added to a window, and are
+  // about to be deleted when they're taken out of it.
+  auto window = cardItem->window();
+  if (!window)
+    return;
+
+  bool suspend = !cardItem->isVisible() ||
+      cardItem->width() <= 0 || cardItem->height() <= 0 ||
+      window->visibility() == QWindow::Hidden ||
+      window->visibility() == QWindow::Minimized ||
+      !window->isExposed();
+
+  this->SetSuspended(suspend);
+}
+
+/////////////////////////////////////////////////
+void Plugin::SetSuspended(const bool _suspend)
+{
+  if (_suspend == this->dataPtr->suspended)
+    return;
+
+  this->dataPtr->suspended = _suspend;
+
+  igndbg << (_suspend ? "Suspending" : "Resuming") << " plugin ["
+         << this->Title() << "]" << std::endl;
+
+  // The helper does the work which can be paused
+  if (this->dataPtr->helper)
+    this->dataPtr->helper->write(_suspend ? "suspend\n" : "resume\n");
+
+  if (_suspend)
+    this->Suspend();
+  else
+    this->Resume();
+
+  this->SuspendedChanged();
+}
+
+/////////////////////////////////////////////////
+bool Plugin::IsProxy() const
+{
+  return nullptr != this->dataPtr->helper;
+}
+
+/////////////////////////////////////////////////
+bool Plugin::IsHelper() const
+{
+  return !this->dataPtr->helperKey.empty() && this->dataPtr->ring;
+}
+
+/////////////////////////////////////////////////
+SharedRing *Plugin::HelperRing() const
+{
+  return this->dataPtr->ring.get();
+}
+
+/////////////////////////////////////////////////
+bool Plugin::SendToHelper(const std::string &_message)
+{
+  if (!this->dataPtr->helper)
+    return false;
+
+  if (_message.find('\n') != std::string::npos)
+  {
+    ignerr << "Messages to helper processes can't contain line breaks."
+           << std::endl;
+    return false;
+  }
+
+  auto line = "message " + _message + "\n";
+  return this->dataPtr->helper->write(line.c_str()) ==
+      static_cast<qint64>(line.size());
+}
+
+/////////////////////////////////////////////////
+void Plugin::StartHelper()
+{
+  static std::atomic<unsigned int> helperCount{0u};
+  auto key = "ign_gui_" + std::to_string(QCoreApplication::applicationPid()) +
+      "_" + std::to_string(helperCount++);
+
+  this->dataPtr->ring = std::make_unique<SharedRing>();
+  if (!this->dataPtr->ring->Create(key, this->dataPtr->slotCount,
+      static_cast<std::size_t>(this->dataPtr->slotSize) << 20))
+  {
+    ignerr << "Failed to create shared memory for plugin ["
+           << this->dataPtr->filename << "], running it in this process."
+           << std::endl;
+    this->dataPtr->ring.reset();
+    return;
+  }
+
+  // The helper loads the same configuration, plus the ring's key
+  tinyxml2::XMLDocument doc;
+  doc.Parse(this->configStr.c_str());
+  auto pluginElem = doc.FirstChildElement("plugin");
+  auto ignGuiElem = pluginElem ?
+      pluginElem->FirstChildElement("ignition-gui") : nullptr;
+  auto processElem = ignGuiElem ?
+      ignGuiElem->FirstChildElement("separate_process") : nullptr;
+  if (!processElem)
+  {
+    ignerr << "Failed to find <separate_process> in the configuration of "
+           << "plugin [" << this->dataPtr->filename << "], running it in "
+           << "this process." << std::endl;
+    this->dataPtr->ring.reset();
+    return;
+  }
+  processElem->SetAttribute("helper_key", key.c_str());
+
+  tinyxml2::XMLPrinter printer;
+  doc.Print(&printer);
+  std::string config(printer.CStr());
+
+  this->dataPtr->helper = new QProcess(this);
+
+  // The helper isn't displayed, and logs to the same console
+  auto env = QProcessEnvironment::systemEnvironment();
+  env.insert("QT_QPA_PLATFORM", "offscreen");
+  this->dataPtr->helper->setProcessEnvironment(env);
+  this->dataPtr->helper->setProcessChannelMode(QProcess::ForwardedChannels);
+
+  this->connect(this->dataPtr->helper, &QProcess::errorOccurred, this,
+      [this](QProcess::ProcessError _error)
+  {
+    // Crashes are handled once the process finished
+    if (_error == QProcess::FailedToStart)
+    {
+      ignerr << "Failed to start helper process for plugin [" << this->Title()
+             << "]. Is the [ign] command available?" << std::endl;
+
+      // May be emitted from within start, before the configuration is loaded
+      QTimer::singleShot(0, this, [this]() {this->FallBackFromHelper();});
+    }
+  });
+  this->connect(this->dataPtr->helper,
+      QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+      [this](int _code, QProcess::ExitStatus)
+  {
+    ignerr << "Helper process of plugin [" << this->Title()
+           << "] exited unexpectedly with code [" << _code << "]."
+           << std::endl;
+    this->FallBackFromHelper();
+  });
+
+  this->dataPtr->helper->start("ign", {"gui", "--helper", "--force-version",
+      IGNITION_GUI_VERSION_FULL});
+
+  // The configuration goes first, prefixed by its length. Writes are
+  // buffered until the process starts.
+  auto header = std::to_string(config.size()) + "\n";
+  this->dataPtr->helper->write(header.c_str());
+  this->dataPtr->helper->write(config.c_str(), config.size());
+
+  this->dataPtr->ringReader = std::thread([this]()
+  {
+    while (!this->dataPtr->stopReader)
+    {
+      this->dataPtr->ring->Wait();
+      if (this->dataPtr->stopReader)
+        break;
+
+      // Writes made while a read is queued are picked up by that read
+      if (!this->dataPtr->readQueued.exchange(true))
+      {
+        this->PostToGuiThread([this]() {this->ReadFromHelper();});
+      }
+    }
+  });
+
+  igndbg << "Started helper process for plugin [" << this->dataPtr->filename
+         << "] with shared ring [" << key << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void Plugin::StopHelper()
+{
+  // Closing its input asks the helper to quit. It's given some time to do
+  // so without blocking the GUI thread, and is killed otherwise. The
+  // application holds on to it meanwhile, and kills it when quitting.
+  if (auto helper = this->dataPtr->helper)
+  {
+    this->dataPtr->helper = nullptr;
+    QObject::disconnect(helper, nullptr, this, nullptr);
+    helper->closeWriteChannel();
+    if (!App())
+    {
+      delete helper;
+    }
+    else if (helper->state() == QProcess::NotRunning)
+    {
+      // May be called from one of its signals
+      helper->deleteLater();
+    }
+    else
+    {
+      helper->setParent(App());
+      QObject::connect(helper,
+          QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+          helper, &QObject::deleteLater);
+
+      auto title = this->Title();
+      QTimer::singleShot(2000, helper, [helper, title]()
+      {
+        ignwarn << "Helper process of plugin [" << title
+                << "] didn't quit, killing it." << std::endl;
+        helper->kill();
+      });
+    }
+  }
+
+  if (this->dataPtr->ringReader.joinable())
+  {
+    this->dataPtr->stopReader = true;
+    this->dataPtr->ring->Wake();
+    this->dataPtr->ringReader.join();
+  }
+}
+
+/////////////////////////////////////////////////
+void Plugin::FallBackFromHelper()
+{
+  if (!this->dataPtr->helper || this->dataPtr->shutDown)
+    return;
+
+  ignwarn << "Running plugin [" << this->Title() << "] in this process "
+          << "instead of a helper process." << std::endl;
+
+  // Reads already queued find no ring
+  this->StopHelper();
+  this->dataPtr->ring.reset();
+
+  if (!this->dataPtr->suspended)
+    this->Resume();
+}
+
+/////////////////////////////////////////////////
+void Plugin::AttachToProxy()
+{
+  this->dataPtr->ring = std::make_unique<SharedRing>();
+  if (!this->dataPtr->ring->Attach(this->dataPtr->helperKey))
+  {
+    ignerr << "Helper for plugin [" << this->dataPtr->filename
+           << "] failed to attach to its proxy, quitting." << std::endl;
+    this->dataPtr->ring.reset();
+    QMetaObject::invokeMethod(App(), "quit", Qt::QueuedConnection);
+    return;
+  }
+
+  // The rest of the input is made of the proxy's messages, one per line.
+  // The thread is left blocked on the input when the application quits.
+  QPointer<Plugin> plugin(this);
+  std::thread([plugin]()
+  {
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+      QMetaObject::invokeMethod(App(), [plugin, line]()
+      {
+        if (plugin)
+          plugin->OnProxyLine(line);
+      }, Qt::QueuedConnection);
+    }
+
+    // The proxy closed the pipe or exited
+    QMetaObject::invokeMethod(App(), "quit", Qt::QueuedConnection);
+  }).detach();
+}
+
+/////////////////////////////////////////////////
+void Plugin::OnProxyLine(const std::string &_line)
+{
+  const std::string messagePrefix{"message "};
+
+  if (_line == "suspend")
+    this->SetSuspended(true);
+  else if (_line == "resume")
+    this->SetSuspended(false);
+  else if (_line.compare(0, messagePrefix.size(), messagePrefix) == 0)
+    this->OnProxyMessage(_line.substr(messagePrefix.size()));
+  else
+    ignwarn << "Unknown line from proxy [" << _line << "]" << std::endl;
+}
+
+/////////////////////////////////////////////////
+void Plugin::ReadFromHelper()
+{
+  this->dataPtr->readQueued = false;
+  if (!this->dataPtr->ring || !this->dataPtr->helper)
+    return;
+
+  std::size_t size{0u};
+  auto data = this->dataPtr->ring->BeginRead(size, true);
+  if (!data)
+    return;
+
+  this->OnHelperData(data, size);
+  this->dataPtr->ring->EndRead();
+}
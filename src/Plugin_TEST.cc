@@ -17,12 +17,16 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <thread>
+
 #include <ignition/common/Console.hh>
 
 #include "test_config.h"  // NOLINT(build/include)
 #include "ignition/gui/Application.hh"
 #include "ignition/gui/MainWindow.hh"
 #include "ignition/gui/Plugin.hh"
+#include "ignition/gui/SharedRing.hh"
 
 int g_argc = 1;
 char **g_argv = new char *[g_argc];
@@ -131,3 +135,399 @@ TEST(PluginTest, Getters)
   ASSERT_NE(nullptr, plugin->Context());
 }
 
+/////////////////////////////////////////////////
+TEST(PluginTest, MaxRate)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  // No rates by default
+  {
+    const char *pluginStr =
+      "<plugin filename=\"TestPlugin\">"
+      "</plugin>";
+
+    tinyxml2::XMLDocument pluginDoc;
+    pluginDoc.Parse(pluginStr);
+    EXPECT_TRUE(app.LoadPlugin("TestPlugin",
+        pluginDoc.FirstChildElement("plugin")));
+  }
+
+  // Default and per-topic rates
+  {
+    const char *pluginStr =
+      "<plugin filename=\"TestPlugin\">"
+        "<ignition-gui>"
+          "<max_rate>10</max_rate>"
+          "<max_rate topic=\"/camera\">2</max_rate>"
+          "<max_rate topic=\"/negative\">-3</max_rate>"
+          "<max_rate topic=\"/text\">fast</max_rate>"
+        "</ignition-gui>"
+      "</plugin>";
+
+    tinyxml2::XMLDocument pluginDoc;
+    pluginDoc.Parse(pluginStr);
+    EXPECT_TRUE(app.LoadPlugin("TestPlugin",
+        pluginDoc.FirstChildElement("plugin")));
+  }
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugins = win->findChildren<Plugin *>();
+  ASSERT_EQ(2, plugins.size());
+
+  EXPECT_EQ(0u, plugins[0]->MaxRate("/camera"));
+  EXPECT_EQ(0u, plugins[0]->MaxRate("/other"));
+
+  EXPECT_EQ(2u, plugins[1]->MaxRate("/camera"));
+  EXPECT_EQ(10u, plugins[1]->MaxRate("/other"));
+
+  // Invalid rates are ignored with a warning, so the default applies
+  EXPECT_EQ(10u, plugins[1]->MaxRate("/negative"));
+  EXPECT_EQ(10u, plugins[1]->MaxRate("/text"));
+}
+
+/////////////////////////////////////////////////
+TEST(PluginTest, Suspended)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin"));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+  ASSERT_NE(nullptr, plugin->CardItem());
+
+  win->QuickWindow()->show();
+  QCoreApplication::processEvents();
+
+  EXPECT_FALSE(plugin->Suspended());
+
+  // Hidden card
+  plugin->CardItem()->setVisible(false);
+  EXPECT_TRUE(plugin->Suspended());
+
+  plugin->CardItem()->setVisible(true);
+  EXPECT_FALSE(plugin->Suspended());
+
+  // Collapsed card
+  auto height = plugin->CardItem()->height();
+  plugin->CardItem()->setHeight(0);
+  EXPECT_TRUE(plugin->Suspended());
+
+  plugin->CardItem()->setHeight(height);
+  EXPECT_FALSE(plugin->Suspended());
+
+  win->QuickWindow()->close();
+}
+
+/////////////////////////////////////////////////
+TEST(PluginTest, Memory)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  const char *pluginStr =
+    "<plugin filename=\"TestPlugin\">"
+      "<ignition-gui>"
+        "<memory_budget>1</memory_budget>"
+      "</ignition-gui>"
+    "</plugin>";
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(pluginStr);
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+
+  EXPECT_EQ(1u << 20, plugin->MemoryBudget());
+  EXPECT_EQ(0u, plugin->MemoryUsage());
+  EXPECT_TRUE(plugin->MemoryUsageByCategory().empty());
+  EXPECT_GT(plugin->QmlObjectCount(), 1u);
+
+  // Under budget
+  QMetaObject::invokeMethod(plugin, "ReportMemory",
+      Q_ARG(QString, "images"), Q_ARG(int, 1000));
+  QMetaObject::invokeMethod(plugin, "ReportMemory",
+      Q_ARG(QString, "test"), Q_ARG(int, 24));
+  QCoreApplication::processEvents();
+
+  EXPECT_EQ(1024u, plugin->MemoryUsage());
+  auto categories = plugin->MemoryUsageByCategory();
+  ASSERT_EQ(2u, categories.size());
+  EXPECT_EQ(1000u, categories["images"]);
+  EXPECT_EQ(24u, categories["test"]);
+
+  int shrinkBudget{0};
+  QMetaObject::invokeMethod(plugin, "ShrinkBudget",
+      Q_RETURN_ARG(int, shrinkBudget));
+  EXPECT_EQ(-1, shrinkBudget);
+
+  // Over budget, the plugin is asked to shrink
+  QMetaObject::invokeMethod(plugin, "ReportMemory",
+      Q_ARG(QString, "test"), Q_ARG(int, 2 << 20));
+  QCoreApplication::processEvents();
+
+  QMetaObject::invokeMethod(plugin, "ShrinkBudget",
+      Q_RETURN_ARG(int, shrinkBudget));
+  EXPECT_EQ(1 << 20, shrinkBudget);
+  EXPECT_EQ(1000u, plugin->MemoryUsage());
+  EXPECT_EQ(1u, plugin->MemoryUsageByCategory().size());
+}
+
+/////////////////////////////////////////////////
+TEST(PluginTest, Latencies)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin"));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_TRUE(plugin->Latencies().empty());
+
+  QMetaObject::invokeMethod(plugin, "ReportLatency",
+      Q_ARG(QString, "display"), Q_ARG(int, 10));
+  QMetaObject::invokeMethod(plugin, "ReportLatency",
+      Q_ARG(QString, "display"), Q_ARG(int, 30));
+  QMetaObject::invokeMethod(plugin, "ReportLatency",
+      Q_ARG(QString, "receive"), Q_ARG(int, 1));
+
+  auto latencies = plugin->Latencies();
+  ASSERT_EQ(2u, latencies.size());
+  EXPECT_EQ(2u, latencies["display"].Count());
+  EXPECT_DOUBLE_EQ(20.0, latencies["display"].Stats().mean);
+  EXPECT_DOUBLE_EQ(30.0, latencies["display"].Stats().max);
+  EXPECT_EQ(1u, latencies["receive"].Count());
+
+  plugin->ResetLatencies();
+  EXPECT_TRUE(plugin->Latencies().empty());
+}
+
+/////////////////////////////////////////////////
+/// \brief Put an `ign` command first on the PATH which stands in for the
+/// helper process. It does nothing until its input is closed.
+/// \param[in] _dir Directory to put the command in.
+/// \return The previous PATH, to be restored.
+QByteArray StandInHelper(const QTemporaryDir &_dir)
+{
+  QFile ign(_dir.filePath("ign"));
+  EXPECT_TRUE(ign.open(QIODevice::WriteOnly));
+  ign.write("#!/bin/sh\nexec cat > /dev/null\n");
+  ign.close();
+  ign.setPermissions(ign.permissions() | QFile::ExeOwner);
+
+  auto path = qgetenv("PATH");
+  qputenv("PATH", _dir.path().toLocal8Bit() + ":" + path);
+  return path;
+}
+
+/////////////////////////////////////////////////
+// The stand-in helper is a shell script
+#ifndef _WIN32
+TEST(PluginTest, HelperData)
+#else
+TEST(PluginTest, DISABLED_HelperData)
+#endif
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  auto path = StandInHelper(dir);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  const char *pluginStr =
+    "<plugin filename=\"TestPlugin\">"
+      "<ignition-gui>"
+        "<separate_process slots=\"2\" slot_size=\"1\">true"
+        "</separate_process>"
+      "</ignition-gui>"
+    "</plugin>";
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(pluginStr);
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_TRUE(plugin->IsProxy());
+  EXPECT_FALSE(plugin->IsHelper());
+
+  QString key;
+  QMetaObject::invokeMethod(plugin, "RingKey", Q_RETURN_ARG(QString, key));
+  ASSERT_FALSE(key.isEmpty());
+
+  // Stand in for the helper process, which only writes when asked to
+  SharedRing helperRing;
+  ASSERT_TRUE(helperRing.Attach(key.toStdString()));
+  EXPECT_EQ(2u, helperRing.SlotCount());
+  EXPECT_EQ(1u << 20, helperRing.SlotSize());
+
+  EXPECT_TRUE(helperRing.Write("first", 5u));
+  EXPECT_TRUE(helperRing.Write("latest", 6u));
+
+  // The proxy's reader thread queues the latest slot on the GUI thread
+  QString data;
+  for (int i = 0; i < 100 && data != "latest"; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    QCoreApplication::processEvents();
+    QMetaObject::invokeMethod(plugin, "HelperData",
+        Q_RETURN_ARG(QString, data));
+  }
+  EXPECT_EQ("latest", data);
+
+  // Removing the proxy doesn't wait for the helper to quit
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(app.RemovePlugin(plugin->CardItem()->objectName()
+      .toStdString()));
+  EXPECT_LT(std::chrono::steady_clock::now() - start,
+      std::chrono::milliseconds(1000));
+
+  qputenv("PATH", path);
+}
+
+/////////////////////////////////////////////////
+#ifndef _WIN32
+TEST(PluginTest, HelperExits)
+#else
+TEST(PluginTest, DISABLED_HelperExits)
+#endif
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  auto path = StandInHelper(dir);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  const char *pluginStr =
+    "<plugin filename=\"TestPlugin\">"
+      "<ignition-gui>"
+        "<separate_process slots=\"2\" slot_size=\"1\">true"
+        "</separate_process>"
+      "</ignition-gui>"
+    "</plugin>";
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(pluginStr);
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+  ASSERT_TRUE(plugin->IsProxy());
+
+  auto helper = plugin->findChild<QProcess *>();
+  ASSERT_NE(nullptr, helper);
+  ASSERT_TRUE(helper->waitForStarted());
+
+  int resumeCount{-1};
+  QMetaObject::invokeMethod(plugin, "ResumeCount",
+      Q_RETURN_ARG(int, resumeCount));
+  EXPECT_EQ(0, resumeCount);
+
+  // The plugin falls back to running in this process
+  helper->kill();
+  for (int i = 0; i < 100 && plugin->IsProxy(); ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    QCoreApplication::processEvents();
+  }
+  EXPECT_FALSE(plugin->IsProxy());
+  EXPECT_FALSE(plugin->IsHelper());
+
+  QString key;
+  QMetaObject::invokeMethod(plugin, "RingKey", Q_RETURN_ARG(QString, key));
+  EXPECT_TRUE(key.isEmpty());
+
+  QMetaObject::invokeMethod(plugin, "ResumeCount",
+      Q_RETURN_ARG(int, resumeCount));
+  EXPECT_EQ(1, resumeCount);
+
+  EXPECT_TRUE(app.RemovePlugin(plugin->CardItem()->objectName()
+      .toStdString()));
+
+  qputenv("PATH", path);
+}
+
+/////////////////////////////////////////////////
+TEST(PluginTest, HelperFailsToStart)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  // No `ign` command to be found
+  QTemporaryDir dir;
+  ASSERT_TRUE(dir.isValid());
+  auto path = qgetenv("PATH");
+  qputenv("PATH", dir.path().toLocal8Bit());
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  const char *pluginStr =
+    "<plugin filename=\"TestPlugin\">"
+      "<ignition-gui>"
+        "<separate_process>true</separate_process>"
+      "</ignition-gui>"
+    "</plugin>";
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(pluginStr);
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+
+  for (int i = 0; i < 100 && plugin->IsProxy(); ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    QCoreApplication::processEvents();
+  }
+  EXPECT_FALSE(plugin->IsProxy());
+
+  int resumeCount{-1};
+  QMetaObject::invokeMethod(plugin, "ResumeCount",
+      Q_RETURN_ARG(int, resumeCount));
+  EXPECT_EQ(1, resumeCount);
+
+  qputenv("PATH", path);
+}
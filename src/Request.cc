@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Request.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    class RequestStateBasePrivate
+    {
+      /// \brief Protects everything below
+      public: mutable std::mutex mutex;
+
+      /// \brief Notified when the request finishes
+      public: std::condition_variable cv;
+
+      /// \brief Current status
+      public: RequestStatus status{RequestStatus::kPending};
+
+      /// \brief Called once the request finishes
+      public: std::vector<std::function<void()>> continuations;
+
+      /// \brief Requests cancelled along with this one
+      public: std::vector<std::weak_ptr<RequestStateBase>> linked;
+
+      /// \brief Threads running continuations right now, once per call.
+      /// Added to with the mutex locked when the request finishes, so
+      /// Cancel can't miss them.
+      public: std::vector<std::thread::id> running;
+
+      /// \brief Run continuations, then remove this thread from running.
+      /// \param[in] _continuations Continuations.
+      public: void Run(
+          const std::vector<std::function<void()>> &_continuations)
+      {
+        for (auto &continuation : _continuations)
+          continuation();
+
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->running.erase(std::find(this->running.begin(),
+              this->running.end(), std::this_thread::get_id()));
+        }
+        this->cv.notify_all();
+      }
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+Executor ignition::gui::guiThreadExecutor(const QObject *_context,
+    const DeliveryLane _lane)
+{
+  return [_context, _lane](std::function<void()> _func)
+  {
+    auto dispatcher = App() ? App()->Dispatcher() : nullptr;
+    if (dispatcher)
+    {
+      dispatcher->Post(_context, std::move(_func), _lane);
+      return;
+    }
+
+    if (auto app = QCoreApplication::instance())
+      QMetaObject::invokeMethod(app, _func, Qt::QueuedConnection);
+  };
+}
+
+/////////////////////////////////////////////////
+Executor ignition::gui::objectThreadExecutor(QObject *_object)
+{
+  QPointer<QObject> object(_object);
+  return [object](std::function<void()> _func)
+  {
+    if (object)
+      QMetaObject::invokeMethod(object, _func, Qt::QueuedConnection);
+  };
+}
+
+/////////////////////////////////////////////////
+Executor ignition::gui::workerExecutor(const void *_owner,
+    const TaskPriority _priority)
+{
+  return [_owner, _priority](std::function<void()> _func)
+  {
+    auto workers = App() ? App()->Workers() : nullptr;
+    if (workers)
+      workers->Post(std::move(_func), _priority, _owner);
+    else
+      _func();
+  };
+}
+
+/////////////////////////////////////////////////
+Executor ignition::gui::inlineExecutor()
+{
+  return [](std::function<void()> _func)
+  {
+    _func();
+  };
+}
+
+/////////////////////////////////////////////////
+RequestStateBase::RequestStateBase()
+  : dataPtr(new RequestStateBasePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+RequestStateBase::~RequestStateBase()
+{
+}
+
+/////////////////////////////////////////////////
+RequestStatus RequestStateBase::Status() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->status;
+}
+
+/////////////////////////////////////////////////
+bool RequestStateBase::Finish(const RequestStatus _status,
+    const std::function<void()> &_store)
+{
+  if (_status == RequestStatus::kPending)
+    return false;
+
+  std::vector<std::function<void()>> continuations;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    if (this->dataPtr->status != RequestStatus::kPending)
+      return false;
+
+    if (_store)
+      _store();
+    this->dataPtr->status = _status;
+
+    if (_status == RequestStatus::kCancelled)
+      this->dataPtr->continuations.clear();
+    else
+      std::swap(continuations, this->dataPtr->continuations);
+
+    if (!continuations.empty())
+      this->dataPtr->running.push_back(std::this_thread::get_id());
+  }
+  this->dataPtr->cv.notify_all();
+
+  if (!continuations.empty())
+    this->dataPtr->Run(continuations);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void RequestStateBase::Cancel()
+{
+  this->Finish(RequestStatus::kCancelled);
+
+  // Chained requests are cancelled even if this one already finished
+  std::vector<std::weak_ptr<RequestStateBase>> linked;
+  {
+    std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+    std::swap(linked, this->dataPtr->linked);
+
+    // Continuations already running elsewhere may use whatever the caller
+    // destroys next. Those running on this thread called Cancel themselves.
+    auto self = std::this_thread::get_id();
+    this->dataPtr->cv.wait(lock, [this, self]
+    {
+      return std::all_of(this->dataPtr->running.begin(),
+          this->dataPtr->running.end(),
+          [self](const std::thread::id &_id) {return _id == self;});
+    });
+  }
+
+  for (auto &weak : linked)
+  {
+    if (auto other = weak.lock())
+      other->Cancel();
+  }
+}
+
+/////////////////////////////////////////////////
+void RequestStateBase::OnFinished(std::function<void()> _func)
+{
+  if (!_func)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    if (this->dataPtr->status == RequestStatus::kCancelled)
+      return;
+
+    if (this->dataPtr->status == RequestStatus::kPending)
+    {
+      this->dataPtr->continuations.push_back(std::move(_func));
+      return;
+    }
+
+    this->dataPtr->running.push_back(std::this_thread::get_id());
+  }
+
+  this->dataPtr->Run({std::move(_func)});
+}
+
+/////////////////////////////////////////////////
+void RequestStateBase::Link(const std::shared_ptr<RequestStateBase> &_other)
+{
+  if (!_other)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->linked.push_back(_other);
+}
+
+/////////////////////////////////////////////////
+void RequestStateBase::SetTimeout(const std::chrono::milliseconds &_timeout)
+{
+  auto app = QCoreApplication::instance();
+  if (!app)
+  {
+    ignwarn << "No application running, request won't time out."
+            << std::endl;
+    return;
+  }
+
+  // The timer doesn't keep the request alive
+  std::weak_ptr<RequestStateBase> weak = this->shared_from_this();
+  auto start = [weak, _timeout]()
+  {
+    QTimer::singleShot(static_cast<int>(_timeout.count()), [weak]()
+    {
+      if (auto state = weak.lock())
+        state->Finish(RequestStatus::kTimedOut);
+    });
+  };
+
+  // Timers must be started on a thread with an event loop
+  if (QThread::currentThread() == app->thread())
+    start();
+  else
+    QMetaObject::invokeMethod(app, start, Qt::QueuedConnection);
+}
+
+/////////////////////////////////////////////////
+RequestStatus RequestStateBase::Wait(const std::chrono::milliseconds &_timeout)
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->cv.wait_for(lock, _timeout, [this]
+  {
+    return this->dataPtr->status != RequestStatus::kPending;
+  });
+  return this->dataPtr->status;
+}
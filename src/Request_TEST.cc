@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <ignition/common/Console.hh>
+#include <ignition/msgs/stringmsg.pb.h>
+#include <ignition/transport/Node.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Request.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Process events until a condition is met or 2 s have passed
+/// \param[in] _done Condition
+/// \return True if the condition was met
+bool processUntil(const std::function<bool()> &_done)
+{
+  for (int i = 0; i < 200 && !_done(); ++i)
+  {
+    QCoreApplication::processEvents();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return _done();
+}
+
+/////////////////////////////////////////////////
+/// \brief Echo service, which fails on empty requests
+/// \param[in] _req Request
+/// \param[out] _rep Reply, same as the request
+/// \return False if the request is empty
+bool echo(const msgs::StringMsg &_req, msgs::StringMsg &_rep)
+{
+  _rep.set_data(_req.data());
+  return !_req.data().empty();
+}
+
+/////////////////////////////////////////////////
+TEST(RequestTest, Reply)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  transport::Node node;
+  ASSERT_TRUE(node.Advertise("/request_test_reply", echo));
+
+  msgs::StringMsg req;
+  req.set_data("hello");
+
+  auto future = request<msgs::StringMsg>(node, "/request_test_reply", req);
+  ASSERT_TRUE(future.Valid());
+
+  std::string reply;
+  auto status{RequestStatus::kPending};
+  std::thread::id thread;
+  future.Then([&](const msgs::StringMsg &_rep, const RequestStatus _status)
+  {
+    reply = _rep.data();
+    status = _status;
+    thread = std::this_thread::get_id();
+  });
+
+  // Continuations run on the GUI thread by default
+  EXPECT_TRUE(processUntil([&] {return status != RequestStatus::kPending;}));
+  EXPECT_EQ(RequestStatus::kOk, status);
+  EXPECT_EQ(RequestStatus::kOk, future.Status());
+  EXPECT_EQ("hello", reply);
+  EXPECT_EQ("hello", future.Reply().data());
+  EXPECT_EQ(std::this_thread::get_id(), thread);
+
+  // Continuations attached once finished run too
+  bool late{false};
+  future.Then([&](const msgs::StringMsg &, const RequestStatus)
+  {
+    late = true;
+  });
+  EXPECT_TRUE(processUntil([&] {return late;}));
+
+  // Failure
+  req.set_data("");
+  auto failed = request<msgs::StringMsg>(node, "/request_test_reply", req);
+  EXPECT_TRUE(processUntil([&]
+  {
+    return failed.Status() != RequestStatus::kPending;
+  }));
+  EXPECT_EQ(RequestStatus::kFailed, failed.Status());
+
+  // Invalid
+  RequestFuture<msgs::StringMsg> invalid;
+  EXPECT_FALSE(invalid.Valid());
+  EXPECT_EQ(RequestStatus::kFailed, invalid.Status());
+}
+
+/////////////////////////////////////////////////
+TEST(RequestTest, TimeoutAndCancel)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  transport::Node node;
+  msgs::StringMsg req;
+  req.set_data("hello");
+
+  // Nobody advertises this service
+  auto timedOut = request<msgs::StringMsg>(node, "/request_test_missing",
+      req, std::chrono::milliseconds(100));
+
+  auto status{RequestStatus::kPending};
+  timedOut.Then([&](const msgs::StringMsg &, const RequestStatus _status)
+  {
+    status = _status;
+  });
+
+  EXPECT_TRUE(processUntil([&] {return status != RequestStatus::kPending;}));
+  EXPECT_EQ(RequestStatus::kTimedOut, status);
+
+  // Cancelled requests don't run their continuations
+  auto cancelled = request<msgs::StringMsg>(node, "/request_test_missing",
+      req, std::chrono::milliseconds(100));
+
+  bool ran{false};
+  cancelled.Then([&](const msgs::StringMsg &, const RequestStatus)
+  {
+    ran = true;
+  });
+  cancelled.Cancel();
+  EXPECT_EQ(RequestStatus::kCancelled, cancelled.Status());
+
+  processUntil([] {return false;});
+  EXPECT_FALSE(ran);
+  EXPECT_EQ(RequestStatus::kCancelled, cancelled.Status());
+}
+
+/////////////////////////////////////////////////
+TEST(RequestTest, Chain)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  transport::Node node;
+  ASSERT_TRUE(node.Advertise("/request_test_chain", echo));
+
+  msgs::StringMsg req;
+  req.set_data("a");
+
+  auto chained = request<msgs::StringMsg>(node, "/request_test_chain", req)
+      .Then([&node](const msgs::StringMsg &_rep, const RequestStatus)
+      {
+        msgs::StringMsg next;
+        next.set_data(_rep.data() + "b");
+        return request<msgs::StringMsg>(node, "/request_test_chain", next);
+      });
+
+  EXPECT_TRUE(processUntil([&]
+  {
+    return chained.Status() != RequestStatus::kPending;
+  }));
+  EXPECT_EQ(RequestStatus::kOk, chained.Status());
+  EXPECT_EQ("ab", chained.Reply().data());
+
+  // Cancelling the first request cancels the chain
+  auto first = request<msgs::StringMsg>(node, "/request_test_missing", req);
+  auto second = first.Then([&node](const msgs::StringMsg &, RequestStatus)
+  {
+    return request<msgs::StringMsg>(node, "/request_test_chain",
+        msgs::StringMsg());
+  });
+  first.Cancel();
+  EXPECT_EQ(RequestStatus::kCancelled, second.Status());
+}
+
+/////////////////////////////////////////////////
+TEST(RequestTest, Executors)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+
+  transport::Node node;
+  ASSERT_TRUE(node.Advertise("/request_test_executors", echo));
+
+  msgs::StringMsg req;
+  req.set_data("hello");
+  auto future = request<msgs::StringMsg>(node, "/request_test_executors",
+      req);
+
+  // Blocking is fine off the GUI thread
+  std::thread waiter([&future]
+  {
+    EXPECT_EQ(RequestStatus::kOk, future.Wait(std::chrono::seconds(2)));
+  });
+  waiter.join();
+
+  auto guiThread = std::this_thread::get_id();
+  std::atomic<int> count{0};
+
+  future.Then([&](const msgs::StringMsg &, const RequestStatus)
+  {
+    EXPECT_NE(guiThread, std::this_thread::get_id());
+    ++count;
+  }, workerExecutor());
+
+  future.Then([&](const msgs::StringMsg &, const RequestStatus)
+  {
+    EXPECT_EQ(guiThread, std::this_thread::get_id());
+    ++count;
+  }, objectThreadExecutor(&app));
+
+  // Already finished, so inline runs right here
+  future.Then([&](const msgs::StringMsg &, const RequestStatus)
+  {
+    EXPECT_EQ(guiThread, std::this_thread::get_id());
+    ++count;
+  }, inlineExecutor());
+  EXPECT_GE(count, 1);
+
+  EXPECT_TRUE(processUntil([&] {return count == 3;}));
+}
+
+/////////////////////////////////////////////////
+TEST(RequestTest, Release)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  // Continuations of a request which never finishes don't keep it alive
+  std::weak_ptr<RequestStateBase> weak;
+  std::weak_ptr<RequestStateBase> weakNext;
+  {
+    auto state = std::make_shared<RequestState<msgs::StringMsg>>();
+    RequestFuture<msgs::StringMsg> future(state, inlineExecutor());
+    weak = state;
+
+    future.Then([](const msgs::StringMsg &, const RequestStatus) {});
+    auto next = future.Then([](const msgs::StringMsg &, const RequestStatus)
+    {
+      return RequestFuture<msgs::StringMsg>(
+          std::make_shared<RequestState<msgs::StringMsg>>(),
+          inlineExecutor());
+    });
+    weakNext = next.State();
+  }
+  EXPECT_TRUE(weak.expired());
+  EXPECT_TRUE(weakNext.expired());
+
+  // Nor do those of an inner request which never finishes
+  std::weak_ptr<RequestStateBase> weakInner;
+  {
+    auto state = std::make_shared<RequestState<msgs::StringMsg>>();
+    RequestFuture<msgs::StringMsg> future(state, inlineExecutor());
+
+    auto next = future.Then([&weakInner](const msgs::StringMsg &,
+        const RequestStatus)
+    {
+      auto inner = std::make_shared<RequestState<msgs::StringMsg>>();
+      weakInner = inner;
+      return RequestFuture<msgs::StringMsg>(inner, inlineExecutor());
+    });
+    state->Finish(RequestStatus::kOk);
+    EXPECT_EQ(RequestStatus::kPending, next.Status());
+  }
+  EXPECT_TRUE(weakInner.expired());
+}
+
+/////////////////////////////////////////////////
+TEST(RequestTest, CancelWaitsForContinuations)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  auto state = std::make_shared<RequestState<msgs::StringMsg>>();
+  RequestFuture<msgs::StringMsg> future(state, inlineExecutor());
+
+  std::atomic<bool> started{false};
+  std::atomic<bool> done{false};
+  future.Then([&](const msgs::StringMsg &, const RequestStatus)
+  {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    done = true;
+  });
+
+  // Stand in for a transport thread
+  std::thread replier([state]()
+  {
+    state->Finish(RequestStatus::kOk);
+  });
+
+  while (!started)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  // Whatever the continuation uses can be destroyed after cancelling
+  future.Cancel();
+  EXPECT_TRUE(done);
+  replier.join();
+
+  // A continuation may cancel its own request
+  auto other = std::make_shared<RequestState<msgs::StringMsg>>();
+  RequestFuture<msgs::StringMsg> otherFuture(other, inlineExecutor());
+
+  bool cancelled{false};
+  otherFuture.Then([&](const msgs::StringMsg &, const RequestStatus)
+  {
+    otherFuture.Cancel();
+    cancelled = true;
+  });
+  other->Finish(RequestStatus::kOk);
+  EXPECT_TRUE(cancelled);
+}
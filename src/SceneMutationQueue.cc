@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "ignition/gui/SceneMutationQueue.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief A queued mutation
+    struct SceneMutation
+    {
+      /// \brief Key, may be empty
+      std::string key;
+
+      /// \brief Function to run
+      std::function<void()> func;
+    };
+
+    class SceneMutationQueuePrivate
+    {
+      /// \brief Protects mutations
+      public: mutable std::mutex mutex;
+
+      /// \brief Pending mutations per scene, in order
+      public: std::map<std::string, std::vector<SceneMutation>> mutations;
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+SceneMutationQueue::SceneMutationQueue()
+  : dataPtr(new SceneMutationQueuePrivate)
+{
+}
+
+/////////////////////////////////////////////////
+SceneMutationQueue::~SceneMutationQueue()
+{
+}
+
+/////////////////////////////////////////////////
+void SceneMutationQueue::Post(const std::string &_scene,
+    std::function<void()> _mutation, const std::string &_key)
+{
+  if (!_mutation)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto &mutations = this->dataPtr->mutations[_scene];
+
+  if (!_key.empty())
+  {
+    for (auto &mutation : mutations)
+    {
+      if (mutation.key == _key)
+      {
+        mutation.func = std::move(_mutation);
+        return;
+      }
+    }
+  }
+
+  mutations.push_back({_key, std::move(_mutation)});
+}
+
+/////////////////////////////////////////////////
+std::size_t SceneMutationQueue::Run(const std::string &_scene)
+{
+  std::vector<SceneMutation> mutations;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    auto it = this->dataPtr->mutations.find(_scene);
+    if (it == this->dataPtr->mutations.end())
+      return 0u;
+    std::swap(mutations, it->second);
+  }
+
+  // Without the lock, so mutations can post more
+  for (auto &mutation : mutations)
+    mutation.func();
+
+  return mutations.size();
+}
+
+/////////////////////////////////////////////////
+std::size_t SceneMutationQueue::Pending(const std::string &_scene) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->mutations.find(_scene);
+  return it == this->dataPtr->mutations.end() ? 0u : it->second.size();
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ignition/gui/SceneMutationQueue.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(SceneMutationQueueTest, Run)
+{
+  SceneMutationQueue queue;
+  EXPECT_EQ(0u, queue.Pending("scene"));
+  EXPECT_EQ(0u, queue.Run("scene"));
+
+  std::vector<std::string> ran;
+  queue.Post("scene", [&]() {ran.push_back("a");});
+  queue.Post("scene", [&]() {ran.push_back("cloud 1");}, "cloud");
+  queue.Post("other", [&]() {ran.push_back("other");});
+  queue.Post("scene", [&]() {ran.push_back("b");});
+  queue.Post("scene", nullptr);
+
+  // Replaced in place
+  queue.Post("scene", [&]() {ran.push_back("cloud 2");}, "cloud");
+
+  EXPECT_EQ(3u, queue.Pending("scene"));
+  EXPECT_EQ(1u, queue.Pending("other"));
+
+  EXPECT_EQ(3u, queue.Run("scene"));
+  ASSERT_EQ(3u, ran.size());
+  EXPECT_EQ("a", ran[0]);
+  EXPECT_EQ("cloud 2", ran[1]);
+  EXPECT_EQ("b", ran[2]);
+  EXPECT_EQ(0u, queue.Pending("scene"));
+  EXPECT_EQ(1u, queue.Pending("other"));
+
+  // Posted while running, left for the next frame
+  queue.Post("scene", [&]()
+  {
+    queue.Post("scene", [&]() {ran.push_back("next");});
+  });
+  EXPECT_EQ(1u, queue.Run("scene"));
+  EXPECT_EQ(1u, queue.Pending("scene"));
+  EXPECT_EQ(1u, queue.Run("scene"));
+  EXPECT_EQ("next", ran.back());
+}
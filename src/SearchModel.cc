@@ -15,95 +15,543 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 
+#include "ignition/gui/Application.hh"
 #include "ignition/gui/Enums.hh"
+#include "ignition/gui/GuiDispatcher.hh"
 #include "ignition/gui/SearchModel.hh"
+#include "ignition/gui/WorkerPool.hh"
+
+/// \brief Default number of rows from which searches run in the background
+static const int kBackgroundThreshold{20000};
+
+/// \brief Number of texts tested between checks for cancellation
+static const std::size_t kCancelCheckInterval{1024u};
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief Rows of the source model, flattened so they can be searched
+    /// away from the GUI thread. Never changed once built.
+    struct SearchIndex
+    {
+      /// \brief Position of each row's parent, -1 for top level rows.
+      /// Parents come before their children.
+      std::vector<int> parents;
+
+      /// \brief Position of each row's lowercased text in texts
+      std::vector<int> textIds;
+
+      /// \brief True for titles, which are never accepted
+      std::vector<bool> titles;
+
+      /// \brief Distinct lowercased texts. Names such as "link" or "visual"
+      /// repeat across large trees, so each word is only tested against each
+      /// distinct text once.
+      std::vector<QString> texts;
+    };
+
+    /// \brief Outcome of searching an index
+    struct SearchResult
+    {
+      /// \brief Full search string
+      QString search;
+
+      /// \brief Distinct lowercased words of the search
+      QStringList words;
+
+      /// \brief For each word, the positions of the texts containing it, in
+      /// increasing order
+      std::vector<std::vector<int>> matches;
+
+      /// \brief Whether each row is accepted
+      std::vector<bool> accepted;
+
+      /// \brief Whether each row should be expanded
+      std::vector<bool> expand;
+
+      /// \brief Number of texts tested against words
+      int tested{0};
+    };
+
+    /// \brief One row of the source model in the search index
+    struct SearchNode
+    {
+      /// \brief Index on the source model, valid until the model changes
+      QModelIndex index;
+
+      /// \brief Whether the row is accepted by the latest search
+      bool accepted{true};
+
+      /// \brief Whether the row should be expanded for the latest search
+      bool expand{false};
+
+      /// \brief Whether TO_EXPAND has been written to the source model with
+      /// the current value of expand
+      bool expandWritten{false};
+    };
+
+    class SearchModelPrivate
+    {
+      /// \brief Index every row of the source model, parents before their
+      /// children
+      /// \param[in] _model Source model
+      /// \param[in] _role Role holding the text searched
+      public: void Build(const QAbstractItemModel *_model, const int _role);
+
+      /// \brief Search the index on the calling thread and apply the result
+      /// \param[in] _model Source model
+      /// \param[in] _search Full search string
+      public: void Run(QAbstractItemModel *_model, const QString &_search);
+
+      /// \brief Decide which rows are accepted and expanded from a result,
+      /// and write TO_EXPAND to the source model where it changed
+      /// \param[in] _model Source model
+      /// \param[in] _result Result of searching the current index
+      public: void Apply(QAbstractItemModel *_model,
+          const std::shared_ptr<const SearchResult> &_result);
+
+      /// \brief Index of the source model, null until built
+      public: std::shared_ptr<const SearchIndex> index;
+
+      /// \brief Rows, in the same order as the index
+      public: std::vector<SearchNode> nodes;
+
+      /// \brief Position of each row in nodes
+      public: QHash<QModelIndex, int> positions;
+
+      /// \brief Latest result applied to nodes, null until the first search
+      /// on the current index. Following searches narrow it down.
+      public: std::shared_ptr<const SearchResult> last;
+
+      /// \brief True when the source model changed since the index was built
+      public: bool dirty{true};
+
+      /// \brief Role the index was built with
+      public: int role{-1};
+
+      /// \brief True if nodes are up to date with the last result
+      public: bool searched{false};
+
+      /// \brief True if TO_EXPAND may have been written outside of Apply, so
+      /// the next result must be written for every row
+      public: bool expandUnknown{false};
+
+      /// \brief Incremented for every search, so stale background searches
+      /// stop early and their results are dropped
+      public: std::atomic<uint64_t> generation{0u};
+
+      /// \brief True while a background search for the current search
+      /// hasn't been applied
+      public: bool pending{false};
+
+      /// \brief Number of rows from which searches run in the background
+      public: int backgroundThreshold{kBackgroundThreshold};
+
+      /// \brief Connections to the source model
+      public: QList<QMetaObject::Connection> connections;
+    };
+  }
+}
 
 using namespace ignition;
 using namespace gui;
 
 /////////////////////////////////////////////////
-bool SearchModel::filterAcceptsRow(const int _srcRow,
-      const QModelIndex &_srcParent) const
+/// \brief Search an index. Safe to call from any thread.
+/// \param[in] _index Index to search.
+/// \param[in] _search Full search string.
+/// \param[in] _previous Previous result on the same index, may be null.
+/// Words which contain one of its words are only tested against the texts
+/// which matched that word.
+/// \param[in] _generation Current search generation.
+/// \param[in] _expected Generation this search belongs to. The search is
+/// abandoned as soon as the current generation differs.
+/// \return Result, null if abandoned.
+static std::shared_ptr<const SearchResult> searchIndex(
+    const SearchIndex &_index, const QString &_search,
+    const std::shared_ptr<const SearchResult> &_previous,
+    const std::atomic<uint64_t> &_generation, const uint64_t _expected)
 {
-  // Item index in search model.
-  auto id = this->sourceModel()->index(_srcRow, 0, _srcParent);
+  auto result = std::make_shared<SearchResult>();
+  result->search = _search;
 
-  // Ignore titles.
-  if (this->sourceModel()->data(id, DataRole::TYPE).toString() ==
-      "title")
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  auto words = _search.toLower().split(" ", Qt::SkipEmptyParts);
+#else
+  auto words = _search.toLower().split(" ", QString::SkipEmptyParts);
+#endif
+  for (const auto &word : words)
   {
-    return false;
+    if (!result->words.contains(word))
+      result->words.append(word);
   }
 
-  // Collapsed by default.
-  this->sourceModel()->blockSignals(true);
-  this->sourceModel()->setData(id, false, DataRole::TO_EXPAND);
-  this->sourceModel()->blockSignals(false);
+  // Texts containing each word
+  result->matches.resize(result->words.size());
+  for (int w = 0; w < result->words.size(); ++w)
+  {
+    if (_generation != _expected)
+      return nullptr;
 
-  // Empty search matches everything.
-  if (this->search.isEmpty())
-    return true;
+    const auto &word = result->words[w];
 
-  // Each word must match at least once, either self, parent or child.
-  auto words = this->search.split(" ");
-  for (auto word : words)
-  {
-    if (word.isEmpty())
+    // The previous word with the fewest matches which this word contains
+    int previous{-1};
+    if (_previous)
+    {
+      for (int p = 0; p < _previous->words.size(); ++p)
+      {
+        if (word.contains(_previous->words[p]) && (previous < 0 ||
+            _previous->matches[p].size() < _previous->matches[previous].size()))
+        {
+          previous = p;
+        }
+      }
+    }
+
+    auto &matches = result->matches[w];
+    if (previous >= 0 && _previous->words[previous] == word)
+    {
+      matches = _previous->matches[previous];
       continue;
+    }
 
-    // Expand this if at least one child contains the word.
-    // Note that this is not enough for this to be accepted, we need to match
-    // all words.
-    if (this->HasChildAcceptsItself(id, word))
+    auto count = previous >= 0 ? _previous->matches[previous].size() :
+        _index.texts.size();
+    for (std::size_t i = 0; i < count; ++i)
     {
-      this->sourceModel()->blockSignals(true);
-      this->sourceModel()->setData(id, true, DataRole::TO_EXPAND);
-      this->sourceModel()->blockSignals(false);
+      if (i % kCancelCheckInterval == 0 && _generation != _expected)
+        return nullptr;
+
+      int t = previous >= 0 ? _previous->matches[previous][i] :
+          static_cast<int>(i);
+      if (_index.texts[t].contains(word))
+        matches.push_back(t);
     }
+    result->tested += static_cast<int>(count);
+  }
 
-    // At least one of the children fits rule 1.
-    if (this->HasAcceptedChildren(_srcRow, _srcParent))
-      continue;
+  auto count = _index.parents.size();
+  std::vector<bool> pathMatch(count, true);
+  std::vector<bool> descendantMatch(count, false);
 
-    // Row itself contains this word.
-    if (this->FilterAcceptsRowItself(_srcRow, _srcParent, word))
-      continue;
+  // Words are matched 64 at a time, one bit each
+  std::vector<uint64_t> textMasks(_index.texts.size());
+  std::vector<uint64_t> masks(count);
+  for (int first = 0; first < result->words.size(); first += 64)
+  {
+    if (_generation != _expected)
+      return nullptr;
+
+    int last = std::min(first + 64, result->words.size());
+    uint64_t all = last - first == 64 ? ~uint64_t{0} :
+        (uint64_t{1} << (last - first)) - 1;
 
-    // One of the ancestors contains this word.
-    QModelIndex parentIndex = _srcParent;
-    bool parentAccepted = false;
-    while (parentIndex.isValid())
+    std::fill(textMasks.begin(), textMasks.end(), 0u);
+    for (int w = first; w < last; ++w)
     {
-      if (this->FilterAcceptsRowItself(parentIndex.row(),
-          parentIndex.parent(), word))
+      for (auto t : result->matches[w])
+        textMasks[t] |= uint64_t{1} << (w - first);
+    }
+
+    // Top down, words found on each row or its ancestors
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      auto parent = _index.parents[i];
+      masks[i] = textMasks[_index.textIds[i]] |
+          (parent < 0 ? 0u : masks[parent]);
+      if (masks[i] != all)
+        pathMatch[i] = false;
+    }
+
+    // Bottom up, whether any descendant has any of the words
+    std::fill(masks.begin(), masks.end(), 0u);
+    for (std::size_t i = count; i-- > 0;)
+    {
+      auto parent = _index.parents[i];
+      if (masks[i] != 0u)
+        descendantMatch[i] = true;
+      if (parent >= 0)
+        masks[parent] |= masks[i] | textMasks[_index.textIds[i]];
+    }
+  }
+
+  // Bottom up, a row is accepted if it or one of its descendants has all
+  // the words on its path
+  result->accepted.assign(count, false);
+  std::vector<bool> childAccepted(count, false);
+  for (std::size_t i = count; i-- > 0;)
+  {
+    bool accepted = !_index.titles[i] && (pathMatch[i] || childAccepted[i]);
+    result->accepted[i] = accepted;
+    if (accepted && _index.parents[i] >= 0)
+      childAccepted[_index.parents[i]] = true;
+  }
+  result->expand = std::move(descendantMatch);
+
+  return result;
+}
+
+/////////////////////////////////////////////////
+void SearchModelPrivate::Build(const QAbstractItemModel *_model,
+    const int _role)
+{
+  this->nodes.clear();
+  this->positions.clear();
+  this->index.reset();
+  this->last.reset();
+  this->searched = false;
+  this->role = _role;
+  this->dirty = false;
+
+  if (!_model)
+    return;
+
+  auto index = std::make_shared<SearchIndex>();
+  QHash<QString, int> textPositions;
+
+  // Depth first, so parents come before their children
+  std::vector<std::pair<QModelIndex, int>> stack;
+  stack.emplace_back(QModelIndex(), -1);
+  while (!stack.empty())
+  {
+    auto parentIndex = stack.back().first;
+    auto parent = stack.back().second;
+    stack.pop_back();
+
+    // Pushed in reverse so rows keep their order
+    for (int row = _model->rowCount(parentIndex) - 1; row >= 0; --row)
+    {
+      SearchNode node;
+      node.index = _model->index(row, 0, parentIndex);
+
+      auto text = _model->data(node.index, _role).toString().toLower();
+      auto it = textPositions.find(text);
+      if (it == textPositions.end())
       {
-        parentAccepted = true;
-        break;
+        it = textPositions.insert(text, static_cast<int>(index->texts.size()));
+        index->texts.push_back(text);
       }
-      parentIndex = parentIndex.parent();
+
+      index->parents.push_back(parent);
+      index->textIds.push_back(it.value());
+      index->titles.push_back(
+          _model->data(node.index, DataRole::TYPE).toString() == "title");
+
+      int position = static_cast<int>(this->nodes.size());
+      this->positions.insert(node.index, position);
+      this->nodes.push_back(node);
+
+      if (_model->hasChildren(node.index))
+        stack.emplace_back(node.index, position);
     }
+  }
 
-    if (parentAccepted)
+  this->index = index;
+}
+
+/////////////////////////////////////////////////
+void SearchModelPrivate::Run(QAbstractItemModel *_model,
+    const QString &_search)
+{
+  // Anything still searching in the background is stale now
+  this->pending = false;
+  auto expected = ++this->generation;
+
+  this->Apply(_model, searchIndex(*this->index, _search, this->last,
+      this->generation, expected));
+}
+
+/////////////////////////////////////////////////
+void SearchModelPrivate::Apply(QAbstractItemModel *_model,
+    const std::shared_ptr<const SearchResult> &_result)
+{
+  this->last = _result;
+  this->searched = true;
+  this->pending = false;
+
+  for (std::size_t i = 0; i < this->nodes.size(); ++i)
+  {
+    auto &node = this->nodes[i];
+    node.accepted = _result->accepted[i];
+
+    bool expand = _result->expand[i];
+    if (expand != node.expand || this->expandUnknown)
+    {
+      node.expand = expand;
+      node.expandWritten = false;
+    }
+  }
+
+  // Only touch the source model where expansion changed
+  bool blocked = _model->blockSignals(true);
+  for (auto &node : this->nodes)
+  {
+    if (node.expandWritten)
       continue;
+    _model->setData(node.index, node.expand, DataRole::TO_EXPAND);
+    node.expandWritten = true;
+  }
+  _model->blockSignals(blocked);
+  this->expandUnknown = false;
+}
+
+/////////////////////////////////////////////////
+SearchModel::SearchModel()
+  : dataPtr(new SearchModelPrivate)
+{
+}
 
-    // This word can't be found on the row or a parent, and no child is fully
-    // accepted.
+/////////////////////////////////////////////////
+SearchModel::~SearchModel()
+{
+  // Stop background searches, and drop results waiting to be applied
+  ++this->dataPtr->generation;
+  if (App() && App()->Workers())
+    App()->Workers()->Cancel(this);
+  if (App() && App()->Dispatcher())
+    App()->Dispatcher()->Cancel(this);
+}
+
+/////////////////////////////////////////////////
+void SearchModel::setSourceModel(QAbstractItemModel *_model)
+{
+  for (const auto &connection : this->dataPtr->connections)
+    this->disconnect(connection);
+  this->dataPtr->connections.clear();
+  this->dataPtr->dirty = true;
+
+  // Connected before the base class connects its own handlers, so the index
+  // is marked dirty before those filter the changed rows
+  if (_model)
+  {
+    auto markDirty = [this]()
+    {
+      this->dataPtr->dirty = true;
+    };
+    auto markDirtyIfSearched = [this](const QModelIndex &, const QModelIndex &,
+        const QVector<int> &_roles)
+    {
+      if (_roles.isEmpty() || _roles.contains(this->filterRole()) ||
+          _roles.contains(DataRole::TYPE))
+      {
+        this->dataPtr->dirty = true;
+      }
+    };
+
+    this->dataPtr->connections
+        << this->connect(_model, &QAbstractItemModel::rowsInserted, this,
+            markDirty)
+        << this->connect(_model, &QAbstractItemModel::rowsRemoved, this,
+            markDirty)
+        << this->connect(_model, &QAbstractItemModel::rowsMoved, this,
+            markDirty)
+        << this->connect(_model, &QAbstractItemModel::layoutChanged, this,
+            markDirty)
+        << this->connect(_model, &QAbstractItemModel::modelReset, this,
+            markDirty)
+        << this->connect(_model, &QAbstractItemModel::dataChanged, this,
+            markDirtyIfSearched);
+  }
+
+  QSortFilterProxyModel::setSourceModel(_model);
+}
+
+/////////////////////////////////////////////////
+bool SearchModel::filterAcceptsRow(const int _srcRow,
+      const QModelIndex &_srcParent) const
+{
+  auto model = this->sourceModel();
+  if (!model)
     return false;
+
+  auto id = model->index(_srcRow, 0, _srcParent);
+
+  // Without words, there's no need for the index, which keeps filling large
+  // models row by row cheap
+  if (this->search.trimmed().isEmpty())
+  {
+    bool blocked = model->blockSignals(true);
+    model->setData(id, false, DataRole::TO_EXPAND);
+    model->blockSignals(blocked);
+    this->dataPtr->expandUnknown = true;
+    this->dataPtr->searched = false;
+
+    return model->data(id, DataRole::TYPE).toString() != "title";
+  }
+
+  if (this->dataPtr->dirty || this->dataPtr->role != this->filterRole())
+    this->dataPtr->Build(model, this->filterRole());
+
+  auto it = this->dataPtr->positions.constFind(id);
+  if (it == this->dataPtr->positions.constEnd())
+  {
+    // Changed without notifying, such as while signals were blocked
+    this->dataPtr->Build(model, this->filterRole());
+    it = this->dataPtr->positions.constFind(id);
+    if (it == this->dataPtr->positions.constEnd())
+      return false;
+  }
+
+  if (!this->dataPtr->searched || this->dataPtr->last->search != this->search)
+  {
+    if (this->dataPtr->last && this->dataPtr->last->search == this->search)
+    {
+      // Same search as before it was cleared
+      this->dataPtr->Apply(model, this->dataPtr->last);
+    }
+    else if (this->dataPtr->pending && this->dataPtr->last)
+    {
+      // Keep the previous results until the background search is applied
+      return this->dataPtr->nodes[it.value()].accepted;
+    }
+    else
+    {
+      this->dataPtr->Run(model, this->search);
+    }
   }
 
-  return true;
+  return this->dataPtr->nodes[it.value()].accepted;
 }
 
 /////////////////////////////////////////////////
-bool SearchModel::FilterAcceptsRowItself(const int _srcRow,
-    const QModelIndex &_srcParent, const QString &_word) const
+int SearchModel::IndexedRowCount() const
 {
-  auto id = this->sourceModel()->index(_srcRow, 0, _srcParent);
+  return static_cast<int>(this->dataPtr->nodes.size());
+}
 
-  return (this->sourceModel()->data(id,
-      this->filterRole()).toString().contains(_word, Qt::CaseInsensitive));
+/////////////////////////////////////////////////
+int SearchModel::TestedTextCount() const
+{
+  return this->dataPtr->last ? this->dataPtr->last->tested : 0;
+}
+
+/////////////////////////////////////////////////
+void SearchModel::SetBackgroundThreshold(const int _rows)
+{
+  this->dataPtr->backgroundThreshold = _rows;
+}
+
+/////////////////////////////////////////////////
+int SearchModel::BackgroundThreshold() const
+{
+  return this->dataPtr->backgroundThreshold;
+}
+
+/////////////////////////////////////////////////
+bool SearchModel::Searching() const
+{
+  return this->dataPtr->pending;
 }
 
 /////////////////////////////////////////////////
@@ -125,28 +573,67 @@ bool SearchModel::HasAcceptedChildren(const int _srcRow,
 }
 
 /////////////////////////////////////////////////
-bool SearchModel::HasChildAcceptsItself(const QModelIndex &_srcParent,
-      const QString &_word) const
+void SearchModel::SetSearch(const QString &_search)
 {
-  for (int i = 0; i < this->sourceModel()->rowCount(_srcParent); ++i)
+  this->search = _search;
+  this->dataPtr->searched = false;
+  this->dataPtr->pending = false;
+  auto expected = ++this->dataPtr->generation;
+
+  // Large models are searched on a worker, and the result is applied in a
+  // single layout change once it's ready. Results of searches which have
+  // been superseded by then are dropped.
+  auto model = this->sourceModel();
+  auto workers = App() ? App()->Workers() : nullptr;
+  if (model && workers && this->dataPtr->backgroundThreshold > 0 &&
+      !_search.trimmed().isEmpty())
   {
-    // Check immediate children.
-    if (this->FilterAcceptsRowItself(i, _srcParent, _word))
-      return true;
+    if (this->dataPtr->dirty || this->dataPtr->role != this->filterRole())
+      this->dataPtr->Build(model, this->filterRole());
 
-    // Check grandchildren.
-    auto item = this->sourceModel()->index(i, 0, _srcParent);
-    if (this->HasChildAcceptsItself(item, _word))
-      return true;
-  }
+    // Searching again for the latest result only needs it reapplied
+    auto last = this->dataPtr->last;
+    if (this->IndexedRowCount() >= this->dataPtr->backgroundThreshold &&
+        !(last && last->search == _search))
+    {
+      this->dataPtr->pending = true;
 
-  return false;
-}
+      auto index = this->dataPtr->index;
+      workers->Post([this, index, last, _search, expected]()
+      {
+        auto result = searchIndex(*index, _search, last,
+            this->dataPtr->generation, expected);
+        if (!result)
+          return;
 
-/////////////////////////////////////////////////
-void SearchModel::SetSearch(const QString &_search)
-{
-  this->search = _search;
+        auto apply = [this, index, result, expected]()
+        {
+          if (!this->dataPtr->pending ||
+              this->dataPtr->generation != expected)
+          {
+            return;
+          }
+
+          // Reindexed meanwhile, filter on this thread instead
+          if (index == this->dataPtr->index)
+            this->dataPtr->Apply(this->sourceModel(), result);
+          this->dataPtr->pending = false;
+
+          this->invalidateFilter();
+          this->layoutChanged();
+        };
+
+        // The model is alive while its tasks run, and calls it posted are
+        // cancelled when it's destroyed
+        auto dispatcher = App() ? App()->Dispatcher() : nullptr;
+        if (dispatcher)
+          dispatcher->Post(this, apply, DeliveryLane::kControl);
+        else
+          QMetaObject::invokeMethod(this, apply, Qt::QueuedConnection);
+      }, TaskPriority::kHigh, this);
+      return;
+    }
+  }
 
   // Trigger repaint on whole model
   this->invalidateFilter();
@@ -155,4 +642,3 @@ void SearchModel::SetSearch(const QString &_search)
   // TopicsStats
   this->layoutChanged();
 }
-
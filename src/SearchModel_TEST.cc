@@ -17,16 +17,23 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <thread>
+
 #include <ignition/common/Console.hh>
 
 #include "test_config.h"  // NOLINT(build/include)
 
+#include "ignition/gui/Application.hh"
 #include "ignition/gui/Enums.hh"
 #include "ignition/gui/SearchModel.hh"
 
 using namespace ignition;
 using namespace gui;
 
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
 /////////////////////////////////////////////////
 /// Helper function to count the rows of a nested model
 int countRowsOfIndex(const QModelIndex &_index = QModelIndex())
@@ -173,3 +180,249 @@ TEST(SearchModelTest, NestedStructure)
   }
 }
 
+
+/////////////////////////////////////////////////
+TEST(SearchModelTest, SourceChanges)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  // - robot
+  // -- link
+  // --- visual
+  // - box
+  auto sourceModel = new QStandardItemModel();
+
+  auto robot = new QStandardItem();
+  robot->setData("robot", DataRole::DISPLAY_NAME);
+  sourceModel->appendRow(robot);
+
+  auto link = new QStandardItem();
+  link->setData("link", DataRole::DISPLAY_NAME);
+  robot->appendRow(link);
+
+  auto visual = new QStandardItem();
+  visual->setData("visual", DataRole::DISPLAY_NAME);
+  link->appendRow(visual);
+
+  auto box = new QStandardItem();
+  box->setData("box", DataRole::DISPLAY_NAME);
+  sourceModel->appendRow(box);
+
+  auto searchModel = new SearchModel();
+  searchModel->setFilterRole(DataRole::DISPLAY_NAME);
+  searchModel->setSourceModel(sourceModel);
+
+  // Not indexed until there's something to search for
+  EXPECT_EQ(2, searchModel->rowCount());
+  EXPECT_EQ(0, searchModel->IndexedRowCount());
+
+  // Words are case insensitive, and ancestors are expanded
+  searchModel->SetSearch("VIS");
+  EXPECT_EQ(4, searchModel->IndexedRowCount());
+  ASSERT_EQ(1, searchModel->rowCount());
+  auto id = searchModel->index(0, 0);
+  EXPECT_EQ(QString("robot"),
+      searchModel->data(id, DataRole::DISPLAY_NAME).toString());
+  EXPECT_TRUE(robot->data(DataRole::TO_EXPAND).toBool());
+  EXPECT_TRUE(link->data(DataRole::TO_EXPAND).toBool());
+  EXPECT_FALSE(visual->data(DataRole::TO_EXPAND).toBool());
+
+  // Rows added while searching are indexed
+  auto sphere = new QStandardItem();
+  sphere->setData("visual_sphere", DataRole::DISPLAY_NAME);
+  box->appendRow(sphere);
+  searchModel->SetSearch("visual");
+  EXPECT_EQ(5, searchModel->IndexedRowCount());
+  EXPECT_EQ(2, searchModel->rowCount());
+  EXPECT_TRUE(box->data(DataRole::TO_EXPAND).toBool());
+
+  // Renamed rows are reindexed
+  sphere->setData("collision", DataRole::DISPLAY_NAME);
+  searchModel->SetSearch("visual");
+  EXPECT_EQ(1, searchModel->rowCount());
+  EXPECT_FALSE(box->data(DataRole::TO_EXPAND).toBool());
+
+  // Removed rows are dropped from the index
+  sourceModel->removeRow(1);
+  searchModel->SetSearch("box");
+  EXPECT_EQ(3, searchModel->IndexedRowCount());
+  EXPECT_EQ(0, searchModel->rowCount());
+
+  // Clearing the search collapses everything
+  searchModel->SetSearch("");
+  EXPECT_EQ(1, searchModel->rowCount());
+  EXPECT_FALSE(robot->data(DataRole::TO_EXPAND).toBool());
+  EXPECT_FALSE(link->data(DataRole::TO_EXPAND).toBool());
+}
+
+/////////////////////////////////////////////////
+TEST(SearchModelTest, DeepStructure)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  // A chain of 2000 rows, with a title halfway
+  auto sourceModel = new QStandardItemModel();
+  auto parent = sourceModel->invisibleRootItem();
+  QStandardItem *title{nullptr};
+  for (int i = 0; i < 2000; ++i)
+  {
+    auto it = new QStandardItem();
+    it->setData(QString("row_%1").arg(i), DataRole::DISPLAY_NAME);
+    if (i == 1000)
+    {
+      it->setData("title", DataRole::TYPE);
+      title = it;
+    }
+    parent->appendRow(it);
+    parent = it;
+  }
+
+  auto searchModel = new SearchModel();
+  searchModel->setFilterRole(DataRole::DISPLAY_NAME);
+  searchModel->setSourceModel(sourceModel);
+
+  // Only found under the title, which is never accepted
+  searchModel->SetSearch("row_1999");
+  EXPECT_EQ(0, searchModel->rowCount());
+
+  // Found above the title, the top row is expanded
+  searchModel->SetSearch("row_999");
+  ASSERT_EQ(1, searchModel->rowCount());
+  EXPECT_TRUE(sourceModel->item(0)->data(DataRole::TO_EXPAND).toBool());
+  EXPECT_FALSE(title->data(DataRole::TO_EXPAND).toBool());
+
+  // All words must be on the path, in any order
+  searchModel->SetSearch("row_5 row_3");
+  EXPECT_EQ(1, searchModel->rowCount());
+  searchModel->SetSearch("row_5 banana");
+  EXPECT_EQ(0, searchModel->rowCount());
+}
+
+/////////////////////////////////////////////////
+/// \brief Build a model with a row per model and a link below each.
+/// \param[in] _count Number of models.
+/// \return Model, owned by the caller.
+QStandardItemModel *buildModels(const int _count)
+{
+  auto sourceModel = new QStandardItemModel();
+  for (int i = 0; i < _count; ++i)
+  {
+    auto model = new QStandardItem();
+    model->setData(QString("model_%1").arg(i), DataRole::DISPLAY_NAME);
+    sourceModel->appendRow(model);
+
+    auto link = new QStandardItem();
+    link->setData(QString("link_%1").arg(i % 10), DataRole::DISPLAY_NAME);
+    model->appendRow(link);
+  }
+  return sourceModel;
+}
+
+/////////////////////////////////////////////////
+TEST(SearchModelTest, Narrowing)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  // 100 model names and 10 link names
+  auto sourceModel = buildModels(100);
+
+  auto searchModel = new SearchModel();
+  searchModel->setFilterRole(DataRole::DISPLAY_NAME);
+  searchModel->setSourceModel(sourceModel);
+  EXPECT_EQ(0, searchModel->TestedTextCount());
+
+  // The first search tests every text
+  searchModel->SetSearch("model_1");
+  EXPECT_EQ(11, searchModel->rowCount());
+  EXPECT_EQ(110, searchModel->TestedTextCount());
+
+  // Extending it only tests what matched
+  searchModel->SetSearch("model_12");
+  EXPECT_EQ(1, searchModel->rowCount());
+  EXPECT_EQ(11, searchModel->TestedTextCount());
+
+  // Added words are tested against everything, kept words aren't retested
+  searchModel->SetSearch("model_12 link");
+  EXPECT_EQ(1, searchModel->rowCount());
+  EXPECT_EQ(110, searchModel->TestedTextCount());
+  EXPECT_TRUE(sourceModel->item(12)->data(DataRole::TO_EXPAND).toBool());
+
+  searchModel->SetSearch("model_12 link_2");
+  EXPECT_EQ(1, searchModel->rowCount());
+  EXPECT_EQ(10, searchModel->TestedTextCount());
+
+  searchModel->SetSearch("model_12 link_3");
+  EXPECT_EQ(0, searchModel->rowCount());
+  EXPECT_EQ(110, searchModel->TestedTextCount());
+
+  // Shorter words can match texts the previous search didn't
+  searchModel->SetSearch("model_1");
+  EXPECT_EQ(11, searchModel->rowCount());
+  EXPECT_EQ(110, searchModel->TestedTextCount());
+
+  delete searchModel;
+  delete sourceModel;
+}
+
+/////////////////////////////////////////////////
+TEST(SearchModelTest, Background)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+
+  auto sourceModel = buildModels(1000);
+
+  auto searchModel = new SearchModel();
+  searchModel->setFilterRole(DataRole::DISPLAY_NAME);
+  searchModel->setSourceModel(sourceModel);
+
+  // Below the threshold, searches are done right away
+  EXPECT_EQ(20000, searchModel->BackgroundThreshold());
+  searchModel->SetSearch("model_99");
+  EXPECT_FALSE(searchModel->Searching());
+  EXPECT_EQ(11, searchModel->rowCount());
+
+  auto waitForSearch = [&]()
+  {
+    for (int i = 0; i < 500 && searchModel->Searching(); ++i)
+    {
+      QCoreApplication::processEvents();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return !searchModel->Searching();
+  };
+
+  // Above it, the previous result is kept until the new one is applied
+  searchModel->SetBackgroundThreshold(1000);
+  searchModel->SetSearch("model_999 link_9");
+  EXPECT_TRUE(searchModel->Searching());
+  EXPECT_EQ(11, searchModel->rowCount());
+
+  ASSERT_TRUE(waitForSearch());
+  EXPECT_EQ(1, searchModel->rowCount());
+  EXPECT_TRUE(sourceModel->item(999)->data(DataRole::TO_EXPAND).toBool());
+  EXPECT_FALSE(sourceModel->item(99)->data(DataRole::TO_EXPAND).toBool());
+
+  // Only the latest of several quick searches is applied
+  searchModel->SetSearch("link_1");
+  searchModel->SetSearch("link_2");
+  searchModel->SetSearch("link_3");
+  ASSERT_TRUE(waitForSearch());
+  EXPECT_EQ(100, searchModel->rowCount());
+  EXPECT_TRUE(sourceModel->item(3)->data(DataRole::TO_EXPAND).toBool());
+  EXPECT_FALSE(sourceModel->item(2)->data(DataRole::TO_EXPAND).toBool());
+
+  // Clearing the search doesn't wait
+  searchModel->SetSearch("");
+  EXPECT_FALSE(searchModel->Searching());
+  EXPECT_EQ(1000, searchModel->rowCount());
+
+  // Destroyed while searching
+  searchModel->SetSearch("model");
+  EXPECT_TRUE(searchModel->Searching());
+  delete searchModel;
+  QCoreApplication::processEvents();
+
+  delete sourceModel;
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <cstring>
+
+#include <ignition/common/Console.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gui/qt.h"
+#include "ignition/gui/SharedImage.hh"
+#include "ignition/gui/SharedRing.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief Key of the header data holding the ring's key
+    static const char kSharedImageKey[] = "shared_memory";
+
+    class SharedImagePublisherPrivate
+    {
+      /// \brief Ring holding the pixels
+      public: SharedRing ring;
+
+      /// \brief Node used to advertise the topic
+      public: transport::Node node;
+
+      /// \brief Publishes notifications
+      public: transport::Node::Publisher publisher;
+
+      /// \brief Notification, reused to avoid allocations
+      public: msgs::Image notification;
+
+      /// \brief Slot returned by BeginImage
+      public: char *slot{nullptr};
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+SharedImagePublisher::SharedImagePublisher()
+  : dataPtr(new SharedImagePublisherPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+SharedImagePublisher::~SharedImagePublisher()
+{
+}
+
+/////////////////////////////////////////////////
+bool SharedImagePublisher::Advertise(const std::string &_topic,
+    const std::size_t _maxImageBytes, const std::size_t _slotCount)
+{
+  if (this->dataPtr->ring.Valid())
+  {
+    ignerr << "Shared image publisher already advertised." << std::endl;
+    return false;
+  }
+
+  static std::atomic<unsigned int> publisherCount{0u};
+  auto key = "ign_gui_image_" +
+      std::to_string(QCoreApplication::applicationPid()) + "_" +
+      std::to_string(publisherCount++);
+
+  // Subscribers are notified through the topic
+  if (!this->dataPtr->ring.Create(key, _slotCount,
+      sizeof(SharedImageHeader) + _maxImageBytes, false))
+  {
+    return false;
+  }
+
+  this->dataPtr->publisher =
+      this->dataPtr->node.Advertise<msgs::Image>(_topic);
+  if (!this->dataPtr->publisher)
+  {
+    ignerr << "Failed to advertise shared images on [" << _topic << "]"
+           << std::endl;
+    return false;
+  }
+
+  auto data = this->dataPtr->notification.mutable_header()->add_data();
+  data->set_key(kSharedImageKey);
+  data->add_value(key);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool SharedImagePublisher::Publish(const msgs::Image &_msg)
+{
+  if (!this->dataPtr->ring.Valid())
+  {
+    ignerr << "Advertise before publishing shared images." << std::endl;
+    return false;
+  }
+
+  auto maxBytes = this->dataPtr->ring.SlotSize() - sizeof(SharedImageHeader);
+  if (_msg.data().size() > maxBytes)
+  {
+    ignerr << "Image of [" << _msg.data().size() << "] bytes is larger than "
+           << "the [" << maxBytes << "] bytes advertised." << std::endl;
+    return false;
+  }
+
+  auto pixels = this->BeginImage();
+  if (!pixels)
+    return false;
+
+  std::memcpy(pixels, _msg.data().data(), _msg.data().size());
+
+  SharedImageHeader header;
+  header.width = _msg.width();
+  header.height = _msg.height();
+  header.step = _msg.step() > 0u || _msg.height() == 0u ? _msg.step() :
+      static_cast<uint32_t>(_msg.data().size() / _msg.height());
+  header.pixelFormat = _msg.pixel_format_type();
+  header.sec = _msg.header().stamp().sec();
+  header.nsec = _msg.header().stamp().nsec();
+
+  return this->EndImage(header);
+}
+
+/////////////////////////////////////////////////
+void *SharedImagePublisher::BeginImage()
+{
+  this->dataPtr->slot = static_cast<char *>(this->dataPtr->ring.BeginWrite());
+  if (!this->dataPtr->slot)
+    return nullptr;
+
+  return this->dataPtr->slot + sizeof(SharedImageHeader);
+}
+
+/////////////////////////////////////////////////
+bool SharedImagePublisher::EndImage(const SharedImageHeader &_header)
+{
+  if (!this->dataPtr->slot)
+    return false;
+
+  auto slot = this->dataPtr->slot;
+  this->dataPtr->slot = nullptr;
+
+  auto size = sizeof(SharedImageHeader) +
+      static_cast<std::size_t>(_header.step) * _header.height;
+  if (size > this->dataPtr->ring.SlotSize())
+  {
+    ignerr << "Image of [" << size - sizeof(SharedImageHeader)
+           << "] bytes is larger than the ["
+           << this->dataPtr->ring.SlotSize() - sizeof(SharedImageHeader)
+           << "] bytes advertised." << std::endl;
+    this->dataPtr->ring.AbortWrite();
+    return false;
+  }
+
+  // The header goes right before the pixels
+  std::memcpy(slot, &_header, sizeof(_header));
+  if (!this->dataPtr->ring.EndWrite(size))
+    return false;
+
+  // Subscribers only get what they need to tell images apart and find the
+  // pixels
+  auto &msg = this->dataPtr->notification;
+  msg.set_width(_header.width);
+  msg.set_height(_header.height);
+  msg.set_step(_header.step);
+  msg.set_pixel_format_type(
+      static_cast<msgs::PixelFormatType>(_header.pixelFormat));
+  msg.mutable_header()->mutable_stamp()->set_sec(_header.sec);
+  msg.mutable_header()->mutable_stamp()->set_nsec(_header.nsec);
+
+  return this->dataPtr->publisher.Publish(msg);
+}
+
+/////////////////////////////////////////////////
+std::string SharedImagePublisher::Key() const
+{
+  return this->dataPtr->ring.Key();
+}
+
+/////////////////////////////////////////////////
+uint64_t SharedImagePublisher::DroppedCount() const
+{
+  return this->dataPtr->ring.DroppedCount();
+}
+
+/////////////////////////////////////////////////
+std::string ignition::gui::SharedImageKey(const msgs::Image &_msg)
+{
+  if (!_msg.data().empty())
+    return std::string();
+
+  for (const auto &data : _msg.header().data())
+  {
+    if (data.key() == kSharedImageKey && data.value_size() > 0)
+      return data.value(0);
+  }
+  return std::string();
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include <ignition/common/Console.hh>
+#include <ignition/msgs/image.pb.h>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/SharedImage.hh"
+#include "ignition/gui/SharedRing.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(SharedImageTest, Publish)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  msgs::Image msg;
+  msg.set_width(4);
+  msg.set_height(2);
+  msg.set_pixel_format_type(msgs::PixelFormatType::L_INT8);
+  msg.mutable_header()->mutable_stamp()->set_sec(10);
+  msg.mutable_header()->mutable_stamp()->set_nsec(20);
+  msg.set_data("abcdefgh");
+
+  // Regular images have no key
+  EXPECT_TRUE(SharedImageKey(msg).empty());
+
+  SharedImagePublisher pub;
+  EXPECT_TRUE(pub.Key().empty());
+
+  // Not advertised
+  EXPECT_FALSE(pub.Publish(msg));
+
+  ASSERT_TRUE(pub.Advertise("/shared_image_test", 8u, 2u));
+  EXPECT_FALSE(pub.Key().empty());
+
+  // Already advertised
+  EXPECT_FALSE(pub.Advertise("/shared_image_test", 8u, 2u));
+
+  SharedRing ring;
+  ASSERT_TRUE(ring.Attach(pub.Key()));
+
+  EXPECT_TRUE(pub.Publish(msg));
+
+  std::size_t size{0u};
+  auto data = static_cast<const char *>(ring.BeginRead(size));
+  ASSERT_NE(nullptr, data);
+  ASSERT_EQ(sizeof(SharedImageHeader) + 8u, size);
+
+  SharedImageHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  EXPECT_EQ(4u, header.width);
+  EXPECT_EQ(2u, header.height);
+  EXPECT_EQ(4u, header.step);
+  EXPECT_EQ(msgs::PixelFormatType::L_INT8, header.pixelFormat);
+  EXPECT_EQ(10, header.sec);
+  EXPECT_EQ(20, header.nsec);
+  EXPECT_EQ("abcdefgh",
+      std::string(data + sizeof(SharedImageHeader), size - sizeof(header)));
+  ring.EndRead();
+
+  // Too large
+  msg.set_height(3);
+  msg.set_data("abcdefghijkl");
+  EXPECT_FALSE(pub.Publish(msg));
+
+  // In place
+  auto pixels = static_cast<char *>(pub.BeginImage());
+  ASSERT_NE(nullptr, pixels);
+  std::memcpy(pixels, "ijklmnop", 8u);
+  header.nsec = 30;
+  EXPECT_TRUE(pub.EndImage(header));
+
+  data = static_cast<const char *>(ring.BeginRead(size));
+  ASSERT_NE(nullptr, data);
+  std::memcpy(&header, data, sizeof(header));
+  EXPECT_EQ(30, header.nsec);
+  EXPECT_EQ("ijklmnop",
+      std::string(data + sizeof(SharedImageHeader), size - sizeof(header)));
+  ring.EndRead();
+
+  // The oldest images are overwritten
+  msg.set_height(2);
+  msg.set_data("abcdefgh");
+  EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_TRUE(pub.Publish(msg));
+  EXPECT_EQ(0u, pub.DroppedCount());
+
+  // Unless subscribers are reading every slot
+  SharedRing otherRing;
+  ASSERT_TRUE(otherRing.Attach(pub.Key()));
+  ASSERT_NE(nullptr, ring.BeginRead(size));
+  ASSERT_NE(nullptr, otherRing.BeginRead(size, true));
+  EXPECT_FALSE(pub.Publish(msg));
+  EXPECT_EQ(1u, pub.DroppedCount());
+  ring.EndRead();
+  otherRing.EndRead();
+}
@@ -0,0 +1,592 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gui/qt.h"
+#include "ignition/gui/SharedRing.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief Identifies a valid ring
+    static constexpr uint32_t kRingMagic = 0x49475252;
+
+    /// \brief Layout version, bumped whenever the header changes
+    static constexpr uint32_t kRingVersion = 2;
+
+    /// \brief Set in a slot's state while the writer fills it. The other
+    /// bits count the readers holding the slot.
+    static constexpr uint64_t kSlotWriting = 1ull << 63;
+
+    /// \brief Alignment of the header fields and slots, so that the reader
+    /// and writer don't share cache lines and slot data is well aligned.
+    static constexpr std::size_t kRingAlign = 64;
+
+    // The counters are shared between processes, which requires them to be
+    // lock-free.
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+        "SharedRing requires lock-free 64-bit atomics");
+
+    /// \brief Header at the start of the shared memory
+    struct SharedRingHeader
+    {
+      /// \brief Set to kRingMagic once the ring is initialized
+      uint32_t magic{0u};
+
+      /// \brief Set to kRingVersion
+      uint32_t version{0u};
+
+      /// \brief Number of slots
+      uint64_t slotCount{0u};
+
+      /// \brief Maximum number of bytes per slot
+      uint64_t slotSize{0u};
+
+      /// \brief 1 if writes release the notification semaphore
+      uint64_t notify{0u};
+
+      /// \brief Sequence number of the latest write published, zero
+      /// before the first one. Only changed by the writer.
+      alignas(kRingAlign) std::atomic<uint64_t> head{0u};
+
+      /// \brief Number of writes dropped
+      alignas(kRingAlign) std::atomic<uint64_t> dropped{0u};
+    };
+
+    /// \brief Header of each slot, followed by the slot's data
+    struct alignas(kRingAlign) SharedRingSlot
+    {
+      /// \brief kSlotWriting while being written, otherwise the number of
+      /// readers holding the slot. The writer only takes slots which no
+      /// reader holds.
+      std::atomic<uint64_t> state{0u};
+
+      /// \brief Sequence number of the write held, zero if never written
+      std::atomic<uint64_t> sequence{0u};
+
+      /// \brief Number of bytes used
+      uint64_t size{0u};
+    };
+
+    class SharedRingPrivate
+    {
+      /// \brief Get a slot's header.
+      /// \param[in] _index Slot index, wrapped around the slot count.
+      /// \return Slot header, followed by its data.
+      public: SharedRingSlot *Slot(const uint64_t _index) const;
+
+      /// \brief Find the unread slot holding the oldest or the latest write.
+      /// Slots being written are skipped, since their previous write is
+      /// being overwritten.
+      /// \param[in] _latest True for the latest write.
+      /// \param[out] _sequence Sequence number of the write.
+      /// \return Slot index, or the slot count if there's nothing to read.
+      public: uint64_t FindUnread(const bool _latest, uint64_t &_sequence)
+          const;
+
+      /// \brief Open the notification semaphore.
+      /// \param[in] _create True to reset it, false to open it.
+      public: void OpenSemaphore(const bool _create);
+
+      /// \brief Shared memory holding the header and slots
+      public: QSharedMemory memory;
+
+      /// \brief Released on every write
+      public: std::unique_ptr<QSystemSemaphore> semaphore;
+
+      /// \brief Header, null while invalid
+      public: SharedRingHeader *header{nullptr};
+
+      /// \brief Distance between two slots, in bytes
+      public: std::size_t stride{0u};
+
+      /// \brief Slot being written, only used by the writer
+      public: uint64_t writing{0u};
+
+      /// \brief True between BeginWrite and EndWrite
+      public: bool inWrite{false};
+
+      /// \brief Slots the writer failed to take during BeginWrite, kept to
+      /// reuse their capacity
+      public: std::vector<bool> taken;
+
+      /// \brief Slot being read, only used by readers
+      public: uint64_t reading{0u};
+
+      /// \brief True between BeginRead and EndRead
+      public: bool inRead{false};
+
+      /// \brief Sequence number of the latest write this reader has read.
+      /// Each reader has its own, so readers don't steal slots from each
+      /// other.
+      public: uint64_t cursor{0u};
+
+      /// \brief Number of writes this reader skipped
+      public: uint64_t skipped{0u};
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Round up to the ring's alignment
+/// \param[in] _size Size in bytes.
+/// \return Aligned size.
+static std::size_t aligned(const std::size_t _size)
+{
+  return (_size + kRingAlign - 1) / kRingAlign * kRingAlign;
+}
+
+/////////////////////////////////////////////////
+SharedRingSlot *SharedRingPrivate::Slot(const uint64_t _index) const
+{
+  auto base = reinterpret_cast<char *>(this->header) +
+      aligned(sizeof(SharedRingHeader));
+  return reinterpret_cast<SharedRingSlot *>(
+      base + (_index % this->header->slotCount) * this->stride);
+}
+
+/////////////////////////////////////////////////
+uint64_t SharedRingPrivate::FindUnread(const bool _latest,
+    uint64_t &_sequence) const
+{
+  auto count = this->header->slotCount;
+  auto found = count;
+  _sequence = 0u;
+  for (uint64_t i = 0; i < count; ++i)
+  {
+    auto slot = this->Slot(i);
+    if (slot->state.load(std::memory_order_acquire) & kSlotWriting)
+      continue;
+
+    auto sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence <= this->cursor)
+      continue;
+
+    if (found == count ||
+        (_latest ? sequence > _sequence : sequence < _sequence))
+    {
+      found = i;
+      _sequence = sequence;
+    }
+  }
+  return found;
+}
+
+/////////////////////////////////////////////////
+void SharedRingPrivate::OpenSemaphore(const bool _create)
+{
+  this->semaphore = std::make_unique<QSystemSemaphore>(
+      this->memory.key() + "_notify", 0,
+      _create ? QSystemSemaphore::Create : QSystemSemaphore::Open);
+
+  if (this->semaphore->error() != QSystemSemaphore::NoError)
+  {
+    ignwarn << "Failed to open notification semaphore of shared ring ["
+            << this->memory.key().toStdString() << "]: "
+            << this->semaphore->errorString().toStdString()
+            << ". The reader will have to poll." << std::endl;
+    this->semaphore.reset();
+  }
+}
+
+/////////////////////////////////////////////////
+SharedRing::SharedRing()
+  : dataPtr(new SharedRingPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+SharedRing::~SharedRing()
+{
+  this->dataPtr->header = nullptr;
+  if (this->dataPtr->memory.isAttached())
+    this->dataPtr->memory.detach();
+}
+
+/////////////////////////////////////////////////
+bool SharedRing::Create(const std::string &_key, const std::size_t _slotCount,
+    const std::size_t _slotSize, const bool _notify)
+{
+  if (this->Valid())
+  {
+    ignerr << "Shared ring [" << this->Key() << "] already created."
+           << std::endl;
+    return false;
+  }
+
+  if (_key.empty() || _slotCount < 2u || _slotSize == 0u)
+  {
+    ignerr << "Invalid shared ring [" << _key << "], it needs a key, at "
+           << "least 2 slots and a positive slot size." << std::endl;
+    return false;
+  }
+
+  // QSharedMemory sizes are ints
+  const std::size_t maxTotal = std::numeric_limits<int>::max();
+  auto headerSize = aligned(sizeof(SharedRingHeader));
+  auto slotHeaderSize = aligned(sizeof(SharedRingSlot));
+  if (_slotSize > maxTotal - slotHeaderSize - kRingAlign ||
+      _slotCount > (maxTotal - headerSize) /
+      (slotHeaderSize + aligned(_slotSize)))
+  {
+    ignerr << "Shared ring [" << _key << "] of [" << _slotCount
+           << "] slots of [" << _slotSize << "] bytes is too large, the "
+           << "total must be under [" << maxTotal << "] bytes." << std::endl;
+    return false;
+  }
+
+  auto stride = slotHeaderSize + aligned(_slotSize);
+  auto total = headerSize + _slotCount * stride;
+
+  this->dataPtr->memory.setKey(QString::fromStdString(_key));
+  if (!this->dataPtr->memory.create(static_cast<int>(total)))
+  {
+    // A process which crashed may have left the segment behind, it's
+    // released once the last process detaches from it.
+    if (this->dataPtr->memory.error() == QSharedMemory::AlreadyExists &&
+        this->dataPtr->memory.attach())
+    {
+      this->dataPtr->memory.detach();
+      this->dataPtr->memory.create(static_cast<int>(total));
+    }
+
+    if (!this->dataPtr->memory.isAttached())
+    {
+      ignerr << "Failed to create shared ring [" << _key << "] of ["
+             << total << "] bytes: "
+             << this->dataPtr->memory.errorString().toStdString()
+             << std::endl;
+      return false;
+    }
+  }
+
+  auto header = new (this->dataPtr->memory.data()) SharedRingHeader;
+  header->slotCount = _slotCount;
+  header->slotSize = _slotSize;
+  header->notify = _notify ? 1u : 0u;
+
+  this->dataPtr->header = header;
+  this->dataPtr->stride = stride;
+  for (std::size_t i = 0; i < _slotCount; ++i)
+    new (this->dataPtr->Slot(i)) SharedRingSlot;
+  this->dataPtr->taken.resize(_slotCount);
+
+  // Readers check these last
+  header->version = kRingVersion;
+  header->magic = kRingMagic;
+  if (_notify)
+    this->dataPtr->OpenSemaphore(true);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool SharedRing::Attach(const std::string &_key)
+{
+  if (this->Valid())
+  {
+    ignerr << "Shared ring [" << this->Key() << "] already attached."
+           << std::endl;
+    return false;
+  }
+
+  this->dataPtr->memory.setKey(QString::fromStdString(_key));
+  if (!this->dataPtr->memory.attach())
+  {
+    ignerr << "Failed to attach to shared ring [" << _key << "]: "
+           << this->dataPtr->memory.errorString().toStdString() << std::endl;
+    return false;
+  }
+
+  auto header =
+      reinterpret_cast<SharedRingHeader *>(this->dataPtr->memory.data());
+  if (static_cast<std::size_t>(this->dataPtr->memory.size()) <
+      sizeof(SharedRingHeader) || header->magic != kRingMagic ||
+      header->version != kRingVersion)
+  {
+    ignerr << "Shared memory [" << _key << "] isn't a compatible ring."
+           << std::endl;
+    this->dataPtr->memory.detach();
+    return false;
+  }
+
+  this->dataPtr->header = header;
+  this->dataPtr->stride = aligned(sizeof(SharedRingSlot)) +
+      aligned(header->slotSize);
+  this->dataPtr->taken.resize(header->slotCount);
+  if (header->notify)
+    this->dataPtr->OpenSemaphore(false);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool SharedRing::Valid() const
+{
+  return nullptr != this->dataPtr->header;
+}
+
+/////////////////////////////////////////////////
+std::string SharedRing::Key() const
+{
+  if (!this->Valid())
+    return std::string();
+
+  return this->dataPtr->memory.key().toStdString();
+}
+
+/////////////////////////////////////////////////
+std::size_t SharedRing::SlotCount() const
+{
+  return this->Valid() ? this->dataPtr->header->slotCount : 0u;
+}
+
+/////////////////////////////////////////////////
+std::size_t SharedRing::SlotSize() const
+{
+  return this->Valid() ? this->dataPtr->header->slotSize : 0u;
+}
+
+/////////////////////////////////////////////////
+void *SharedRing::BeginWrite()
+{
+  if (!this->Valid() || this->dataPtr->inWrite)
+    return nullptr;
+
+  // Overwrite the oldest write which no reader holds. A reader may grab a
+  // slot between looking at it and taking it, in which case the next
+  // oldest is tried.
+  auto header = this->dataPtr->header;
+  auto count = header->slotCount;
+  auto &taken = this->dataPtr->taken;
+  std::fill(taken.begin(), taken.end(), false);
+  while (true)
+  {
+    auto oldest = count;
+    uint64_t oldestSequence{0u};
+    for (uint64_t i = 0; i < count; ++i)
+    {
+      auto slot = this->dataPtr->Slot(i);
+      if (taken[i] || slot->state.load(std::memory_order_relaxed) != 0u)
+        continue;
+
+      auto sequence = slot->sequence.load(std::memory_order_relaxed);
+      if (oldest == count || sequence < oldestSequence)
+      {
+        oldest = i;
+        oldestSequence = sequence;
+      }
+    }
+
+    // Readers hold every slot
+    if (oldest == count)
+    {
+      header->dropped.fetch_add(1u, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    uint64_t expected{0u};
+    if (this->dataPtr->Slot(oldest)->state.compare_exchange_strong(expected,
+        kSlotWriting, std::memory_order_acquire))
+    {
+      this->dataPtr->writing = oldest;
+      this->dataPtr->inWrite = true;
+      return reinterpret_cast<char *>(this->dataPtr->Slot(oldest)) +
+          aligned(sizeof(SharedRingSlot));
+    }
+    taken[oldest] = true;
+  }
+}
+
+/////////////////////////////////////////////////
+bool SharedRing::EndWrite(const std::size_t _size)
+{
+  if (!this->Valid() || !this->dataPtr->inWrite)
+    return false;
+
+  auto header = this->dataPtr->header;
+  if (_size > header->slotSize)
+  {
+    ignerr << "Wrote [" << _size << "] bytes to shared ring [" << this->Key()
+           << "], which only has [" << header->slotSize << "] per slot."
+           << std::endl;
+    this->AbortWrite();
+    return false;
+  }
+
+  this->dataPtr->inWrite = false;
+
+  // The slot's contents are visible to readers which take it after this
+  auto sequence = header->head.load(std::memory_order_relaxed) + 1u;
+  auto slot = this->dataPtr->Slot(this->dataPtr->writing);
+  slot->size = _size;
+  slot->sequence.store(sequence, std::memory_order_relaxed);
+  slot->state.store(0u, std::memory_order_release);
+  header->head.store(sequence, std::memory_order_release);
+
+  if (this->dataPtr->semaphore)
+    this->dataPtr->semaphore->release();
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void SharedRing::AbortWrite()
+{
+  if (!this->Valid() || !this->dataPtr->inWrite)
+    return;
+
+  // The slot's previous contents may have been partly overwritten, so it's
+  // marked as never written
+  this->dataPtr->inWrite = false;
+  auto slot = this->dataPtr->Slot(this->dataPtr->writing);
+  slot->sequence.store(0u, std::memory_order_relaxed);
+  slot->state.store(0u, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+bool SharedRing::Write(const void *_data, const std::size_t _size)
+{
+  if (_size > this->SlotSize())
+  {
+    ignerr << "Can't write [" << _size << "] bytes to shared ring ["
+           << this->Key() << "], which only has [" << this->SlotSize()
+           << "] per slot." << std::endl;
+    return false;
+  }
+
+  auto slot = this->BeginWrite();
+  if (!slot)
+    return false;
+
+  std::memcpy(slot, _data, _size);
+  return this->EndWrite(_size);
+}
+
+/////////////////////////////////////////////////
+const void *SharedRing::BeginRead(std::size_t &_size, const bool _latest)
+{
+  _size = 0u;
+  if (!this->Valid() || this->dataPtr->inRead)
+    return nullptr;
+
+  auto header = this->dataPtr->header;
+  if (header->head.load(std::memory_order_acquire) <= this->dataPtr->cursor)
+    return nullptr;
+
+  // The writer may take the slot between finding it and holding it, in
+  // which case the next one is looked for. Each retry means the writer took
+  // a slot, so give up after as many as there are slots rather than racing
+  // a fast writer. Writes being overwritten are counted as skipped once a
+  // later one is read.
+  for (uint64_t attempt = 0; attempt <= header->slotCount; ++attempt)
+  {
+    uint64_t sequence{0u};
+    auto index = this->dataPtr->FindUnread(_latest, sequence);
+    if (index == header->slotCount)
+      return nullptr;
+
+    auto slot = this->dataPtr->Slot(index);
+    auto state = slot->state.load(std::memory_order_relaxed);
+    bool held{false};
+    while (!held && (state & kSlotWriting) == 0u)
+    {
+      held = slot->state.compare_exchange_weak(state, state + 1u,
+          std::memory_order_acquire);
+    }
+
+    if (!held)
+      continue;
+
+    if (slot->sequence.load(std::memory_order_relaxed) != sequence)
+    {
+      slot->state.fetch_sub(1u, std::memory_order_release);
+      continue;
+    }
+
+    // Writes which were overwritten, or skipped to get to the latest
+    this->dataPtr->skipped += sequence - this->dataPtr->cursor - 1u;
+    this->dataPtr->cursor = sequence;
+    this->dataPtr->reading = index;
+    this->dataPtr->inRead = true;
+
+    _size = std::min<std::size_t>(slot->size, header->slotSize);
+    return reinterpret_cast<const char *>(slot) +
+        aligned(sizeof(SharedRingSlot));
+  }
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+void SharedRing::EndRead()
+{
+  if (!this->Valid() || !this->dataPtr->inRead)
+    return;
+
+  this->dataPtr->inRead = false;
+  this->dataPtr->Slot(this->dataPtr->reading)->state.fetch_sub(1u,
+      std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+void SharedRing::Wait()
+{
+  if (this->dataPtr->semaphore)
+  {
+    this->dataPtr->semaphore->acquire();
+  }
+  else
+  {
+    // No semaphore, poll
+    QThread::msleep(5);
+  }
+}
+
+/////////////////////////////////////////////////
+void SharedRing::Wake()
+{
+  if (this->dataPtr->semaphore)
+    this->dataPtr->semaphore->release();
+}
+
+/////////////////////////////////////////////////
+uint64_t SharedRing::DroppedCount() const
+{
+  if (!this->Valid())
+    return 0u;
+
+  return this->dataPtr->header->dropped.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+uint64_t SharedRing::SkippedCount() const
+{
+  return this->dataPtr->skipped;
+}
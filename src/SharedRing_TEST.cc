@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/SharedRing.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Key unique to this test process
+/// \param[in] _name Test name
+/// \return Key
+std::string key(const std::string &_name)
+{
+  return "ign_gui_test_" + _name + "_" +
+      std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+/////////////////////////////////////////////////
+/// \brief Read one slot as a string
+/// \param[in] _ring Ring to read from
+/// \param[in] _latest Whether to skip to the latest slot
+/// \return Slot contents, empty if there was nothing to read
+std::string read(SharedRing &_ring, const bool _latest = false)
+{
+  std::size_t size{0u};
+  auto data = _ring.BeginRead(size, _latest);
+  if (!data)
+    return std::string();
+
+  std::string result(static_cast<const char *>(data), size);
+  _ring.EndRead();
+  return result;
+}
+
+/////////////////////////////////////////////////
+TEST(SharedRingTest, CreateAttach)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  SharedRing writer;
+  EXPECT_FALSE(writer.Valid());
+  EXPECT_EQ(nullptr, writer.BeginWrite());
+
+  // Invalid
+  EXPECT_FALSE(writer.Create(key("invalid"), 1u, 16u));
+  EXPECT_FALSE(writer.Create(key("invalid"), 2u, 0u));
+  EXPECT_FALSE(writer.Valid());
+
+  // Too large, including sizes which would overflow
+  EXPECT_FALSE(writer.Create(key("invalid"), 1024u, 4u << 20));
+  EXPECT_FALSE(writer.Create(key("invalid"), 2u,
+      std::numeric_limits<std::size_t>::max()));
+  EXPECT_FALSE(writer.Create(key("invalid"),
+      std::numeric_limits<std::size_t>::max(), 16u));
+  EXPECT_FALSE(writer.Valid());
+
+  ASSERT_TRUE(writer.Create(key("create"), 3u, 16u));
+  EXPECT_TRUE(writer.Valid());
+  EXPECT_EQ(key("create"), writer.Key());
+  EXPECT_EQ(3u, writer.SlotCount());
+  EXPECT_EQ(16u, writer.SlotSize());
+
+  // Missing
+  SharedRing missing;
+  EXPECT_FALSE(missing.Attach(key("missing")));
+  EXPECT_FALSE(missing.Valid());
+
+  SharedRing reader;
+  ASSERT_TRUE(reader.Attach(key("create")));
+  EXPECT_EQ(3u, reader.SlotCount());
+  EXPECT_EQ(16u, reader.SlotSize());
+}
+
+/////////////////////////////////////////////////
+TEST(SharedRingTest, WriteRead)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  SharedRing writer;
+  ASSERT_TRUE(writer.Create(key("write_read"), 3u, 16u));
+
+  SharedRing reader;
+  ASSERT_TRUE(reader.Attach(key("write_read")));
+
+  EXPECT_EQ("", read(reader));
+
+  EXPECT_TRUE(writer.Write("first", 5u));
+  EXPECT_TRUE(writer.Write("second", 6u));
+
+  // In place
+  auto slot = static_cast<char *>(writer.BeginWrite());
+  ASSERT_NE(nullptr, slot);
+  std::memcpy(slot, "third", 5u);
+  EXPECT_TRUE(writer.EndWrite(5u));
+
+  // Too large
+  EXPECT_FALSE(writer.Write("this doesn't fit in a slot", 26u));
+
+  EXPECT_EQ("first", read(reader));
+  EXPECT_EQ(0u, reader.SkippedCount());
+
+  // The oldest write is overwritten, the latest ones win
+  EXPECT_TRUE(writer.Write("fourth", 6u));
+  EXPECT_TRUE(writer.Write("fifth", 5u));
+  EXPECT_EQ(0u, writer.DroppedCount());
+
+  EXPECT_EQ("third", read(reader));
+  EXPECT_EQ(1u, reader.SkippedCount());
+  EXPECT_EQ("fourth", read(reader));
+  EXPECT_EQ("fifth", read(reader));
+  EXPECT_EQ("", read(reader));
+
+  // Aborted writes aren't read
+  ASSERT_NE(nullptr, writer.BeginWrite());
+  writer.AbortWrite();
+  EXPECT_EQ("", read(reader));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedRingTest, Latest)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  SharedRing writer;
+  ASSERT_TRUE(writer.Create(key("latest"), 4u, 16u));
+
+  SharedRing reader;
+  ASSERT_TRUE(reader.Attach(key("latest")));
+
+  EXPECT_TRUE(writer.Write("1", 1u));
+  EXPECT_TRUE(writer.Write("2", 1u));
+  EXPECT_TRUE(writer.Write("3", 1u));
+
+  EXPECT_EQ("3", read(reader, true));
+  EXPECT_EQ(2u, reader.SkippedCount());
+  EXPECT_EQ("", read(reader, true));
+
+  for (auto i = 0; i < 4; ++i)
+    EXPECT_TRUE(writer.Write("x", 1u));
+  EXPECT_EQ(0u, writer.DroppedCount());
+}
+
+/////////////////////////////////////////////////
+TEST(SharedRingTest, PublishBeforeReader)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  SharedRing writer;
+  ASSERT_TRUE(writer.Create(key("before_reader"), 3u, 16u));
+
+  for (auto data : {"1", "2", "3", "4"})
+    EXPECT_TRUE(writer.Write(data, 1u));
+
+  // Readers attaching late get what's still in the ring
+  SharedRing reader;
+  ASSERT_TRUE(reader.Attach(key("before_reader")));
+  EXPECT_EQ("2", read(reader));
+  EXPECT_EQ(1u, reader.SkippedCount());
+
+  SharedRing latestReader;
+  ASSERT_TRUE(latestReader.Attach(key("before_reader")));
+  EXPECT_EQ("4", read(latestReader, true));
+  EXPECT_EQ("", read(latestReader, true));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedRingTest, TwoReaders)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  SharedRing writer;
+  ASSERT_TRUE(writer.Create(key("two_readers"), 2u, 16u));
+
+  SharedRing readerA;
+  ASSERT_TRUE(readerA.Attach(key("two_readers")));
+  SharedRing readerB;
+  ASSERT_TRUE(readerB.Attach(key("two_readers")));
+
+  // Readers don't take data from each other
+  EXPECT_TRUE(writer.Write("1", 1u));
+  EXPECT_EQ("1", read(readerA));
+  EXPECT_EQ("1", read(readerB));
+  EXPECT_EQ("", read(readerA));
+
+  EXPECT_TRUE(writer.Write("2", 1u));
+  EXPECT_EQ("2", read(readerB));
+
+  // Slots being read aren't overwritten
+  std::size_t size{0u};
+  auto data = static_cast<const char *>(readerA.BeginRead(size));
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ("2", std::string(data, size));
+
+  EXPECT_TRUE(writer.Write("3", 1u));
+  EXPECT_TRUE(writer.Write("4", 1u));
+  EXPECT_EQ("2", std::string(data, size));
+
+  // Dropped once every slot is being read
+  data = static_cast<const char *>(readerB.BeginRead(size));
+  ASSERT_NE(nullptr, data);
+  EXPECT_EQ("4", std::string(data, size));
+  EXPECT_FALSE(writer.Write("5", 1u));
+  EXPECT_EQ(1u, writer.DroppedCount());
+
+  readerA.EndRead();
+  readerB.EndRead();
+  EXPECT_TRUE(writer.Write("6", 1u));
+
+  // Each reader goes on from where it was
+  EXPECT_EQ("4", read(readerA));
+  EXPECT_EQ("6", read(readerA));
+  EXPECT_EQ(1u, readerA.SkippedCount());
+  EXPECT_EQ("6", read(readerB));
+  EXPECT_EQ(1u, readerB.SkippedCount());
+}
+
+/////////////////////////////////////////////////
+TEST(SharedRingTest, ReadWhileWriting)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  SharedRing writer;
+  ASSERT_TRUE(writer.Create(key("read_while_writing"), 3u, 16u));
+
+  SharedRing reader;
+  ASSERT_TRUE(reader.Attach(key("read_while_writing")));
+
+  EXPECT_TRUE(writer.Write("1", 1u));
+  EXPECT_TRUE(writer.Write("2", 1u));
+  EXPECT_TRUE(writer.Write("3", 1u));
+
+  // The writer takes the oldest unread slot and stays there, such as if it
+  // crashed. Readers skip it instead of waiting.
+  auto slot = static_cast<char *>(writer.BeginWrite());
+  ASSERT_NE(nullptr, slot);
+  slot[0] = 'x';
+
+  EXPECT_EQ("2", read(reader));
+  EXPECT_EQ(1u, reader.SkippedCount());
+  EXPECT_EQ("3", read(reader));
+  EXPECT_EQ("", read(reader));
+
+  EXPECT_TRUE(writer.EndWrite(1u));
+  EXPECT_EQ("x", read(reader));
+  EXPECT_EQ(1u, reader.SkippedCount());
+
+  // The only unread slot is being written
+  SharedRing late;
+  ASSERT_TRUE(late.Attach(key("read_while_writing")));
+  EXPECT_EQ("x", read(late, true));
+  EXPECT_TRUE(writer.Write("5", 1u));
+  slot = static_cast<char *>(writer.BeginWrite());
+  ASSERT_NE(nullptr, slot);
+  EXPECT_EQ("5", read(late));
+
+  writer.AbortWrite();
+  EXPECT_EQ("", read(late));
+  EXPECT_TRUE(writer.Write("6", 1u));
+  EXPECT_EQ("6", read(late));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedRingTest, Threads)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  SharedRing writer;
+  ASSERT_TRUE(writer.Create(key("threads"), 4u, sizeof(int)));
+
+  SharedRing reader;
+  ASSERT_TRUE(reader.Attach(key("threads")));
+
+  const int count = 10000;
+  std::atomic<bool> done{false};
+  int received{0};
+  int last{-1};
+  bool ordered{true};
+
+  std::thread readerThread([&]()
+  {
+    while (true)
+    {
+      reader.Wait();
+
+      std::size_t size{0u};
+      while (auto data = reader.BeginRead(size))
+      {
+        int value;
+        std::memcpy(&value, data, sizeof(value));
+        reader.EndRead();
+
+        ordered = ordered && value > last;
+        last = value;
+        ++received;
+      }
+
+      if (done)
+        break;
+    }
+  });
+
+  for (int i = 0; i < count; ++i)
+    EXPECT_TRUE(writer.Write(&i, sizeof(i)));
+
+  done = true;
+  reader.Wake();
+  readerThread.join();
+
+  // The writer doesn't wait for the reader, which skips what it missed
+  EXPECT_EQ(static_cast<uint64_t>(count),
+      received + reader.SkippedCount());
+  EXPECT_EQ(count - 1, last);
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(0u, writer.DroppedCount());
+}
@@ -0,0 +1,479 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gui/StallMonitor.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief Maximum number of receivers whose owner is cached. The cache
+    /// is cleared when it grows beyond this.
+    static constexpr std::size_t kMaxCachedReceivers = 4096u;
+
+    /// \brief Maximum number of nested deliveries the watchdog can see.
+    /// Deeper ones are still timed, but left out of stall reports.
+    static constexpr std::size_t kMaxSnapshotDepth = 32u;
+
+    /// \brief Times of a plugin
+    struct PluginTimes
+    {
+      /// \brief Times, only used on the GUI thread. The plugin name is set
+      /// once, before the watchdog can see it.
+      GuiThreadTime time;
+
+      /// \brief Number of stalls, counted by the watchdog
+      std::atomic<uint64_t> stalls{0u};
+    };
+
+    /// \brief An event delivery in progress on the GUI thread
+    struct Delivery
+    {
+      /// \brief Plugin owning the receiver, null if not owned by a plugin
+      PluginTimes *owner{nullptr};
+
+      /// \brief When the delivery started
+      std::chrono::steady_clock::time_point start;
+
+      /// \brief Time spent on nested deliveries
+      std::chrono::steady_clock::duration nested{0};
+    };
+
+    /// \brief What the watchdog can see of a delivery in progress, written
+    /// by the GUI thread
+    struct DeliverySnapshot
+    {
+      /// \brief Plugin owning the receiver, null if not owned by a plugin
+      std::atomic<PluginTimes *> owner{nullptr};
+
+      /// \brief Receiver's class name
+      std::atomic<const char *> className{nullptr};
+
+      /// \brief Event type
+      std::atomic<int> eventType{0};
+    };
+
+    /// \brief Owner found for a receiver
+    struct CachedOwner
+    {
+      /// \brief The receiver, null once destroyed, in which case another
+      /// object may have taken its address
+      QPointer<const QObject> receiver;
+
+      /// \brief Plugin owning the receiver, null if not owned by a plugin
+      PluginTimes *owner{nullptr};
+    };
+
+    class StallMonitorPrivate
+    {
+      /// \brief Watchdog thread loop
+      public: void Watch();
+
+      /// \brief Find the plugin owning an object, from the cache or by
+      /// walking up its item and object hierarchies. GUI thread only.
+      /// \param[in] _object Object to look for.
+      /// \return Plugin's times, or null if not owned by a plugin.
+      public: PluginTimes *Owner(const QObject *_object);
+
+      /// \brief Log a stall. Watchdog thread only.
+      /// \param[in] _blocked How long the GUI thread has been blocked.
+      public: void Report(const std::chrono::steady_clock::duration &_blocked);
+
+      /// \brief Only used to wake up the watchdog
+      public: std::mutex mutex;
+
+      /// \brief Wakes up the watchdog to stop it
+      public: std::condition_variable cv;
+
+      /// \brief Set to true to stop the watchdog, with the mutex locked
+      public: bool stop{false};
+
+      /// \brief Watchdog thread
+      public: std::thread watchdog;
+
+      /// \brief Stall threshold, in milliseconds
+      public: std::atomic<int64_t> threshold{200};
+
+      // The members below are only used on the GUI thread
+
+      /// \brief Times per plugin name. Entries are never removed, so
+      /// pointers to them remain valid.
+      public: std::map<std::string, PluginTimes> times;
+
+      /// \brief Plugin times for each owning object
+      public: std::unordered_map<const QObject *, PluginTimes *> owners;
+
+      /// \brief Owner found for each receiver, so that hierarchies are only
+      /// walked on the first delivery. Cleared whenever owners or parents
+      /// change.
+      public: std::unordered_map<const QObject *, CachedOwner> ownerCache;
+
+      /// \brief Deliveries in progress, innermost last
+      public: std::vector<Delivery> deliveries;
+
+      // The members below are shared with the watchdog
+
+      /// \brief The outermost deliveries in progress
+      public: std::array<DeliverySnapshot, kMaxSnapshotDepth> snapshot;
+
+      /// \brief Number of deliveries in progress. Stored after the snapshot
+      /// is written.
+      public: std::atomic<std::size_t> depth{0u};
+
+      /// \brief Last time a delivery started or ended, as steady clock ticks
+      public: std::atomic<std::chrono::steady_clock::rep> lastProgress{0};
+
+      /// \brief True if the current stall has already been reported
+      public: std::atomic<bool> stalled{false};
+
+      /// \brief Number of stalls detected
+      public: std::atomic<uint64_t> stallCount{0u};
+
+      /// \brief True while a ping is waiting to be handled
+      public: std::atomic<bool> pingPending{false};
+
+      /// \brief Latest event loop latency, as steady clock ticks
+      public: std::atomic<std::chrono::steady_clock::rep> latency{0};
+
+      /// \brief Highest event loop latency, as steady clock ticks. Only
+      /// written on the GUI thread.
+      public: std::atomic<std::chrono::steady_clock::rep> maxLatency{0};
+
+      /// \brief Object living on the GUI thread which receives pings
+      public: std::unique_ptr<QObject> pingTarget;
+    };
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Convert a duration to milliseconds for printing.
+/// \param[in] _duration Duration.
+/// \return Milliseconds.
+static double toMs(const std::chrono::steady_clock::duration &_duration)
+{
+  return std::chrono::duration<double, std::milli>(_duration).count();
+}
+
+/////////////////////////////////////////////////
+StallMonitor::StallMonitor()
+  : dataPtr(new StallMonitorPrivate)
+{
+  this->dataPtr->pingTarget = std::make_unique<QObject>();
+  this->dataPtr->watchdog = std::thread(&StallMonitorPrivate::Watch,
+      this->dataPtr.get());
+}
+
+/////////////////////////////////////////////////
+StallMonitor::~StallMonitor()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->cv.notify_all();
+
+  if (this->dataPtr->watchdog.joinable())
+    this->dataPtr->watchdog.join();
+
+  // Drops pings which haven't been handled yet
+  this->dataPtr->pingTarget.reset();
+}
+
+/////////////////////////////////////////////////
+void StallMonitor::SetThreshold(const std::chrono::milliseconds &_threshold)
+{
+  this->dataPtr->threshold = _threshold.count();
+}
+
+/////////////////////////////////////////////////
+std::chrono::milliseconds StallMonitor::Threshold() const
+{
+  return std::chrono::milliseconds(this->dataPtr->threshold.load());
+}
+
+/////////////////////////////////////////////////
+void StallMonitor::AddOwner(const QObject *_object, const std::string &_plugin)
+{
+  if (nullptr == _object || _plugin.empty())
+    return;
+
+  // The name is only written once, since the watchdog may be reading it
+  auto &times = this->dataPtr->times[_plugin];
+  if (times.time.plugin.empty())
+    times.time.plugin = _plugin;
+  this->dataPtr->owners[_object] = &times;
+  this->dataPtr->ownerCache.clear();
+}
+
+/////////////////////////////////////////////////
+void StallMonitor::RemoveOwner(const std::string &_plugin)
+{
+  this->dataPtr->ownerCache.clear();
+  for (auto it = this->dataPtr->owners.begin();
+      it != this->dataPtr->owners.end();)
+  {
+    if (it->second->time.plugin == _plugin)
+      it = this->dataPtr->owners.erase(it);
+    else
+      ++it;
+  }
+}
+
+/////////////////////////////////////////////////
+void StallMonitor::BeginDelivery(const QObject *_receiver,
+    const QEvent *_event)
+{
+  // Descendants of a reparented object may change owners
+  if (_event->type() == QEvent::ParentChange)
+    this->dataPtr->ownerCache.clear();
+
+  Delivery delivery;
+  delivery.owner = this->dataPtr->Owner(_receiver);
+  delivery.start = std::chrono::steady_clock::now();
+
+  auto &deliveries = this->dataPtr->deliveries;
+  if (deliveries.size() < kMaxSnapshotDepth)
+  {
+    auto &snapshot = this->dataPtr->snapshot[deliveries.size()];
+    snapshot.owner.store(delivery.owner, std::memory_order_relaxed);
+    snapshot.className.store(_receiver->metaObject()->className(),
+        std::memory_order_relaxed);
+    snapshot.eventType.store(static_cast<int>(_event->type()),
+        std::memory_order_relaxed);
+  }
+  deliveries.push_back(delivery);
+
+  this->dataPtr->lastProgress.store(delivery.start.time_since_epoch().count(),
+      std::memory_order_relaxed);
+  this->dataPtr->depth.store(deliveries.size(), std::memory_order_release);
+}
+
+/////////////////////////////////////////////////
+void StallMonitor::EndDelivery()
+{
+  auto now = std::chrono::steady_clock::now();
+
+  auto &deliveries = this->dataPtr->deliveries;
+  if (deliveries.empty())
+    return;
+
+  auto delivery = deliveries.back();
+  deliveries.pop_back();
+  this->dataPtr->lastProgress.store(now.time_since_epoch().count(),
+      std::memory_order_relaxed);
+  this->dataPtr->depth.store(deliveries.size(), std::memory_order_release);
+
+  auto elapsed = now - delivery.start;
+  if (!deliveries.empty())
+    deliveries.back().nested += elapsed;
+
+  if (delivery.owner)
+  {
+    auto &time = delivery.owner->time;
+    time.total += elapsed - delivery.nested;
+    time.max = std::max(time.max, elapsed);
+    ++time.count;
+  }
+
+  if (this->dataPtr->stalled.exchange(false))
+  {
+    ignwarn << "GUI thread was blocked for [" << toMs(elapsed) << "] ms"
+            << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+std::vector<GuiThreadTime> StallMonitor::Times() const
+{
+  std::vector<GuiThreadTime> result;
+  for (const auto &times : this->dataPtr->times)
+  {
+    result.push_back(times.second.time);
+    result.back().stalls = times.second.stalls;
+  }
+
+  std::sort(result.begin(), result.end(),
+      [](const GuiThreadTime &_a, const GuiThreadTime &_b)
+      {
+        return _a.total > _b.total;
+      });
+
+  return result;
+}
+
+/////////////////////////////////////////////////
+uint64_t StallMonitor::StallCount() const
+{
+  return this->dataPtr->stallCount;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration StallMonitor::Latency() const
+{
+  return std::chrono::steady_clock::duration(this->dataPtr->latency.load());
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration StallMonitor::MaxLatency() const
+{
+  return std::chrono::steady_clock::duration(
+      this->dataPtr->maxLatency.load());
+}
+
+/////////////////////////////////////////////////
+void StallMonitor::Reset()
+{
+  for (auto &times : this->dataPtr->times)
+  {
+    auto &time = times.second.time;
+    time.total = std::chrono::steady_clock::duration::zero();
+    time.max = std::chrono::steady_clock::duration::zero();
+    time.count = 0u;
+    times.second.stalls = 0u;
+  }
+  this->dataPtr->stallCount = 0u;
+  this->dataPtr->latency = 0;
+  this->dataPtr->maxLatency = 0;
+}
+
+/////////////////////////////////////////////////
+PluginTimes *StallMonitorPrivate::Owner(const QObject *_object)
+{
+  auto cached = this->ownerCache.find(_object);
+  if (cached != this->ownerCache.end() && cached->second.receiver)
+    return cached->second.owner;
+
+  PluginTimes *owner{nullptr};
+  auto object = _object;
+  while (object)
+  {
+    auto it = this->owners.find(object);
+    if (it != this->owners.end())
+    {
+      owner = it->second;
+      break;
+    }
+
+    // Items are usually parented to the engine, so follow the visual parent
+    auto item = qobject_cast<const QQuickItem *>(object);
+    if (item && item->parentItem())
+      object = item->parentItem();
+    else
+      object = object->parent();
+  }
+
+  if (this->ownerCache.size() >= kMaxCachedReceivers)
+    this->ownerCache.clear();
+  this->ownerCache[_object] = CachedOwner{_object, owner};
+
+  return owner;
+}
+
+/////////////////////////////////////////////////
+void StallMonitorPrivate::Report(
+    const std::chrono::steady_clock::duration &_blocked)
+{
+  this->stalled = true;
+  ++this->stallCount;
+
+  // The GUI thread hasn't made progress, so the snapshot is stable unless
+  // it resumes right now, in which case the sample may be off
+  auto depth = std::min(this->depth.load(std::memory_order_acquire),
+      kMaxSnapshotDepth);
+
+  // Blame the innermost delivery owned by a plugin
+  PluginTimes *culprit{nullptr};
+  for (auto i = depth; i > 0u && !culprit; --i)
+    culprit = this->snapshot[i - 1].owner.load(std::memory_order_relaxed);
+
+  if (culprit)
+    ++culprit->stalls;
+
+  auto typeEnum = QMetaEnum::fromType<QEvent::Type>();
+  std::ostringstream sample;
+  for (std::size_t i = 0; i < depth; ++i)
+  {
+    const auto &delivery = this->snapshot[i];
+    auto owner = delivery.owner.load(std::memory_order_relaxed);
+    auto className = delivery.className.load(std::memory_order_relaxed);
+    auto eventType = delivery.eventType.load(std::memory_order_relaxed);
+    auto typeName = typeEnum.valueToKey(eventType);
+    sample << std::endl << "  ["
+           << (owner ? owner->time.plugin : "-") << "] "
+           << (className ? className : "?") << " <- "
+           << (typeName ? typeName : std::to_string(eventType));
+  }
+
+  ignwarn << "GUI thread blocked for more than [" << toMs(_blocked)
+          << "] ms by " << (culprit ? "plugin [" + culprit->time.plugin + "]"
+          : std::string("code outside plugins"))
+          << ". Deliveries in progress:" << sample.str() << std::endl;
+}
+
+/////////////////////////////////////////////////
+void StallMonitorPrivate::Watch()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (!this->stop)
+  {
+    // Ping often enough that idle nested event loops show progress
+    std::chrono::milliseconds threshold(this->threshold.load());
+    auto interval = std::max(threshold / 4, std::chrono::milliseconds(10));
+    this->cv.wait_for(lock, interval, [this] {return this->stop;});
+    if (this->stop)
+      break;
+
+    auto now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point lastProgress(
+        std::chrono::steady_clock::duration(this->lastProgress.load(
+        std::memory_order_relaxed)));
+
+    // Deliveries only happen while the event loop runs, so a blocked thread
+    // which isn't delivering anything, such as a test, isn't a stall.
+    if (!this->stalled && this->depth.load(std::memory_order_acquire) > 0u &&
+        now - lastProgress > threshold)
+    {
+      this->Report(now - lastProgress);
+    }
+
+    if (this->pingPending.exchange(true))
+      continue;
+
+    QMetaObject::invokeMethod(this->pingTarget.get(), [this, now]
+    {
+      auto latency = (std::chrono::steady_clock::now() - now).count();
+      this->latency = latency;
+      this->maxLatency = std::max(this->maxLatency.load(), latency);
+      this->pingPending = false;
+    }, Qt::QueuedConnection);
+  }
+}
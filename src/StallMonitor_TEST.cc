@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/MainWindow.hh"
+#include "ignition/gui/Plugin.hh"
+#include "ignition/gui/StallMonitor.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(StallMonitorTest, Threshold)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+
+  auto monitor = app.Monitor();
+  ASSERT_NE(nullptr, monitor);
+  EXPECT_EQ(std::chrono::milliseconds(200), monitor->Threshold());
+
+  monitor->SetThreshold(std::chrono::milliseconds(50));
+  EXPECT_EQ(std::chrono::milliseconds(50), monitor->Threshold());
+}
+
+/////////////////////////////////////////////////
+TEST(StallMonitorTest, Attribution)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin"));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+  auto pluginName = plugin->CardItem()->objectName().toStdString();
+
+  auto monitor = app.Monitor();
+  ASSERT_NE(nullptr, monitor);
+  monitor->SetThreshold(std::chrono::milliseconds(50));
+  monitor->Reset();
+
+  // Blocking the test thread outside of event delivery isn't a stall
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(0u, monitor->StallCount());
+
+  // A slow queued call on the plugin
+  QMetaObject::invokeMethod(plugin, []
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }, Qt::QueuedConnection);
+  QCoreApplication::processEvents();
+
+  EXPECT_EQ(1u, monitor->StallCount());
+
+  auto times = monitor->Times();
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(pluginName, times[0].plugin);
+  EXPECT_EQ(1u, times[0].stalls);
+  EXPECT_GE(times[0].count, 1u);
+  EXPECT_GE(times[0].max, std::chrono::milliseconds(200));
+  EXPECT_GE(times[0].total, std::chrono::milliseconds(200));
+
+  // Pings go through once events are processed
+  for (int i = 0; i < 10 && monitor->Latency().count() == 0; ++i)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    QCoreApplication::processEvents();
+  }
+  EXPECT_GT(monitor->Latency().count(), 0);
+  EXPECT_GE(monitor->MaxLatency(), monitor->Latency());
+
+  // Reset
+  monitor->Reset();
+  EXPECT_EQ(0u, monitor->StallCount());
+  EXPECT_EQ(0, monitor->MaxLatency().count());
+
+  times = monitor->Times();
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(0u, times[0].stalls);
+  EXPECT_EQ(0, times[0].total.count());
+
+  // Cached owners are forgotten once the plugin is removed
+  monitor->RemoveOwner(pluginName);
+  QMetaObject::invokeMethod(plugin, [] {}, Qt::QueuedConnection);
+  QCoreApplication::processEvents();
+
+  times = monitor->Times();
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(0u, times[0].count);
+}
+
+/////////////////////////////////////////////////
+TEST(StallMonitorTest, DeletedReceiver)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("TestPlugin"));
+
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  auto plugin = win->findChild<Plugin *>();
+  ASSERT_NE(nullptr, plugin);
+
+  auto monitor = app.Monitor();
+  ASSERT_NE(nullptr, monitor);
+  monitor->Reset();
+
+  QEvent event(QEvent::User);
+
+  // Owned by the plugin
+  auto child = new QObject(plugin);
+  monitor->BeginDelivery(child, &event);
+  monitor->EndDelivery();
+
+  auto times = monitor->Times();
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(1u, times[0].count);
+
+  // Deleted without a deferred delete, and likely replaced at the same
+  // address by an object which isn't owned by any plugin
+  delete child;
+  auto other = std::make_unique<QObject>();
+  monitor->BeginDelivery(other.get(), &event);
+  monitor->EndDelivery();
+
+  times = monitor->Times();
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(1u, times[0].count);
+}
@@ -0,0 +1,382 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "ignition/gui/WorkerPool.hh"
+
+namespace ignition
+{
+  namespace gui
+  {
+    /// \brief Number of priority levels
+    static constexpr int kPriorityCount = 3;
+
+    /// \brief A queued task
+    struct Task
+    {
+      /// \brief Function to run
+      std::function<void()> func;
+
+      /// \brief Owner given to WorkerPool::Post, may be null
+      const void *owner{nullptr};
+    };
+
+    /// \brief Queues owned by a single worker
+    struct WorkerQueues
+    {
+      /// \brief One deque per priority, indexed by TaskPriority. The owning
+      /// worker pops from the front and thieves steal from the back.
+      std::array<std::deque<Task>, kPriorityCount> tasks;
+
+      /// \brief Protects tasks
+      std::mutex mutex;
+    };
+
+    class WorkerPoolPrivate
+    {
+      /// \brief Run loop for a worker thread
+      /// \param[in] _index Index of the worker
+      public: void Run(const unsigned int _index);
+
+      /// \brief Mark a task as taken from the queues and running. Called
+      /// while the queue holding the task is still locked, so that Cancel
+      /// never misses a task in flight.
+      /// \param[in] _task Task being claimed
+      public: void Claim(const Task &_task);
+
+      /// \brief Take the next task for a worker, looking at its own queues
+      /// first and then stealing from the others, one priority at a time.
+      /// \param[in] _index Index of the worker
+      /// \param[out] _task Task taken
+      /// \return True if a task was taken
+      public: bool Take(const unsigned int _index, Task &_task);
+
+      /// \brief Worker threads
+      public: std::vector<std::thread> threads;
+
+      /// \brief Queues for each worker
+      public: std::vector<std::unique_ptr<WorkerQueues>> queues;
+
+      /// \brief Next worker to receive a task posted from outside the pool
+      public: std::atomic<unsigned int> next{0u};
+
+      /// \brief Number of tasks queued but not yet taken
+      public: std::atomic<int> pending{0};
+
+      /// \brief Set to true to stop the workers
+      public: std::atomic<bool> stop{false};
+
+      /// \brief Protects sleeping and the running bookkeeping below
+      public: mutable std::mutex mutex;
+
+      /// \brief Wakes up idle workers
+      public: std::condition_variable workCv;
+
+      /// \brief Notified whenever a task finishes
+      public: std::condition_variable doneCv;
+
+      /// \brief Number of tasks currently running
+      public: int running{0};
+
+      /// \brief Number of tasks currently running per owner
+      public: std::map<const void *, int> runningPerOwner;
+
+      /// \brief Time spent running tasks per owner
+      public: std::map<const void *, std::chrono::steady_clock::duration>
+          busyPerOwner;
+
+      /// \brief Protects cancelling. Locked before any queue's mutex.
+      public: std::mutex cancelMutex;
+
+      /// \brief Owners being cancelled, with the number of Cancel calls in
+      /// progress for each. Their new tasks are rejected, so that running
+      /// tasks can't queue more work behind Cancel's back.
+      public: std::map<const void *, int> cancelling;
+    };
+
+    /// \brief Index of the current worker, or -1 if the current thread
+    /// isn't a worker.
+    static thread_local int tlWorkerIndex{-1};
+
+    /// \brief Pool the current worker belongs to.
+    static thread_local const WorkerPoolPrivate *tlWorkerPool{nullptr};
+  }
+}
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+WorkerPool::WorkerPool(const unsigned int _threadCount)
+  : dataPtr(new WorkerPoolPrivate)
+{
+  unsigned int count = _threadCount;
+  if (count == 0u)
+  {
+    auto hw = std::thread::hardware_concurrency();
+    count = hw > 1u ? hw - 1u : 1u;
+  }
+
+  for (unsigned int i = 0; i < count; ++i)
+    this->dataPtr->queues.push_back(std::make_unique<WorkerQueues>());
+
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    this->dataPtr->threads.emplace_back(&WorkerPoolPrivate::Run,
+        this->dataPtr.get(), i);
+  }
+
+  igndbg << "Started worker pool with [" << count << "] threads."
+         << std::endl;
+}
+
+/////////////////////////////////////////////////
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->workCv.notify_all();
+
+  for (auto &thread : this->dataPtr->threads)
+  {
+    if (thread.joinable())
+      thread.join();
+  }
+}
+
+/////////////////////////////////////////////////
+unsigned int WorkerPool::ThreadCount() const
+{
+  return this->dataPtr->threads.size();
+}
+
+/////////////////////////////////////////////////
+void WorkerPool::Post(std::function<void()> _task,
+    const TaskPriority _priority, const void *_owner)
+{
+  if (!_task || this->dataPtr->stop)
+    return;
+
+  // Tasks posted from a worker stay on that worker, which keeps related work
+  // together. Others are spread round-robin.
+  unsigned int index;
+  if (tlWorkerPool == this->dataPtr.get() && tlWorkerIndex >= 0)
+    index = static_cast<unsigned int>(tlWorkerIndex);
+  else
+    index = this->dataPtr->next++ % this->dataPtr->queues.size();
+
+  auto &queues = *this->dataPtr->queues[index];
+  {
+    std::lock_guard<std::mutex> cancelLock(this->dataPtr->cancelMutex);
+    if (_owner && this->dataPtr->cancelling.count(_owner) > 0)
+      return;
+
+    std::lock_guard<std::mutex> lock(queues.mutex);
+    queues.tasks[static_cast<int>(_priority)].push_back(
+        {std::move(_task), _owner});
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    ++this->dataPtr->pending;
+  }
+  this->dataPtr->workCv.notify_one();
+}
+
+/////////////////////////////////////////////////
+void WorkerPool::Cancel(const void *_owner)
+{
+  if (nullptr == _owner)
+    return;
+
+  // From now on, tasks posted for the owner, including by its running
+  // tasks, are rejected, so the queues can be emptied once.
+  {
+    std::lock_guard<std::mutex> cancelLock(this->dataPtr->cancelMutex);
+    ++this->dataPtr->cancelling[_owner];
+  }
+
+  int removed{0};
+  for (auto &queues : this->dataPtr->queues)
+  {
+    std::lock_guard<std::mutex> lock(queues->mutex);
+    for (auto &deque : queues->tasks)
+    {
+      auto it = std::remove_if(deque.begin(), deque.end(),
+          [&_owner](const Task &_t) {return _t.owner == _owner;});
+      removed += std::distance(it, deque.end());
+      deque.erase(it, deque.end());
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->pending -= removed;
+  if (removed > 0)
+    this->dataPtr->doneCv.notify_all();
+
+  this->dataPtr->doneCv.wait(lock, [this, &_owner]
+  {
+    return this->dataPtr->runningPerOwner.find(_owner) ==
+        this->dataPtr->runningPerOwner.end();
+  });
+
+  // Owners are usually plugins, and a new one may reuse the address
+  this->dataPtr->busyPerOwner.erase(_owner);
+  lock.unlock();
+
+  std::lock_guard<std::mutex> cancelLock(this->dataPtr->cancelMutex);
+  auto it = this->dataPtr->cancelling.find(_owner);
+  if (--it->second == 0)
+    this->dataPtr->cancelling.erase(it);
+}
+
+/////////////////////////////////////////////////
+void WorkerPool::WaitForIdle()
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->doneCv.wait(lock, [this]
+  {
+    return this->dataPtr->pending <= 0 && this->dataPtr->running == 0;
+  });
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration WorkerPool::BusyTime(
+    const void *_owner) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto it = this->dataPtr->busyPerOwner.find(_owner);
+  if (it == this->dataPtr->busyPerOwner.end())
+    return std::chrono::steady_clock::duration::zero();
+  return it->second;
+}
+
+/////////////////////////////////////////////////
+void WorkerPool::ResetBusyTimes()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->busyPerOwner.clear();
+}
+
+/////////////////////////////////////////////////
+void WorkerPoolPrivate::Claim(const Task &_task)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  --this->pending;
+  ++this->running;
+  if (_task.owner)
+    ++this->runningPerOwner[_task.owner];
+}
+
+/////////////////////////////////////////////////
+bool WorkerPoolPrivate::Take(const unsigned int _index, Task &_task)
+{
+  auto count = this->queues.size();
+  for (int p = kPriorityCount - 1; p >= 0; --p)
+  {
+    // Own queue, oldest first
+    {
+      auto &own = *this->queues[_index];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks[p].empty())
+      {
+        _task = std::move(own.tasks[p].front());
+        own.tasks[p].pop_front();
+        this->Claim(_task);
+        return true;
+      }
+    }
+
+    // Steal from the back of the others
+    for (unsigned int i = 1; i < count; ++i)
+    {
+      auto &other = *this->queues[(_index + i) % count];
+      std::lock_guard<std::mutex> lock(other.mutex);
+      if (!other.tasks[p].empty())
+      {
+        _task = std::move(other.tasks[p].back());
+        other.tasks[p].pop_back();
+        this->Claim(_task);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+void WorkerPoolPrivate::Run(const unsigned int _index)
+{
+  tlWorkerIndex = static_cast<int>(_index);
+  tlWorkerPool = this;
+
+  while (true)
+  {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->workCv.wait(lock, [this]
+      {
+        return this->stop || this->pending > 0;
+      });
+
+      if (this->stop)
+        break;
+    }
+
+    if (!this->Take(_index, task))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    task.func();
+    auto busy = std::chrono::steady_clock::now() - start;
+
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      --this->running;
+      if (task.owner)
+      {
+        auto it = this->runningPerOwner.find(task.owner);
+        if (--it->second == 0)
+          this->runningPerOwner.erase(it);
+        this->busyPerOwner[task.owner] += busy;
+      }
+    }
+    this->doneCv.notify_all();
+  }
+
+  tlWorkerIndex = -1;
+  tlWorkerPool = nullptr;
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/WorkerPool.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(WorkerPoolTest, ThreadCount)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  WorkerPool pool(3);
+  EXPECT_EQ(3u, pool.ThreadCount());
+
+  WorkerPool defaultPool;
+  EXPECT_GE(defaultPool.ThreadCount(), 1u);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkerPoolTest, RunAll)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  WorkerPool pool(4);
+
+  std::atomic<int> count{0};
+  for (int i = 0; i < 1000; ++i)
+    pool.Post([&count]() {++count;});
+
+  pool.WaitForIdle();
+  EXPECT_EQ(1000, count);
+
+  // Tasks posted from within tasks
+  count = 0;
+  for (int i = 0; i < 10; ++i)
+  {
+    pool.Post([&pool, &count]()
+    {
+      for (int j = 0; j < 10; ++j)
+        pool.Post([&count]() {++count;});
+    });
+  }
+
+  pool.WaitForIdle();
+  EXPECT_EQ(100, count);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkerPoolTest, Priority)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  WorkerPool pool(1);
+
+  // Block the only worker while tasks are queued
+  std::atomic<bool> release{false};
+  pool.Post([&release]()
+  {
+    while (!release)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  });
+
+  std::mutex mutex;
+  std::vector<TaskPriority> order;
+  for (auto priority : {TaskPriority::kLow, TaskPriority::kNormal,
+      TaskPriority::kHigh})
+  {
+    pool.Post([&mutex, &order, priority]()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(priority);
+    }, priority);
+  }
+
+  release = true;
+  pool.WaitForIdle();
+
+  ASSERT_EQ(3u, order.size());
+  EXPECT_EQ(TaskPriority::kHigh, order[0]);
+  EXPECT_EQ(TaskPriority::kNormal, order[1]);
+  EXPECT_EQ(TaskPriority::kLow, order[2]);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkerPoolTest, Cancel)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  WorkerPool pool(1);
+
+  int ownerA{0};
+  int ownerB{0};
+
+  // Block the only worker with a task from owner A
+  std::atomic<bool> started{false};
+  std::atomic<bool> finished{false};
+  pool.Post([&started, &finished]()
+  {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    finished = true;
+  }, TaskPriority::kNormal, &ownerA);
+
+  std::atomic<int> countA{0};
+  std::atomic<int> countB{0};
+  for (int i = 0; i < 10; ++i)
+  {
+    pool.Post([&countA]() {++countA;}, TaskPriority::kNormal, &ownerA);
+    pool.Post([&countB]() {++countB;}, TaskPriority::kNormal, &ownerB);
+  }
+
+  while (!started)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  // Cancelling waits for the running task and drops queued ones
+  pool.Cancel(&ownerA);
+  EXPECT_TRUE(finished);
+
+  pool.WaitForIdle();
+  EXPECT_EQ(0, countA);
+  EXPECT_EQ(10, countB);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkerPoolTest, CancelReposting)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  WorkerPool pool(2);
+
+  int owner{0};
+  std::atomic<int> count{0};
+  std::function<void()> task;
+  task = [&]()
+  {
+    ++count;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    pool.Post(task, TaskPriority::kNormal, &owner);
+  };
+  pool.Post(task, TaskPriority::kNormal, &owner);
+
+  while (count < 5)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  // Tasks posted by the running task while cancelling are discarded too
+  pool.Cancel(&owner);
+  pool.WaitForIdle();
+  int cancelledCount = count;
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(cancelledCount, count);
+
+  // The owner can post again afterwards
+  std::atomic<bool> ran{false};
+  pool.Post([&ran]() {ran = true;}, TaskPriority::kNormal, &owner);
+  pool.WaitForIdle();
+  EXPECT_TRUE(ran);
+}
+
+/////////////////////////////////////////////////
+TEST(WorkerPoolTest, BusyTime)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  WorkerPool pool(2);
+
+  int ownerA{0};
+  int ownerB{0};
+  EXPECT_EQ(std::chrono::steady_clock::duration::zero(),
+      pool.BusyTime(&ownerA));
+
+  for (int i = 0; i < 4; ++i)
+  {
+    pool.Post([]()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }, TaskPriority::kNormal, &ownerA);
+  }
+  pool.Post([]() {}, TaskPriority::kNormal, &ownerB);
+  pool.WaitForIdle();
+
+  EXPECT_GE(pool.BusyTime(&ownerA), std::chrono::milliseconds(20));
+  EXPECT_LT(pool.BusyTime(&ownerB), std::chrono::milliseconds(5));
+
+  // Forgotten once cancelled
+  pool.Cancel(&ownerA);
+  EXPECT_EQ(std::chrono::steady_clock::duration::zero(),
+      pool.BusyTime(&ownerA));
+
+  pool.ResetBusyTimes();
+  EXPECT_EQ(std::chrono::steady_clock::duration::zero(),
+      pool.BusyTime(&ownerB));
+}
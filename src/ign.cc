@@ -16,12 +16,20 @@
 */
 
 #include <string.h>
+#include <tinyxml2.h>
 
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <limits>
+#include <string>
 
 #include <ignition/common/Console.hh>
 
 #include "ignition/gui/Application.hh"
+#include "ignition/gui/Benchmark.hh"
 #include "ignition/gui/config.hh"
 #include "ignition/gui/Export.hh"
 #include "ignition/gui/ign.hh"
@@ -91,6 +99,131 @@ extern "C" IGNITION_GUI_VISIBLE void cmdConfig(const char *_config)
   app.exec();
 }
 
+//////////////////////////////////////////////////
+extern "C" IGNITION_GUI_VISIBLE void cmdHelper()
+{
+  ignition::gui::Application app(g_argc, g_argv,
+      ignition::gui::WindowType::kHeadless);
+
+  // The proxy sends the plugin's configuration, prefixed by its length
+  std::size_t length{0u};
+  if (!(std::cin >> length) || std::cin.get() != '\n')
+  {
+    ignerr << "Helper didn't receive a configuration." << std::endl;
+    return;
+  }
+
+  std::string config(length, '\0');
+  if (!std::cin.read(&config[0], length))
+  {
+    ignerr << "Helper received an incomplete configuration." << std::endl;
+    return;
+  }
+
+  tinyxml2::XMLDocument doc;
+  doc.Parse(config.c_str());
+
+  auto pluginElem = doc.FirstChildElement("plugin");
+  if (!pluginElem || !pluginElem->Attribute("filename"))
+  {
+    ignerr << "Helper received an invalid configuration:" << std::endl
+           << config << std::endl;
+    return;
+  }
+
+  if (!app.LoadPlugin(pluginElem->Attribute("filename"), pluginElem))
+  {
+    return;
+  }
+
+  app.exec();
+}
+
+//////////////////////////////////////////////////
+extern "C" IGNITION_GUI_VISIBLE int cmdBenchmark(const char *_config,
+    const char *_frames, const char *_duration)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  ignition::gui::useOffscreenPlatform();
+
+  ignition::gui::Application app(g_argc, g_argv);
+
+  if (!app.findChild<ignition::gui::MainWindow *>())
+  {
+    return 1;
+  }
+
+  ignition::gui::Benchmark benchmark;
+  if (!benchmark.Load(std::string(_config)))
+  {
+    return 1;
+  }
+
+  if (_duration && *_duration)
+  {
+    double seconds{0.0};
+    std::size_t parsed{0u};
+    try
+    {
+      seconds = std::stod(_duration, &parsed);
+    }
+    catch (const std::exception &)
+    {
+      parsed = 0u;
+    }
+
+    auto period = benchmark.FramePeriod().count();
+    if (parsed != std::strlen(_duration) || !std::isfinite(seconds) ||
+        seconds <= 0.0 || period <= 0)
+    {
+      ignerr << "Invalid benchmark duration [" << _duration << "]"
+             << std::endl;
+      return 1;
+    }
+
+    auto frames = std::ceil(seconds * 1000.0 / period);
+    if (frames > std::numeric_limits<unsigned int>::max())
+    {
+      ignerr << "Benchmark duration [" << _duration << "] is too long"
+             << std::endl;
+      return 1;
+    }
+    benchmark.SetFrames(static_cast<unsigned int>(frames));
+  }
+  else if (_frames && *_frames)
+  {
+    int frames{0};
+    std::size_t parsed{0u};
+    try
+    {
+      frames = std::stoi(_frames, &parsed);
+    }
+    catch (const std::exception &)
+    {
+      parsed = 0u;
+    }
+
+    if (parsed != std::strlen(_frames) || frames <= 0)
+    {
+      ignerr << "Invalid benchmark frame count [" << _frames << "]"
+             << std::endl;
+      return 1;
+    }
+    benchmark.SetFrames(static_cast<unsigned int>(frames));
+  }
+
+  // Let the window and plugins finish loading
+  QCoreApplication::processEvents();
+  auto startup = std::chrono::steady_clock::now() - start;
+
+  auto report = benchmark.Run();
+  report.startup = startup;
+
+  std::cout << ignition::gui::benchmarkReportJson(report) << std::flush;
+  return 0;
+}
+
 //////////////////////////////////////////////////
 extern "C" IGNITION_GUI_VISIBLE void cmdVerbose(const char *_verbosity)
 {
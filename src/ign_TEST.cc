@@ -58,3 +58,33 @@ TEST(CmdLine, list)
   EXPECT_NE(output.find("Publisher"), std::string::npos);
 }
 
+
+/////////////////////////////////////////////////
+TEST(CmdLine, benchmark)
+{
+  std::string output = custom_exec_str("ign gui --benchmark " +
+      std::string(PROJECT_SOURCE_PATH) + "/test/config/benchmark.config" +
+      " --frames 5");
+  EXPECT_NE(output.find("\"frames\": 5,"), std::string::npos) << output;
+  EXPECT_NE(output.find("\"frame_time_ms\""), std::string::npos) << output;
+  EXPECT_NE(output.find("\"peak_rss_bytes\""), std::string::npos) << output;
+}
+
+/////////////////////////////////////////////////
+TEST(CmdLine, benchmarkInvalid)
+{
+  std::string config = std::string(PROJECT_SOURCE_PATH) +
+      "/test/config/benchmark.config";
+
+  std::string output = custom_exec_str("ign gui --benchmark " + config +
+      " --frames 5abc");
+  EXPECT_NE(output.find("Invalid benchmark frame count"), std::string::npos)
+      << output;
+  EXPECT_EQ(output.find("\"frames\""), std::string::npos) << output;
+
+  // Failures exit with an error
+  EXPECT_NE(0, system(("ign gui --benchmark " + config +
+      " --duration -1 > /dev/null 2>&1").c_str()));
+  EXPECT_NE(0, system(("ign gui --benchmark " + config +
+      "_missing --frames 5 > /dev/null 2>&1").c_str()));
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <ignition/common/Console.hh>
+#include <ignition/plugin/Register.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/StallMonitor.hh"
+
+#include "Diagnostics.hh"
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class DiagnosticsPrivate
+  {
+    /// \brief Timer to refresh the display
+    public: QTimer *timer{nullptr};
+
+    /// \brief Times per plugin
+    public: QStringList times;
+
+    /// \brief Memory per plugin
+    public: QStringList memory;
+
+    /// \brief Event loop latency
+    public: QString latency{"N/A"};
+
+    /// \brief Number of stalls
+    public: int stalls{0};
+  };
+}
+}
+}
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+/// \brief Format a duration in milliseconds.
+/// \param[in] _duration Duration.
+/// \return Formatted string.
+static QString formatMs(const std::chrono::steady_clock::duration &_duration)
+{
+  return QString::number(
+      std::chrono::duration<double, std::milli>(_duration).count(), 'f', 1) +
+      " ms";
+}
+
+/////////////////////////////////////////////////
+/// \brief Format a number of bytes using the most suitable unit.
+/// \param[in] _bytes Number of bytes.
+/// \return Formatted string.
+static QString formatBytes(const uint64_t _bytes)
+{
+  if (_bytes >= (1u << 20))
+    return QString::number(_bytes / double(1u << 20), 'f', 1) + " MB";
+  if (_bytes >= (1u << 10))
+    return QString::number(_bytes / double(1u << 10), 'f', 1) + " kB";
+  return QString::number(_bytes) + " B";
+}
+
+/////////////////////////////////////////////////
+Diagnostics::Diagnostics()
+  : Plugin(), dataPtr(new DiagnosticsPrivate)
+{
+  this->dataPtr->timer = new QTimer(this);
+  this->dataPtr->timer->setInterval(1000);
+  this->connect(this->dataPtr->timer, &QTimer::timeout, this,
+      &Diagnostics::Update);
+}
+
+/////////////////////////////////////////////////
+Diagnostics::~Diagnostics()
+{
+}
+
+/////////////////////////////////////////////////
+void Diagnostics::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+{
+  if (this->title.empty())
+    this->title = "Diagnostics";
+
+  if (!App() || !App()->Monitor())
+  {
+    ignerr << "No application monitor, diagnostics won't be displayed."
+           << std::endl;
+    return;
+  }
+
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("stall_threshold"))
+    {
+      unsigned int threshold{0u};
+      if (elem->QueryUnsignedText(&threshold) != tinyxml2::XML_SUCCESS ||
+          threshold == 0u)
+      {
+        ignwarn << "Invalid <stall_threshold>, keeping ["
+                << App()->Monitor()->Threshold().count() << "] ms."
+                << std::endl;
+      }
+      else
+      {
+        App()->Monitor()->SetThreshold(std::chrono::milliseconds(threshold));
+      }
+    }
+  }
+
+  this->Update();
+  this->dataPtr->timer->start();
+}
+
+/////////////////////////////////////////////////
+void Diagnostics::Suspend()
+{
+  this->dataPtr->timer->stop();
+}
+
+/////////////////////////////////////////////////
+void Diagnostics::Resume()
+{
+  this->Update();
+  this->dataPtr->timer->start();
+}
+
+/////////////////////////////////////////////////
+void Diagnostics::Update()
+{
+  if (!App() || !App()->Monitor())
+    return;
+
+  auto monitor = App()->Monitor();
+
+  auto times = monitor->Times();
+  std::chrono::steady_clock::duration total{0};
+  for (const auto &time : times)
+    total += time.total;
+
+  QStringList lines;
+  for (const auto &time : times)
+  {
+    auto share = total.count() > 0 ?
+        100.0 * time.total.count() / total.count() : 0.0;
+
+    lines.push_back(QString::fromStdString(time.plugin) + ": " +
+        formatMs(time.total) + " (" + QString::number(share, 'f', 1) +
+        "%), max " + formatMs(time.max) + ", " +
+        QString::number(time.stalls) + " stalls");
+  }
+
+  this->dataPtr->times = lines;
+  this->TimesChanged();
+
+  this->dataPtr->latency = formatMs(monitor->Latency()) + " (max " +
+      formatMs(monitor->MaxLatency()) + ")";
+  this->LatencyChanged();
+
+  this->dataPtr->stalls = static_cast<int>(monitor->StallCount());
+  this->StallsChanged();
+
+  // Memory
+  QStringList memoryLines;
+  for (auto plugin : App()->findChildren<Plugin *>())
+  {
+    QStringList categories;
+    for (const auto &category : plugin->MemoryUsageByCategory())
+    {
+      categories.push_back(QString::fromStdString(category.first) + " " +
+          formatBytes(category.second));
+    }
+
+    auto line = QString::fromStdString(plugin->Title()) + ": " +
+        formatBytes(plugin->MemoryUsage());
+    if (!categories.empty())
+      line += " (" + categories.join(", ") + ")";
+    line += ", " + QString::number(plugin->QmlObjectCount()) +
+        " QML objects";
+    if (plugin->MemoryBudget() > 0u)
+      line += ", budget " + formatBytes(plugin->MemoryBudget());
+
+    memoryLines.push_back(line);
+  }
+
+  this->dataPtr->memory = memoryLines;
+  this->MemoryChanged();
+}
+
+/////////////////////////////////////////////////
+void Diagnostics::OnReset()
+{
+  if (!App() || !App()->Monitor())
+    return;
+
+  App()->Monitor()->Reset();
+  this->Update();
+}
+
+/////////////////////////////////////////////////
+QStringList Diagnostics::Times() const
+{
+  return this->dataPtr->times;
+}
+
+/////////////////////////////////////////////////
+QStringList Diagnostics::Memory() const
+{
+  return this->dataPtr->memory;
+}
+
+/////////////////////////////////////////////////
+QString Diagnostics::Latency() const
+{
+  return this->dataPtr->latency;
+}
+
+/////////////////////////////////////////////////
+int Diagnostics::Stalls() const
+{
+  return this->dataPtr->stalls;
+}
+
+// Register this plugin
+IGNITION_ADD_PLUGIN(ignition::gui::plugins::Diagnostics,
+                    ignition::gui::Plugin)
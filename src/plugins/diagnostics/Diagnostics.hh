@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_DIAGNOSTICS_HH_
+#define IGNITION_GUI_PLUGINS_DIAGNOSTICS_HH_
+
+#include <memory>
+
+#include "ignition/gui/Plugin.hh"
+
+#ifndef _WIN32
+#  define Diagnostics_EXPORTS_API
+#else
+#  if (defined(Diagnostics_EXPORTS))
+#    define Diagnostics_EXPORTS_API __declspec(dllexport)
+#  else
+#    define Diagnostics_EXPORTS_API __declspec(dllimport)
+#  endif
+#endif
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class DiagnosticsPrivate;
+
+  /// \brief Displays how much time each plugin spends on the GUI thread,
+  /// the event loop latency and the number of GUI thread stalls detected.
+  /// Stalls themselves are logged as warnings whether this plugin is loaded
+  /// or not.
+  ///
+  /// It also displays the memory reported by each plugin, the number of QML
+  /// objects it created and its memory budget, if any.
+  ///
+  /// ## Configuration
+  ///
+  /// * \<stall_threshold\> : Optional time in milliseconds after which a
+  ///                         blocked GUI thread is reported as stalled.
+  ///                         This applies to the whole application, and
+  ///                         defaults to 200.
+  class Diagnostics_EXPORTS_API Diagnostics : public Plugin
+  {
+    Q_OBJECT
+
+    /// \brief One line of text per plugin, from the most to the least time
+    /// spent on the GUI thread
+    Q_PROPERTY(
+      QStringList times
+      READ Times
+      NOTIFY TimesChanged
+    )
+
+    /// \brief One line of text per plugin with its memory usage
+    Q_PROPERTY(
+      QStringList memory
+      READ Memory
+      NOTIFY MemoryChanged
+    )
+
+    /// \brief Event loop latency
+    Q_PROPERTY(
+      QString latency
+      READ Latency
+      NOTIFY LatencyChanged
+    )
+
+    /// \brief Number of stalls
+    Q_PROPERTY(
+      int stalls
+      READ Stalls
+      NOTIFY StallsChanged
+    )
+
+    /// \brief Constructor
+    public: Diagnostics();
+
+    /// \brief Destructor
+    public: virtual ~Diagnostics();
+
+    // Documentation inherited
+    public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+        override;
+
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
+    /// \brief Get the times per plugin
+    /// \return One line per plugin
+    public: Q_INVOKABLE QStringList Times() const;
+
+    /// \brief Notify that times have changed
+    signals: void TimesChanged();
+
+    /// \brief Get the memory usage per plugin
+    /// \return One line per plugin
+    public: Q_INVOKABLE QStringList Memory() const;
+
+    /// \brief Notify that memory usage has changed
+    signals: void MemoryChanged();
+
+    /// \brief Get the event loop latency, formatted for display
+    /// \return Latest and maximum latency
+    public: Q_INVOKABLE QString Latency() const;
+
+    /// \brief Notify that latency has changed
+    signals: void LatencyChanged();
+
+    /// \brief Get the number of stalls
+    /// \return Number of stalls
+    public: Q_INVOKABLE int Stalls() const;
+
+    /// \brief Notify that the number of stalls has changed
+    signals: void StallsChanged();
+
+    /// \brief Callback when the reset button is pressed
+    public slots: void OnReset();
+
+    /// \brief Update the displayed values from the application's monitor
+    private slots: void Update();
+
+    /// \internal
+    /// \brief Pointer to private data.
+    private: std::unique_ptr<DiagnosticsPrivate> dataPtr;
+  };
+}
+}
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+import QtQuick 2.9
+import QtQuick.Controls 2.2
+import QtQuick.Layouts 1.3
+
+Rectangle {
+  id: diagnostics
+  Layout.minimumWidth: 400
+  Layout.minimumHeight: 400
+  color: "transparent"
+
+  ColumnLayout {
+    anchors.fill: parent
+    anchors.margins: 10
+
+    GridLayout {
+      columns: 2
+
+      Label {
+        text: "Event loop latency"
+        font.weight: Font.DemiBold
+      }
+      Label {
+        text: Diagnostics.latency
+      }
+
+      Label {
+        text: "Stalls"
+        font.weight: Font.DemiBold
+      }
+      Label {
+        text: Diagnostics.stalls
+      }
+    }
+
+    Label {
+      text: "GUI thread time per plugin"
+      font.weight: Font.DemiBold
+    }
+
+    ListView {
+      id: listView
+      clip: true
+      Layout.fillWidth: true
+      Layout.fillHeight: true
+
+      model: Diagnostics.times
+
+      delegate: Label {
+        width: listView.width
+        text: modelData
+        elide: Text.ElideRight
+      }
+
+      ScrollIndicator.vertical: ScrollIndicator {
+        active: true
+      }
+    }
+
+    Label {
+      text: "Memory per plugin"
+      font.weight: Font.DemiBold
+    }
+
+    ListView {
+      id: memoryView
+      clip: true
+      Layout.fillWidth: true
+      Layout.fillHeight: true
+
+      model: Diagnostics.memory
+
+      delegate: Label {
+        width: memoryView.width
+        text: modelData
+        elide: Text.ElideRight
+      }
+
+      ScrollIndicator.vertical: ScrollIndicator {
+        active: true
+      }
+    }
+
+    Button {
+      text: qsTr("Reset")
+      onClicked: {
+        Diagnostics.OnReset()
+      }
+    }
+  }
+}
@@ -16,6 +16,7 @@
 */
 
 #include <QQuickImageProvider>
+#include <cstring>
 #include <iostream>
 
 #include <ignition/common/Console.hh>
@@ -24,6 +25,8 @@
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gui/Application.hh"
+#include "ignition/gui/SharedImage.hh"
+#include "ignition/gui/SharedRing.hh"
 #include "ImageDisplay.hh"
 
 namespace ignition
@@ -68,9 +71,22 @@ namespace plugins
     /// \brief List of topics publishing image messages.
     public: QStringList topicList;
 
+    /// \brief Topic currently chosen, which is only subscribed to while the
+    /// plugin isn't suspended.
+    public: std::string topic;
+
     /// \brief Holds data to set as the next image
     public: msgs::Image imageMsg;
 
+    /// \brief True if imageMsg hasn't been converted yet
+    public: bool newMsg{false};
+
+    /// \brief True while a conversion is queued or running on a worker
+    public: bool converting{false};
+
+    /// \brief Latest converted image, waiting to be handed to the provider
+    public: QImage image;
+
     /// \brief Node for communication.
     public: transport::Node node;
 
@@ -79,6 +95,10 @@ namespace plugins
 
     /// \brief To provide images for QML.
     public: ImageProvider *provider{nullptr};
+
+    /// \brief Ring of the shared image publisher on the current topic, if
+    /// any. Only used by conversions.
+    public: std::unique_ptr<SharedRing> sharedImages;
   };
 }
 }
@@ -88,6 +108,206 @@ using namespace ignition;
 using namespace gui;
 using namespace plugins;
 
+/// \brief Header of an image passed from a helper to its proxy, followed by
+/// the image's bytes
+struct HelperImage
+{
+  /// \brief Width in pixels
+  int32_t width;
+
+  /// \brief Height in pixels
+  int32_t height;
+
+  /// \brief Bytes per line
+  int32_t bytesPerLine;
+
+  /// \brief QImage::Format
+  int32_t format;
+};
+
+/////////////////////////////////////////////////
+/// \brief Convert from RGB_INT8
+/// \param[in] _data Pixels, which may be in a message or in shared memory
+/// \param[in] _width Width in pixels
+/// \param[in] _height Height in pixels
+/// \param[in] _step Bytes per row
+/// \return Converted image, which owns its data
+static QImage imageFromRgbInt8(const char *_data, const unsigned int _width,
+    const unsigned int _height, const unsigned int _step)
+{
+  QImage image(reinterpret_cast<const uchar *>(_data), _width, _height,
+      _step, QImage::Format_RGB888);
+
+  // Detach from the message's buffer
+  return image.copy();
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert from R_FLOAT32
+/// \param[in] _data Pixels, which may be in a message or in shared memory
+/// \param[in] _width Width in pixels
+/// \param[in] _height Height in pixels
+/// \return Converted image
+static QImage imageFromFloat32(const char *_data, const unsigned int _width,
+    const unsigned int _height)
+{
+  unsigned int height = _height;
+  unsigned int width = _width;
+  QImage::Format qFormat = QImage::Format_RGB888;
+
+  QImage image = QImage(width, height, qFormat);
+
+  unsigned int depthSamples = width * height;
+  float f;
+  // cppchecker recommends using sizeof(varname)
+  unsigned int depthBufferSize = depthSamples * sizeof(f);
+
+  float * depthBuffer = new float[depthSamples];
+
+  memcpy(depthBuffer, _data, depthBufferSize);
+
+  float maxDepth = 0;
+  for (unsigned int i = 0; i < depthSamples; ++i)
+  {
+    if (depthBuffer[i] > maxDepth && !std::isinf(depthBuffer[i]))
+    {
+      maxDepth = depthBuffer[i];
+    }
+  }
+  unsigned int idx = 0;
+  double factor = 255 / maxDepth;
+  for (unsigned int j = 0; j < height; ++j)
+  {
+    for (unsigned int i = 0; i < width; ++i)
+    {
+      float d = depthBuffer[idx++];
+      d = 255 - (d * factor);
+      QRgb value = qRgb(d, d, d);
+      image.setPixel(i, j, value);
+    }
+  }
+
+  delete[] depthBuffer;
+
+  return image;
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert from L_INT16
+/// \param[in] _data Pixels, which may be in a message or in shared memory
+/// \param[in] _width Width in pixels
+/// \param[in] _height Height in pixels
+/// \return Converted image
+static QImage imageFromLInt16(const char *_data, const unsigned int _width,
+    const unsigned int _height)
+{
+  unsigned int height = _height;
+  unsigned int width = _width;
+  QImage::Format qFormat = QImage::Format_RGB888;
+
+  QImage image = QImage(width, height, qFormat);
+
+  unsigned int samples = width * height;
+  uint16_t type;
+  // cppchecker recommends using sizeof(varname)
+  unsigned int bufferSize = samples * sizeof(type);
+
+  uint16_t *buffer = new uint16_t[samples];
+  memcpy(buffer, _data, bufferSize);
+
+  // get min and max of temperature values
+  uint16_t min = std::numeric_limits<uint16_t>::max();
+  uint16_t max = 0;
+  for (unsigned int i = 0; i < samples; ++i)
+  {
+    uint16_t temp = buffer[i];
+    if (temp > max)
+      max = temp;
+    if (temp < min)
+      min = temp;
+  }
+
+  // convert temperature to grayscale image
+  double range = static_cast<double>(max - min);
+  if (ignition::math::equal(range, 0.0))
+    range = 1.0;
+  unsigned int idx = 0;
+  for (unsigned int j = 0; j < height; ++j)
+  {
+    for (unsigned int i = 0; i < width; ++i)
+    {
+      uint16_t temp = buffer[idx++];
+      double t = static_cast<double>(temp-min) / range;
+      int r = 255*t;
+      int g = r;
+      int b = r;
+      QRgb value = qRgb(r, g, b);
+      image.setPixel(i, j, value);
+    }
+  }
+
+  delete[] buffer;
+
+  return image;
+}
+
+/////////////////////////////////////////////////
+/// \brief Convert pixels in any of the supported formats
+/// \param[in] _data Pixels, which may be in a message or in shared memory
+/// \param[in] _size Number of bytes in _data
+/// \param[in] _width Width in pixels
+/// \param[in] _height Height in pixels
+/// \param[in] _step Bytes per row, zero if unknown
+/// \param[in] _format Pixel format
+/// \return Converted image, null if the format isn't supported or there
+/// aren't enough pixels
+static QImage convert(const char *_data, const std::size_t _size,
+    const unsigned int _width, const unsigned int _height,
+    unsigned int _step, const msgs::PixelFormatType _format)
+{
+  std::size_t pixelSize{0u};
+  switch (_format)
+  {
+    case msgs::PixelFormatType::RGB_INT8:
+      pixelSize = 3u;
+      break;
+    case msgs::PixelFormatType::R_FLOAT32:
+      pixelSize = sizeof(float);
+      break;
+    case msgs::PixelFormatType::L_INT16:
+      pixelSize = sizeof(uint16_t);
+      break;
+    default:
+    {
+      ignwarn << "Unsupported image type: " << _format << std::endl;
+      return QImage();
+    }
+  }
+
+  if (_step == 0u)
+    _step = _width * pixelSize;
+
+  if (_step < _width * pixelSize)
+  {
+    ignwarn << "Image [" << _width << "] pixels wide only has [" << _step
+            << "] bytes per row." << std::endl;
+    return QImage();
+  }
+
+  if (_size < static_cast<std::size_t>(_step) * _height)
+  {
+    ignwarn << "Image of [" << _width << "x" << _height << "] only has ["
+            << _size << "] bytes." << std::endl;
+    return QImage();
+  }
+
+  if (_format == msgs::PixelFormatType::RGB_INT8)
+    return imageFromRgbInt8(_data, _width, _height, _step);
+  if (_format == msgs::PixelFormatType::R_FLOAT32)
+    return imageFromFloat32(_data, _width, _height);
+  return imageFromLInt16(_data, _width, _height);
+}
+
 /////////////////////////////////////////////////
 ImageDisplay::ImageDisplay()
   : Plugin(), dataPtr(new ImageDisplayPrivate)
@@ -142,34 +362,135 @@ void ImageDisplay::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 /////////////////////////////////////////////////
 void ImageDisplay::ProcessImage()
 {
+  QImage image;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->imageMutex);
+    std::swap(image, this->dataPtr->image);
+  }
+
+  if (image.isNull())
+    return;
+
+  this->dataPtr->provider->SetImage(image);
+  this->newImage();
+
+  this->SetMemoryUsage("images", image.sizeInBytes());
+}
+
+/////////////////////////////////////////////////
+void ImageDisplay::ConvertImage()
+{
+  msgs::Image msg;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->imageMutex);
+    msg.Swap(&this->dataPtr->imageMsg);
+    this->dataPtr->newMsg = false;
+  }
+
+  QImage image;
+  auto key = SharedImageKey(msg);
+  if (key.empty())
+  {
+    image = convert(msg.data().data(), msg.data().size(), msg.width(),
+        msg.height(), msg.step(), msg.pixel_format_type());
+  }
+  else
+  {
+    image = this->ConvertSharedImage(key);
+  }
+
+  // Helpers pass the image to their proxy instead of displaying it
+  auto ring = this->HelperRing();
+  if (this->IsHelper() && !image.isNull())
+  {
+    std::size_t size = sizeof(HelperImage) + image.sizeInBytes();
+    if (size > ring->SlotSize())
+    {
+      ignerr << "Image of [" << size << "] bytes doesn't fit in the ["
+             << ring->SlotSize() << "] bytes shared with the main process. "
+             << "Increase the slot_size of <separate_process>." << std::endl;
+    }
+    else if (auto slot = static_cast<char *>(ring->BeginWrite()))
+    {
+      HelperImage header{image.width(), image.height(),
+          image.bytesPerLine(), static_cast<int32_t>(image.format())};
+      std::memcpy(slot, &header, sizeof(header));
+      std::memcpy(slot + sizeof(header), image.constBits(),
+          image.sizeInBytes());
+      ring->EndWrite(size);
+    }
+    image = QImage();
+  }
+
   std::lock_guard<std::recursive_mutex> lock(this->dataPtr->imageMutex);
-  switch (this->dataPtr->imageMsg.pixel_format_type())
+  this->dataPtr->image = image;
+
+  // Frames which arrived during the conversion were coalesced into the
+  // latest one, convert it next.
+  if (this->dataPtr->newMsg)
   {
-    case msgs::PixelFormatType::RGB_INT8:
-      this->UpdateFromRgbInt8();
-      break;
-    case msgs::PixelFormatType::R_FLOAT32:
-      this->UpdateFromFloat32();
-      break;
-    case msgs::PixelFormatType::L_INT16:
-      this->UpdateFromLInt16();
-      break;
-    default:
+    this->RunInBackground([this]() {this->ConvertImage();},
+        [this]() {this->ProcessImage();});
+  }
+  else
+  {
+    this->dataPtr->converting = false;
+  }
+}
+
+/////////////////////////////////////////////////
+QImage ImageDisplay::ConvertSharedImage(const std::string &_key)
+{
+  auto &ring = this->dataPtr->sharedImages;
+  if (!ring || ring->Key() != _key)
+  {
+    ring = std::make_unique<SharedRing>();
+    if (!ring->Attach(_key))
     {
-      ignwarn << "Unsupported image type: "
-              << this->dataPtr->imageMsg.pixel_format_type() << std::endl;
+      ring.reset();
+      return QImage();
     }
   }
+
+  // Convert straight from shared memory, skipping images which were
+  // published during the previous conversion
+  std::size_t size{0u};
+  auto slot = static_cast<const char *>(ring->BeginRead(size, true));
+  if (!slot)
+    return QImage();
+
+  QImage image;
+  SharedImageHeader header;
+  if (size >= sizeof(header))
+  {
+    std::memcpy(&header, slot, sizeof(header));
+    image = convert(slot + sizeof(header), size - sizeof(header),
+        header.width, header.height, header.step,
+        static_cast<msgs::PixelFormatType>(header.pixelFormat));
+  }
+
+  ring->EndRead();
+  return image;
 }
 
 /////////////////////////////////////////////////
 void ImageDisplay::OnImageMsg(const msgs::Image &_msg)
 {
-  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->imageMutex);
-  this->dataPtr->imageMsg = _msg;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->dataPtr->imageMutex);
+    this->dataPtr->imageMsg = _msg;
+    this->dataPtr->newMsg = true;
+    this->SetMemoryUsage("messages", _msg.data().size());
+
+    // A conversion in flight will pick up the latest message
+    if (this->dataPtr->converting)
+      return;
+    this->dataPtr->converting = true;
+  }
 
-  // Signal to main thread that the image changed
-  QMetaObject::invokeMethod(this, "ProcessImage");
+  // Convert off the transport and GUI threads
+  this->RunInBackground([this]() {this->ConvertImage();},
+      [this]() {this->ProcessImage();});
 }
 
 /////////////////////////////////////////////////
@@ -179,158 +500,131 @@ void ImageDisplay::OnTopic(const QString _topic)
   if (topic.empty())
     return;
 
+  this->dataPtr->topic = topic;
+
   // Unsubscribe
   auto subs = this->dataPtr->node.SubscribedTopics();
   for (auto sub : subs)
     this->dataPtr->node.Unsubscribe(sub);
 
+  // The helper subscribes instead
+  if (this->IsProxy())
+  {
+    this->SendToHelper(topic);
+    return;
+  }
+
+  // Subscribe once resumed
+  if (this->Suspended())
+    return;
+
   // Subscribe to new topic
   if (!this->dataPtr->node.Subscribe(topic, &ImageDisplay::OnImageMsg,
-      this))
+      this, this->SubscribeOptions(topic)))
   {
     ignerr << "Unable to subscribe to topic [" << topic << "]" << std::endl;
   }
 }
 
 /////////////////////////////////////////////////
-void ImageDisplay::OnRefresh()
+void ImageDisplay::Suspend()
 {
-  // Clear
-  this->dataPtr->topicList.clear();
-
-  // Get updated list
-  std::vector<std::string> allTopics;
-  this->dataPtr->node.TopicList(allTopics);
-  for (auto topic : allTopics)
-  {
-    std::vector<transport::MessagePublisher> publishers;
-    this->dataPtr->node.TopicInfo(topic, publishers);
-    for (auto pub : publishers)
-    {
-      if (pub.MsgTypeName() == "ignition.msgs.Image")
-      {
-        this->dataPtr->topicList.push_back(QString::fromStdString(topic));
-        break;
-      }
-    }
-  }
-
-  // Select first one
-  if (this->dataPtr->topicList.count() > 0)
-    this->OnTopic(this->dataPtr->topicList.at(0));
-  this->TopicListChanged();
+  // Stop receiving and converting frames nobody can see
+  for (auto sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
 }
 
 /////////////////////////////////////////////////
-void ImageDisplay::UpdateFromRgbInt8()
+void ImageDisplay::Resume()
 {
-  QImage image(
-    reinterpret_cast<const uchar *>(this->dataPtr->imageMsg.data().c_str()),
-    this->dataPtr->imageMsg.width(), this->dataPtr->imageMsg.height(),
-    QImage::Format_RGB888);
+  // The helper resumes on its own
+  if (this->IsProxy())
+    return;
 
-  this->dataPtr->provider->SetImage(image);
-  this->newImage();
+  this->OnTopic(QString::fromStdString(this->dataPtr->topic));
 }
 
 /////////////////////////////////////////////////
-void ImageDisplay::UpdateFromFloat32()
+void ImageDisplay::ShrinkMemory(const uint64_t /*_budget*/)
 {
-  unsigned int height = this->dataPtr->imageMsg.height();
-  unsigned int width = this->dataPtr->imageMsg.width();
-  QImage::Format qFormat = QImage::Format_RGB888;
-
-  QImage image = QImage(width, height, qFormat);
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->imageMutex);
 
-  unsigned int depthSamples = width * height;
-  float f;
-  // cppchecker recommends using sizeof(varname)
-  unsigned int depthBufferSize = depthSamples * sizeof(f);
+  // Keep the displayed image and frames waiting to be converted, and drop
+  // what's left over from previous conversions
+  if (!this->dataPtr->newMsg)
+  {
+    msgs::Image empty;
+    this->dataPtr->imageMsg.Swap(&empty);
+    this->SetMemoryUsage("messages", 0u);
+  }
 
-  float * depthBuffer = new float[depthSamples];
+  // Attached again on the next shared image
+  if (!this->dataPtr->converting)
+    this->dataPtr->sharedImages.reset();
+}
 
-  memcpy(depthBuffer, this->dataPtr->imageMsg.data().c_str(),
-      depthBufferSize);
+/////////////////////////////////////////////////
+void ImageDisplay::OnHelperData(const void *_data, const std::size_t _size)
+{
+  HelperImage header;
+  if (_size < sizeof(header))
+    return;
+  std::memcpy(&header, _data, sizeof(header));
 
-  float maxDepth = 0;
-  for (unsigned int i = 0; i < depthSamples; ++i)
+  if (_size < sizeof(header) +
+      static_cast<std::size_t>(header.bytesPerLine) * header.height)
   {
-    if (depthBuffer[i] > maxDepth && !std::isinf(depthBuffer[i]))
-    {
-      maxDepth = depthBuffer[i];
-    }
-  }
-  unsigned int idx = 0;
-  double factor = 255 / maxDepth;
-  for (unsigned int j = 0; j < height; ++j)
-  {
-    for (unsigned int i = 0; i < width; ++i)
-    {
-      float d = depthBuffer[idx++];
-      d = 255 - (d * factor);
-      QRgb value = qRgb(d, d, d);
-      image.setPixel(i, j, value);
-    }
+    ignerr << "Received truncated image from helper." << std::endl;
+    return;
   }
 
+  QImage image(static_cast<const uchar *>(_data) + sizeof(header),
+      header.width, header.height, header.bytesPerLine,
+      static_cast<QImage::Format>(header.format));
+
+  // Detach from the shared memory, which is reused once this returns
+  image = image.copy();
+
   this->dataPtr->provider->SetImage(image);
   this->newImage();
 
-  delete[] depthBuffer;
+  this->SetMemoryUsage("images", image.sizeInBytes());
 }
 
 /////////////////////////////////////////////////
-void ImageDisplay::UpdateFromLInt16()
+void ImageDisplay::OnProxyMessage(const std::string &_message)
 {
-  unsigned int height = this->dataPtr->imageMsg.height();
-  unsigned int width = this->dataPtr->imageMsg.width();
-  QImage::Format qFormat = QImage::Format_RGB888;
-
-  QImage image = QImage(width, height, qFormat);
-
-  unsigned int samples = width * height;
-  uint16_t type;
-  // cppchecker recommends using sizeof(varname)
-  unsigned int bufferSize = samples * sizeof(type);
-
-  uint16_t *buffer = new uint16_t[samples];
-  memcpy(buffer, this->dataPtr->imageMsg.data().c_str(),
-      bufferSize);
+  // The proxy only sends the topic chosen by the user
+  this->OnTopic(QString::fromStdString(_message));
+}
 
-  // get min and max of temperature values
-  uint16_t min = std::numeric_limits<uint16_t>::max();
-  uint16_t max = 0;
-  for (unsigned int i = 0; i < samples; ++i)
-  {
-    uint16_t temp = buffer[i];
-    if (temp > max)
-      max = temp;
-    if (temp < min)
-      min = temp;
-  }
+/////////////////////////////////////////////////
+void ImageDisplay::OnRefresh()
+{
+  // Clear
+  this->dataPtr->topicList.clear();
 
-  // convert temperature to grayscale image
-  double range = static_cast<double>(max - min);
-  if (ignition::math::equal(range, 0.0))
-    range = 1.0;
-  unsigned int idx = 0;
-  for (unsigned int j = 0; j < height; ++j)
+  // Get updated list
+  std::vector<std::string> allTopics;
+  this->dataPtr->node.TopicList(allTopics);
+  for (auto topic : allTopics)
   {
-    for (unsigned int i = 0; i < width; ++i)
+    std::vector<transport::MessagePublisher> publishers;
+    this->dataPtr->node.TopicInfo(topic, publishers);
+    for (auto pub : publishers)
     {
-      uint16_t temp = buffer[idx++];
-      double t = static_cast<double>(temp-min) / range;
-      int r = 255*t;
-      int g = r;
-      int b = r;
-      QRgb value = qRgb(r, g, b);
-      image.setPixel(i, j, value);
+      if (pub.MsgTypeName() == "ignition.msgs.Image")
+      {
+        this->dataPtr->topicList.push_back(QString::fromStdString(topic));
+        break;
+      }
     }
   }
-  this->dataPtr->provider->SetImage(image);
-  this->newImage();
 
-  delete[] buffer;
+  // Select first one
+  if (this->dataPtr->topicList.count() > 0)
+    this->OnTopic(this->dataPtr->topicList.at(0));
+  this->TopicListChanged();
 }
 
 /////////////////////////////////////////////////
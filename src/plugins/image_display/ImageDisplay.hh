@@ -33,6 +33,10 @@ namespace plugins
 
   /// \brief Display images coming through an Ignition transport topic.
   ///
+  /// Images can be received and converted in a helper process, see
+  /// `<separate_process>`. Images published on the same machine with a
+  /// SharedImagePublisher are read straight from shared memory.
+  ///
   /// ## Configuration
   ///
   /// \<topic\> : Set the topic to receive image messages.
@@ -59,6 +63,22 @@ namespace plugins
     // Documentation inherited
     public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem);
 
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
+    // Documentation inherited
+    protected: void ShrinkMemory(const uint64_t _budget) override;
+
+    // Documentation inherited
+    protected: void OnHelperData(const void *_data, const std::size_t _size)
+        override;
+
+    // Documentation inherited
+    protected: void OnProxyMessage(const std::string &_message) override;
+
     /// \brief Callback when refresh button is pressed.
     public slots: void OnRefresh();
 
@@ -84,14 +104,15 @@ namespace plugins
     /// \brief Callback in main thread when image changes
     private slots: void ProcessImage();
 
-    /// \brief Update from rx'd RGB_INT8
-    private: void UpdateFromRgbInt8();
-
-    /// \brief Update from rx'd R_FLOAT32
-    private: void UpdateFromFloat32();
+    /// \brief Convert the latest image message into a QImage. Runs on a
+    /// worker thread.
+    private: void ConvertImage();
 
-    /// \brief Update from L_INT16
-    private: void UpdateFromLInt16();
+    /// \brief Convert the latest image written by a shared image publisher.
+    /// Runs on a worker thread.
+    /// \param[in] _key Key of the publisher's ring.
+    /// \return Converted image, null if there was none.
+    private: QImage ConvertSharedImage(const std::string &_key);
 
     /// \brief Subscriber callback when new image is received
     /// \param[in] _msg New image
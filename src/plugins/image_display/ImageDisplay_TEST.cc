@@ -16,151 +16,129 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
 #include <ignition/common/Console.hh>
-#include <ignition/common/Image.hh>
+#include <ignition/msgs/image.pb.h>
 #include <ignition/transport/Node.hh>
 
-#include "ignition/gui/Iface.hh"
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
 #include "ignition/gui/Plugin.hh"
 #include "ignition/gui/MainWindow.hh"
+#include "ignition/gui/SharedImage.hh"
+#include "ImageDisplay.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
 
 using namespace ignition;
 using namespace gui;
 
 /////////////////////////////////////////////////
-TEST(ImageDisplayTest, Load)
+/// \brief Load an image display on a topic and show its window
+/// \param[in] _app Application
+/// \param[in] _topic Topic
+/// \return The plugin, null on failure
+plugins::ImageDisplay *loadImageDisplay(Application &_app,
+    const std::string &_topic)
 {
-  EXPECT_TRUE(initApp());
-
-  EXPECT_TRUE(loadPlugin("ImageDisplay"));
-
-  EXPECT_TRUE(stop());
-}
+  _app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
 
-/////////////////////////////////////////////////
-TEST(ImageDisplayTest, DefaultConfig)
-{
-  setVerbosity(4);
-  EXPECT_TRUE(initApp());
-
-  // Load plugin
-  EXPECT_TRUE(loadPlugin("ImageDisplay"));
+  std::string pluginStr =
+    "<plugin filename=\"ImageDisplay\">"
+      "<topic>" + _topic + "</topic>"
+      "<topic_picker>false</topic_picker>"
+    "</plugin>";
 
-  // Create main window
-  EXPECT_TRUE(createMainWindow());
-  auto win = mainWindow();
-  EXPECT_TRUE(win != nullptr);
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(pluginStr.c_str());
+  EXPECT_TRUE(_app.LoadPlugin("ImageDisplay",
+      pluginDoc.FirstChildElement("plugin")));
 
-  // Get plugin
-  auto plugins = win->findChildren<Plugin *>();
-  EXPECT_EQ(plugins.size(), 1);
-  auto plugin = plugins[0];
-  EXPECT_EQ(plugin->Title(), "Image display");
+  auto win = _app.findChild<MainWindow *>();
+  if (!win)
+    return nullptr;
 
-  // Has a topic picker
-  auto topicsCombo = plugin->findChild<QComboBox *>("topicsCombo");
-  EXPECT_TRUE(topicsCombo != nullptr);
-  EXPECT_EQ(topicsCombo->count(), 0);
+  // Show, but don't exec, so we don't block. Hidden plugins are suspended.
+  win->QuickWindow()->show();
 
-  auto refreshButton = plugin->findChild<QPushButton *>("refreshButton");
-  EXPECT_TRUE(refreshButton != nullptr);
+  return win->findChild<plugins::ImageDisplay *>();
+}
 
-  // No images
-  auto label = plugin->findChild<QLabel *>();
-  EXPECT_TRUE(label != nullptr);
-  EXPECT_EQ(label->text(), "No image");
+/////////////////////////////////////////////////
+/// \brief Get the image the plugin gives QML
+/// \param[in] _plugin Plugin
+/// \return Image, a 400x400 placeholder until one is received
+QImage providedImage(plugins::ImageDisplay *_plugin)
+{
+  auto provider = dynamic_cast<QQuickImageProvider *>(
+      App()->Engine()->imageProvider(
+      _plugin->CardItem()->objectName() + "imagedisplay"));
+  if (!provider)
+    return QImage();
+
+  QSize size;
+  return provider->requestImage(QString(), &size, QSize());
+}
 
-  // Cleanup
-  plugins.clear();
-  EXPECT_TRUE(stop());
+/////////////////////////////////////////////////
+/// \brief Process events until the plugin gets a new image, for up to 1 s
+/// \param[in] _count Number of new images so far
+/// \param[in] _expected Number of new images to wait for
+void waitForImages(const int &_count, const int _expected)
+{
+  for (int sleep = 0; sleep < 10 && _count < _expected; ++sleep)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    QCoreApplication::processEvents();
+  }
 }
 
 /////////////////////////////////////////////////
-TEST(ImageDisplayTest, NoPickerNeedsTopic)
+TEST(ImageDisplayTest, Load)
 {
-  setVerbosity(4);
-  EXPECT_TRUE(initApp());
+  common::Console::SetVerbosity(4);
 
-  // Load plugin
-  const char *pluginStr =
-    "<plugin filename=\"ImageDisplay\">"
-      "<topic_picker>false</topic_picker>"
-    "</plugin>";
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
 
-  tinyxml2::XMLDocument pluginDoc;
-  pluginDoc.Parse(pluginStr);
-  EXPECT_TRUE(loadPlugin("ImageDisplay",
-      pluginDoc.FirstChildElement("plugin")));
+  EXPECT_TRUE(app.LoadPlugin("ImageDisplay"));
 
-  // Create main window
-  EXPECT_TRUE(createMainWindow());
-  auto win = mainWindow();
-  EXPECT_TRUE(win != nullptr);
+  // Get main window
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
 
   // Get plugin
   auto plugins = win->findChildren<Plugin *>();
   EXPECT_EQ(plugins.size(), 1);
+
   auto plugin = plugins[0];
   EXPECT_EQ(plugin->Title(), "Image display");
 
-  // Has a topic picker anyway
-  auto topicsCombo = plugin->findChild<QComboBox *>("topicsCombo");
-  EXPECT_TRUE(topicsCombo != nullptr);
-  EXPECT_EQ(topicsCombo->count(), 0);
-
-  auto refreshButton = plugin->findChild<QPushButton *>("refreshButton");
-  EXPECT_TRUE(refreshButton != nullptr);
-
-  // No images
-  auto label = plugin->findChild<QLabel *>();
-  EXPECT_TRUE(label != nullptr);
-  EXPECT_EQ(label->text(), "No image");
-
   // Cleanup
   plugins.clear();
-  EXPECT_TRUE(stop());
 }
 
 /////////////////////////////////////////////////
 TEST(ImageDisplayTest, ReceiveImage)
 {
-  setVerbosity(4);
-  EXPECT_TRUE(initApp());
-
-  // Load plugin
-  const char *pluginStr =
-    "<plugin filename=\"ImageDisplay\">"
-      "<topic>/image_test</topic>"
-      "<topic_picker>false</topic_picker>"
-    "</plugin>";
-
-  tinyxml2::XMLDocument pluginDoc;
-  pluginDoc.Parse(pluginStr);
-  EXPECT_TRUE(loadPlugin("ImageDisplay",
-      pluginDoc.FirstChildElement("plugin")));
+  common::Console::SetVerbosity(4);
 
-  // Create main window
-  EXPECT_TRUE(createMainWindow());
-  auto win = mainWindow();
-  EXPECT_TRUE(win != nullptr);
+  Application app(g_argc, g_argv);
+  auto plugin = loadImageDisplay(app, "/image_test");
+  ASSERT_NE(nullptr, plugin);
 
-  // Get plugin
-  auto plugins = win->findChildren<Plugin *>();
-  EXPECT_EQ(plugins.size(), 1);
-  auto plugin = plugins[0];
-  EXPECT_EQ(plugin->Title(), "Image display");
-
-  // Doesn't have a topic picker
-  EXPECT_EQ(plugin->findChildren<QComboBox *>().size(), 0);
-  EXPECT_EQ(plugin->findChildren<QPushButton *>().size(), 0);
+  int count{0};
+  QObject::connect(plugin, &plugins::ImageDisplay::newImage,
+      [&count]() {++count;});
 
-  // Starts with no image
-  auto label = plugin->findChild<QLabel *>();
-  EXPECT_TRUE(label != nullptr);
-  EXPECT_EQ(label->text(), "No image");
-  EXPECT_TRUE(label->pixmap() == nullptr);
+  // Starts with a placeholder
+  EXPECT_EQ(400, providedImage(plugin).width());
 
-  // Publish images
   transport::Node node;
   auto pub = node.Advertise<msgs::Image>("/image_test");
 
@@ -169,103 +147,112 @@ TEST(ImageDisplayTest, ReceiveImage)
     msgs::Image msg;
     msg.set_height(100);
     msg.set_width(200);
-    msg.set_pixel_format(common::Image::RGB_FLOAT32);
+    msg.set_pixel_format_type(msgs::PixelFormatType::RGB_FLOAT32);
+    msg.mutable_data()->assign(200 * 100 * 12, '\0');
     pub.Publish(msg);
   }
-
-  // Give it time to be processed
-  int sleep = 0;
-  int maxSleep = 10;
-  while (!label->text().isEmpty() && sleep < maxSleep)
-  {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    QCoreApplication::processEvents();
-    sleep++;
-  }
-
-  // Still no image
-  EXPECT_EQ(label->text(), "No image");
-  EXPECT_TRUE(label->pixmap() == nullptr);
+  waitForImages(count, 1);
+  EXPECT_EQ(0, count);
 
   // Good message
   {
     msgs::Image msg;
     msg.set_height(100);
     msg.set_width(200);
-    msg.set_pixel_format(common::Image::RGB_INT8);
+    msg.set_pixel_format_type(msgs::PixelFormatType::RGB_INT8);
+    msg.mutable_data()->assign(200 * 100 * 3, '\x40');
     pub.Publish(msg);
   }
+  waitForImages(count, 1);
+  EXPECT_EQ(1, count);
 
-  // Give it time to be processed
-  sleep = 0;
-  while (!label->text().isEmpty() && sleep < maxSleep)
-  {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    QCoreApplication::processEvents();
-    sleep++;
-  }
-
-  // Now it has an image
-  EXPECT_TRUE(label->text().isEmpty());
-  ASSERT_NE(nullptr, label->pixmap());
-  EXPECT_EQ(label->pixmap()->height(), 100);
-  EXPECT_EQ(label->pixmap()->width(), 200);
-
-  // Cleanup
-  plugins.clear();
-  EXPECT_TRUE(stop());
+  auto image = providedImage(plugin);
+  EXPECT_EQ(200, image.width());
+  EXPECT_EQ(100, image.height());
+  EXPECT_EQ(qRgb(0x40, 0x40, 0x40), image.pixel(10, 10));
 }
 
 /////////////////////////////////////////////////
-TEST(ImageDisplayTest, TopicPicker)
+TEST(ImageDisplayTest, SharedImage)
 {
-  setVerbosity(4);
-  EXPECT_TRUE(initApp());
+  common::Console::SetVerbosity(4);
 
-  // Load plugin
-  EXPECT_TRUE(loadPlugin("ImageDisplay"));
+  Application app(g_argc, g_argv);
+  auto plugin = loadImageDisplay(app, "/image_test_shared");
+  ASSERT_NE(nullptr, plugin);
 
-  // Create main window
-  EXPECT_TRUE(createMainWindow());
-  auto win = mainWindow();
-  EXPECT_TRUE(win != nullptr);
+  int count{0};
+  QObject::connect(plugin, &plugins::ImageDisplay::newImage,
+      [&count]() {++count;});
 
-  // Get plugin
-  auto plugins = win->findChildren<Plugin *>();
-  EXPECT_EQ(plugins.size(), 1);
-  auto plugin = plugins[0];
-  EXPECT_EQ(plugin->Title(), "Image display");
+  msgs::Image msg;
+  msg.set_height(10);
+  msg.set_width(20);
+  msg.set_pixel_format_type(msgs::PixelFormatType::RGB_INT8);
+  msg.mutable_data()->assign(20 * 10 * 3, '\x80');
 
-  // Topic picker starts empty
-  auto topicsCombo = plugin->findChild<QComboBox *>("topicsCombo");
-  EXPECT_TRUE(topicsCombo != nullptr);
-  EXPECT_EQ(topicsCombo->count(), 0);
+  SharedImagePublisher pub;
+  ASSERT_TRUE(pub.Advertise("/image_test_shared", msg.data().size()));
 
-  auto refreshButton = plugin->findChild<QPushButton *>("refreshButton");
-  EXPECT_TRUE(refreshButton != nullptr);
+  // Wait for discovery
+  for (int sleep = 0; sleep < 10 && count == 0; ++sleep)
+  {
+    pub.Publish(msg);
+    waitForImages(count, 1);
+  }
+  EXPECT_LE(1, count);
+
+  // The pixels were read from shared memory
+  auto image = providedImage(plugin);
+  EXPECT_EQ(20, image.width());
+  EXPECT_EQ(10, image.height());
+  EXPECT_EQ(qRgb(0x80, 0x80, 0x80), image.pixel(5, 5));
+}
+
+/////////////////////////////////////////////////
+TEST(ImageDisplayTest, TooFewBytes)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadImageDisplay(app, "/image_test_short");
+  ASSERT_NE(nullptr, plugin);
 
-  // Refresh and still empty
-  refreshButton->click();
-  EXPECT_EQ(topicsCombo->count(), 0);
+  int count{0};
+  QObject::connect(plugin, &plugins::ImageDisplay::newImage,
+      [&count]() {++count;});
 
-  // Advertise topics
   transport::Node node;
-  auto pubImage = node.Advertise<msgs::Image>("/image_test");
-  auto pubImage2 = node.Advertise<msgs::Image>("/image_test_2");
-  auto pubString = node.Advertise<msgs::StringMsg>("/string_test");
+  auto pub = node.Advertise<msgs::Image>("/image_test_short");
 
-  // Refresh and now we have image topics
-  refreshButton->click();
-  EXPECT_EQ(topicsCombo->count(), 2);
-  EXPECT_EQ(topicsCombo->itemText(0), "/image_test");
-  EXPECT_EQ(topicsCombo->itemText(1), "/image_test_2");
+  // Wait for discovery
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+  // Fewer bytes than its size needs
+  {
+    msgs::Image msg;
+    msg.set_height(100);
+    msg.set_width(200);
+    msg.set_pixel_format_type(msgs::PixelFormatType::RGB_INT8);
+    msg.mutable_data()->assign(10, '\x40');
+    pub.Publish(msg);
+  }
+  waitForImages(count, 1);
+  EXPECT_EQ(0, count);
 
-  // Pick topics
-  topicsCombo->setCurrentIndex(1);
-  topicsCombo->setCurrentIndex(0);
-  topicsCombo->setCurrentIndex(1);
+  // Enough bytes, but rows shorter than the width
+  {
+    msgs::Image msg;
+    msg.set_height(100);
+    msg.set_width(200);
+    msg.set_step(3);
+    msg.set_pixel_format_type(msgs::PixelFormatType::RGB_INT8);
+    msg.mutable_data()->assign(200 * 100 * 3, '\x40');
+    pub.Publish(msg);
+  }
+  waitForImages(count, 1);
+  EXPECT_EQ(0, count);
 
-  // Cleanup
-  plugins.clear();
-  EXPECT_TRUE(stop());
+  // Still the placeholder
+  EXPECT_EQ(400, providedImage(plugin).width());
 }
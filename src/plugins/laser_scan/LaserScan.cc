@@ -0,0 +1,453 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Color.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/rendering.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/SceneMutationQueue.hh"
+#include "LaserScan.hh"
+#include "ScanRing.hh"
+
+// Default number of scans displayed
+static const int kDefaultDecay{10};
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Scans and the scene objects displaying them. Shared with the
+  /// scene mutations, which outlive the plugin.
+  struct ScanScene
+  {
+    /// \brief Marker displaying a slot of the ring, render thread only
+    struct Slot
+    {
+      /// \brief Visual
+      rendering::VisualPtr visual;
+
+      /// \brief Points
+      rendering::MarkerPtr marker;
+
+      /// \brief Material, whose transparency increases with age
+      rendering::MaterialPtr material;
+
+      /// \brief Number of the scan uploaded to the marker
+      uint64_t uploaded{0u};
+    };
+
+    /// \brief Constructor
+    /// \param[in] _depth Number of scans displayed
+    explicit ScanScene(const std::size_t _depth)
+      : ring(_depth), written(ring.Depth(), 0u), slots(ring.Depth())
+    {
+    }
+
+    /// \brief Render engine name
+    std::string engineName{"ogre"};
+
+    /// \brief Scene name
+    std::string sceneName{"scene"};
+
+    /// \brief Color of scans without intensities
+    math::Color color{math::Color::Red};
+
+    /// \brief Intensity range, automatic if min isn't below max
+    double minIntensity{0.0};
+
+    /// \brief Intensity range, automatic if min isn't below max
+    double maxIntensity{0.0};
+
+    /// \brief Protects the ring and written
+    std::mutex mutex;
+
+    /// \brief Latest scans
+    ScanRing ring;
+
+    /// \brief Number of the scan written to each slot, starting at 1
+    std::vector<uint64_t> written;
+
+    /// \brief Markers, render thread only
+    std::vector<Slot> slots;
+
+    /// \brief Positions copied out of the ring, render thread only
+    std::vector<float> positions;
+
+    /// \brief Intensities copied out of the ring, render thread only
+    std::vector<float> intensities;
+  };
+
+  class LaserScanPrivate
+  {
+    /// \brief Topic to subscribe to while the plugin isn't suspended
+    public: std::string topic;
+
+    /// \brief Node for communication
+    public: transport::Node node;
+
+    /// \brief Scans, shared with scene mutations
+    public: std::shared_ptr<ScanScene> scene;
+
+    /// \brief Key of this plugin's mutations, so that scans arriving
+    /// faster than frames are uploaded at once
+    public: std::string mutationKey;
+
+    /// \brief Beams of the latest scan
+    public: std::atomic<std::size_t> beams{0u};
+
+    /// \brief Valid points of the latest scan
+    public: std::atomic<std::size_t> points{0u};
+
+    /// \brief Number of scans received
+    public: std::atomic<uint64_t> scans{0u};
+  };
+}
+}
+}
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+/// \brief Map an intensity to a color, from blue to red
+/// \param[in] _t Intensity from 0 to 1
+/// \return Color
+static math::Color intensityColor(const float _t)
+{
+  auto channel = [_t](const float _center)
+  {
+    return std::min(1.0f, std::max(0.0f, 1.5f - std::abs(4.0f * _t -
+        _center)));
+  };
+  return math::Color(channel(3.0f), channel(2.0f), channel(1.0f));
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the scene scans are displayed in. Render thread only.
+/// \param[in] _scans Scans
+/// \return Scene, null if it doesn't exist yet
+static rendering::ScenePtr scanScene(const ScanScene &_scans)
+{
+  if (!rendering::isEngineLoaded(_scans.engineName))
+    return nullptr;
+
+  auto engine = rendering::engine(_scans.engineName);
+  if (!engine)
+    return nullptr;
+
+  return engine->SceneByName(_scans.sceneName);
+}
+
+/////////////////////////////////////////////////
+/// \brief Upload new scans and fade older ones. Render thread only.
+/// \param[in] _scans Scans
+static void updateScans(ScanScene &_scans)
+{
+  auto scene = scanScene(_scans);
+  if (!scene)
+    return;
+
+  const std::size_t depth = _scans.slots.size();
+  for (std::size_t s = 0; s < depth; ++s)
+  {
+    auto &slot = _scans.slots[s];
+    std::size_t age;
+    std::size_t count{0u};
+    bool upload{false};
+
+    // Copy the scan out, so that new scans can be converted meanwhile
+    {
+      std::lock_guard<std::mutex> lock(_scans.mutex);
+      age = _scans.ring.Age(s);
+      if (_scans.written[s] != slot.uploaded)
+      {
+        upload = true;
+        slot.uploaded = _scans.written[s];
+        count = _scans.ring.PointCount(s);
+        if (count > 0u)
+        {
+          _scans.positions.assign(_scans.ring.Positions(s),
+              _scans.ring.Positions(s) + count * 3);
+          _scans.intensities.assign(_scans.ring.Intensities(s),
+              _scans.ring.Intensities(s) + count);
+        }
+      }
+    }
+
+    if (!slot.visual)
+    {
+      if (!upload)
+        continue;
+
+      slot.material = scene->CreateMaterial();
+      slot.material->SetDepthWriteEnabled(false);
+      slot.marker = scene->CreateMarker();
+      slot.marker->SetType(rendering::MarkerType::MT_POINTS);
+      slot.visual = scene->CreateVisual();
+      slot.visual->AddGeometry(slot.marker);
+      slot.visual->SetMaterial(slot.material, false);
+      scene->RootVisual()->AddChild(slot.visual);
+    }
+
+    // Older scans fade out
+    slot.visual->SetVisible(age < depth);
+    slot.material->SetTransparency(static_cast<double>(age) / depth);
+
+    if (!upload)
+      continue;
+
+    float minIntensity = static_cast<float>(_scans.minIntensity);
+    float maxIntensity = static_cast<float>(_scans.maxIntensity);
+    if (!(minIntensity < maxIntensity) && count > 0u)
+    {
+      auto range = std::minmax_element(_scans.intensities.begin(),
+          _scans.intensities.begin() + count);
+      minIntensity = *range.first;
+      maxIntensity = *range.second;
+    }
+    const bool useIntensity = minIntensity < maxIntensity;
+    const float scale = useIntensity ? 1.0f / (maxIntensity - minIntensity) :
+        0.0f;
+
+    slot.marker->ClearPoints();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const float *position = &_scans.positions[i * 3];
+      auto color = useIntensity ? intensityColor(
+          (_scans.intensities[i] - minIntensity) * scale) : _scans.color;
+      slot.marker->AddPoint(position[0], position[1], position[2], color);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Remove scans from the scene. Render thread only.
+/// \param[in] _scans Scans
+static void destroyScans(ScanScene &_scans)
+{
+  auto scene = scanScene(_scans);
+  for (auto &slot : _scans.slots)
+  {
+    if (scene && slot.visual)
+    {
+      scene->DestroyVisual(slot.visual);
+      scene->DestroyMaterial(slot.material);
+    }
+    slot = ScanScene::Slot();
+  }
+}
+
+/////////////////////////////////////////////////
+LaserScan::LaserScan()
+  : Plugin(), dataPtr(new LaserScanPrivate)
+{
+  std::ostringstream key;
+  key << "LaserScan" << this;
+  this->dataPtr->mutationKey = key.str();
+}
+
+/////////////////////////////////////////////////
+LaserScan::~LaserScan()
+{
+  for (auto sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
+
+  // Replaces scans which haven't been uploaded yet
+  auto scene = this->dataPtr->scene;
+  if (scene && App() && App()->SceneMutations())
+  {
+    App()->SceneMutations()->Post(scene->sceneName,
+        [scene]() {destroyScans(*scene);}, this->dataPtr->mutationKey);
+  }
+}
+
+/////////////////////////////////////////////////
+void LaserScan::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+{
+  // Default name in case user didn't define one
+  if (this->title.empty())
+    this->title = "Laser scan";
+
+  int decay{kDefaultDecay};
+  std::string engineName{"ogre"};
+  std::string sceneName{"scene"};
+  math::Color color{math::Color::Red};
+  double minIntensity{0.0};
+  double maxIntensity{0.0};
+
+  // Read configuration
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("topic"))
+      this->dataPtr->topic = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("engine"))
+      engineName = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("scene"))
+      sceneName = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("decay"))
+      elem->QueryIntText(&decay);
+
+    if (auto elem = _pluginElem->FirstChildElement("color"))
+    {
+      std::stringstream colorStr(elem->GetText() ? elem->GetText() : "");
+      colorStr >> color;
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("min_intensity"))
+      elem->QueryDoubleText(&minIntensity);
+
+    if (auto elem = _pluginElem->FirstChildElement("max_intensity"))
+      elem->QueryDoubleText(&maxIntensity);
+  }
+
+  if (decay < 1)
+  {
+    ignwarn << "Invalid <decay> [" << decay << "], displaying the latest "
+            << "scan only." << std::endl;
+    decay = 1;
+  }
+
+  auto scene = std::make_shared<ScanScene>(decay);
+  scene->engineName = engineName;
+  scene->sceneName = sceneName;
+  scene->color = color;
+  scene->minIntensity = minIntensity;
+  scene->maxIntensity = maxIntensity;
+  this->dataPtr->scene = scene;
+
+  if (this->dataPtr->topic.empty())
+  {
+    ignerr << "Missing <topic>, no scans will be displayed." << std::endl;
+    return;
+  }
+
+  this->Resume();
+}
+
+/////////////////////////////////////////////////
+void LaserScan::OnScanMsg(const msgs::LaserScan &_msg)
+{
+  auto scene = this->dataPtr->scene;
+
+  ScanConfig config;
+  config.angleMin = _msg.angle_min();
+  config.angleStep = _msg.angle_step();
+  config.count = _msg.count();
+  config.verticalAngleMin = _msg.vertical_angle_min();
+  config.verticalAngleStep = _msg.vertical_angle_step();
+  config.verticalCount = std::max(1u, _msg.vertical_count());
+
+  double pose[7]{0, 0, 0, 1, 0, 0, 0};
+  if (_msg.has_world_pose())
+  {
+    const auto &msgPose = _msg.world_pose();
+    pose[0] = msgPose.position().x();
+    pose[1] = msgPose.position().y();
+    pose[2] = msgPose.position().z();
+    if (msgPose.has_orientation())
+    {
+      pose[3] = msgPose.orientation().w();
+      pose[4] = msgPose.orientation().x();
+      pose[5] = msgPose.orientation().y();
+      pose[6] = msgPose.orientation().z();
+    }
+  }
+
+  const auto &ranges = _msg.ranges();
+  const auto &intensities = _msg.intensities();
+  const bool hasIntensities = intensities.size() >= ranges.size();
+
+  // Converted straight from the message, which isn't copied
+  std::size_t points;
+  {
+    std::lock_guard<std::mutex> lock(scene->mutex);
+    auto slot = scene->ring.Add(config, ranges.data(),
+        hasIntensities ? intensities.data() : nullptr, ranges.size(),
+        _msg.range_min(), _msg.range_max(), pose);
+    scene->written[slot] = scene->ring.ScanCount();
+    points = scene->ring.PointCount(slot);
+  }
+
+  if (App() && App()->SceneMutations())
+  {
+    App()->SceneMutations()->Post(scene->sceneName,
+        [scene]() {updateScans(*scene);}, this->dataPtr->mutationKey);
+  }
+
+  this->dataPtr->beams = ranges.size();
+  this->dataPtr->points = points;
+  ++this->dataPtr->scans;
+  this->PostToGuiThread([this]() {this->StatsChanged();},
+      DeliveryLane::kBulk, "stats");
+}
+
+/////////////////////////////////////////////////
+QString LaserScan::Stats() const
+{
+  if (this->dataPtr->scans == 0u)
+    return "No scans received";
+
+  std::ostringstream stats;
+  stats << this->dataPtr->scans << " scans received\n"
+        << this->dataPtr->points << " of " << this->dataPtr->beams
+        << " beams in range";
+  return QString::fromStdString(stats.str());
+}
+
+/////////////////////////////////////////////////
+void LaserScan::Suspend()
+{
+  // Stop receiving scans nobody can see
+  for (auto sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
+}
+
+/////////////////////////////////////////////////
+void LaserScan::Resume()
+{
+  auto topic = this->dataPtr->topic;
+  if (topic.empty() || this->Suspended())
+    return;
+
+  if (!this->dataPtr->node.Subscribe(topic, &LaserScan::OnScanMsg, this,
+      this->SubscribeOptions(topic)))
+  {
+    ignerr << "Unable to subscribe to topic [" << topic << "]" << std::endl;
+  }
+}
+
+// Register this plugin
+IGNITION_ADD_PLUGIN(ignition::gui::plugins::LaserScan,
+                    ignition::gui::Plugin)
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_LASERSCAN_HH_
+#define IGNITION_GUI_PLUGINS_LASERSCAN_HH_
+
+#include <memory>
+#include <ignition/msgs.hh>
+
+#include "ignition/gui/Plugin.hh"
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class LaserScanPrivate;
+
+  /// \brief Display 2D and 3D laser scans coming through an Ignition
+  /// transport topic in a 3D scene, such as the one rendered by Scene3D,
+  /// with the latest scans fading out.
+  ///
+  /// Scans are converted to points in the scene's frame as they're
+  /// received, using the sensor's world pose, into a ring holding the last
+  /// `<decay>` scans. The scene's render thread uploads each scan once to
+  /// the slot's marker, which is reused as the ring wraps around, and
+  /// updates the transparency of older scans.
+  ///
+  /// ## Configuration
+  ///
+  /// \<topic\> : Topic to receive ignition::msgs::LaserScan messages.
+  /// \<engine\> : Name of the render engine, defaults to "ogre".
+  /// \<scene\> : Name of the scene, defaults to "scene".
+  /// \<decay\> : Number of scans displayed, defaults to 10.
+  /// \<color\> : Color of scans without intensities, defaults to red.
+  /// \<min_intensity\> : Intensity at the bottom of the color scale. If
+  ///                     neither this nor \<max_intensity\> are set, each
+  ///                     scan's range of intensities is used.
+  /// \<max_intensity\> : Intensity at the top of the color scale.
+  class LaserScan : public Plugin
+  {
+    Q_OBJECT
+
+    /// \brief Statistics about the latest scan
+    Q_PROPERTY(
+      QString stats
+      READ Stats
+      NOTIFY StatsChanged
+    )
+
+    /// \brief Constructor
+    public: LaserScan();
+
+    /// \brief Destructor
+    public: virtual ~LaserScan();
+
+    // Documentation inherited
+    public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem);
+
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
+    /// \brief Get statistics about the latest scan.
+    /// \return Human readable statistics.
+    public: Q_INVOKABLE QString Stats() const;
+
+    /// \brief Notify that statistics have changed
+    signals: void StatsChanged();
+
+    /// \brief Subscriber callback when a new scan is received
+    /// \param[in] _msg New scan
+    private: void OnScanMsg(const msgs::LaserScan &_msg);
+
+    /// \internal
+    /// \brief Pointer to private data.
+    private: std::unique_ptr<LaserScanPrivate> dataPtr;
+  };
+}
+}
+}
+
+#endif
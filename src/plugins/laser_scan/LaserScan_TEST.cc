@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <ignition/common/Console.hh>
+#include <ignition/transport/Node.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Plugin.hh"
+#include "ignition/gui/MainWindow.hh"
+#include "LaserScan.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Load a laser scan plugin and show its window
+/// \param[in] _app Application
+/// \param[in] _config Plugin configuration
+/// \return The plugin, null on failure
+plugins::LaserScan *loadLaserScan(Application &_app,
+    const std::string &_config)
+{
+  _app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(("<plugin filename=\"LaserScan\">" + _config +
+      "</plugin>").c_str());
+  EXPECT_TRUE(_app.LoadPlugin("LaserScan",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = _app.findChild<MainWindow *>();
+  if (!win)
+    return nullptr;
+
+  // Show, but don't exec, so we don't block. Hidden plugins are suspended.
+  win->QuickWindow()->show();
+
+  return win->findChild<plugins::LaserScan *>();
+}
+
+/////////////////////////////////////////////////
+/// \brief Make a planar scan
+/// \param[in] _count Number of beams
+/// \param[in] _inRange Number of beams which hit something
+/// \return Scan
+msgs::LaserScan makeScan(const unsigned int _count,
+    const unsigned int _inRange)
+{
+  msgs::LaserScan msg;
+  msg.set_angle_min(-1.0);
+  msg.set_angle_max(1.0);
+  msg.set_angle_step(2.0 / (_count - 1));
+  msg.set_count(_count);
+  msg.set_range_min(0.1);
+  msg.set_range_max(10.0);
+  for (unsigned int i = 0; i < _count; ++i)
+    msg.add_ranges(i < _inRange ? 1.0 : 20.0);
+  return msg;
+}
+
+/////////////////////////////////////////////////
+/// \brief Publish a scan until the plugin's statistics change, for up to
+/// 2 s
+/// \param[in] _plugin Plugin
+/// \param[in] _pub Publisher
+/// \param[in] _msg Scan
+/// \return The new statistics, or the old ones if they didn't change
+QString publishUntilStats(plugins::LaserScan *_plugin,
+    transport::Node::Publisher &_pub, const msgs::LaserScan &_msg)
+{
+  auto stats = _plugin->Stats();
+  for (int sleep = 0; sleep < 20 && _plugin->Stats() == stats; ++sleep)
+  {
+    _pub.Publish(_msg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    QCoreApplication::processEvents();
+  }
+  return _plugin->Stats();
+}
+
+/////////////////////////////////////////////////
+TEST(LaserScanTest, Load)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("LaserScan"));
+
+  // Get main window
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  // Get plugin
+  auto plugins = win->findChildren<Plugin *>();
+  EXPECT_EQ(plugins.size(), 1);
+
+  auto plugin = plugins[0];
+  EXPECT_EQ(plugin->Title(), "Laser scan");
+
+  // Cleanup
+  plugins.clear();
+}
+
+/////////////////////////////////////////////////
+TEST(LaserScanTest, ReceiveScan)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadLaserScan(app, "<topic>/laser_scan_test</topic>");
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_EQ("No scans received", plugin->Stats().toStdString());
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::LaserScan>("/laser_scan_test");
+
+  auto stats = publishUntilStats(plugin, pub, makeScan(10u, 4u));
+  EXPECT_TRUE(stats.endsWith("4 of 10 beams in range"))
+      << stats.toStdString();
+
+  // Hiding the card unsubscribes
+  plugin->CardItem()->setVisible(false);
+  EXPECT_TRUE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeScan(10u, 6u));
+  EXPECT_TRUE(stats.endsWith("4 of 10 beams in range"))
+      << stats.toStdString();
+
+  // Showing it subscribes again
+  plugin->CardItem()->setVisible(true);
+  EXPECT_FALSE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeScan(10u, 6u));
+  EXPECT_TRUE(stats.endsWith("6 of 10 beams in range"))
+      << stats.toStdString();
+}
+
+/////////////////////////////////////////////////
+TEST(LaserScanTest, NegativeDecay)
+{
+  common::Console::SetVerbosity(4);
+
+  // Only the latest scan is displayed instead
+  Application app(g_argc, g_argv);
+  auto plugin = loadLaserScan(app,
+      "<topic>/laser_scan_negative</topic>"
+      "<decay>-3</decay>");
+  ASSERT_NE(nullptr, plugin);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::LaserScan>("/laser_scan_negative");
+
+  auto stats = publishUntilStats(plugin, pub, makeScan(10u, 4u));
+  EXPECT_TRUE(stats.endsWith("4 of 10 beams in range"))
+      << stats.toStdString();
+  stats = publishUntilStats(plugin, pub, makeScan(10u, 2u));
+  EXPECT_TRUE(stats.endsWith("2 of 10 beams in range"))
+      << stats.toStdString();
+}
+
+/////////////////////////////////////////////////
+TEST(LaserScanTest, MissingTopic)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadLaserScan(app, "<decay>5</decay>");
+  ASSERT_NE(nullptr, plugin);
+
+  // Nothing to subscribe to, even once resumed
+  plugin->CardItem()->setVisible(false);
+  plugin->CardItem()->setVisible(true);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::LaserScan>("/laser_scan");
+  EXPECT_EQ("No scans received",
+      publishUntilStats(plugin, pub, makeScan(10u, 4u)).toStdString());
+}
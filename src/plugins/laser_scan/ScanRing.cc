@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "ScanRing.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+ScanRing::ScanRing(const std::size_t _depth)
+  : depth(std::max<std::size_t>(1u, _depth)), counts(depth, 0u)
+{
+}
+
+/////////////////////////////////////////////////
+std::size_t ScanRing::Add(const ScanConfig &_config, const double *_ranges,
+    const double *_intensities, const std::size_t _count,
+    const double _rangeMin, const double _rangeMax, const double _pose[7])
+{
+  // Tables only change with the sensor's configuration
+  if (this->tableBuilds == 0u || !(this->config == _config))
+  {
+    this->config = _config;
+    this->horizontal.resize(_config.count);
+    for (uint32_t h = 0; h < _config.count; ++h)
+    {
+      double angle = _config.angleMin + h * _config.angleStep;
+      this->horizontal[h] = {std::sin(angle), std::cos(angle)};
+    }
+    this->vertical.resize(_config.verticalCount);
+    for (uint32_t v = 0; v < _config.verticalCount; ++v)
+    {
+      double angle = _config.verticalAngleMin + v * _config.verticalAngleStep;
+      this->vertical[v] = {std::sin(angle), std::cos(angle)};
+    }
+    ++this->tableBuilds;
+  }
+
+  // Slots only grow, which discards the scans they held
+  const std::size_t beams =
+      static_cast<std::size_t>(_config.count) * _config.verticalCount;
+  if (beams > this->capacity)
+  {
+    this->capacity = beams;
+    this->positions.assign(this->depth * beams * 3, 0.0f);
+    this->intensities.assign(this->depth * beams, 0.0f);
+    std::fill(this->counts.begin(), this->counts.end(), 0u);
+  }
+
+  // Rotation matrix of the sensor's orientation
+  const double w = _pose[3];
+  const double x = _pose[4];
+  const double y = _pose[5];
+  const double z = _pose[6];
+  const double rot[3][3]{
+      {1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y)},
+      {2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x)},
+      {2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y)}};
+
+  const std::size_t slot = this->scanCount % this->depth;
+  float *position = &this->positions[slot * this->capacity * 3];
+  float *intensity = &this->intensities[slot * this->capacity];
+  std::size_t valid{0u};
+
+  const std::size_t count = std::min(beams, _count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const double range = _ranges[i];
+    if (!(range >= _rangeMin && range <= _rangeMax) || std::isinf(range))
+      continue;
+
+    const auto &h = this->horizontal[i % _config.count];
+    const auto &v = this->vertical[i / _config.count];
+    const double lx = range * v.cos * h.cos;
+    const double ly = range * v.cos * h.sin;
+    const double lz = range * v.sin;
+
+    for (int r = 0; r < 3; ++r)
+    {
+      *position++ = static_cast<float>(_pose[r] + rot[r][0] * lx +
+          rot[r][1] * ly + rot[r][2] * lz);
+    }
+    *intensity++ = _intensities ? static_cast<float>(_intensities[i]) : 0.0f;
+    ++valid;
+  }
+
+  this->counts[slot] = valid;
+  ++this->scanCount;
+  return slot;
+}
+
+/////////////////////////////////////////////////
+std::size_t ScanRing::Depth() const
+{
+  return this->depth;
+}
+
+/////////////////////////////////////////////////
+std::size_t ScanRing::Capacity() const
+{
+  return this->capacity;
+}
+
+/////////////////////////////////////////////////
+uint64_t ScanRing::ScanCount() const
+{
+  return this->scanCount;
+}
+
+/////////////////////////////////////////////////
+std::size_t ScanRing::Age(const std::size_t _slot) const
+{
+  if (_slot >= this->depth || this->scanCount == 0u)
+    return this->depth;
+
+  const std::size_t newest = (this->scanCount - 1) % this->depth;
+  const std::size_t age = (newest + this->depth - _slot) % this->depth;
+  return age < this->scanCount ? age : this->depth;
+}
+
+/////////////////////////////////////////////////
+std::size_t ScanRing::PointCount(const std::size_t _slot) const
+{
+  return _slot < this->depth ? this->counts[_slot] : 0u;
+}
+
+/////////////////////////////////////////////////
+const float *ScanRing::Positions(const std::size_t _slot) const
+{
+  if (_slot >= this->depth || this->positions.empty())
+    return nullptr;
+  return &this->positions[_slot * this->capacity * 3];
+}
+
+/////////////////////////////////////////////////
+const float *ScanRing::Intensities(const std::size_t _slot) const
+{
+  if (_slot >= this->depth || this->intensities.empty())
+    return nullptr;
+  return &this->intensities[_slot * this->capacity];
+}
+
+/////////////////////////////////////////////////
+std::size_t ScanRing::TableBuilds() const
+{
+  return this->tableBuilds;
+}
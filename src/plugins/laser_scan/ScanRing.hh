@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_SCANRING_HH_
+#define IGNITION_GUI_PLUGINS_SCANRING_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Beam angles of a laser scan, which usually don't change from
+  /// one scan to the next
+  struct ScanConfig
+  {
+    /// \brief Angle of the first horizontal beam, in radians
+    double angleMin{0.0};
+
+    /// \brief Angle between horizontal beams, in radians
+    double angleStep{0.0};
+
+    /// \brief Number of horizontal beams
+    uint32_t count{0u};
+
+    /// \brief Angle of the first vertical beam, in radians
+    double verticalAngleMin{0.0};
+
+    /// \brief Angle between vertical beams, in radians
+    double verticalAngleStep{0.0};
+
+    /// \brief Number of vertical beams, 1 for 2D scans
+    uint32_t verticalCount{1u};
+
+    /// \brief Equality operator
+    /// \param[in] _other Other configuration
+    /// \return True if all beams have the same angles
+    bool operator==(const ScanConfig &_other) const
+    {
+      return this->angleMin == _other.angleMin &&
+          this->angleStep == _other.angleStep &&
+          this->count == _other.count &&
+          this->verticalAngleMin == _other.verticalAngleMin &&
+          this->verticalAngleStep == _other.verticalAngleStep &&
+          this->verticalCount == _other.verticalCount;
+    }
+  };
+
+  /// \brief Keeps the points of the latest scans, each in its own slot of a
+  /// ring, so that older scans can be displayed fading out.
+  ///
+  /// Ranges are converted to points with sine and cosine tables which are
+  /// only computed again when the scan configuration changes. The slots are
+  /// allocated for the largest scan seen so far, so converting a scan is
+  /// linear in the number of beams and doesn't allocate.
+  ///
+  /// Not thread safe.
+  class ScanRing
+  {
+    /// \brief Constructor.
+    /// \param[in] _depth Number of scans kept, at least 1.
+    public: explicit ScanRing(const std::size_t _depth);
+
+    /// \brief Convert a scan into the slot of the oldest one.
+    /// \param[in] _config Beam angles.
+    /// \param[in] _ranges Ranges, vertical beam major.
+    /// \param[in] _intensities Intensities, null if there are none.
+    /// \param[in] _count Number of ranges, and intensities if any. Extra
+    /// ranges are ignored, missing ones are treated as invalid.
+    /// \param[in] _rangeMin Smaller ranges are invalid.
+    /// \param[in] _rangeMax Larger ranges are invalid.
+    /// \param[in] _pose Pose of the sensor as x, y, z, qw, qx, qy, qz.
+    /// \return Slot which was written.
+    public: std::size_t Add(const ScanConfig &_config, const double *_ranges,
+        const double *_intensities, const std::size_t _count,
+        const double _rangeMin, const double _rangeMax,
+        const double _pose[7]);
+
+    /// \brief Get the number of slots.
+    /// \return Number of slots.
+    public: std::size_t Depth() const;
+
+    /// \brief Get the number of beams each slot can hold without
+    /// allocating.
+    /// \return Number of beams.
+    public: std::size_t Capacity() const;
+
+    /// \brief Get the number of scans added so far.
+    /// \return Number of scans.
+    public: uint64_t ScanCount() const;
+
+    /// \brief Get the age of the scan in a slot.
+    /// \param[in] _slot Slot.
+    /// \return 0 for the latest scan, Depth() if the slot is empty.
+    public: std::size_t Age(const std::size_t _slot) const;
+
+    /// \brief Get the number of valid points in a slot.
+    /// \param[in] _slot Slot.
+    /// \return Number of points.
+    public: std::size_t PointCount(const std::size_t _slot) const;
+
+    /// \brief Get the positions of a slot's points, 3 floats each.
+    /// \param[in] _slot Slot.
+    /// \return Positions, valid until the next scan is added.
+    public: const float *Positions(const std::size_t _slot) const;
+
+    /// \brief Get the intensities of a slot's points.
+    /// \param[in] _slot Slot.
+    /// \return Intensities, zero if the scan had none.
+    public: const float *Intensities(const std::size_t _slot) const;
+
+    /// \brief Get the number of times the sine and cosine tables were
+    /// computed.
+    /// \return Number of times.
+    public: std::size_t TableBuilds() const;
+
+    /// \brief Sine and cosine of each beam's angle
+    private: struct Angle
+    {
+      /// \brief Sine
+      double sin;
+
+      /// \brief Cosine
+      double cos;
+    };
+
+    /// \brief Configuration of the tables
+    private: ScanConfig config;
+
+    /// \brief Horizontal angles
+    private: std::vector<Angle> horizontal;
+
+    /// \brief Vertical angles
+    private: std::vector<Angle> vertical;
+
+    /// \brief Number of table builds
+    private: std::size_t tableBuilds{0u};
+
+    /// \brief Number of slots
+    private: std::size_t depth;
+
+    /// \brief Beams per slot
+    private: std::size_t capacity{0u};
+
+    /// \brief Positions of all slots
+    private: std::vector<float> positions;
+
+    /// \brief Intensities of all slots
+    private: std::vector<float> intensities;
+
+    /// \brief Valid points per slot
+    private: std::vector<std::size_t> counts;
+
+    /// \brief Number of scans added
+    private: uint64_t scanCount{0u};
+  };
+}
+}
+}
+
+#endif
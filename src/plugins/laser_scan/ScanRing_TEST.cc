@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "ScanRing.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/// \brief Identity pose
+static const double kIdentity[7]{0, 0, 0, 1, 0, 0, 0};
+
+/////////////////////////////////////////////////
+TEST(ScanRingTest, Points)
+{
+  // 4 beams, a quarter turn apart
+  ScanConfig config;
+  config.angleMin = 0.0;
+  config.angleStep = M_PI / 2;
+  config.count = 4;
+
+  ScanRing ring(3);
+  EXPECT_EQ(3u, ring.Depth());
+  EXPECT_EQ(0u, ring.Capacity());
+  EXPECT_EQ(3u, ring.Age(0));
+
+  std::vector<double> ranges{1.0, 2.0, std::numeric_limits<double>::infinity(),
+      0.05};
+  std::vector<double> intensities{10, 20, 30, 40};
+  EXPECT_EQ(0u, ring.Add(config, ranges.data(), intensities.data(),
+      ranges.size(), 0.1, 10.0, kIdentity));
+
+  // Out of range beams are skipped
+  ASSERT_EQ(2u, ring.PointCount(0));
+  auto positions = ring.Positions(0);
+  EXPECT_NEAR(1.0, positions[0], 1e-6);
+  EXPECT_NEAR(0.0, positions[1], 1e-6);
+  EXPECT_NEAR(0.0, positions[3], 1e-6);
+  EXPECT_NEAR(2.0, positions[4], 1e-6);
+  EXPECT_FLOAT_EQ(20.0f, ring.Intensities(0)[1]);
+  EXPECT_EQ(0u, ring.Age(0));
+  EXPECT_EQ(3u, ring.Age(1));
+
+  // Moved and turned a quarter, without intensities
+  const double pose[7]{1, 2, 3, std::cos(M_PI / 4), 0, 0, std::sin(M_PI / 4)};
+  EXPECT_EQ(1u, ring.Add(config, ranges.data(), nullptr, ranges.size(), 0.1,
+      10.0, pose));
+  positions = ring.Positions(1);
+  EXPECT_NEAR(1.0, positions[0], 1e-6);
+  EXPECT_NEAR(3.0, positions[1], 1e-6);
+  EXPECT_NEAR(3.0, positions[2], 1e-6);
+  EXPECT_NEAR(-1.0, positions[3], 1e-6);
+  EXPECT_NEAR(2.0, positions[4], 1e-6);
+  EXPECT_FLOAT_EQ(0.0f, ring.Intensities(1)[0]);
+  EXPECT_EQ(1u, ring.Age(0));
+  EXPECT_EQ(0u, ring.Age(1));
+
+  // The ring wraps around, the tables are reused
+  ring.Add(config, ranges.data(), nullptr, ranges.size(), 0.1, 10.0,
+      kIdentity);
+  EXPECT_EQ(0u, ring.Add(config, ranges.data(), nullptr, 2, 0.1, 10.0,
+      kIdentity));
+  EXPECT_EQ(0u, ring.Age(0));
+  EXPECT_EQ(2u, ring.Age(1));
+  EXPECT_EQ(4u, ring.ScanCount());
+  EXPECT_EQ(1u, ring.TableBuilds());
+  EXPECT_EQ(4u, ring.Capacity());
+}
+
+/////////////////////////////////////////////////
+TEST(ScanRingTest, Vertical)
+{
+  // 2 rows of 3 beams, the second one pointing up
+  ScanConfig config;
+  config.angleMin = -0.5;
+  config.angleStep = 0.5;
+  config.count = 3;
+  config.verticalAngleMin = 0.0;
+  config.verticalAngleStep = M_PI / 2;
+  config.verticalCount = 2;
+
+  ScanRing ring(2);
+  std::vector<double> ranges(6, 1.0);
+  ring.Add(config, ranges.data(), nullptr, ranges.size(), 0.0, 10.0,
+      kIdentity);
+  EXPECT_EQ(6u, ring.PointCount(0));
+  auto positions = ring.Positions(0);
+  EXPECT_NEAR(std::cos(-0.5), positions[0], 1e-6);
+  EXPECT_NEAR(std::sin(-0.5), positions[1], 1e-6);
+  for (int i = 3; i < 6; ++i)
+  {
+    EXPECT_NEAR(0.0, positions[i * 3], 1e-6);
+    EXPECT_NEAR(1.0, positions[i * 3 + 2], 1e-6);
+  }
+
+  // A new configuration builds new tables, larger scans grow the slots
+  config.count = 6;
+  ranges.resize(12, 2.0);
+  ring.Add(config, ranges.data(), nullptr, ranges.size(), 0.0, 10.0,
+      kIdentity);
+  EXPECT_EQ(2u, ring.TableBuilds());
+  EXPECT_EQ(12u, ring.Capacity());
+  EXPECT_EQ(12u, ring.PointCount(1));
+  EXPECT_EQ(0u, ring.PointCount(0));
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <ctime>
+#include <deque>
+#include <string>
+
+#include <ignition/common/Console.hh>
+#include <ignition/plugin/Register.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/LogSink.hh"
+
+#include "LogViewer.hh"
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class LogViewerPrivate
+  {
+    /// \brief Timer to fetch new messages
+    public: QTimer *timer{nullptr};
+
+    /// \brief Messages fetched so far, up to the sink's history size
+    public: std::deque<LogEntry> entries;
+
+    /// \brief Sequence number of the latest message fetched
+    public: uint64_t lastSeq{0u};
+
+    /// \brief Displayed lines
+    public: QStringList lines;
+
+    /// \brief Minimum level displayed
+    public: LogLevel level{LogLevel::kInfo};
+  };
+}
+}
+}
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/// \brief Maximum number of messages kept by the viewer
+static const std::size_t kMaxEntries{1000u};
+
+/////////////////////////////////////////////////
+/// \brief Format a message for display.
+/// \param[in] _entry Message.
+/// \return Formatted string.
+static QString formatEntry(const LogEntry &_entry)
+{
+  static const char *levels[] = {"[Dbg]", "[Msg]", "[Wrn]", "[Err]"};
+
+  auto time = std::chrono::system_clock::to_time_t(_entry.time);
+  char stamp[16];
+  std::strftime(stamp, sizeof(stamp), "%H:%M:%S", std::localtime(&time));
+
+  return QString(stamp) + " " + levels[static_cast<int>(_entry.level)] +
+      " " + QString::fromStdString(_entry.text);
+}
+
+/////////////////////////////////////////////////
+LogViewer::LogViewer()
+  : Plugin(), dataPtr(new LogViewerPrivate)
+{
+  this->dataPtr->timer = new QTimer(this);
+  this->dataPtr->timer->setInterval(250);
+  this->connect(this->dataPtr->timer, &QTimer::timeout, this,
+      &LogViewer::Update);
+}
+
+/////////////////////////////////////////////////
+LogViewer::~LogViewer()
+{
+}
+
+/////////////////////////////////////////////////
+void LogViewer::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+{
+  if (this->title.empty())
+    this->title = "Log viewer";
+
+  if (!App() || !App()->Logs())
+  {
+    ignerr << "No application log sink, messages won't be displayed."
+           << std::endl;
+    return;
+  }
+
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("level"))
+    {
+      std::string level = elem->GetText() ? elem->GetText() : "";
+      if (level == "debug")
+        this->dataPtr->level = LogLevel::kDebug;
+      else if (level == "info")
+        this->dataPtr->level = LogLevel::kInfo;
+      else if (level == "warning")
+        this->dataPtr->level = LogLevel::kWarning;
+      else if (level == "error")
+        this->dataPtr->level = LogLevel::kError;
+      else
+        ignwarn << "Invalid <level> [" << level << "], using [info]."
+                << std::endl;
+    }
+  }
+
+  this->Update();
+  this->dataPtr->timer->start();
+}
+
+/////////////////////////////////////////////////
+void LogViewer::Suspend()
+{
+  this->dataPtr->timer->stop();
+}
+
+/////////////////////////////////////////////////
+void LogViewer::Resume()
+{
+  this->Update();
+  this->dataPtr->timer->start();
+}
+
+/////////////////////////////////////////////////
+void LogViewer::Update()
+{
+  if (!App() || !App()->Logs())
+    return;
+
+  auto newEntries = App()->Logs()->Entries(this->dataPtr->lastSeq);
+  if (newEntries.empty())
+    return;
+
+  this->dataPtr->lastSeq = newEntries.back().seq;
+
+  bool changed{false};
+  for (auto &entry : newEntries)
+  {
+    if (entry.level >= this->dataPtr->level)
+    {
+      this->dataPtr->lines.push_back(formatEntry(entry));
+      changed = true;
+    }
+    this->dataPtr->entries.push_back(std::move(entry));
+  }
+
+  while (this->dataPtr->entries.size() > kMaxEntries)
+    this->dataPtr->entries.pop_front();
+  while (static_cast<std::size_t>(this->dataPtr->lines.size()) > kMaxEntries)
+    this->dataPtr->lines.pop_front();
+
+  if (changed)
+    this->EntriesChanged();
+}
+
+/////////////////////////////////////////////////
+void LogViewer::OnClear()
+{
+  this->dataPtr->entries.clear();
+  this->dataPtr->lines.clear();
+  this->EntriesChanged();
+}
+
+/////////////////////////////////////////////////
+QStringList LogViewer::Entries() const
+{
+  return this->dataPtr->lines;
+}
+
+/////////////////////////////////////////////////
+int LogViewer::Level() const
+{
+  return static_cast<int>(this->dataPtr->level);
+}
+
+/////////////////////////////////////////////////
+void LogViewer::SetLevel(const int _level)
+{
+  if (_level < static_cast<int>(LogLevel::kDebug) ||
+      _level > static_cast<int>(LogLevel::kError) ||
+      _level == this->Level())
+  {
+    return;
+  }
+
+  this->dataPtr->level = static_cast<LogLevel>(_level);
+  this->LevelChanged();
+
+  // Filter the messages already fetched again
+  this->dataPtr->lines.clear();
+  for (const auto &entry : this->dataPtr->entries)
+  {
+    if (entry.level >= this->dataPtr->level)
+      this->dataPtr->lines.push_back(formatEntry(entry));
+  }
+  this->EntriesChanged();
+}
+
+// Register this plugin
+IGNITION_ADD_PLUGIN(ignition::gui::plugins::LogViewer,
+                    ignition::gui::Plugin)
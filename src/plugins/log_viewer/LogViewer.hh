@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_LOGVIEWER_HH_
+#define IGNITION_GUI_PLUGINS_LOGVIEWER_HH_
+
+#include <memory>
+
+#include "ignition/gui/Plugin.hh"
+
+#ifndef _WIN32
+#  define LogViewer_EXPORTS_API
+#else
+#  if (defined(LogViewer_EXPORTS))
+#    define LogViewer_EXPORTS_API __declspec(dllexport)
+#  else
+#    define LogViewer_EXPORTS_API __declspec(dllimport)
+#  endif
+#endif
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class LogViewerPrivate;
+
+  /// \brief Displays the latest messages which went through the
+  /// application's log sink, such as Qt and QML warnings.
+  ///
+  /// ## Configuration
+  ///
+  /// * \<level\> : Optional minimum level to display, one of "debug",
+  ///               "info", "warning" or "error". Defaults to "info".
+  class LogViewer_EXPORTS_API LogViewer : public Plugin
+  {
+    Q_OBJECT
+
+    /// \brief One line of text per message, oldest first
+    Q_PROPERTY(
+      QStringList entries
+      READ Entries
+      NOTIFY EntriesChanged
+    )
+
+    /// \brief Minimum level displayed, see LogLevel
+    Q_PROPERTY(
+      int level
+      READ Level
+      WRITE SetLevel
+      NOTIFY LevelChanged
+    )
+
+    /// \brief Constructor
+    public: LogViewer();
+
+    /// \brief Destructor
+    public: virtual ~LogViewer();
+
+    // Documentation inherited
+    public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+        override;
+
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
+    /// \brief Get the displayed messages
+    /// \return One line per message
+    public: Q_INVOKABLE QStringList Entries() const;
+
+    /// \brief Notify that the displayed messages have changed
+    signals: void EntriesChanged();
+
+    /// \brief Get the minimum level displayed
+    /// \return Level, see LogLevel
+    public: Q_INVOKABLE int Level() const;
+
+    /// \brief Set the minimum level displayed
+    /// \param[in] _level Level, see LogLevel
+    public: Q_INVOKABLE void SetLevel(const int _level);
+
+    /// \brief Notify that the level has changed
+    signals: void LevelChanged();
+
+    /// \brief Callback when the clear button is pressed
+    public slots: void OnClear();
+
+    /// \brief Fetch new messages from the application's sink
+    private slots: void Update();
+
+    /// \internal
+    /// \brief Pointer to private data.
+    private: std::unique_ptr<LogViewerPrivate> dataPtr;
+  };
+}
+}
+}
+
+#endif
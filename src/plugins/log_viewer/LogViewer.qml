@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+import QtQuick 2.9
+import QtQuick.Controls 2.2
+import QtQuick.Layouts 1.3
+
+Rectangle {
+  id: logViewer
+  Layout.minimumWidth: 400
+  Layout.minimumHeight: 300
+  color: "transparent"
+
+  ColumnLayout {
+    anchors.fill: parent
+    anchors.margins: 10
+
+    RowLayout {
+      Label {
+        text: "Level"
+        font.weight: Font.DemiBold
+      }
+
+      ComboBox {
+        model: ["Debug", "Info", "Warning", "Error"]
+        currentIndex: LogViewer.level
+        onActivated: {
+          LogViewer.SetLevel(index)
+        }
+      }
+
+      Item {
+        Layout.fillWidth: true
+      }
+
+      Button {
+        text: qsTr("Clear")
+        onClicked: {
+          LogViewer.OnClear()
+        }
+      }
+    }
+
+    ListView {
+      id: listView
+      clip: true
+      Layout.fillWidth: true
+      Layout.fillHeight: true
+
+      model: LogViewer.entries
+
+      // Keep showing the latest messages
+      onCountChanged: {
+        listView.positionViewAtEnd()
+      }
+
+      delegate: Label {
+        width: listView.width
+        text: modelData
+        elide: Text.ElideRight
+      }
+
+      ScrollIndicator.vertical: ScrollIndicator {
+        active: true
+      }
+    }
+  }
+}
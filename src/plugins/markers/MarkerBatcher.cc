@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "MarkerBatcher.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/// \brief Batches aren't compacted until they have at least this many
+/// collapsed vertices, so small batches are never rebuilt for it
+static const std::size_t kCompactMinimum{256u};
+
+/////////////////////////////////////////////////
+/// \brief Get the number of vertices of each primitive
+/// \param[in] _primitive Primitive
+/// \return Vertices per primitive
+static std::size_t primitiveSize(const MarkerPrimitive _primitive)
+{
+  switch (_primitive)
+  {
+    case MarkerPrimitive::kPoints:
+      return 1u;
+    case MarkerPrimitive::kLines:
+      return 2u;
+    default:
+      return 3u;
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Quantize a color to 8 bits per channel
+/// \param[in] _color Red, green, blue and alpha from 0 to 1
+/// \return Packed color
+static uint32_t packColor(const std::array<float, 4> &_color)
+{
+  uint32_t packed{0u};
+  for (auto channel : _color)
+  {
+    float clamped = std::min(1.0f, std::max(0.0f, channel));
+    packed = (packed << 8) | static_cast<uint32_t>(std::lround(
+        clamped * 255.0f));
+  }
+  return packed;
+}
+
+/////////////////////////////////////////////////
+/// \brief Unpack a quantized color
+/// \param[in] _packed Packed color
+/// \return Red, green, blue and alpha from 0 to 1
+static std::array<float, 4> unpackColor(const uint32_t _packed)
+{
+  std::array<float, 4> color;
+  for (int c = 0; c < 4; ++c)
+    color[c] = ((_packed >> (24 - 8 * c)) & 0xFF) / 255.0f;
+  return color;
+}
+
+/////////////////////////////////////////////////
+void MarkerBatcher::Set(const std::string &_ns, const int64_t _id,
+    const MarkerPrimitive _primitive, const std::array<float, 4> &_color,
+    const std::vector<float> &_positions)
+{
+  std::size_t count = _positions.size() / 3;
+  count -= count % primitiveSize(_primitive);
+  if (count == 0u)
+  {
+    this->Remove(_ns, _id);
+    return;
+  }
+
+  const uint32_t color = packColor(_color);
+  auto key = std::make_tuple(static_cast<int>(_primitive), color);
+  auto idIt = this->batchIds.find(key);
+  if (idIt == this->batchIds.end())
+  {
+    idIt = this->batchIds.emplace(key, this->nextBatch++).first;
+    auto &batch = this->batches[idIt->second];
+    batch.primitive = _primitive;
+    batch.color = color;
+  }
+  const uint32_t batchId = idIt->second;
+  auto &batch = this->batches[batchId];
+
+  auto &nsMarkers = this->markers[_ns];
+  auto it = nsMarkers.find(_id);
+  if (it != nsMarkers.end())
+  {
+    auto &entry = it->second;
+
+    // Same place
+    if (entry.batch == batchId && entry.count == count)
+    {
+      std::copy(_positions.begin(), _positions.begin() + count * 3,
+          batch.positions.begin() + entry.first * 3);
+      this->Touch(batchId, batch, entry.first, entry.first + count);
+      return;
+    }
+
+    this->Release(entry);
+  }
+  else
+  {
+    it = nsMarkers.emplace(_id, Entry{batchId, 0u, 0u}).first;
+    ++this->markerCount;
+  }
+
+  // Appended
+  auto &entry = it->second;
+  entry.batch = batchId;
+  entry.first = batch.positions.size() / 3;
+  entry.count = count;
+  batch.positions.insert(batch.positions.end(), _positions.begin(),
+      _positions.begin() + count * 3);
+  batch.ranges[entry.first] = &entry;
+  batch.live += count;
+  this->Touch(batchId, batch, entry.first, entry.first + count);
+}
+
+/////////////////////////////////////////////////
+bool MarkerBatcher::Remove(const std::string &_ns, const int64_t _id)
+{
+  auto nsIt = this->markers.find(_ns);
+  if (nsIt == this->markers.end())
+    return false;
+
+  auto it = nsIt->second.find(_id);
+  if (it == nsIt->second.end())
+    return false;
+
+  this->Release(it->second);
+  nsIt->second.erase(it);
+  --this->markerCount;
+
+  if (nsIt->second.empty())
+    this->markers.erase(nsIt);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::size_t MarkerBatcher::RemoveNamespace(const std::string &_ns)
+{
+  auto nsIt = this->markers.find(_ns);
+  if (nsIt == this->markers.end())
+    return 0u;
+
+  for (auto &marker : nsIt->second)
+    this->Release(marker.second);
+
+  auto count = nsIt->second.size();
+  this->markerCount -= count;
+  this->markers.erase(nsIt);
+  return count;
+}
+
+/////////////////////////////////////////////////
+std::size_t MarkerBatcher::Clear()
+{
+  // Batches are removed as a whole, or rebuilt if markers are added to
+  // them before the next update
+  for (auto &batch : this->batches)
+  {
+    batch.second.live = 0u;
+    batch.second.ranges.clear();
+    batch.second.positions.clear();
+    batch.second.rebuild = true;
+    batch.second.dirtyBegin = 0u;
+    batch.second.dirtyEnd = 0u;
+    this->dirty.insert(batch.first);
+  }
+
+  auto count = this->markerCount;
+  this->markers.clear();
+  this->markerCount = 0u;
+  return count;
+}
+
+/////////////////////////////////////////////////
+bool MarkerBatcher::Has(const std::string &_ns, const int64_t _id) const
+{
+  auto nsIt = this->markers.find(_ns);
+  return nsIt != this->markers.end() && nsIt->second.count(_id) > 0u;
+}
+
+/////////////////////////////////////////////////
+std::size_t MarkerBatcher::MarkerCount() const
+{
+  return this->markerCount;
+}
+
+/////////////////////////////////////////////////
+std::size_t MarkerBatcher::BatchCount() const
+{
+  return this->batches.size();
+}
+
+/////////////////////////////////////////////////
+std::size_t MarkerBatcher::VertexCount() const
+{
+  std::size_t count{0u};
+  for (const auto &batch : this->batches)
+    count += batch.second.positions.size() / 3;
+  return count;
+}
+
+/////////////////////////////////////////////////
+void MarkerBatcher::TakeUpdates(std::vector<BatchUpdate> &_updates,
+    const std::set<uint32_t> &_whole)
+{
+  _updates.clear();
+
+  for (auto id : this->dirty)
+  {
+    auto it = this->batches.find(id);
+    if (it == this->batches.end())
+      continue;
+    auto &batch = it->second;
+
+    BatchUpdate update;
+    update.batch = id;
+    update.primitive = batch.primitive;
+    update.color = unpackColor(batch.color);
+
+    if (batch.live == 0u)
+    {
+      update.removed = true;
+      _updates.push_back(std::move(update));
+      this->batchIds.erase(std::make_tuple(
+          static_cast<int>(batch.primitive), batch.color));
+      this->batches.erase(it);
+      continue;
+    }
+
+    const std::size_t collapsed = batch.positions.size() / 3 - batch.live;
+    if (batch.rebuild || _whole.count(id) > 0u ||
+        (collapsed > batch.live && collapsed >= kCompactMinimum))
+    {
+      if (collapsed > 0u)
+        this->Compact(batch);
+      update.rebuild = true;
+      update.positions = batch.positions;
+    }
+    else
+    {
+      update.first = batch.dirtyBegin;
+      update.positions.assign(batch.positions.begin() + batch.dirtyBegin * 3,
+          batch.positions.begin() + batch.dirtyEnd * 3);
+    }
+    update.size = batch.positions.size() / 3;
+
+    batch.rebuild = false;
+    batch.dirtyBegin = 0u;
+    batch.dirtyEnd = 0u;
+    _updates.push_back(std::move(update));
+  }
+
+  this->dirty.clear();
+}
+
+/////////////////////////////////////////////////
+void MarkerBatcher::Release(Entry &_entry)
+{
+  auto &batch = this->batches[_entry.batch];
+  batch.live -= _entry.count;
+  batch.ranges.erase(_entry.first);
+
+  // Collapsed points would still show, compact the batch instead
+  if (batch.primitive == MarkerPrimitive::kPoints)
+  {
+    batch.rebuild = true;
+    this->dirty.insert(_entry.batch);
+    return;
+  }
+
+  std::fill(batch.positions.begin() + _entry.first * 3,
+      batch.positions.begin() + (_entry.first + _entry.count) * 3, 0.0f);
+  this->Touch(_entry.batch, batch, _entry.first,
+      _entry.first + _entry.count);
+}
+
+/////////////////////////////////////////////////
+void MarkerBatcher::Touch(const uint32_t _id, Batch &_batch,
+    const std::size_t _begin, const std::size_t _end)
+{
+  if (_batch.dirtyBegin == _batch.dirtyEnd)
+  {
+    _batch.dirtyBegin = _begin;
+    _batch.dirtyEnd = _end;
+  }
+  else
+  {
+    _batch.dirtyBegin = std::min(_batch.dirtyBegin, _begin);
+    _batch.dirtyEnd = std::max(_batch.dirtyEnd, _end);
+  }
+  this->dirty.insert(_id);
+}
+
+/////////////////////////////////////////////////
+void MarkerBatcher::Compact(Batch &_batch)
+{
+  std::vector<float> positions;
+  positions.reserve(_batch.live * 3);
+
+  std::map<std::size_t, Entry *> ranges;
+  for (auto &range : _batch.ranges)
+  {
+    auto entry = range.second;
+    auto begin = _batch.positions.begin() + entry->first * 3;
+    entry->first = positions.size() / 3;
+    positions.insert(positions.end(), begin, begin + entry->count * 3);
+    ranges.emplace_hint(ranges.end(), entry->first, entry);
+  }
+
+  _batch.positions.swap(positions);
+  _batch.ranges.swap(ranges);
+}
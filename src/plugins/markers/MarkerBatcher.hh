@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_MARKERBATCHER_HH_
+#define IGNITION_GUI_PLUGINS_MARKERBATCHER_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Primitive which a batch's vertices are drawn as
+  enum class MarkerPrimitive : int
+  {
+    /// \brief One point per vertex
+    kPoints = 0,
+
+    /// \brief One line per pair of vertices
+    kLines = 1,
+
+    /// \brief One triangle per three vertices
+    kTriangles = 2
+  };
+
+  /// \brief Changes to a batch since the previous updates were taken,
+  /// to be applied to the batch's buffer in the scene.
+  struct BatchUpdate
+  {
+    /// \brief Batch id, unique for the batcher's lifetime
+    uint32_t batch{0u};
+
+    /// \brief Primitive of the batch
+    MarkerPrimitive primitive{MarkerPrimitive::kTriangles};
+
+    /// \brief Color of the batch's material, red, green, blue and alpha
+    std::array<float, 4> color{{1.0f, 1.0f, 1.0f, 1.0f}};
+
+    /// \brief True if the batch has no markers left and should be destroyed
+    bool removed{false};
+
+    /// \brief True if the buffer should be cleared first, positions then
+    /// hold all of the vertices
+    bool rebuild{false};
+
+    /// \brief Index of the first changed vertex
+    std::size_t first{0u};
+
+    /// \brief Positions of the changed vertices, 3 floats each, starting
+    /// at first. Vertices past the end of the buffer are appended.
+    std::vector<float> positions;
+
+    /// \brief Number of vertices in the batch after the update
+    std::size_t size{0u};
+  };
+
+  /// \brief Groups markers by primitive and color into batches, so that
+  /// each batch is drawn with a single buffer, and keeps track of what
+  /// changed in each batch so that buffers are updated incrementally.
+  ///
+  /// Markers are identified by namespace and id. Modifying a marker without
+  /// changing its number of vertices overwrites them in place. Otherwise,
+  /// and when markers are removed, their old vertices are collapsed to the
+  /// origin, so lines and triangles become invisible without moving other
+  /// markers, and the marker is appended at the end of its batch. Collapsed
+  /// points would still be visible, so point batches are rebuilt instead.
+  /// Batches are compacted, and rebuilt, once most of their vertices are
+  /// collapsed.
+  ///
+  /// Not thread safe.
+  class MarkerBatcher
+  {
+    /// \brief Add or modify a marker.
+    /// \param[in] _ns Namespace.
+    /// \param[in] _id Id within the namespace.
+    /// \param[in] _primitive Primitive, positions are truncated to a
+    /// multiple of the primitive's vertex count.
+    /// \param[in] _color Color, quantized to 8 bits per channel to pick
+    /// the batch.
+    /// \param[in] _positions Positions, 3 floats per vertex. Markers without
+    /// vertices are removed.
+    public: void Set(const std::string &_ns, const int64_t _id,
+        const MarkerPrimitive _primitive, const std::array<float, 4> &_color,
+        const std::vector<float> &_positions);
+
+    /// \brief Remove a marker.
+    /// \param[in] _ns Namespace.
+    /// \param[in] _id Id within the namespace.
+    /// \return True if the marker existed.
+    public: bool Remove(const std::string &_ns, const int64_t _id);
+
+    /// \brief Remove all markers of a namespace.
+    /// \param[in] _ns Namespace.
+    /// \return Number of markers removed.
+    public: std::size_t RemoveNamespace(const std::string &_ns);
+
+    /// \brief Remove all markers.
+    /// \return Number of markers removed.
+    public: std::size_t Clear();
+
+    /// \brief Check whether a marker exists.
+    /// \param[in] _ns Namespace.
+    /// \param[in] _id Id within the namespace.
+    /// \return True if it exists.
+    public: bool Has(const std::string &_ns, const int64_t _id) const;
+
+    /// \brief Get the number of markers.
+    /// \return Number of markers.
+    public: std::size_t MarkerCount() const;
+
+    /// \brief Get the number of batches, which is the number of buffers
+    /// drawn.
+    /// \return Number of batches.
+    public: std::size_t BatchCount() const;
+
+    /// \brief Get the number of vertices in all batches, including
+    /// collapsed ones.
+    /// \return Number of vertices.
+    public: std::size_t VertexCount() const;
+
+    /// \brief Take the changes made since the previous call.
+    /// \param[out] _updates One update per changed batch, in the order the
+    /// batches were created.
+    /// \param[in] _whole Batches which are sent whole if they changed, such
+    /// as batches whose previous update hasn't been applied yet, so that
+    /// the new update can replace it.
+    public: void TakeUpdates(std::vector<BatchUpdate> &_updates,
+        const std::set<uint32_t> &_whole = {});
+
+    /// \brief Location of a marker's vertices
+    private: struct Entry
+    {
+      /// \brief Batch id
+      uint32_t batch;
+
+      /// \brief First vertex
+      std::size_t first;
+
+      /// \brief Number of vertices
+      std::size_t count;
+    };
+
+    /// \brief Vertices of the markers sharing a primitive and color
+    private: struct Batch
+    {
+      /// \brief Primitive
+      MarkerPrimitive primitive;
+
+      /// \brief Quantized color
+      uint32_t color;
+
+      /// \brief Positions, 3 floats per vertex
+      std::vector<float> positions;
+
+      /// \brief Markers, by first vertex
+      std::map<std::size_t, Entry *> ranges;
+
+      /// \brief Number of vertices used by markers
+      std::size_t live{0u};
+
+      /// \brief First changed vertex
+      std::size_t dirtyBegin{0u};
+
+      /// \brief One past the last changed vertex
+      std::size_t dirtyEnd{0u};
+
+      /// \brief True if the buffer must be rebuilt
+      bool rebuild{true};
+    };
+
+    /// \brief Remove a marker's vertices from its batch
+    /// \param[in] _entry Marker
+    private: void Release(Entry &_entry);
+
+    /// \brief Mark vertices of a batch as changed
+    /// \param[in] _id Batch id
+    /// \param[in] _batch Batch
+    /// \param[in] _begin First vertex
+    /// \param[in] _end One past the last vertex
+    private: void Touch(const uint32_t _id, Batch &_batch,
+        const std::size_t _begin, const std::size_t _end);
+
+    /// \brief Move the markers of a batch next to each other
+    /// \param[in] _batch Batch
+    private: void Compact(Batch &_batch);
+
+    /// \brief Markers per namespace and id
+    private: std::map<std::string, std::unordered_map<int64_t, Entry>>
+        markers;
+
+    /// \brief Batches by id
+    private: std::map<uint32_t, Batch> batches;
+
+    /// \brief Batch ids by primitive and quantized color
+    private: std::map<std::tuple<int, uint32_t>, uint32_t> batchIds;
+
+    /// \brief Batches changed since the last updates
+    private: std::set<uint32_t> dirty;
+
+    /// \brief Next batch id
+    private: uint32_t nextBatch{1u};
+
+    /// \brief Number of markers
+    private: std::size_t markerCount{0u};
+  };
+}
+}
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <vector>
+
+#include "MarkerBatcher.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+static const std::array<float, 4> kRed{{1.0f, 0.0f, 0.0f, 1.0f}};
+static const std::array<float, 4> kBlue{{0.0f, 0.0f, 1.0f, 1.0f}};
+
+/////////////////////////////////////////////////
+/// \brief Make a line
+/// \param[in] _x Position along X of both ends
+/// \return Positions
+static std::vector<float> line(const float _x)
+{
+  return {_x, 0.0f, 0.0f, _x, 1.0f, 0.0f};
+}
+
+/////////////////////////////////////////////////
+TEST(MarkerBatcherTest, Batches)
+{
+  MarkerBatcher batcher;
+  std::vector<BatchUpdate> updates;
+
+  // Thousands of markers, two colors, lines and triangles
+  for (int i = 0; i < 5000; ++i)
+  {
+    batcher.Set("lines", i, MarkerPrimitive::kLines, i % 2 ? kRed : kBlue,
+        line(i));
+    batcher.Set("triangles", i, MarkerPrimitive::kTriangles, kRed,
+        {0, 0, 0, 1, 0, 0, 0, 1, 0});
+  }
+  EXPECT_EQ(10000u, batcher.MarkerCount());
+  EXPECT_EQ(3u, batcher.BatchCount());
+
+  // New batches are sent whole
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(3u, updates.size());
+  for (const auto &update : updates)
+  {
+    EXPECT_TRUE(update.rebuild);
+    EXPECT_FALSE(update.removed);
+    EXPECT_EQ(update.size * 3, update.positions.size());
+  }
+  EXPECT_EQ(MarkerPrimitive::kLines, updates[0].primitive);
+  EXPECT_EQ(kBlue, updates[0].color);
+  EXPECT_EQ(5000u, updates[0].size);
+  EXPECT_EQ(15000u, updates[1].size);
+  EXPECT_EQ(5000u, updates[2].size);
+
+  // Nothing changed
+  batcher.TakeUpdates(updates);
+  EXPECT_TRUE(updates.empty());
+
+  // Moving a marker only sends its vertices
+  batcher.Set("lines", 3, MarkerPrimitive::kLines, kRed, line(-1));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_FALSE(updates[0].rebuild);
+  EXPECT_EQ(2u, updates[0].first);
+  ASSERT_EQ(6u, updates[0].positions.size());
+  EXPECT_FLOAT_EQ(-1.0f, updates[0].positions[0]);
+  EXPECT_EQ(5000u, updates[0].size);
+
+  // Changing its color moves it to the other batch, collapsing it here
+  batcher.Set("lines", 3, MarkerPrimitive::kLines, kBlue, line(-1));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(2u, updates.size());
+  EXPECT_EQ(5000u, updates[0].first);
+  EXPECT_EQ(5002u, updates[0].size);
+  EXPECT_EQ(2u, updates[1].first);
+  for (auto position : updates[1].positions)
+    EXPECT_FLOAT_EQ(0.0f, position);
+  EXPECT_TRUE(batcher.Has("lines", 3));
+
+  // Removing a namespace removes its batches once they're empty
+  EXPECT_EQ(5000u, batcher.RemoveNamespace("lines"));
+  EXPECT_FALSE(batcher.Has("lines", 3));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(2u, updates.size());
+  EXPECT_TRUE(updates[0].removed);
+  EXPECT_TRUE(updates[1].removed);
+  EXPECT_EQ(1u, batcher.BatchCount());
+  EXPECT_EQ(5000u, batcher.MarkerCount());
+
+  EXPECT_EQ(5000u, batcher.Clear());
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_TRUE(updates[0].removed);
+  EXPECT_EQ(0u, batcher.BatchCount());
+}
+
+/////////////////////////////////////////////////
+TEST(MarkerBatcherTest, Compact)
+{
+  MarkerBatcher batcher;
+  std::vector<BatchUpdate> updates;
+
+  for (int i = 0; i < 1000; ++i)
+    batcher.Set("", i, MarkerPrimitive::kLines, kRed, line(i));
+  batcher.TakeUpdates(updates);
+
+  // Collapsed in place while few
+  for (int i = 0; i < 400; ++i)
+    EXPECT_TRUE(batcher.Remove("", i));
+  EXPECT_FALSE(batcher.Remove("", 0));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_FALSE(updates[0].rebuild);
+  EXPECT_EQ(2000u, batcher.VertexCount());
+
+  // Compacted once most are collapsed, keeping the order
+  for (int i = 400; i < 700; ++i)
+    batcher.Remove("", i);
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_TRUE(updates[0].rebuild);
+  EXPECT_EQ(600u, updates[0].size);
+  EXPECT_FLOAT_EQ(700.0f, updates[0].positions[0]);
+  EXPECT_EQ(600u, batcher.VertexCount());
+
+  // Markers know where they moved to
+  batcher.Set("", 701, MarkerPrimitive::kLines, kRed, line(-1));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_EQ(2u, updates[0].first);
+}
+
+/////////////////////////////////////////////////
+TEST(MarkerBatcherTest, Points)
+{
+  MarkerBatcher batcher;
+  std::vector<BatchUpdate> updates;
+
+  batcher.Set("a", 0, MarkerPrimitive::kPoints, kRed, {0, 0, 0, 1, 1, 1});
+  batcher.Set("a", 1, MarkerPrimitive::kPoints, kRed, {2, 2, 2});
+  batcher.TakeUpdates(updates);
+  EXPECT_EQ(3u, updates[0].size);
+
+  // Removed points are compacted right away, not collapsed
+  batcher.Remove("a", 0);
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_TRUE(updates[0].rebuild);
+  ASSERT_EQ(3u, updates[0].positions.size());
+  EXPECT_FLOAT_EQ(2.0f, updates[0].positions[0]);
+
+  // No vertices, no marker; incomplete primitives are dropped
+  batcher.Set("a", 1, MarkerPrimitive::kPoints, kRed, {});
+  EXPECT_FALSE(batcher.Has("a", 1));
+  batcher.Set("a", 2, MarkerPrimitive::kTriangles, kRed, {0, 0, 0, 1, 1, 1});
+  EXPECT_FALSE(batcher.Has("a", 2));
+  EXPECT_EQ(0u, batcher.MarkerCount());
+}
+
+/////////////////////////////////////////////////
+TEST(MarkerBatcherTest, ClearThenSet)
+{
+  MarkerBatcher batcher;
+  std::vector<BatchUpdate> updates;
+
+  for (int i = 0; i < 10; ++i)
+    batcher.Set("a", i, MarkerPrimitive::kLines, kRed, line(i));
+  batcher.TakeUpdates(updates);
+
+  // Markers added after clearing replace the old ones in the batch
+  EXPECT_EQ(10u, batcher.Clear());
+  batcher.Set("b", 0, MarkerPrimitive::kLines, kRed, line(100));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_FALSE(updates[0].removed);
+  EXPECT_TRUE(updates[0].rebuild);
+  EXPECT_EQ(2u, updates[0].size);
+  EXPECT_EQ(line(100), updates[0].positions);
+  EXPECT_EQ(2u, batcher.VertexCount());
+
+  // And are laid out like any other
+  batcher.Set("b", 1, MarkerPrimitive::kLines, kRed, line(101));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_FALSE(updates[0].rebuild);
+  EXPECT_EQ(2u, updates[0].first);
+  EXPECT_EQ(4u, updates[0].size);
+}
+
+/////////////////////////////////////////////////
+TEST(MarkerBatcherTest, Whole)
+{
+  MarkerBatcher batcher;
+  std::vector<BatchUpdate> updates;
+
+  for (int i = 0; i < 10; ++i)
+    batcher.Set("a", i, MarkerPrimitive::kLines, kRed, line(i));
+  batcher.Set("a", 10, MarkerPrimitive::kLines, kBlue, line(10));
+  batcher.TakeUpdates(updates);
+  ASSERT_EQ(2u, updates.size());
+  const auto red = updates[0].batch;
+  const auto blue = updates[1].batch;
+
+  // Only changed batches are sent whole when asked to
+  batcher.Set("a", 3, MarkerPrimitive::kLines, kRed, line(30));
+  batcher.TakeUpdates(updates, {red, blue});
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_EQ(red, updates[0].batch);
+  EXPECT_TRUE(updates[0].rebuild);
+  EXPECT_EQ(0u, updates[0].first);
+  EXPECT_EQ(20u, updates[0].size);
+  ASSERT_EQ(60u, updates[0].positions.size());
+  EXPECT_FLOAT_EQ(30.0f, updates[0].positions[18]);
+
+  // Others are still sent in part
+  batcher.Set("a", 4, MarkerPrimitive::kLines, kRed, line(40));
+  batcher.TakeUpdates(updates, {blue});
+  ASSERT_EQ(1u, updates.size());
+  EXPECT_FALSE(updates[0].rebuild);
+  EXPECT_EQ(8u, updates[0].first);
+}
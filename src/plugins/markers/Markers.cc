@@ -0,0 +1,955 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Color.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/rendering.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/SceneMutationQueue.hh"
+#include "MarkerBatcher.hh"
+#include "Markers.hh"
+
+// Segments around spheres and cylinders
+static const int kRoundSegments{16};
+
+// Rings from pole to pole of spheres
+static const int kSphereRings{8};
+
+// Interval at which marker lifetimes are checked, in milliseconds
+static const int kExpiryInterval{100};
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Namespace and id of a marker
+  using MarkerKey = std::pair<std::string, int64_t>;
+
+  /// \brief Text marker, which isn't batched
+  struct TextUpdate
+  {
+    /// \brief Marker
+    MarkerKey key;
+
+    /// \brief True if the text should be removed
+    bool removed{false};
+
+    /// \brief Text
+    std::string text;
+
+    /// \brief Pose in the scene
+    math::Pose3d pose;
+
+    /// \brief Color
+    math::Color color;
+
+    /// \brief Character height
+    float height{0.2f};
+  };
+
+  /// \brief Changes posted to the scene at once
+  struct MarkerUpdates
+  {
+    /// \brief Batches
+    std::vector<BatchUpdate> batches;
+
+    /// \brief Texts
+    std::vector<TextUpdate> texts;
+  };
+
+  /// \brief Scene objects displaying the markers. Shared with the scene
+  /// mutations, which outlive the plugin, and only used on the render
+  /// thread once the plugin is loaded.
+  struct MarkerScene
+  {
+    /// \brief A batch's buffer
+    struct Batch
+    {
+      /// \brief Visual
+      rendering::VisualPtr visual;
+
+      /// \brief Marker holding the vertices
+      rendering::MarkerPtr marker;
+
+      /// \brief Material
+      rendering::MaterialPtr material;
+
+      /// \brief Number of vertices in the marker
+      std::size_t size{0u};
+    };
+
+    /// \brief A text marker
+    struct Text
+    {
+      /// \brief Visual
+      rendering::VisualPtr visual;
+
+      /// \brief Text geometry
+      rendering::TextPtr text;
+
+      /// \brief Material
+      rendering::MaterialPtr material;
+    };
+
+    /// \brief Render engine name
+    std::string engineName{"ogre"};
+
+    /// \brief Scene name
+    std::string sceneName{"scene"};
+
+    /// \brief Batches by id
+    std::map<uint32_t, Batch> batches;
+
+    /// \brief Texts by marker
+    std::map<MarkerKey, Text> texts;
+
+    /// \brief Key of the plugin's mutations, so that at most one of them
+    /// is queued however long the scene isn't rendered
+    std::string mutationKey;
+
+    /// \brief Protects the pending updates
+    std::mutex pendingMutex;
+
+    /// \brief Batch updates waiting for the mutation to run. A batch
+    /// changed again in the meantime is sent whole, replacing its update.
+    std::map<uint32_t, BatchUpdate> pendingBatches;
+
+    /// \brief Text updates waiting for the mutation to run, the latest of
+    /// each marker
+    std::map<MarkerKey, TextUpdate> pendingTexts;
+  };
+
+  class MarkersPrivate
+  {
+    /// \brief Topic of single markers
+    public: std::string topic{"/marker"};
+
+    /// \brief Topic of marker arrays
+    public: std::string arrayTopic{"/marker_array"};
+
+    /// \brief Node for communication
+    public: transport::Node node;
+
+    /// \brief Protects pending messages and statistics
+    public: std::mutex mutex;
+
+    /// \brief Messages waiting to be processed, in order
+    public: std::vector<msgs::Marker> pending;
+
+    /// \brief Index in pending of the latest message of each marker, which
+    /// later messages for the same marker replace
+    public: std::map<MarkerKey, std::size_t> pendingIndex;
+
+    /// \brief True while processing is queued or running on a worker
+    public: bool processing{false};
+
+    /// \brief True if some markers have a lifetime
+    public: std::atomic<bool> hasExpiries{false};
+
+    /// \brief Checks lifetimes
+    public: QTimer expiryTimer;
+
+    /// \brief Batches the markers, only used by the processing task
+    public: MarkerBatcher batcher;
+
+    /// \brief Text markers, only used by the processing task
+    public: std::set<MarkerKey> texts;
+
+    /// \brief When markers with a lifetime expire, only used by the
+    /// processing task
+    public: std::map<MarkerKey, std::chrono::steady_clock::time_point>
+        expiries;
+
+    /// \brief Scene objects, shared with scene mutations
+    public: std::shared_ptr<MarkerScene> scene{
+        std::make_shared<MarkerScene>()};
+
+    /// \brief Statistics of the latest update
+    public: QString stats{"No markers received"};
+
+    /// \brief Memory used by batched vertices
+    public: uint64_t memory{0u};
+  };
+}
+}
+}
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+/// \brief Appends transformed vertices to a position list
+class VertexWriter
+{
+  /// \brief Constructor
+  /// \param[in] _msg Marker whose pose and scale are applied
+  /// \param[out] _positions Positions to append to
+  public: VertexWriter(const msgs::Marker &_msg,
+      std::vector<float> &_positions)
+    : pose(_msg.has_pose() ? msgs::Convert(_msg.pose()) : math::Pose3d::Zero),
+      scale(_msg.has_scale() ? msgs::Convert(_msg.scale()) :
+          math::Vector3d::One),
+      positions(_positions)
+  {
+  }
+
+  /// \brief Append a vertex
+  /// \param[in] _vertex Vertex in the marker's frame, before scaling
+  public: void Add(const math::Vector3d &_vertex)
+  {
+    auto vertex = this->pose.Pos() + this->pose.Rot() * (_vertex *
+        this->scale);
+    this->positions.push_back(static_cast<float>(vertex.X()));
+    this->positions.push_back(static_cast<float>(vertex.Y()));
+    this->positions.push_back(static_cast<float>(vertex.Z()));
+  }
+
+  /// \brief Append a triangle
+  /// \param[in] _a First vertex
+  /// \param[in] _b Second vertex
+  /// \param[in] _c Third vertex
+  public: void Triangle(const math::Vector3d &_a, const math::Vector3d &_b,
+      const math::Vector3d &_c)
+  {
+    this->Add(_a);
+    this->Add(_b);
+    this->Add(_c);
+  }
+
+  /// \brief Pose
+  private: math::Pose3d pose;
+
+  /// \brief Scale
+  private: math::Vector3d scale;
+
+  /// \brief Positions
+  private: std::vector<float> &positions;
+};
+
+/////////////////////////////////////////////////
+/// \brief Tessellate a unit box centered on the origin
+/// \param[in] _writer Writer
+static void box(VertexWriter &_writer)
+{
+  static const int kFaces[6][4]{
+      {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4},
+      {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+
+  math::Vector3d corners[8];
+  for (int i = 0; i < 8; ++i)
+  {
+    corners[i].Set(i & 1 ? 0.5 : -0.5, i & 2 ? 0.5 : -0.5,
+        i & 4 ? 0.5 : -0.5);
+  }
+
+  for (const auto &face : kFaces)
+  {
+    _writer.Triangle(corners[face[0]], corners[face[1]], corners[face[2]]);
+    _writer.Triangle(corners[face[0]], corners[face[2]], corners[face[3]]);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Tessellate a unit diameter sphere centered on the origin
+/// \param[in] _writer Writer
+static void sphere(VertexWriter &_writer)
+{
+  auto vertex = [](const int _ring, const int _segment)
+  {
+    double polar = IGN_PI * _ring / kSphereRings;
+    double azimuth = 2 * IGN_PI * _segment / kRoundSegments;
+    return math::Vector3d(std::sin(polar) * std::cos(azimuth),
+        std::sin(polar) * std::sin(azimuth), std::cos(polar)) * 0.5;
+  };
+
+  for (int r = 0; r < kSphereRings; ++r)
+  {
+    for (int s = 0; s < kRoundSegments; ++s)
+    {
+      auto a = vertex(r, s);
+      auto b = vertex(r + 1, s);
+      auto c = vertex(r + 1, s + 1);
+      auto d = vertex(r, s + 1);
+      if (r > 0)
+        _writer.Triangle(a, b, d);
+      if (r < kSphereRings - 1)
+        _writer.Triangle(b, c, d);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Tessellate a unit diameter and height cylinder centered on the
+/// origin, along Z
+/// \param[in] _writer Writer
+static void cylinder(VertexWriter &_writer)
+{
+  math::Vector3d top(0, 0, 0.5);
+  math::Vector3d bottom(0, 0, -0.5);
+  for (int s = 0; s < kRoundSegments; ++s)
+  {
+    double a0 = 2 * IGN_PI * s / kRoundSegments;
+    double a1 = 2 * IGN_PI * (s + 1) / kRoundSegments;
+    math::Vector3d r0(0.5 * std::cos(a0), 0.5 * std::sin(a0), 0);
+    math::Vector3d r1(0.5 * std::cos(a1), 0.5 * std::sin(a1), 0);
+
+    _writer.Triangle(bottom + r0, bottom + r1, top + r1);
+    _writer.Triangle(bottom + r0, top + r1, top + r0);
+    _writer.Triangle(top, top + r0, top + r1);
+    _writer.Triangle(bottom, bottom + r1, bottom + r0);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get a marker's vertices in the scene's frame
+/// \param[in] _msg Marker
+/// \param[out] _primitive Primitive to draw the vertices as
+/// \param[out] _positions Positions
+/// \return False if the marker's type isn't supported
+static bool markerVertices(const msgs::Marker &_msg,
+    MarkerPrimitive &_primitive, std::vector<float> &_positions)
+{
+  _positions.clear();
+  VertexWriter writer(_msg, _positions);
+
+  std::vector<math::Vector3d> points;
+  points.reserve(_msg.point_size());
+  for (const auto &point : _msg.point())
+    points.push_back(msgs::Convert(point));
+
+  _primitive = MarkerPrimitive::kTriangles;
+  switch (_msg.type())
+  {
+    case msgs::Marker::BOX:
+      box(writer);
+      return true;
+    case msgs::Marker::SPHERE:
+      sphere(writer);
+      return true;
+    case msgs::Marker::CYLINDER:
+      cylinder(writer);
+      return true;
+    case msgs::Marker::TRIANGLE_LIST:
+      for (const auto &point : points)
+        writer.Add(point);
+      return true;
+    case msgs::Marker::TRIANGLE_STRIP:
+      // Alternate the winding so that all triangles face the same way
+      for (std::size_t i = 2; i < points.size(); ++i)
+      {
+        if (i % 2 == 0)
+          writer.Triangle(points[i - 2], points[i - 1], points[i]);
+        else
+          writer.Triangle(points[i - 1], points[i - 2], points[i]);
+      }
+      return true;
+    case msgs::Marker::TRIANGLE_FAN:
+      for (std::size_t i = 2; i < points.size(); ++i)
+        writer.Triangle(points[0], points[i - 1], points[i]);
+      return true;
+    case msgs::Marker::LINE_LIST:
+      _primitive = MarkerPrimitive::kLines;
+      for (const auto &point : points)
+        writer.Add(point);
+      return true;
+    case msgs::Marker::LINE_STRIP:
+      _primitive = MarkerPrimitive::kLines;
+      for (std::size_t i = 1; i < points.size(); ++i)
+      {
+        writer.Add(points[i - 1]);
+        writer.Add(points[i]);
+      }
+      return true;
+    case msgs::Marker::POINTS:
+      _primitive = MarkerPrimitive::kPoints;
+      for (const auto &point : points)
+        writer.Add(point);
+      return true;
+    default:
+      return false;
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get a marker's color
+/// \param[in] _msg Marker
+/// \return Color
+static math::Color markerColor(const msgs::Marker &_msg)
+{
+  if (!_msg.has_material() || !_msg.material().has_diffuse())
+    return math::Color::White;
+  return msgs::Convert(_msg.material().diffuse());
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the scene markers are displayed in. Render thread only.
+/// \param[in] _markers Markers
+/// \return Scene, null if it doesn't exist yet
+static rendering::ScenePtr markerScene(const MarkerScene &_markers)
+{
+  if (!rendering::isEngineLoaded(_markers.engineName))
+    return nullptr;
+
+  auto engine = rendering::engine(_markers.engineName);
+  if (!engine)
+    return nullptr;
+
+  return engine->SceneByName(_markers.sceneName);
+}
+
+/////////////////////////////////////////////////
+/// \brief Make a material of a single color
+/// \param[in] _scene Scene
+/// \param[in] _color Color
+/// \return Material
+static rendering::MaterialPtr colorMaterial(rendering::ScenePtr _scene,
+    const math::Color &_color)
+{
+  auto material = _scene->CreateMaterial();
+  material->SetAmbient(_color);
+  material->SetDiffuse(_color);
+  material->SetEmissive(_color);
+  if (_color.A() < 1.0f)
+  {
+    material->SetTransparency(1.0 - _color.A());
+    material->SetDepthWriteEnabled(false);
+  }
+  return material;
+}
+
+/////////////////////////////////////////////////
+/// \brief Apply changes to the scene. Render thread only.
+/// \param[in] _markers Markers
+/// \param[in] _updates Changes
+static void updateMarkers(MarkerScene &_markers,
+    const MarkerUpdates &_updates)
+{
+  auto scene = markerScene(_markers);
+  if (!scene)
+    return;
+
+  for (const auto &update : _updates.batches)
+  {
+    auto it = _markers.batches.find(update.batch);
+    if (update.removed)
+    {
+      if (it == _markers.batches.end())
+        continue;
+      scene->DestroyVisual(it->second.visual);
+      scene->DestroyMaterial(it->second.material);
+      _markers.batches.erase(it);
+      continue;
+    }
+
+    math::Color color(update.color[0], update.color[1], update.color[2],
+        update.color[3]);
+
+    // Created once per batch, then updated in place
+    if (it == _markers.batches.end())
+    {
+      MarkerScene::Batch batch;
+      batch.material = colorMaterial(scene, color);
+      batch.marker = scene->CreateMarker();
+      switch (update.primitive)
+      {
+        case MarkerPrimitive::kPoints:
+          batch.marker->SetType(rendering::MarkerType::MT_POINTS);
+          break;
+        case MarkerPrimitive::kLines:
+          batch.marker->SetType(rendering::MarkerType::MT_LINE_LIST);
+          break;
+        default:
+          batch.marker->SetType(rendering::MarkerType::MT_TRIANGLE_LIST);
+          break;
+      }
+      batch.visual = scene->CreateVisual();
+      batch.visual->AddGeometry(batch.marker);
+      batch.visual->SetMaterial(batch.material);
+      scene->RootVisual()->AddChild(batch.visual);
+      it = _markers.batches.emplace(update.batch, batch).first;
+    }
+
+    auto &batch = it->second;
+    if (update.rebuild)
+    {
+      batch.marker->ClearPoints();
+      batch.size = 0u;
+    }
+
+    const std::size_t count = update.positions.size() / 3;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      const float *position = &update.positions[i * 3];
+      math::Vector3d vertex(position[0], position[1], position[2]);
+      const std::size_t index = update.first + i;
+      if (index < batch.size)
+        batch.marker->SetPoint(static_cast<unsigned int>(index), vertex);
+      else
+        batch.marker->AddPoint(vertex, color);
+    }
+    batch.size = std::max(batch.size, update.first + count);
+  }
+
+  for (const auto &update : _updates.texts)
+  {
+    auto it = _markers.texts.find(update.key);
+    if (it != _markers.texts.end())
+    {
+      scene->DestroyVisual(it->second.visual);
+      scene->DestroyMaterial(it->second.material);
+      _markers.texts.erase(it);
+    }
+    if (update.removed)
+      continue;
+
+    MarkerScene::Text text;
+    text.text = scene->CreateText();
+    if (!text.text)
+      continue;
+    text.text->SetTextString(update.text);
+    text.text->SetCharHeight(update.height);
+    text.text->SetTextAlignment(rendering::TextHorizontalAlign::CENTER,
+        rendering::TextVerticalAlign::CENTER);
+    text.material = colorMaterial(scene, update.color);
+    text.visual = scene->CreateVisual();
+    text.visual->AddGeometry(text.text);
+    text.visual->SetMaterial(text.material);
+    text.visual->SetLocalPose(update.pose);
+    scene->RootVisual()->AddChild(text.visual);
+    _markers.texts.emplace(update.key, text);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Apply the pending changes to the scene. Render thread only.
+/// \param[in] _markers Markers
+static void updatePendingMarkers(MarkerScene &_markers)
+{
+  MarkerUpdates updates;
+  {
+    std::lock_guard<std::mutex> lock(_markers.pendingMutex);
+    updates.batches.reserve(_markers.pendingBatches.size());
+    for (auto &pending : _markers.pendingBatches)
+      updates.batches.push_back(std::move(pending.second));
+    updates.texts.reserve(_markers.pendingTexts.size());
+    for (auto &pending : _markers.pendingTexts)
+      updates.texts.push_back(std::move(pending.second));
+    _markers.pendingBatches.clear();
+    _markers.pendingTexts.clear();
+  }
+  updateMarkers(_markers, updates);
+}
+
+/////////////////////////////////////////////////
+/// \brief Remove all markers from the scene. Render thread only.
+/// \param[in] _markers Markers
+static void destroyMarkers(MarkerScene &_markers)
+{
+  {
+    std::lock_guard<std::mutex> lock(_markers.pendingMutex);
+    _markers.pendingBatches.clear();
+    _markers.pendingTexts.clear();
+  }
+
+  if (auto scene = markerScene(_markers))
+  {
+    for (auto &batch : _markers.batches)
+    {
+      scene->DestroyVisual(batch.second.visual);
+      scene->DestroyMaterial(batch.second.material);
+    }
+    for (auto &text : _markers.texts)
+    {
+      scene->DestroyVisual(text.second.visual);
+      scene->DestroyMaterial(text.second.material);
+    }
+  }
+
+  _markers.batches.clear();
+  _markers.texts.clear();
+}
+
+/////////////////////////////////////////////////
+Markers::Markers()
+  : Plugin(), dataPtr(new MarkersPrivate)
+{
+  std::ostringstream key;
+  key << "Markers" << this;
+  this->dataPtr->scene->mutationKey = key.str();
+}
+
+/////////////////////////////////////////////////
+Markers::~Markers()
+{
+  this->dataPtr->expiryTimer.stop();
+  for (auto sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
+
+  // Before removing the markers, so processing doesn't post more
+  if (App() && App()->Workers())
+    App()->Workers()->Cancel(this);
+
+  if (App() && App()->SceneMutations())
+  {
+    // Replaces the pending update, if any
+    auto scene = this->dataPtr->scene;
+    App()->SceneMutations()->Post(scene->sceneName,
+        [scene]() {destroyMarkers(*scene);}, scene->mutationKey);
+  }
+}
+
+/////////////////////////////////////////////////
+void Markers::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+{
+  // Default name in case user didn't define one
+  if (this->title.empty())
+    this->title = "Markers";
+
+  auto &scene = *this->dataPtr->scene;
+
+  // Read configuration
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("topic"))
+      this->dataPtr->topic = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("array_topic"))
+      this->dataPtr->arrayTopic = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("engine"))
+      scene.engineName = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("scene"))
+      scene.sceneName = elem->GetText() ? elem->GetText() : "";
+  }
+
+  this->dataPtr->expiryTimer.setInterval(kExpiryInterval);
+  this->connect(&this->dataPtr->expiryTimer, &QTimer::timeout, this,
+      [this]()
+  {
+    if (this->dataPtr->hasExpiries)
+      this->ScheduleProcessing();
+  });
+  this->dataPtr->expiryTimer.start();
+
+  this->Subscribe();
+}
+
+/////////////////////////////////////////////////
+void Markers::OnMarkerMsg(const msgs::Marker &_msg)
+{
+  this->Queue(_msg);
+  this->ScheduleProcessing();
+}
+
+/////////////////////////////////////////////////
+void Markers::OnMarkersMsg(const msgs::Marker_V &_msg)
+{
+  for (const auto &marker : _msg.marker())
+    this->Queue(marker);
+  this->ScheduleProcessing();
+}
+
+/////////////////////////////////////////////////
+void Markers::Queue(const msgs::Marker &_msg)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto &pending = this->dataPtr->pending;
+  auto &index = this->dataPtr->pendingIndex;
+
+  // Earlier messages for the deleted markers are still applied in order.
+  // Later ones are queued after the deletion instead of replacing them.
+  if (_msg.action() == msgs::Marker::DELETE_ALL)
+  {
+    if (_msg.ns().empty())
+    {
+      pending.clear();
+      index.clear();
+    }
+    else
+    {
+      auto begin = index.lower_bound(MarkerKey(_msg.ns(),
+          std::numeric_limits<int64_t>::min()));
+      auto end = index.upper_bound(MarkerKey(_msg.ns(),
+          std::numeric_limits<int64_t>::max()));
+      index.erase(begin, end);
+    }
+    pending.push_back(_msg);
+    return;
+  }
+
+  MarkerKey key(_msg.ns(), static_cast<int64_t>(_msg.id()));
+  auto it = index.find(key);
+  if (it != index.end())
+  {
+    pending[it->second] = _msg;
+    return;
+  }
+
+  index[key] = pending.size();
+  pending.push_back(_msg);
+}
+
+/////////////////////////////////////////////////
+void Markers::ScheduleProcessing()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+    // Processing in flight will pick up the latest messages
+    if (this->dataPtr->processing)
+      return;
+    this->dataPtr->processing = true;
+  }
+
+  this->RunInBackground([this]() {this->ProcessMarkers();},
+      [this]() {this->OnMarkersProcessed();});
+}
+
+/////////////////////////////////////////////////
+void Markers::ProcessMarkers()
+{
+  std::vector<msgs::Marker> pending;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    std::swap(pending, this->dataPtr->pending);
+    this->dataPtr->pendingIndex.clear();
+  }
+
+  auto &batcher = this->dataPtr->batcher;
+  auto &texts = this->dataPtr->texts;
+  auto &expiries = this->dataPtr->expiries;
+  MarkerUpdates updates;
+
+  auto removeText = [&](const MarkerKey &_key)
+  {
+    if (texts.erase(_key) == 0u)
+      return;
+    TextUpdate update;
+    update.key = _key;
+    update.removed = true;
+    updates.texts.push_back(update);
+  };
+
+  auto now = std::chrono::steady_clock::now();
+  std::vector<float> positions;
+  for (const auto &msg : pending)
+  {
+    if (msg.action() == msgs::Marker::DELETE_ALL)
+    {
+      if (msg.ns().empty())
+        batcher.Clear();
+      else
+        batcher.RemoveNamespace(msg.ns());
+
+      for (auto it = texts.begin(); it != texts.end();)
+      {
+        auto key = *it++;
+        if (msg.ns().empty() || key.first == msg.ns())
+          removeText(key);
+      }
+      for (auto it = expiries.begin(); it != expiries.end();)
+      {
+        if (msg.ns().empty() || it->first.first == msg.ns())
+          it = expiries.erase(it);
+        else
+          ++it;
+      }
+      continue;
+    }
+
+    MarkerKey key(msg.ns(), static_cast<int64_t>(msg.id()));
+    if (msg.action() == msgs::Marker::DELETE_MARKER)
+    {
+      batcher.Remove(key.first, key.second);
+      removeText(key);
+      expiries.erase(key);
+      continue;
+    }
+
+    if (msg.has_lifetime() &&
+        (msg.lifetime().sec() > 0 || msg.lifetime().nsec() > 0))
+    {
+      expiries[key] = now + std::chrono::seconds(msg.lifetime().sec()) +
+          std::chrono::nanoseconds(msg.lifetime().nsec());
+    }
+    else
+    {
+      expiries.erase(key);
+    }
+
+    if (msg.type() == msgs::Marker::TEXT)
+    {
+      batcher.Remove(key.first, key.second);
+      texts.insert(key);
+
+      TextUpdate update;
+      update.key = key;
+      update.text = msg.text();
+      update.pose = msg.has_pose() ? msgs::Convert(msg.pose()) :
+          math::Pose3d::Zero;
+      update.color = markerColor(msg);
+      if (msg.has_scale() && msg.scale().z() > 0)
+        update.height = static_cast<float>(msg.scale().z());
+      updates.texts.push_back(update);
+      continue;
+    }
+
+    MarkerPrimitive primitive;
+    if (!markerVertices(msg, primitive, positions))
+    {
+      ignwarn << "Unsupported marker type [" << msg.type() << "] for marker ["
+              << key.first << "::" << key.second << "]" << std::endl;
+      continue;
+    }
+    removeText(key);
+
+    auto color = markerColor(msg);
+    batcher.Set(key.first, key.second, primitive,
+        {{color.R(), color.G(), color.B(), color.A()}}, positions);
+  }
+
+  // Lifetimes
+  for (auto it = expiries.begin(); it != expiries.end();)
+  {
+    if (it->second > now)
+    {
+      ++it;
+      continue;
+    }
+    batcher.Remove(it->first.first, it->first.second);
+    removeText(it->first);
+    it = expiries.erase(it);
+  }
+  this->dataPtr->hasExpiries = !expiries.empty();
+
+  // Updates are merged into those which haven't been applied yet, such as
+  // while the scene isn't rendered, so they don't pile up. Batches with a
+  // pending update are sent whole, to replace it.
+  auto scene = this->dataPtr->scene;
+  std::set<uint32_t> pendingBatches;
+  {
+    std::lock_guard<std::mutex> lock(scene->pendingMutex);
+    for (const auto &pending : scene->pendingBatches)
+      pendingBatches.insert(pending.first);
+  }
+  batcher.TakeUpdates(updates.batches, pendingBatches);
+
+  if (!updates.batches.empty() || !updates.texts.empty())
+  {
+    {
+      std::lock_guard<std::mutex> lock(scene->pendingMutex);
+      for (auto &update : updates.batches)
+        scene->pendingBatches[update.batch] = std::move(update);
+      for (auto &update : updates.texts)
+        scene->pendingTexts[update.key] = std::move(update);
+    }
+
+    if (App() && App()->SceneMutations())
+    {
+      App()->SceneMutations()->Post(scene->sceneName,
+          [scene]() {updatePendingMarkers(*scene);}, scene->mutationKey);
+    }
+  }
+
+  std::ostringstream stats;
+  stats << batcher.MarkerCount() + texts.size() << " markers\n"
+        << batcher.BatchCount() << " batches, " << texts.size()
+        << " texts\n" << batcher.VertexCount() << " vertices";
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->stats = QString::fromStdString(stats.str());
+  this->dataPtr->memory = batcher.VertexCount() * 3 * sizeof(float);
+
+  // Messages which arrived during processing are processed next
+  if (!this->dataPtr->pending.empty())
+  {
+    this->RunInBackground([this]() {this->ProcessMarkers();},
+        [this]() {this->OnMarkersProcessed();});
+  }
+  else
+  {
+    this->dataPtr->processing = false;
+  }
+}
+
+/////////////////////////////////////////////////
+void Markers::OnMarkersProcessed()
+{
+  uint64_t memory;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    memory = this->dataPtr->memory;
+  }
+  this->SetMemoryUsage("vertices", memory);
+  this->StatsChanged();
+}
+
+/////////////////////////////////////////////////
+QString Markers::Stats() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->stats;
+}
+
+/////////////////////////////////////////////////
+void Markers::Subscribe()
+{
+  // Unlike displays which only show the latest message, every message
+  // changes the markers, so they're neither rate limited nor unsubscribed
+  // while the card is hidden
+  auto topic = this->dataPtr->topic;
+  if (!topic.empty() && !this->dataPtr->node.Subscribe(topic,
+      &Markers::OnMarkerMsg, this))
+  {
+    ignerr << "Unable to subscribe to topic [" << topic << "]" << std::endl;
+  }
+
+  topic = this->dataPtr->arrayTopic;
+  if (!topic.empty() && !this->dataPtr->node.Subscribe(topic,
+      &Markers::OnMarkersMsg, this))
+  {
+    ignerr << "Unable to subscribe to topic [" << topic << "]" << std::endl;
+  }
+}
+
+// Register this plugin
+IGNITION_ADD_PLUGIN(ignition::gui::plugins::Markers,
+                    ignition::gui::Plugin)
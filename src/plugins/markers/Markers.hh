@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_MARKERS_HH_
+#define IGNITION_GUI_PLUGINS_MARKERS_HH_
+
+#include <memory>
+#include <ignition/msgs.hh>
+
+#include "ignition/gui/Plugin.hh"
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class MarkersPrivate;
+
+  /// \brief Display debug markers coming through Ignition transport topics
+  /// in a 3D scene, such as the one rendered by Scene3D.
+  ///
+  /// Markers are added, modified and deleted by namespace and id, following
+  /// the actions of ignition::msgs::Marker. A DELETE_ALL with an empty
+  /// namespace deletes every marker. Markers with a lifetime are deleted
+  /// once it elapses.
+  ///
+  /// Boxes, spheres and cylinders are tessellated, and all markers except
+  /// text are transformed to the scene's frame and batched by primitive and
+  /// material color on a worker thread, so thousands of markers are drawn
+  /// with one buffer per batch. Only the vertices which changed are sent to
+  /// the scene's render thread, as scene mutations. Messages for a marker
+  /// which hasn't been processed yet replace each other.
+  ///
+  /// ## Configuration
+  ///
+  /// \<topic\> : Topic to receive ignition::msgs::Marker messages, defaults
+  ///             to "/marker".
+  /// \<array_topic\> : Topic to receive ignition::msgs::Marker_V messages,
+  ///                   defaults to "/marker_array".
+  /// \<engine\> : Name of the render engine, defaults to "ogre".
+  /// \<scene\> : Name of the scene, defaults to "scene".
+  class Markers : public Plugin
+  {
+    Q_OBJECT
+
+    /// \brief Statistics about the markers displayed
+    Q_PROPERTY(
+      QString stats
+      READ Stats
+      NOTIFY StatsChanged
+    )
+
+    /// \brief Constructor
+    public: Markers();
+
+    /// \brief Destructor
+    public: virtual ~Markers();
+
+    // Documentation inherited
+    public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem);
+
+    /// \brief Get statistics about the markers displayed.
+    /// \return Human readable statistics.
+    public: Q_INVOKABLE QString Stats() const;
+
+    /// \brief Notify that statistics have changed
+    signals: void StatsChanged();
+
+    /// \brief Subscribe to the marker topics.
+    private: void Subscribe();
+
+    /// \brief Subscriber callback for a single marker
+    /// \param[in] _msg Marker
+    private: void OnMarkerMsg(const msgs::Marker &_msg);
+
+    /// \brief Subscriber callback for markers
+    /// \param[in] _msg Markers
+    private: void OnMarkersMsg(const msgs::Marker_V &_msg);
+
+    /// \brief Queue a marker to be processed, replacing pending messages for
+    /// the same marker.
+    /// \param[in] _msg Marker
+    private: void Queue(const msgs::Marker &_msg);
+
+    /// \brief Make sure queued markers, and expired ones, are processed.
+    private: void ScheduleProcessing();
+
+    /// \brief Apply queued markers and post the changes to the scene. Runs
+    /// on a worker thread.
+    private: void ProcessMarkers();
+
+    /// \brief Update statistics on the GUI thread once changes are posted.
+    private: void OnMarkersProcessed();
+
+    /// \internal
+    /// \brief Pointer to private data.
+    private: std::unique_ptr<MarkersPrivate> dataPtr;
+  };
+}
+}
+}
+
+#endif
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <ignition/common/Console.hh>
+#include <ignition/transport/Node.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Plugin.hh"
+#include "ignition/gui/MainWindow.hh"
+#include "Markers.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Load a markers plugin and show its window
+/// \param[in] _app Application
+/// \param[in] _config Plugin configuration
+/// \return The plugin, null on failure
+plugins::Markers *loadMarkers(Application &_app, const std::string &_config)
+{
+  _app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(("<plugin filename=\"Markers\">" + _config +
+      "</plugin>").c_str());
+  EXPECT_TRUE(_app.LoadPlugin("Markers",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = _app.findChild<MainWindow *>();
+  if (!win)
+    return nullptr;
+
+  // Show, but don't exec, so we don't block. Hidden plugins are suspended.
+  win->QuickWindow()->show();
+
+  return win->findChild<plugins::Markers *>();
+}
+
+/////////////////////////////////////////////////
+/// \brief Make a box marker
+/// \param[in] _id Marker id
+/// \return Marker
+msgs::Marker makeBox(const int _id)
+{
+  msgs::Marker msg;
+  msg.set_ns("test");
+  msg.set_id(_id);
+  msg.set_action(msgs::Marker::ADD_MODIFY);
+  msg.set_type(msgs::Marker::BOX);
+  msg.mutable_scale()->set_x(1.0);
+  msg.mutable_scale()->set_y(1.0);
+  msg.mutable_scale()->set_z(1.0);
+  msg.mutable_pose()->mutable_position()->set_x(_id);
+  return msg;
+}
+
+/////////////////////////////////////////////////
+/// \brief Publish until the plugin's statistics change, for up to 2 s
+/// \param[in] _plugin Plugin
+/// \param[in] _pub Publisher
+/// \param[in] _msg Message
+/// \return The new statistics, or the old ones if they didn't change
+template <typename Msg>
+QString publishUntilStats(plugins::Markers *_plugin,
+    transport::Node::Publisher &_pub, const Msg &_msg)
+{
+  auto stats = _plugin->Stats();
+  for (int sleep = 0; sleep < 20 && _plugin->Stats() == stats; ++sleep)
+  {
+    _pub.Publish(_msg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    QCoreApplication::processEvents();
+  }
+  return _plugin->Stats();
+}
+
+/////////////////////////////////////////////////
+TEST(MarkersTest, Load)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("Markers"));
+
+  // Get main window
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  // Get plugin
+  auto plugins = win->findChildren<Plugin *>();
+  EXPECT_EQ(plugins.size(), 1);
+
+  auto plugin = plugins[0];
+  EXPECT_EQ(plugin->Title(), "Markers");
+
+  // Cleanup
+  plugins.clear();
+}
+
+/////////////////////////////////////////////////
+TEST(MarkersTest, ReceiveMarkers)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadMarkers(app,
+      "<topic>/markers_test</topic>"
+      "<array_topic>/markers_array_test</array_topic>");
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_EQ("No markers received", plugin->Stats().toStdString());
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Marker>("/markers_test");
+  auto arrayPub = node.Advertise<msgs::Marker_V>("/markers_array_test");
+
+  // Boxes of the same color share a batch
+  auto stats = publishUntilStats(plugin, pub, makeBox(1));
+  EXPECT_TRUE(stats.startsWith("1 markers\n1 batches, 0 texts"))
+      << stats.toStdString();
+
+  msgs::Marker_V markers;
+  *markers.add_marker() = makeBox(2);
+  *markers.add_marker() = makeBox(3);
+  stats = publishUntilStats(plugin, arrayPub, markers);
+  EXPECT_TRUE(stats.startsWith("3 markers\n1 batches")) << stats.toStdString();
+
+  // Every message changes the markers, so they're still received while the
+  // card is hidden
+  plugin->CardItem()->setVisible(false);
+  EXPECT_TRUE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeBox(4));
+  EXPECT_TRUE(stats.startsWith("4 markers")) << stats.toStdString();
+
+  plugin->CardItem()->setVisible(true);
+  EXPECT_FALSE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeBox(5));
+  EXPECT_TRUE(stats.startsWith("5 markers")) << stats.toStdString();
+}
+
+/////////////////////////////////////////////////
+TEST(MarkersTest, EmptyTopic)
+{
+  common::Console::SetVerbosity(4);
+
+  // An empty topic turns off the default one
+  Application app(g_argc, g_argv);
+  auto plugin = loadMarkers(app,
+      "<topic></topic>"
+      "<array_topic>/markers_empty_test</array_topic>");
+  ASSERT_NE(nullptr, plugin);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Marker>("/marker");
+  EXPECT_EQ("No markers received",
+      publishUntilStats(plugin, pub, makeBox(1)).toStdString());
+
+  msgs::Marker_V markers;
+  *markers.add_marker() = makeBox(1);
+  auto arrayPub = node.Advertise<msgs::Marker_V>("/markers_empty_test");
+  auto stats = publishUntilStats(plugin, arrayPub, markers);
+  EXPECT_TRUE(stats.startsWith("1 markers")) << stats.toStdString();
+}
@@ -0,0 +1,537 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/rendering.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/SceneMutationQueue.hh"
+#include "OccupancyGrid.hh"
+#include "TiledMap.hh"
+
+// Default width and height of tiles, in cells
+static const unsigned int kDefaultTileSize{256u};
+
+// Default number of tiles displayed again per frame
+static const unsigned int kDefaultTilesPerFrame{16u};
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Map and the scene objects displaying it. Shared with the scene
+  /// mutations, which outlive the plugin.
+  struct MapScene
+  {
+    /// \brief Mesh displaying a tile, render thread only
+    struct Tile
+    {
+      /// \brief Visual
+      rendering::VisualPtr visual;
+
+      /// \brief Quads
+      rendering::MarkerPtr marker;
+    };
+
+    /// \brief Constructor
+    /// \param[in] _tileSize Width and height of tiles, in cells
+    explicit MapScene(const uint32_t _tileSize) : map(_tileSize)
+    {
+    }
+
+    /// \brief Render engine name
+    std::string engineName{"ogre"};
+
+    /// \brief Scene name
+    std::string sceneName{"scene"};
+
+    /// \brief Key of the mutations displaying changed tiles
+    std::string mutationKey;
+
+    /// \brief Size of cells, in meters
+    double resolution{0.05};
+
+    /// \brief Pose of the map's origin
+    math::Pose3d pose{math::Pose3d::Zero};
+
+    /// \brief Color of each cell value
+    CellColors colors;
+
+    /// \brief Maximum number of tiles displayed again per frame
+    std::size_t tilesPerFrame{kDefaultTilesPerFrame};
+
+    /// \brief Protects the map
+    std::mutex mutex;
+
+    /// \brief Cells
+    TiledMap map;
+
+    /// \brief Generation of the map the tiles were made for, render thread
+    /// only
+    uint64_t generation{0u};
+
+    /// \brief Parent of all tiles, at the map's origin, render thread only
+    rendering::VisualPtr root;
+
+    /// \brief Material of all tiles, render thread only
+    rendering::MaterialPtr material;
+
+    /// \brief Tiles, render thread only
+    std::vector<Tile> tiles;
+
+    /// \brief Tiles taken from the map, render thread only
+    std::vector<std::size_t> taken;
+
+    /// \brief Runs of a tile, render thread only
+    std::vector<CellRun> runs;
+  };
+
+  class OccupancyGridPrivate
+  {
+    /// \brief Topic of whole maps
+    public: std::string topic;
+
+    /// \brief Topic of updates
+    public: std::string updateTopic;
+
+    /// \brief Node for communication
+    public: transport::Node node;
+
+    /// \brief Map, shared with scene mutations
+    public: std::shared_ptr<MapScene> scene;
+
+    /// \brief Cells which changed with the latest message
+    public: std::atomic<std::size_t> changedCells{0u};
+
+    /// \brief Tiles which haven't been displayed again yet
+    public: std::atomic<std::size_t> changedTiles{0u};
+
+    /// \brief Number of messages received
+    public: std::atomic<uint64_t> messages{0u};
+
+    /// \brief Whether the pixel format warning was printed
+    public: std::atomic<bool> formatWarned{false};
+  };
+}
+}
+}
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+/// \brief Get the scene the map is displayed in. Render thread only.
+/// \param[in] _map Map
+/// \return Scene, null if it doesn't exist yet
+static rendering::ScenePtr mapScene(const MapScene &_map)
+{
+  if (!rendering::isEngineLoaded(_map.engineName))
+    return nullptr;
+
+  auto engine = rendering::engine(_map.engineName);
+  if (!engine)
+    return nullptr;
+
+  return engine->SceneByName(_map.sceneName);
+}
+
+/////////////////////////////////////////////////
+/// \brief Remove all tiles from the scene. Render thread only.
+/// \param[in] _scene Scene, may be null
+/// \param[in] _map Map
+static void destroyTiles(rendering::ScenePtr _scene, MapScene &_map)
+{
+  for (auto &tile : _map.tiles)
+  {
+    if (_scene && tile.visual)
+      _scene->DestroyVisual(tile.visual);
+  }
+  _map.tiles.clear();
+}
+
+/////////////////////////////////////////////////
+/// \brief Display changed tiles, up to the limit per frame, and post
+/// another mutation for the next frame if more are left. Render thread only.
+/// \param[in] _map Map, shared with the mutation
+static void updateTiles(const std::shared_ptr<MapScene> &_map)
+{
+  auto &map = *_map;
+  auto scene = mapScene(map);
+  if (!scene)
+    return;
+
+  if (!map.root)
+  {
+    map.material = scene->CreateMaterial();
+    map.root = scene->CreateVisual();
+    map.root->SetLocalPose(map.pose);
+    scene->RootVisual()->AddChild(map.root);
+  }
+
+  std::size_t left;
+  {
+    std::lock_guard<std::mutex> lock(map.mutex);
+
+    // Tiles of a map of another size no longer exist
+    if (map.generation != map.map.Generation())
+    {
+      destroyTiles(scene, map);
+      map.tiles.resize(map.map.TileCount());
+      map.generation = map.map.Generation();
+    }
+
+    map.taken.clear();
+    map.map.TakeChanged(map.tilesPerFrame, map.taken);
+    left = map.map.ChangedCount();
+  }
+
+  const double resolution = map.resolution;
+  for (auto index : map.taken)
+  {
+    {
+      std::lock_guard<std::mutex> lock(map.mutex);
+
+      // The map was resized meanwhile, all tiles will be taken again
+      if (map.generation != map.map.Generation())
+        break;
+      map.map.TileRuns(index, map.runs);
+    }
+
+    auto &tile = map.tiles[index];
+    if (!tile.visual)
+    {
+      tile.marker = scene->CreateMarker();
+      tile.marker->SetType(rendering::MarkerType::MT_TRIANGLE_LIST);
+      tile.visual = scene->CreateVisual();
+      tile.visual->AddGeometry(tile.marker);
+      tile.visual->SetMaterial(map.material, false);
+      map.root->AddChild(tile.visual);
+    }
+
+    tile.marker->ClearPoints();
+    for (const auto &run : map.runs)
+    {
+      const auto &rgba = map.colors[run.value];
+      if (rgba[3] <= 0.0f)
+        continue;
+
+      math::Color color(rgba[0], rgba[1], rgba[2], rgba[3]);
+      const double x0 = run.begin * resolution;
+      const double x1 = run.end * resolution;
+      const double y0 = run.row * resolution;
+      const double y1 = (run.row + 1) * resolution;
+      tile.marker->AddPoint(x0, y0, 0, color);
+      tile.marker->AddPoint(x1, y0, 0, color);
+      tile.marker->AddPoint(x1, y1, 0, color);
+      tile.marker->AddPoint(x0, y0, 0, color);
+      tile.marker->AddPoint(x1, y1, 0, color);
+      tile.marker->AddPoint(x0, y1, 0, color);
+    }
+  }
+
+  // The rest is spread over the next frames
+  if (left > 0u && App() && App()->SceneMutations())
+  {
+    App()->SceneMutations()->Post(map.sceneName,
+        [_map]() {updateTiles(_map);}, map.mutationKey);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Remove the map from the scene. Render thread only.
+/// \param[in] _map Map
+static void destroyMap(MapScene &_map)
+{
+  auto scene = mapScene(_map);
+  destroyTiles(scene, _map);
+  if (scene && _map.root)
+  {
+    scene->DestroyVisual(_map.root);
+    scene->DestroyMaterial(_map.material);
+  }
+  _map.root.reset();
+  _map.material.reset();
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a cell offset from an update's header
+/// \param[in] _msg Update
+/// \param[in] _key Header key, "x" or "y"
+/// \param[out] _value Offset
+/// \return True if the offset was found
+static bool headerOffset(const msgs::Image &_msg, const std::string &_key,
+    uint32_t &_value)
+{
+  for (const auto &data : _msg.header().data())
+  {
+    if (data.key() != _key || data.value_size() == 0)
+      continue;
+
+    std::istringstream stream(data.value(0));
+    return static_cast<bool>(stream >> _value);
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+OccupancyGrid::OccupancyGrid()
+  : Plugin(), dataPtr(new OccupancyGridPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+OccupancyGrid::~OccupancyGrid()
+{
+  for (auto sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
+
+  // Replaces tiles which haven't been displayed yet
+  auto scene = this->dataPtr->scene;
+  if (scene && App() && App()->SceneMutations())
+  {
+    App()->SceneMutations()->Post(scene->sceneName,
+        [scene]() {destroyMap(*scene);}, scene->mutationKey);
+  }
+}
+
+/////////////////////////////////////////////////
+void OccupancyGrid::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+{
+  // Default name in case user didn't define one
+  if (this->title.empty())
+    this->title = "Occupancy grid";
+
+  std::string engineName{"ogre"};
+  std::string sceneName{"scene"};
+  std::string colorScheme{"map"};
+  double resolution{0.05};
+  math::Pose3d pose{math::Pose3d::Zero};
+  unsigned int tileSize{kDefaultTileSize};
+  unsigned int tilesPerFrame{kDefaultTilesPerFrame};
+
+  // Read configuration
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("topic"))
+      this->dataPtr->topic = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("update_topic"))
+      this->dataPtr->updateTopic = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("engine"))
+      engineName = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("scene"))
+      sceneName = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("resolution"))
+      elem->QueryDoubleText(&resolution);
+
+    if (auto elem = _pluginElem->FirstChildElement("pose"))
+    {
+      std::stringstream poseStr(elem->GetText() ? elem->GetText() : "");
+      poseStr >> pose;
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("color_scheme"))
+      colorScheme = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("tile_size"))
+      elem->QueryUnsignedText(&tileSize);
+
+    if (auto elem = _pluginElem->FirstChildElement("tiles_per_frame"))
+      elem->QueryUnsignedText(&tilesPerFrame);
+  }
+
+  if (resolution <= 0.0)
+  {
+    ignwarn << "Invalid <resolution> [" << resolution << "], using 0.05."
+            << std::endl;
+    resolution = 0.05;
+  }
+
+  auto scene = std::make_shared<MapScene>(std::max(1u, tileSize));
+  scene->engineName = engineName;
+  scene->sceneName = sceneName;
+  scene->resolution = resolution;
+  scene->pose = pose;
+  scene->tilesPerFrame = std::max(1u, tilesPerFrame);
+
+  if (colorScheme == "costmap")
+  {
+    scene->colors = CostmapColors();
+  }
+  else
+  {
+    if (colorScheme != "map")
+    {
+      ignwarn << "Unknown <color_scheme> [" << colorScheme << "], using "
+              << "[map]." << std::endl;
+    }
+    scene->colors = MapColors();
+  }
+
+  std::ostringstream key;
+  key << "OccupancyGrid" << this;
+  scene->mutationKey = key.str();
+  this->dataPtr->scene = scene;
+
+  if (this->dataPtr->topic.empty())
+  {
+    ignerr << "Missing <topic>, no map will be displayed." << std::endl;
+    return;
+  }
+
+  // Maps replace each other, so they can be dropped
+  auto topic = this->dataPtr->topic;
+  if (!this->dataPtr->node.Subscribe(topic, &OccupancyGrid::OnMapMsg, this,
+      this->SubscribeOptions(topic)))
+  {
+    ignerr << "Unable to subscribe to topic [" << topic << "]" << std::endl;
+  }
+
+  // Updates can't
+  topic = this->dataPtr->updateTopic;
+  if (!topic.empty() &&
+      !this->dataPtr->node.Subscribe(topic, &OccupancyGrid::OnUpdateMsg, this))
+  {
+    ignerr << "Unable to subscribe to topic [" << topic << "]" << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void OccupancyGrid::OnMapMsg(const msgs::Image &_msg)
+{
+  {
+    auto scene = this->dataPtr->scene;
+    std::lock_guard<std::mutex> lock(scene->mutex);
+    scene->map.Resize(_msg.width(), _msg.height());
+  }
+  this->Apply(_msg, 0u, 0u);
+}
+
+/////////////////////////////////////////////////
+void OccupancyGrid::OnUpdateMsg(const msgs::Image &_msg)
+{
+  uint32_t x;
+  uint32_t y;
+  if (!headerOffset(_msg, "x", x) || !headerOffset(_msg, "y", y))
+  {
+    ignwarn << "Map update without \"x\" and \"y\" header data, ignoring."
+            << std::endl;
+    return;
+  }
+  this->Apply(_msg, x, y);
+}
+
+/////////////////////////////////////////////////
+void OccupancyGrid::Apply(const msgs::Image &_msg, const uint32_t _x,
+    const uint32_t _y)
+{
+  if (_msg.pixel_format_type() != msgs::PixelFormatType::L_INT8)
+  {
+    if (!this->dataPtr->formatWarned.exchange(true))
+    {
+      ignwarn << "Maps must have the L_INT8 pixel format, ignoring ["
+              << msgs::PixelFormatType_Name(_msg.pixel_format_type())
+              << "]." << std::endl;
+    }
+    return;
+  }
+
+  const std::size_t step = _msg.step() > 0u ? _msg.step() : _msg.width();
+  if (step < _msg.width() || _msg.data().size() < step * _msg.height())
+  {
+    ignwarn << "Map of [" << _msg.width() << "x" << _msg.height()
+            << "] cells with only [" << _msg.data().size()
+            << "] bytes, ignoring." << std::endl;
+    return;
+  }
+
+  auto scene = this->dataPtr->scene;
+  auto data = reinterpret_cast<const uint8_t *>(_msg.data().data());
+
+  // A band of tiles at a time, so the render thread doesn't wait for the
+  // whole map to be compared
+  std::size_t changedCells{0u};
+  std::size_t changedTiles;
+  uint64_t cells;
+  const uint32_t band = scene->map.TileSize();
+  for (uint32_t row = 0; row < _msg.height(); row += band)
+  {
+    std::lock_guard<std::mutex> lock(scene->mutex);
+    changedCells += scene->map.Update(_x, _y + row, _msg.width(),
+        std::min(band, _msg.height() - row), data + row * step, step);
+  }
+  {
+    std::lock_guard<std::mutex> lock(scene->mutex);
+    changedTiles = scene->map.ChangedCount();
+    cells = static_cast<uint64_t>(scene->map.Width()) * scene->map.Height();
+  }
+
+  if (changedTiles > 0u && App() && App()->SceneMutations())
+  {
+    App()->SceneMutations()->Post(scene->sceneName,
+        [scene]() {updateTiles(scene);}, scene->mutationKey);
+  }
+
+  this->dataPtr->changedCells = changedCells;
+  this->dataPtr->changedTiles = changedTiles;
+  ++this->dataPtr->messages;
+  this->PostToGuiThread([this, cells]()
+  {
+    this->SetMemoryUsage("cells", cells);
+    this->StatsChanged();
+  }, DeliveryLane::kBulk, "stats");
+}
+
+/////////////////////////////////////////////////
+QString OccupancyGrid::Stats() const
+{
+  if (this->dataPtr->messages == 0u)
+    return "No map received";
+
+  auto scene = this->dataPtr->scene;
+  std::ostringstream stats;
+  {
+    std::lock_guard<std::mutex> lock(scene->mutex);
+    stats << scene->map.Width() << "x" << scene->map.Height() << " cells, "
+          << scene->map.TileCount() << " tiles\n";
+  }
+  stats << this->dataPtr->changedCells << " cells changed, "
+        << this->dataPtr->changedTiles << " tiles to display";
+  return QString::fromStdString(stats.str());
+}
+
+// Register this plugin
+IGNITION_ADD_PLUGIN(ignition::gui::plugins::OccupancyGrid,
+                    ignition::gui::Plugin)
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_OCCUPANCYGRID_HH_
+#define IGNITION_GUI_PLUGINS_OCCUPANCYGRID_HH_
+
+#include <memory>
+#include <ignition/msgs.hh>
+
+#include "ignition/gui/Plugin.hh"
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class OccupancyGridPrivate;
+
+  /// \brief Display grid maps, such as occupancy grids and costmaps, coming
+  /// through Ignition transport topics in a 3D scene, such as the one
+  /// rendered by Scene3D.
+  ///
+  /// Maps are ignition::msgs::Image messages with the L_INT8 pixel format,
+  /// one byte per cell, with the first row at the map's origin. Updates of
+  /// part of the map are images with "x" and "y" header data holding the
+  /// column and row of their first cell.
+  ///
+  /// The map is split in square tiles, and only tiles whose cells changed
+  /// are displayed again, a few per frame, so that large maps which change
+  /// locally, even when the whole map is sent again, don't slow the scene
+  /// down. Each tile is a mesh with a quad per run of equal cells in a row,
+  /// colored according to the color scheme.
+  ///
+  /// ## Configuration
+  ///
+  /// \<topic\> : Topic to receive whole maps.
+  /// \<update_topic\> : Topic to receive updates of part of the map,
+  ///                    optional.
+  /// \<engine\> : Name of the render engine, defaults to "ogre".
+  /// \<scene\> : Name of the scene, defaults to "scene".
+  /// \<resolution\> : Size of cells, in meters, defaults to 0.05.
+  /// \<pose\> : Pose of the map's origin, defaults to the scene's origin.
+  /// \<color_scheme\> : "map" or "costmap", defaults to "map".
+  /// \<tile_size\> : Width and height of tiles, in cells, defaults to 256.
+  /// \<tiles_per_frame\> : Maximum number of tiles displayed again on each
+  ///                       frame, defaults to 16.
+  class OccupancyGrid : public Plugin
+  {
+    Q_OBJECT
+
+    /// \brief Statistics about the map
+    Q_PROPERTY(
+      QString stats
+      READ Stats
+      NOTIFY StatsChanged
+    )
+
+    /// \brief Constructor
+    public: OccupancyGrid();
+
+    /// \brief Destructor
+    public: virtual ~OccupancyGrid();
+
+    // Documentation inherited
+    public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem);
+
+    /// \brief Get statistics about the map.
+    /// \return Human readable statistics.
+    public: Q_INVOKABLE QString Stats() const;
+
+    /// \brief Notify that statistics have changed
+    signals: void StatsChanged();
+
+    /// \brief Subscriber callback when a whole map is received
+    /// \param[in] _msg Map
+    private: void OnMapMsg(const msgs::Image &_msg);
+
+    /// \brief Subscriber callback when an update is received
+    /// \param[in] _msg Part of the map
+    private: void OnUpdateMsg(const msgs::Image &_msg);
+
+    /// \brief Write cells to the map and display them
+    /// \param[in] _msg Cells
+    /// \param[in] _x Column of the first cell
+    /// \param[in] _y Row of the first cell
+    private: void Apply(const msgs::Image &_msg, const uint32_t _x,
+        const uint32_t _y);
+
+    /// \internal
+    /// \brief Pointer to private data.
+    private: std::unique_ptr<OccupancyGridPrivate> dataPtr;
+  };
+}
+}
+}
+
+#endif
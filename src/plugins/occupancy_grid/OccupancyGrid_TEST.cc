@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <ignition/common/Console.hh>
+#include <ignition/transport/Node.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Plugin.hh"
+#include "ignition/gui/MainWindow.hh"
+#include "OccupancyGrid.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Load an occupancy grid plugin and show its window
+/// \param[in] _app Application
+/// \param[in] _config Plugin configuration
+/// \return The plugin, null on failure
+plugins::OccupancyGrid *loadOccupancyGrid(Application &_app,
+    const std::string &_config)
+{
+  _app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(("<plugin filename=\"OccupancyGrid\">" + _config +
+      "</plugin>").c_str());
+  EXPECT_TRUE(_app.LoadPlugin("OccupancyGrid",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = _app.findChild<MainWindow *>();
+  if (!win)
+    return nullptr;
+
+  // Show, but don't exec, so we don't block. Hidden plugins are suspended.
+  win->QuickWindow()->show();
+
+  return win->findChild<plugins::OccupancyGrid *>();
+}
+
+/////////////////////////////////////////////////
+/// \brief Make a map, or an update of part of a map
+/// \param[in] _width Width in cells
+/// \param[in] _height Height in cells
+/// \param[in] _value Value of every cell
+/// \return Map
+msgs::Image makeMap(const unsigned int _width, const unsigned int _height,
+    const char _value)
+{
+  msgs::Image msg;
+  msg.set_width(_width);
+  msg.set_height(_height);
+  msg.set_pixel_format_type(msgs::PixelFormatType::L_INT8);
+  msg.mutable_data()->assign(_width * _height, _value);
+  return msg;
+}
+
+/////////////////////////////////////////////////
+/// \brief Publish a map until the plugin's statistics change, for up to 2 s
+/// \param[in] _plugin Plugin
+/// \param[in] _pub Publisher
+/// \param[in] _msg Map
+/// \return The new statistics, or the old ones if they didn't change
+QString publishUntilStats(plugins::OccupancyGrid *_plugin,
+    transport::Node::Publisher &_pub, const msgs::Image &_msg)
+{
+  auto stats = _plugin->Stats();
+  for (int sleep = 0; sleep < 20 && _plugin->Stats() == stats; ++sleep)
+  {
+    _pub.Publish(_msg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    QCoreApplication::processEvents();
+  }
+  return _plugin->Stats();
+}
+
+/////////////////////////////////////////////////
+TEST(OccupancyGridTest, Load)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("OccupancyGrid"));
+
+  // Get main window
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  // Get plugin
+  auto plugins = win->findChildren<Plugin *>();
+  EXPECT_EQ(plugins.size(), 1);
+
+  auto plugin = plugins[0];
+  EXPECT_EQ(plugin->Title(), "Occupancy grid");
+
+  // Cleanup
+  plugins.clear();
+}
+
+/////////////////////////////////////////////////
+TEST(OccupancyGridTest, ReceiveMap)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadOccupancyGrid(app,
+      "<topic>/map_test</topic>"
+      "<update_topic>/map_update_test</update_topic>"
+      "<tile_size>2</tile_size>");
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_EQ("No map received", plugin->Stats().toStdString());
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Image>("/map_test");
+  auto updatePub = node.Advertise<msgs::Image>("/map_update_test");
+
+  auto stats = publishUntilStats(plugin, pub, makeMap(4u, 4u, 100));
+  EXPECT_TRUE(stats.startsWith("4x4 cells, 4 tiles\n16 cells changed"))
+      << stats.toStdString();
+
+  // Update of the 2x2 cells at (1, 1)
+  auto update = makeMap(2u, 2u, 0);
+  for (auto key : {"x", "y"})
+  {
+    auto data = update.mutable_header()->add_data();
+    data->set_key(key);
+    data->add_value("1");
+  }
+  stats = publishUntilStats(plugin, updatePub, update);
+  EXPECT_TRUE(stats.startsWith("4x4 cells, 4 tiles\n4 cells changed"))
+      << stats.toStdString();
+
+  // The map is kept up to date while the card is hidden, since updates
+  // can't be dropped
+  plugin->CardItem()->setVisible(false);
+  EXPECT_TRUE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeMap(6u, 4u, 100));
+  EXPECT_TRUE(stats.startsWith("6x4 cells, 6 tiles")) << stats.toStdString();
+
+  plugin->CardItem()->setVisible(true);
+  EXPECT_FALSE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeMap(8u, 4u, 100));
+  EXPECT_TRUE(stats.startsWith("8x4 cells, 8 tiles")) << stats.toStdString();
+}
+
+/////////////////////////////////////////////////
+TEST(OccupancyGridTest, InvalidConfig)
+{
+  common::Console::SetVerbosity(4);
+
+  // Defaults are used instead
+  Application app(g_argc, g_argv);
+  auto plugin = loadOccupancyGrid(app,
+      "<topic>/map_invalid_test</topic>"
+      "<resolution>-1</resolution>"
+      "<tile_size>0</tile_size>"
+      "<color_scheme>banana</color_scheme>");
+  ASSERT_NE(nullptr, plugin);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Image>("/map_invalid_test");
+
+  // Tiles of one cell
+  auto stats = publishUntilStats(plugin, pub, makeMap(2u, 2u, 100));
+  EXPECT_TRUE(stats.startsWith("2x2 cells, 4 tiles")) << stats.toStdString();
+}
+
+/////////////////////////////////////////////////
+TEST(OccupancyGridTest, MissingTopic)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadOccupancyGrid(app,
+      "<update_topic>/map_missing_update</update_topic>");
+  ASSERT_NE(nullptr, plugin);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Image>("/map");
+  EXPECT_EQ("No map received",
+      publishUntilStats(plugin, pub, makeMap(4u, 4u, 100)).toStdString());
+}
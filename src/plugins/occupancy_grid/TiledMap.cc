@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "TiledMap.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+// Value of unknown cells
+static const uint8_t kUnknown{255u};
+
+/////////////////////////////////////////////////
+CellColors plugins::MapColors()
+{
+  CellColors colors;
+  for (int v = 0; v < 256; ++v)
+  {
+    if (v <= 100)
+    {
+      float gray = (100 - v) / 100.0f;
+      colors[v] = {gray, gray, gray, 1.0f};
+    }
+    else if (v == kUnknown)
+    {
+      colors[v] = {0.5f, 0.5f, 0.5f, 1.0f};
+    }
+    else
+    {
+      // Invalid
+      colors[v] = {1.0f, 0.0f, 1.0f, 1.0f};
+    }
+  }
+  return colors;
+}
+
+/////////////////////////////////////////////////
+CellColors plugins::CostmapColors()
+{
+  CellColors colors;
+  for (int v = 0; v < 256; ++v)
+  {
+    if (v == 0 || v == kUnknown)
+    {
+      colors[v] = {0.0f, 0.0f, 0.0f, 0.0f};
+    }
+    else if (v < 99)
+    {
+      float t = (v - 1) / 97.0f;
+      colors[v] = {t, 0.0f, 1.0f - t, 1.0f};
+    }
+    else if (v == 99)
+    {
+      colors[v] = {0.0f, 1.0f, 1.0f, 1.0f};
+    }
+    else if (v == 100)
+    {
+      colors[v] = {1.0f, 0.0f, 1.0f, 1.0f};
+    }
+    else
+    {
+      // Invalid
+      colors[v] = {0.0f, 1.0f, 0.0f, 1.0f};
+    }
+  }
+  return colors;
+}
+
+/////////////////////////////////////////////////
+TiledMap::TiledMap(const uint32_t _tileSize)
+  : tileSize(std::max(1u, _tileSize))
+{
+}
+
+/////////////////////////////////////////////////
+bool TiledMap::Resize(const uint32_t _width, const uint32_t _height)
+{
+  if (_width == this->width && _height == this->height)
+    return false;
+
+  this->width = _width;
+  this->height = _height;
+  this->tilesX = (_width + this->tileSize - 1) / this->tileSize;
+  this->tilesY = (_height + this->tileSize - 1) / this->tileSize;
+  this->cells.assign(static_cast<std::size_t>(_width) * _height, kUnknown);
+  ++this->generation;
+
+  const std::size_t count = this->TileCount();
+  this->isChanged.assign(count, false);
+  this->changed.clear();
+  this->changed.reserve(count);
+  this->changedBegin = 0u;
+  for (std::size_t t = 0; t < count; ++t)
+    this->MarkChanged(t);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::size_t TiledMap::Update(const uint32_t _x, const uint32_t _y,
+    const uint32_t _width, const uint32_t _height, const uint8_t *_data,
+    const std::size_t _step)
+{
+  if (!_data || _x >= this->width || _y >= this->height)
+    return 0u;
+
+  const uint32_t endX = std::min<uint64_t>(this->width,
+      static_cast<uint64_t>(_x) + _width);
+  const uint32_t endY = std::min<uint64_t>(this->height,
+      static_cast<uint64_t>(_y) + _height);
+
+  std::size_t changedCells{0u};
+  for (uint32_t y = _y; y < endY; ++y)
+  {
+    const uint8_t *src = _data + (y - _y) * _step;
+    uint8_t *dst = &this->cells[static_cast<std::size_t>(y) * this->width];
+    const std::size_t tileRow =
+        static_cast<std::size_t>(y / this->tileSize) * this->tilesX;
+
+    // Tile by tile, so unchanged parts of rows are skipped at once
+    for (uint32_t begin = _x; begin < endX;)
+    {
+      const uint32_t end = std::min(endX,
+          (begin / this->tileSize + 1) * this->tileSize);
+      const uint8_t *from = src + (begin - _x);
+      uint8_t *to = dst + begin;
+      const std::size_t count = end - begin;
+      if (std::memcmp(from, to, count) != 0)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+          changedCells += from[i] != to[i];
+        std::memcpy(to, from, count);
+        this->MarkChanged(tileRow + begin / this->tileSize);
+      }
+      begin = end;
+    }
+  }
+
+  return changedCells;
+}
+
+/////////////////////////////////////////////////
+uint32_t TiledMap::Width() const
+{
+  return this->width;
+}
+
+/////////////////////////////////////////////////
+uint32_t TiledMap::Height() const
+{
+  return this->height;
+}
+
+/////////////////////////////////////////////////
+uint32_t TiledMap::TileSize() const
+{
+  return this->tileSize;
+}
+
+/////////////////////////////////////////////////
+std::size_t TiledMap::TileCount() const
+{
+  return static_cast<std::size_t>(this->tilesX) * this->tilesY;
+}
+
+/////////////////////////////////////////////////
+uint64_t TiledMap::Generation() const
+{
+  return this->generation;
+}
+
+/////////////////////////////////////////////////
+uint8_t TiledMap::Cell(const uint32_t _x, const uint32_t _y) const
+{
+  if (_x >= this->width || _y >= this->height)
+    return kUnknown;
+  return this->cells[static_cast<std::size_t>(_y) * this->width + _x];
+}
+
+/////////////////////////////////////////////////
+std::size_t TiledMap::ChangedCount() const
+{
+  return this->changed.size() - this->changedBegin;
+}
+
+/////////////////////////////////////////////////
+std::size_t TiledMap::TakeChanged(const std::size_t _max,
+    std::vector<std::size_t> &_tiles)
+{
+  const std::size_t count = std::min(_max, this->ChangedCount());
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const std::size_t tile = this->changed[this->changedBegin++];
+    this->isChanged[tile] = false;
+    _tiles.push_back(tile);
+  }
+
+  // Drop taken tiles once they're half of the storage, which is reused
+  if (this->changedBegin * 2 >= this->changed.size())
+  {
+    this->changed.erase(this->changed.begin(),
+        this->changed.begin() + this->changedBegin);
+    this->changedBegin = 0u;
+  }
+
+  return count;
+}
+
+/////////////////////////////////////////////////
+void TiledMap::TileRuns(const std::size_t _tile,
+    std::vector<CellRun> &_runs) const
+{
+  _runs.clear();
+  if (_tile >= this->TileCount())
+    return;
+
+  const uint32_t beginX = (_tile % this->tilesX) * this->tileSize;
+  const uint32_t beginY = (_tile / this->tilesX) * this->tileSize;
+  const uint32_t endX = std::min(this->width, beginX + this->tileSize);
+  const uint32_t endY = std::min(this->height, beginY + this->tileSize);
+
+  for (uint32_t y = beginY; y < endY; ++y)
+  {
+    const uint8_t *row =
+        &this->cells[static_cast<std::size_t>(y) * this->width];
+    CellRun run{y, beginX, beginX, row[beginX]};
+    for (uint32_t x = beginX; x < endX; ++x)
+    {
+      if (row[x] != run.value)
+      {
+        run.end = x;
+        _runs.push_back(run);
+        run.begin = x;
+        run.value = row[x];
+      }
+    }
+    run.end = endX;
+    _runs.push_back(run);
+  }
+}
+
+/////////////////////////////////////////////////
+void TiledMap::MarkChanged(const std::size_t _tile)
+{
+  if (this->isChanged[_tile])
+    return;
+  this->isChanged[_tile] = true;
+  this->changed.push_back(_tile);
+}
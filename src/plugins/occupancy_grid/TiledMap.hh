@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_TILEDMAP_HH_
+#define IGNITION_GUI_PLUGINS_TILEDMAP_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Color of each cell value, as red, green, blue and alpha from 0
+  /// to 1. Cells with zero alpha aren't displayed.
+  using CellColors = std::array<std::array<float, 4>, 256>;
+
+  /// \brief Colors of an occupancy map: 0 is free and white, 100 is
+  /// occupied and black, 255 (-1 as a signed byte) is unknown and gray.
+  /// \return Colors.
+  CellColors MapColors();
+
+  /// \brief Colors of a costmap: 0 and unknown aren't displayed, costs go
+  /// from blue to red, 99 is cyan and 100 is magenta.
+  /// \return Colors.
+  CellColors CostmapColors();
+
+  /// \brief Cells of a row of a tile which have the same value
+  struct CellRun
+  {
+    /// \brief Row, in map cells
+    uint32_t row;
+
+    /// \brief First column, in map cells
+    uint32_t begin;
+
+    /// \brief Column after the last one, in map cells
+    uint32_t end;
+
+    /// \brief Value of the cells
+    uint8_t value;
+  };
+
+  /// \brief Keeps the cells of a grid map split in square tiles, and which
+  /// tiles have changed since they were last displayed.
+  ///
+  /// Cells are only marked as changed when their value does, so that
+  /// messages carrying a whole map which only changed locally only cause
+  /// the changed tiles to be displayed again. Changed tiles are taken in the
+  /// order they changed, a few at a time, so that the work of displaying
+  /// them can be spread over several frames.
+  ///
+  /// Not thread safe.
+  class TiledMap
+  {
+    /// \brief Constructor.
+    /// \param[in] _tileSize Width and height of tiles, in cells, at least 1.
+    public: explicit TiledMap(const uint32_t _tileSize);
+
+    /// \brief Change the size of the map. Cells become unknown and all
+    /// tiles are changed, unless the size is the same.
+    /// \param[in] _width Width, in cells.
+    /// \param[in] _height Height, in cells.
+    /// \return True if the size changed.
+    public: bool Resize(const uint32_t _width, const uint32_t _height);
+
+    /// \brief Write a rectangle of cells. Parts outside the map are ignored.
+    /// \param[in] _x First column.
+    /// \param[in] _y First row.
+    /// \param[in] _width Number of columns.
+    /// \param[in] _height Number of rows.
+    /// \param[in] _data Values, row major.
+    /// \param[in] _step Bytes from one row of values to the next.
+    /// \return Number of cells whose value changed.
+    public: std::size_t Update(const uint32_t _x, const uint32_t _y,
+        const uint32_t _width, const uint32_t _height, const uint8_t *_data,
+        const std::size_t _step);
+
+    /// \brief Get the width of the map.
+    /// \return Width, in cells.
+    public: uint32_t Width() const;
+
+    /// \brief Get the height of the map.
+    /// \return Height, in cells.
+    public: uint32_t Height() const;
+
+    /// \brief Get the width and height of tiles.
+    /// \return Size, in cells.
+    public: uint32_t TileSize() const;
+
+    /// \brief Get the number of tiles.
+    /// \return Number of tiles, row major.
+    public: std::size_t TileCount() const;
+
+    /// \brief Get the number of times the map was resized, so that users can
+    /// tell when tiles they display no longer exist.
+    /// \return Number of resizes.
+    public: uint64_t Generation() const;
+
+    /// \brief Get the value of a cell.
+    /// \param[in] _x Column.
+    /// \param[in] _y Row.
+    /// \return Value, 255 if out of the map.
+    public: uint8_t Cell(const uint32_t _x, const uint32_t _y) const;
+
+    /// \brief Get the number of tiles changed since they were last taken.
+    /// \return Number of tiles.
+    public: std::size_t ChangedCount() const;
+
+    /// \brief Take changed tiles, in the order they changed.
+    /// \param[in] _max Maximum number of tiles taken.
+    /// \param[out] _tiles Tiles taken are appended here.
+    /// \return Number of tiles taken.
+    public: std::size_t TakeChanged(const std::size_t _max,
+        std::vector<std::size_t> &_tiles);
+
+    /// \brief Get the runs of equal cells of a tile.
+    /// \param[in] _tile Tile.
+    /// \param[out] _runs Runs, replaced, row by row.
+    public: void TileRuns(const std::size_t _tile,
+        std::vector<CellRun> &_runs) const;
+
+    /// \brief Mark a tile as changed
+    /// \param[in] _tile Tile
+    private: void MarkChanged(const std::size_t _tile);
+
+    /// \brief Tile size
+    private: uint32_t tileSize;
+
+    /// \brief Width, in cells
+    private: uint32_t width{0u};
+
+    /// \brief Height, in cells
+    private: uint32_t height{0u};
+
+    /// \brief Tiles per row
+    private: uint32_t tilesX{0u};
+
+    /// \brief Tiles per column
+    private: uint32_t tilesY{0u};
+
+    /// \brief Number of resizes
+    private: uint64_t generation{0u};
+
+    /// \brief Cell values, row major
+    private: std::vector<uint8_t> cells;
+
+    /// \brief Whether each tile is in changed
+    private: std::vector<bool> isChanged;
+
+    /// \brief Changed tiles, in order, from changedBegin on
+    private: std::vector<std::size_t> changed;
+
+    /// \brief First changed tile which wasn't taken
+    private: std::size_t changedBegin{0u};
+  };
+}
+}
+}
+
+#endif
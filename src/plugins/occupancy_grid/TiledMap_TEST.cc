@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "TiledMap.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+TEST(TiledMapTest, ChangedTiles)
+{
+  // 3x2 tiles, the last column and row partial
+  TiledMap map(4);
+  EXPECT_TRUE(map.Resize(10, 6));
+  EXPECT_FALSE(map.Resize(10, 6));
+  EXPECT_EQ(6u, map.TileCount());
+  EXPECT_EQ(6u, map.ChangedCount());
+  EXPECT_EQ(255u, map.Cell(0, 0));
+
+  std::vector<std::size_t> tiles;
+  EXPECT_EQ(4u, map.TakeChanged(4, tiles));
+  EXPECT_EQ(2u, map.TakeChanged(4, tiles));
+  EXPECT_EQ((std::vector<std::size_t>{0, 1, 2, 3, 4, 5}), tiles);
+  EXPECT_EQ(0u, map.ChangedCount());
+
+  // A whole map which only changed in the last tile
+  std::vector<uint8_t> cells(60, 255);
+  cells[5 * 10 + 9] = 100;
+  EXPECT_EQ(1u, map.Update(0, 0, 10, 6, cells.data(), 10));
+  EXPECT_EQ(100u, map.Cell(9, 5));
+  tiles.clear();
+  EXPECT_EQ(1u, map.TakeChanged(10, tiles));
+  EXPECT_EQ(5u, tiles[0]);
+
+  // The same map changes nothing
+  EXPECT_EQ(0u, map.Update(0, 0, 10, 6, cells.data(), 10));
+  EXPECT_EQ(0u, map.ChangedCount());
+
+  // A patch across tiles, clipped to the map, with padded rows
+  std::vector<uint8_t> patch{0, 0, 0, 9, 0, 0, 0, 9};
+  EXPECT_EQ(6u, map.Update(3, 4, 3, 4, patch.data(), 4));
+  EXPECT_EQ(0u, map.Cell(5, 5));
+  EXPECT_EQ(255u, map.Cell(6, 5));
+  tiles.clear();
+  map.TakeChanged(10, tiles);
+  EXPECT_EQ((std::vector<std::size_t>{3, 4}), tiles);
+
+  // Out of the map
+  EXPECT_EQ(0u, map.Update(10, 0, 1, 1, patch.data(), 1));
+  EXPECT_EQ(255u, map.Cell(10, 0));
+
+  // Resizing changes everything
+  EXPECT_TRUE(map.Resize(4, 4));
+  EXPECT_EQ(2u, map.Generation());
+  EXPECT_EQ(1u, map.ChangedCount());
+}
+
+/////////////////////////////////////////////////
+TEST(TiledMapTest, Runs)
+{
+  TiledMap map(4);
+  map.Resize(6, 2);
+  std::vector<uint8_t> cells{0, 0, 100, 100, 0, 0,
+                             0, 0, 0, 0, 0, 0};
+  map.Update(0, 0, 6, 2, cells.data(), 6);
+
+  std::vector<CellRun> runs;
+  map.TileRuns(0, runs);
+  ASSERT_EQ(3u, runs.size());
+  EXPECT_EQ(0u, runs[0].begin);
+  EXPECT_EQ(2u, runs[0].end);
+  EXPECT_EQ(100u, runs[1].value);
+  EXPECT_EQ(1u, runs[2].row);
+  EXPECT_EQ(4u, runs[2].end);
+
+  // Partial tile
+  map.TileRuns(1, runs);
+  ASSERT_EQ(2u, runs.size());
+  EXPECT_EQ(4u, runs[0].begin);
+  EXPECT_EQ(6u, runs[0].end);
+
+  map.TileRuns(2, runs);
+  EXPECT_TRUE(runs.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(TiledMapTest, Colors)
+{
+  auto map = MapColors();
+  EXPECT_FLOAT_EQ(1.0f, map[0][0]);
+  EXPECT_FLOAT_EQ(0.0f, map[100][0]);
+  EXPECT_FLOAT_EQ(1.0f, map[255][3]);
+
+  auto costmap = CostmapColors();
+  EXPECT_FLOAT_EQ(0.0f, costmap[0][3]);
+  EXPECT_FLOAT_EQ(0.0f, costmap[255][3]);
+  EXPECT_FLOAT_EQ(1.0f, costmap[1][2]);
+  EXPECT_FLOAT_EQ(1.0f, costmap[98][0]);
+}
@@ -0,0 +1,509 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Color.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/rendering.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/SceneMutationQueue.hh"
+#include "PointCloud.hh"
+#include "VoxelGrid.hh"
+
+// Default leaf size
+static const double kDefaultVoxelSize{0.05};
+
+// Default maximum number of points
+static const std::size_t kDefaultMaxPoints{200000u};
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Scene objects displaying a cloud. Shared with the scene
+  /// mutations, which outlive the plugin, and only used on the render
+  /// thread once the plugin is loaded.
+  struct CloudVisual
+  {
+    /// \brief Render engine name
+    std::string engineName{"ogre"};
+
+    /// \brief Scene name
+    std::string sceneName{"scene"};
+
+    /// \brief Pose of the cloud's frame
+    math::Pose3d pose{math::Pose3d::Zero};
+
+    /// \brief Color of points without colors
+    math::Color color{math::Color::White};
+
+    /// \brief Visual holding the marker, created with the first cloud
+    rendering::VisualPtr visual;
+
+    /// \brief Marker whose points are refilled with each cloud
+    rendering::MarkerPtr marker;
+
+    /// \brief Marker material
+    rendering::MaterialPtr material;
+  };
+
+  class PointCloudPrivate
+  {
+    /// \brief Topic to subscribe to while the plugin isn't suspended
+    public: std::string topic;
+
+    /// \brief Node for communication
+    public: transport::Node node;
+
+    /// \brief Protects the message and the statistics
+    public: std::mutex mutex;
+
+    /// \brief Latest cloud which hasn't been processed yet
+    public: msgs::PointCloudPacked cloudMsg;
+
+    /// \brief True if cloudMsg hasn't been processed yet
+    public: bool newMsg{false};
+
+    /// \brief Time at which cloudMsg was received
+    public: std::chrono::steady_clock::time_point received;
+
+    /// \brief True while processing is queued or running on a worker
+    public: bool processing{false};
+
+    /// \brief Downsamples clouds, only used by the processing task
+    public: std::unique_ptr<VoxelGrid> grid;
+
+    /// \brief Packed points, reused once the scene is done with them.
+    /// Only used by the processing task.
+    public: std::vector<std::shared_ptr<PackedPoints>> buffers;
+
+    /// \brief Scene objects, shared with scene mutations
+    public: std::shared_ptr<CloudVisual> cloud{
+        std::make_shared<CloudVisual>()};
+
+    /// \brief Key of this plugin's mutations, so a cloud waiting to be
+    /// displayed is replaced by newer ones
+    public: std::string mutationKey;
+
+    /// \brief Statistics of the latest processed cloud
+    public: QString stats{"No clouds received"};
+
+    /// \brief Memory used by the grid and buffers of the latest cloud
+    public: uint64_t memory{0u};
+  };
+}
+}
+}
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+/// \brief Find where positions and colors are in a cloud's points
+/// \param[in] _msg Cloud
+/// \param[out] _layout Layout
+/// \return False if the cloud has no usable positions
+static bool pointLayout(const msgs::PointCloudPacked &_msg,
+    PointLayout &_layout)
+{
+  _layout = PointLayout();
+  _layout.step = _msg.point_step();
+
+  bool found[3]{false, false, false};
+  for (const auto &field : _msg.field())
+  {
+    if (field.offset() + 4u > _msg.point_step())
+      continue;
+
+    const auto &name = field.name();
+    if (name == "x" || name == "y" || name == "z")
+    {
+      if (field.datatype() != msgs::PointCloudPacked::Field::FLOAT32)
+        continue;
+      int axis = name[0] - 'x';
+      found[axis] = true;
+      (axis == 0 ? _layout.x : axis == 1 ? _layout.y : _layout.z) =
+          field.offset();
+    }
+    else if (name == "rgb" || name == "rgba")
+    {
+      _layout.color = static_cast<int>(field.offset());
+      _layout.hasAlpha = name == "rgba";
+    }
+  }
+
+  return found[0] && found[1] && found[2];
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the scene a cloud is displayed in. Render thread only.
+/// \param[in] _cloud Cloud
+/// \return Scene, null if it doesn't exist yet
+static rendering::ScenePtr cloudScene(const CloudVisual &_cloud)
+{
+  if (!rendering::isEngineLoaded(_cloud.engineName))
+    return nullptr;
+
+  auto engine = rendering::engine(_cloud.engineName);
+  if (!engine)
+    return nullptr;
+
+  return engine->SceneByName(_cloud.sceneName);
+}
+
+/////////////////////////////////////////////////
+/// \brief Refill a cloud's marker. Render thread only.
+/// \param[in] _cloud Cloud
+/// \param[in] _points Points
+static void updateCloud(CloudVisual &_cloud, const PackedPoints &_points)
+{
+  auto scene = cloudScene(_cloud);
+  if (!scene)
+    return;
+
+  // Created once, then reused for every cloud
+  if (!_cloud.visual)
+  {
+    _cloud.material = scene->CreateMaterial();
+    _cloud.material->SetAmbient(_cloud.color);
+    _cloud.material->SetDiffuse(_cloud.color);
+    _cloud.material->SetEmissive(_cloud.color);
+
+    _cloud.marker = scene->CreateMarker();
+    _cloud.marker->SetType(rendering::MarkerType::MT_POINTS);
+
+    _cloud.visual = scene->CreateVisual();
+    _cloud.visual->AddGeometry(_cloud.marker);
+    _cloud.visual->SetMaterial(_cloud.material);
+    _cloud.visual->SetLocalPose(_cloud.pose);
+    scene->RootVisual()->AddChild(_cloud.visual);
+  }
+
+  const bool hasColor = !_points.colors.empty();
+  const std::size_t count = _points.positions.size() / 3;
+
+  _cloud.marker->ClearPoints();
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const float *position = &_points.positions[i * 3];
+    math::Color color = _cloud.color;
+    if (hasColor)
+    {
+      const float *rgba = &_points.colors[i * 4];
+      color.Set(rgba[0], rgba[1], rgba[2], rgba[3]);
+    }
+    _cloud.marker->AddPoint(position[0], position[1], position[2], color);
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Remove a cloud from its scene. Render thread only.
+/// \param[in] _cloud Cloud
+static void destroyCloud(CloudVisual &_cloud)
+{
+  if (!_cloud.visual)
+    return;
+
+  if (auto scene = cloudScene(_cloud))
+  {
+    scene->DestroyVisual(_cloud.visual);
+    scene->DestroyMaterial(_cloud.material);
+  }
+
+  _cloud.visual.reset();
+  _cloud.marker.reset();
+  _cloud.material.reset();
+}
+
+/////////////////////////////////////////////////
+PointCloud::PointCloud()
+  : Plugin(), dataPtr(new PointCloudPrivate)
+{
+  std::ostringstream key;
+  key << "PointCloud" << this;
+  this->dataPtr->mutationKey = key.str();
+}
+
+/////////////////////////////////////////////////
+PointCloud::~PointCloud()
+{
+  for (auto sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
+
+  // Before removing the cloud, so processing doesn't post it again
+  if (App() && App()->Workers())
+    App()->Workers()->Cancel(this);
+
+  // Replaces a cloud which hasn't been displayed yet
+  if (App() && App()->SceneMutations())
+  {
+    auto cloud = this->dataPtr->cloud;
+    App()->SceneMutations()->Post(cloud->sceneName,
+        [cloud]() {destroyCloud(*cloud);}, this->dataPtr->mutationKey);
+  }
+}
+
+/////////////////////////////////////////////////
+void PointCloud::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
+{
+  // Default name in case user didn't define one
+  if (this->title.empty())
+    this->title = "Point cloud";
+
+  auto &cloud = *this->dataPtr->cloud;
+  double voxelSize{kDefaultVoxelSize};
+  auto maxPoints{kDefaultMaxPoints};
+
+  // Read configuration
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("topic"))
+      this->dataPtr->topic = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("engine"))
+      cloud.engineName = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("scene"))
+      cloud.sceneName = elem->GetText() ? elem->GetText() : "";
+
+    if (auto elem = _pluginElem->FirstChildElement("voxel_size"))
+      elem->QueryDoubleText(&voxelSize);
+
+    if (auto elem = _pluginElem->FirstChildElement("max_points"))
+    {
+      unsigned int value{0u};
+      if (elem->QueryUnsignedText(&value) == tinyxml2::XML_SUCCESS)
+        maxPoints = value;
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("color"))
+    {
+      std::stringstream colorStr(elem->GetText() ? elem->GetText() : "");
+      colorStr >> cloud.color;
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("pose"))
+    {
+      std::stringstream poseStr(elem->GetText() ? elem->GetText() : "");
+      poseStr >> cloud.pose;
+    }
+  }
+
+  if (voxelSize < 0.0)
+  {
+    ignwarn << "Negative <voxel_size> [" << voxelSize << "], sampling "
+            << "clouds instead." << std::endl;
+    voxelSize = 0.0;
+  }
+
+  this->dataPtr->grid = std::make_unique<VoxelGrid>(voxelSize, maxPoints);
+
+  if (this->dataPtr->topic.empty())
+  {
+    ignerr << "Missing <topic>, no clouds will be displayed." << std::endl;
+    return;
+  }
+
+  this->Resume();
+}
+
+/////////////////////////////////////////////////
+void PointCloud::OnCloudMsg(const msgs::PointCloudPacked &_msg)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->cloudMsg = _msg;
+    this->dataPtr->newMsg = true;
+    this->dataPtr->received = std::chrono::steady_clock::now();
+
+    // Processing in flight will pick up the latest cloud
+    if (this->dataPtr->processing)
+      return;
+    this->dataPtr->processing = true;
+  }
+
+  // Downsample off the transport and GUI threads
+  this->RunInBackground([this]() {this->ProcessCloud();},
+      [this]() {this->OnCloudProcessed();});
+}
+
+/////////////////////////////////////////////////
+void PointCloud::ProcessCloud()
+{
+  msgs::PointCloudPacked msg;
+  std::chrono::steady_clock::time_point received;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    msg.Swap(&this->dataPtr->cloudMsg);
+    received = this->dataPtr->received;
+    this->dataPtr->newMsg = false;
+  }
+
+  // A buffer the scene is done with. At most three are in use: one being
+  // displayed, one waiting to be displayed and one being filled.
+  std::shared_ptr<PackedPoints> points;
+  for (auto &buffer : this->dataPtr->buffers)
+  {
+    if (buffer.use_count() == 1)
+    {
+      points = buffer;
+      break;
+    }
+  }
+  if (!points)
+  {
+    points = std::make_shared<PackedPoints>();
+    this->dataPtr->buffers.push_back(points);
+  }
+
+  PointLayout layout;
+  const std::size_t count =
+      static_cast<std::size_t>(msg.width()) * msg.height();
+  const bool bigEndian = QSysInfo::ByteOrder == QSysInfo::BigEndian;
+  if (!pointLayout(msg, layout))
+  {
+    ignwarn << "Point cloud without FLOAT32 x, y and z fields, ignoring."
+            << std::endl;
+  }
+  else if (msg.is_bigendian() != bigEndian)
+  {
+    ignwarn << "Point cloud with foreign byte order, ignoring." << std::endl;
+  }
+  else if (msg.height() > 1u &&
+      msg.row_step() != msg.width() * msg.point_step())
+  {
+    ignwarn << "Point cloud with padded rows, ignoring." << std::endl;
+  }
+  else if (msg.data().size() < count * msg.point_step())
+  {
+    ignwarn << "Point cloud of [" << count << "] points only has ["
+            << msg.data().size() << "] bytes, ignoring." << std::endl;
+  }
+  else
+  {
+    auto start = std::chrono::steady_clock::now();
+    this->dataPtr->grid->Filter(
+        reinterpret_cast<const uint8_t *>(msg.data().data()), count, layout,
+        *points);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    auto cloud = this->dataPtr->cloud;
+    if (App() && App()->SceneMutations())
+    {
+      App()->SceneMutations()->Post(cloud->sceneName,
+          [cloud, points]() {updateCloud(*cloud, *points);},
+          this->dataPtr->mutationKey);
+    }
+    this->RecordLatency("receive_to_post",
+        std::chrono::steady_clock::now() - received);
+
+    std::ostringstream stats;
+    stats << points->input << " points, " << points->positions.size() / 3
+          << " displayed\n";
+    if (points->leafSize > 0.0)
+      stats << "Voxels of " << points->leafSize << " m";
+    else
+      stats << "Sampled";
+    stats << " in " << std::chrono::duration_cast<std::chrono::milliseconds>(
+        elapsed).count() << " ms";
+    if (points->skipped > 0u)
+      stats << "\n" << points->skipped << " invalid points";
+
+    uint64_t memory = this->dataPtr->grid->MemoryUsage();
+    for (const auto &buffer : this->dataPtr->buffers)
+    {
+      memory += (buffer->positions.capacity() + buffer->colors.capacity()) *
+          sizeof(float);
+    }
+
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stats = QString::fromStdString(stats.str());
+    this->dataPtr->memory = memory;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  // Clouds which arrived during processing were coalesced into the latest
+  // one, process it next.
+  if (this->dataPtr->newMsg)
+  {
+    this->RunInBackground([this]() {this->ProcessCloud();},
+        [this]() {this->OnCloudProcessed();});
+  }
+  else
+  {
+    this->dataPtr->processing = false;
+  }
+}
+
+/////////////////////////////////////////////////
+void PointCloud::OnCloudProcessed()
+{
+  uint64_t memory;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    memory = this->dataPtr->memory;
+  }
+  this->SetMemoryUsage("points", memory);
+  this->StatsChanged();
+}
+
+/////////////////////////////////////////////////
+QString PointCloud::Stats() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->stats;
+}
+
+/////////////////////////////////////////////////
+void PointCloud::Suspend()
+{
+  // Stop receiving and processing clouds nobody can see
+  for (auto sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
+}
+
+/////////////////////////////////////////////////
+void PointCloud::Resume()
+{
+  auto topic = this->dataPtr->topic;
+  if (topic.empty() || this->Suspended())
+    return;
+
+  if (!this->dataPtr->node.Subscribe(topic, &PointCloud::OnCloudMsg, this,
+      this->SubscribeOptions(topic)))
+  {
+    ignerr << "Unable to subscribe to topic [" << topic << "]" << std::endl;
+  }
+}
+
+// Register this plugin
+IGNITION_ADD_PLUGIN(ignition::gui::plugins::PointCloud,
+                    ignition::gui::Plugin)
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_POINTCLOUD_HH_
+#define IGNITION_GUI_PLUGINS_POINTCLOUD_HH_
+
+#include <memory>
+#include <ignition/msgs.hh>
+
+#include "ignition/gui/Plugin.hh"
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  class PointCloudPrivate;
+
+  /// \brief Display point clouds coming through an Ignition transport topic
+  /// in a 3D scene, such as the one rendered by Scene3D.
+  ///
+  /// Clouds are downsampled on a voxel grid and packed on a worker thread,
+  /// so that the number of points sent to the scene, and the memory used,
+  /// stay bounded however large the clouds are. Clouds arriving while the
+  /// previous one is being processed are coalesced, only the latest one is
+  /// displayed. The points are handed to the scene's render thread as a
+  /// scene mutation, which refills the same marker every time.
+  ///
+  /// Positions must be `x`, `y` and `z` FLOAT32 fields. Colors are read from
+  /// an `rgb` or `rgba` field if there's one.
+  ///
+  /// ## Configuration
+  ///
+  /// \<topic\> : Topic to receive ignition::msgs::PointCloudPacked messages.
+  /// \<engine\> : Name of the render engine, defaults to "ogre".
+  /// \<scene\> : Name of the scene, defaults to "scene".
+  /// \<voxel_size\> : Leaf size of the voxel grid in meters, defaults to
+  ///                  0.05. Zero samples clouds at a regular stride instead.
+  /// \<max_points\> : Maximum number of points displayed, defaults to
+  ///                  200000. The voxels grow while clouds have more.
+  /// \<color\> : Color of clouds without colors, defaults to white.
+  /// \<pose\> : Pose of the cloud's frame in the scene.
+  class PointCloud : public Plugin
+  {
+    Q_OBJECT
+
+    /// \brief Statistics about the latest cloud
+    Q_PROPERTY(
+      QString stats
+      READ Stats
+      NOTIFY StatsChanged
+    )
+
+    /// \brief Constructor
+    public: PointCloud();
+
+    /// \brief Destructor
+    public: virtual ~PointCloud();
+
+    // Documentation inherited
+    public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem);
+
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
+    /// \brief Get statistics about the latest cloud.
+    /// \return Human readable statistics.
+    public: Q_INVOKABLE QString Stats() const;
+
+    /// \brief Notify that statistics have changed
+    signals: void StatsChanged();
+
+    /// \brief Subscriber callback when a new cloud is received
+    /// \param[in] _msg New cloud
+    private: void OnCloudMsg(const msgs::PointCloudPacked &_msg);
+
+    /// \brief Downsample the latest cloud and post it to the scene. Runs on
+    /// a worker thread.
+    private: void ProcessCloud();
+
+    /// \brief Update statistics on the GUI thread once a cloud is posted.
+    private: void OnCloudProcessed();
+
+    /// \internal
+    /// \brief Pointer to private data.
+    private: std::unique_ptr<PointCloudPrivate> dataPtr;
+  };
+}
+}
+}
+
+#endif
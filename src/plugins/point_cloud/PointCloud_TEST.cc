@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/transport/Node.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Plugin.hh"
+#include "ignition/gui/MainWindow.hh"
+#include "PointCloud.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+/// \brief Load a point cloud plugin and show its window
+/// \param[in] _app Application
+/// \param[in] _config Plugin configuration
+/// \return The plugin, null on failure
+plugins::PointCloud *loadPointCloud(Application &_app,
+    const std::string &_config)
+{
+  _app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  tinyxml2::XMLDocument pluginDoc;
+  pluginDoc.Parse(("<plugin filename=\"PointCloud\">" + _config +
+      "</plugin>").c_str());
+  EXPECT_TRUE(_app.LoadPlugin("PointCloud",
+      pluginDoc.FirstChildElement("plugin")));
+
+  auto win = _app.findChild<MainWindow *>();
+  if (!win)
+    return nullptr;
+
+  // Show, but don't exec, so we don't block. Hidden plugins are suspended.
+  win->QuickWindow()->show();
+
+  return win->findChild<plugins::PointCloud *>();
+}
+
+/////////////////////////////////////////////////
+/// \brief Make a cloud of points along the x axis
+/// \param[in] _count Number of points
+/// \return Cloud
+msgs::PointCloudPacked makeCloud(const unsigned int _count)
+{
+  msgs::PointCloudPacked msg;
+  for (auto name : {"x", "y", "z"})
+  {
+    auto field = msg.add_field();
+    field->set_name(name);
+    field->set_offset(static_cast<unsigned int>(4 * (name[0] - 'x')));
+    field->set_datatype(msgs::PointCloudPacked::Field::FLOAT32);
+    field->set_count(1);
+  }
+  msg.set_width(_count);
+  msg.set_height(1);
+  msg.set_point_step(12);
+  msg.set_row_step(12 * _count);
+  msg.set_is_bigendian(QSysInfo::ByteOrder == QSysInfo::BigEndian);
+
+  std::vector<float> points(3 * _count, 0.0f);
+  for (unsigned int i = 0; i < _count; ++i)
+    points[3 * i] = static_cast<float>(i);
+  msg.set_data(points.data(), points.size() * sizeof(float));
+  return msg;
+}
+
+/////////////////////////////////////////////////
+/// \brief Publish a cloud until the plugin's statistics change, for up to
+/// 2 s
+/// \param[in] _plugin Plugin
+/// \param[in] _pub Publisher
+/// \param[in] _msg Cloud
+/// \return The new statistics, or the old ones if they didn't change
+QString publishUntilStats(plugins::PointCloud *_plugin,
+    transport::Node::Publisher &_pub, const msgs::PointCloudPacked &_msg)
+{
+  auto stats = _plugin->Stats();
+  for (int sleep = 0; sleep < 20 && _plugin->Stats() == stats; ++sleep)
+  {
+    _pub.Publish(_msg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    QCoreApplication::processEvents();
+  }
+  return _plugin->Stats();
+}
+
+/////////////////////////////////////////////////
+TEST(PointCloudTest, Load)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  EXPECT_TRUE(app.LoadPlugin("PointCloud"));
+
+  // Get main window
+  auto win = app.findChild<MainWindow *>();
+  ASSERT_NE(nullptr, win);
+
+  // Get plugin
+  auto plugins = win->findChildren<Plugin *>();
+  EXPECT_EQ(plugins.size(), 1);
+
+  auto plugin = plugins[0];
+  EXPECT_EQ(plugin->Title(), "Point cloud");
+
+  // Cleanup
+  plugins.clear();
+}
+
+/////////////////////////////////////////////////
+TEST(PointCloudTest, ReceiveCloud)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadPointCloud(app,
+      "<topic>/point_cloud_test</topic>"
+      "<voxel_size>0.5</voxel_size>");
+  ASSERT_NE(nullptr, plugin);
+  EXPECT_FALSE(plugin->Suspended());
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::PointCloudPacked>("/point_cloud_test");
+
+  // Points 1 m apart each get a voxel
+  auto stats = publishUntilStats(plugin, pub, makeCloud(10u));
+  EXPECT_TRUE(stats.startsWith("10 points, 10 displayed\nVoxels of 0.5 m"))
+      << stats.toStdString();
+  EXPECT_LT(0u, plugin->MemoryUsage());
+
+  // Hiding the card unsubscribes
+  plugin->CardItem()->setVisible(false);
+  EXPECT_TRUE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeCloud(20u));
+  EXPECT_TRUE(stats.startsWith("10 points")) << stats.toStdString();
+
+  // Showing it subscribes again
+  plugin->CardItem()->setVisible(true);
+  EXPECT_FALSE(plugin->Suspended());
+  stats = publishUntilStats(plugin, pub, makeCloud(20u));
+  EXPECT_TRUE(stats.startsWith("20 points")) << stats.toStdString();
+}
+
+/////////////////////////////////////////////////
+TEST(PointCloudTest, NegativeVoxelSize)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadPointCloud(app,
+      "<topic>/point_cloud_negative</topic>"
+      "<voxel_size>-1</voxel_size>");
+  ASSERT_NE(nullptr, plugin);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::PointCloudPacked>("/point_cloud_negative");
+
+  // Clouds are sampled instead
+  auto stats = publishUntilStats(plugin, pub, makeCloud(10u));
+  EXPECT_TRUE(stats.startsWith("10 points, 10 displayed\nSampled"))
+      << stats.toStdString();
+}
+
+/////////////////////////////////////////////////
+TEST(PointCloudTest, MissingTopic)
+{
+  common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+  auto plugin = loadPointCloud(app, "<voxel_size>0.5</voxel_size>");
+  ASSERT_NE(nullptr, plugin);
+
+  // Nothing to subscribe to, even once resumed
+  plugin->CardItem()->setVisible(false);
+  plugin->CardItem()->setVisible(true);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::PointCloudPacked>("/point_cloud");
+  EXPECT_EQ("No clouds received",
+      publishUntilStats(plugin, pub, makeCloud(10u)).toStdString());
+}
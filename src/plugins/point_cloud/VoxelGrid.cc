@@ -0,0 +1,293 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "VoxelGrid.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/// \brief Bits per voxel coordinate in a key
+static const int kKeyBits{21};
+
+/// \brief Added to voxel coordinates so they're positive in a key
+static const int64_t kKeyOffset{int64_t{1} << (kKeyBits - 1)};
+
+/// \brief Factor by which the effective leaf size grows while clouds
+/// overflow, and shrinks back once they're sparse
+static const double kLeafGrowth{1.5};
+
+/////////////////////////////////////////////////
+/// \brief Read a float from a packed point, which may not be aligned
+/// \param[in] _point Start of the point
+/// \param[in] _offset Offset of the float
+/// \return Value
+static inline float readFloat(const uint8_t *_point, const std::size_t _offset)
+{
+  float value;
+  std::memcpy(&value, _point + _offset, sizeof(value));
+  return value;
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a color from a packed point
+/// \param[in] _point Start of the point
+/// \param[in] _layout Layout, which must have a color
+/// \param[out] _color Red, green, blue and alpha, from 0 to 255
+static inline void readColor(const uint8_t *_point,
+    const PointLayout &_layout, float _color[4])
+{
+  uint32_t value;
+  std::memcpy(&value, _point + _layout.color, sizeof(value));
+  _color[0] = static_cast<float>((value >> 16) & 0xFF);
+  _color[1] = static_cast<float>((value >> 8) & 0xFF);
+  _color[2] = static_cast<float>(value & 0xFF);
+  _color[3] = _layout.hasAlpha ? static_cast<float>(value >> 24) : 255.0f;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the voxel coordinate of a position
+/// \param[in] _value Position
+/// \param[in] _inverseLeaf One over the leaf size
+/// \param[out] _coord Coordinate, offset to be positive
+/// \return False if the coordinate doesn't fit in a key
+static inline bool voxelCoord(const float _value, const double _inverseLeaf,
+    uint64_t &_coord)
+{
+  double coord = std::floor(_value * _inverseLeaf);
+  if (coord < -kKeyOffset || coord >= kKeyOffset)
+    return false;
+
+  _coord = static_cast<uint64_t>(static_cast<int64_t>(coord) + kKeyOffset);
+  return true;
+}
+
+/////////////////////////////////////////////////
+VoxelGrid::VoxelGrid(const double _leafSize, const std::size_t _maxPoints)
+  : leafSize(std::max(0.0, _leafSize)),
+    effectiveLeafSize(std::max(0.0, _leafSize)),
+    maxPoints(std::min<std::size_t>(_maxPoints,
+        std::numeric_limits<uint32_t>::max() / 2))
+{
+}
+
+/////////////////////////////////////////////////
+void VoxelGrid::Filter(const uint8_t *_data, const std::size_t _count,
+    const PointLayout &_layout, PackedPoints &_out)
+{
+  _out.positions.clear();
+  _out.colors.clear();
+  _out.input = _count;
+  _out.skipped = 0u;
+  _out.dropped = 0u;
+  _out.leafSize = this->effectiveLeafSize;
+
+  if (!_data || _count == 0u || this->maxPoints == 0u)
+    return;
+
+  if (this->leafSize <= 0.0)
+  {
+    this->Sample(_data, _count, _layout, _out);
+    return;
+  }
+
+  // Allocated once, at least twice as many slots as voxels keeps probes
+  // short
+  if (this->slots.empty())
+  {
+    std::size_t size{16u};
+    while (size < this->maxPoints * 2)
+      size <<= 1;
+    this->slots.assign(size, Slot{0u, 0u, 0u});
+    this->voxels.reserve(this->maxPoints);
+  }
+
+  // Empty the table without touching it
+  if (++this->generation == 0u)
+  {
+    for (auto &slot : this->slots)
+      slot.generation = 0u;
+    this->generation = 1u;
+  }
+  this->voxels.clear();
+
+  const std::size_t mask = this->slots.size() - 1;
+  int shift{64};
+  for (std::size_t size = this->slots.size(); size > 1u; size >>= 1)
+    --shift;
+
+  const double inverseLeaf = 1.0 / this->effectiveLeafSize;
+  const bool hasColor = _layout.color >= 0;
+  float color[4]{0.0f, 0.0f, 0.0f, 255.0f};
+
+  const uint8_t *point = _data;
+  for (std::size_t i = 0; i < _count; ++i, point += _layout.step)
+  {
+    float x = readFloat(point, _layout.x);
+    float y = readFloat(point, _layout.y);
+    float z = readFloat(point, _layout.z);
+
+    uint64_t vx, vy, vz;
+    if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z) ||
+        !voxelCoord(x, inverseLeaf, vx) || !voxelCoord(y, inverseLeaf, vy) ||
+        !voxelCoord(z, inverseLeaf, vz))
+    {
+      ++_out.skipped;
+      continue;
+    }
+
+    if (hasColor)
+      readColor(point, _layout, color);
+
+    const uint64_t key = (vx << (2 * kKeyBits)) | (vy << kKeyBits) | vz;
+    std::size_t index = (key * 0x9E3779B97F4A7C15ull) >> shift;
+    while (true)
+    {
+      auto &slot = this->slots[index];
+      if (slot.generation != this->generation)
+      {
+        if (this->voxels.size() >= this->maxPoints)
+        {
+          ++_out.dropped;
+          break;
+        }
+
+        slot.key = key;
+        slot.generation = this->generation;
+        slot.voxel = static_cast<uint32_t>(this->voxels.size());
+        this->voxels.push_back(Voxel{{x, y, z},
+            {color[0], color[1], color[2], color[3]}, 1u});
+        break;
+      }
+
+      if (slot.key == key)
+      {
+        auto &voxel = this->voxels[slot.voxel];
+        voxel.sum[0] += x;
+        voxel.sum[1] += y;
+        voxel.sum[2] += z;
+        for (int c = 0; c < 4; ++c)
+          voxel.color[c] += color[c];
+        ++voxel.count;
+        break;
+      }
+
+      index = (index + 1) & mask;
+    }
+  }
+
+  // Centroids and mean colors
+  _out.positions.resize(this->voxels.size() * 3);
+  if (hasColor)
+    _out.colors.resize(this->voxels.size() * 4);
+  for (std::size_t v = 0; v < this->voxels.size(); ++v)
+  {
+    const auto &voxel = this->voxels[v];
+    const double inverseCount = 1.0 / voxel.count;
+    for (int c = 0; c < 3; ++c)
+      _out.positions[v * 3 + c] = static_cast<float>(voxel.sum[c] *
+          inverseCount);
+
+    if (!hasColor)
+      continue;
+    for (int c = 0; c < 4; ++c)
+    {
+      _out.colors[v * 4 + c] = static_cast<float>(voxel.color[c] *
+          inverseCount / 255.0);
+    }
+  }
+
+  // Coarser until clouds fit, finer again once they're sparse
+  if (_out.dropped > 0u)
+  {
+    this->effectiveLeafSize *= kLeafGrowth;
+  }
+  else if (this->effectiveLeafSize > this->leafSize &&
+      this->voxels.size() < this->maxPoints / 4)
+  {
+    this->effectiveLeafSize = std::max(this->leafSize,
+        this->effectiveLeafSize / kLeafGrowth);
+  }
+}
+
+/////////////////////////////////////////////////
+void VoxelGrid::Sample(const uint8_t *_data, const std::size_t _count,
+    const PointLayout &_layout, PackedPoints &_out) const
+{
+  const std::size_t stride = (_count + this->maxPoints - 1) / this->maxPoints;
+  const std::size_t sampled = (_count + stride - 1) / stride;
+  const bool hasColor = _layout.color >= 0;
+
+  _out.positions.reserve(sampled * 3);
+  if (hasColor)
+    _out.colors.reserve(sampled * 4);
+  _out.dropped = _count - sampled;
+
+  float color[4];
+  for (std::size_t i = 0; i < _count; i += stride)
+  {
+    const uint8_t *point = _data + i * _layout.step;
+    float x = readFloat(point, _layout.x);
+    float y = readFloat(point, _layout.y);
+    float z = readFloat(point, _layout.z);
+    if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z))
+    {
+      ++_out.skipped;
+      continue;
+    }
+
+    _out.positions.push_back(x);
+    _out.positions.push_back(y);
+    _out.positions.push_back(z);
+
+    if (!hasColor)
+      continue;
+    readColor(point, _layout, color);
+    for (int c = 0; c < 4; ++c)
+      _out.colors.push_back(color[c] / 255.0f);
+  }
+}
+
+/////////////////////////////////////////////////
+double VoxelGrid::LeafSize() const
+{
+  return this->leafSize;
+}
+
+/////////////////////////////////////////////////
+double VoxelGrid::EffectiveLeafSize() const
+{
+  return this->effectiveLeafSize;
+}
+
+/////////////////////////////////////////////////
+std::size_t VoxelGrid::MaxPoints() const
+{
+  return this->maxPoints;
+}
+
+/////////////////////////////////////////////////
+std::size_t VoxelGrid::MemoryUsage() const
+{
+  return this->slots.capacity() * sizeof(Slot) +
+      this->voxels.capacity() * sizeof(Voxel);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_VOXELGRID_HH_
+#define IGNITION_GUI_PLUGINS_VOXELGRID_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Where each attribute is found within the points of a packed
+  /// buffer, such as the data of a PointCloudPacked message. Positions are
+  /// 32 bit floats. Colors are 32 bit words holding 0xAARRGGBB, where alpha
+  /// is ignored unless hasAlpha is set.
+  struct PointLayout
+  {
+    /// \brief Bytes from one point to the next
+    std::size_t step{0u};
+
+    /// \brief Offset of x
+    std::size_t x{0u};
+
+    /// \brief Offset of y
+    std::size_t y{4u};
+
+    /// \brief Offset of z
+    std::size_t z{8u};
+
+    /// \brief Offset of the color, negative if there's none
+    int color{-1};
+
+    /// \brief True if the color's top byte is alpha
+    bool hasAlpha{false};
+  };
+
+  /// \brief Points ready to be uploaded to a vertex buffer
+  struct PackedPoints
+  {
+    /// \brief Positions, 3 floats per point
+    std::vector<float> positions;
+
+    /// \brief Colors, 4 floats from 0 to 1 per point, empty if the input
+    /// had no colors
+    std::vector<float> colors;
+
+    /// \brief Number of points in the input
+    std::size_t input{0u};
+
+    /// \brief Number of input points skipped because they weren't finite,
+    /// or were too far to fit in the grid
+    std::size_t skipped{0u};
+
+    /// \brief Number of input points dropped to stay within the maximum
+    /// number of points, because they fell in extra voxels or between
+    /// samples
+    std::size_t dropped{0u};
+
+    /// \brief Leaf size which was used, zero for sampling
+    double leafSize{0.0};
+  };
+
+  /// \brief Downsamples point clouds to at most a given number of points,
+  /// replacing the points in each cubic voxel by their centroid and mean
+  /// color.
+  ///
+  /// Voxels are found through an open addressing hash table which is
+  /// allocated once, for the maximum number of points, and cleared between
+  /// clouds by bumping a generation counter rather than by writing to it, so
+  /// memory is bounded and filtering a cloud doesn't allocate. When a cloud
+  /// has more occupied voxels than the maximum, the extra voxels are
+  /// dropped, and the leaf size of the following clouds is increased until
+  /// they fit. It shrinks back down to the requested size as clouds get
+  /// sparser.
+  ///
+  /// With a leaf size of zero, clouds are sampled at a regular stride
+  /// instead.
+  ///
+  /// Not thread safe, each thread should filter with its own grid.
+  class VoxelGrid
+  {
+    /// \brief Constructor.
+    /// \param[in] _leafSize Requested leaf size, in meters.
+    /// \param[in] _maxPoints Maximum number of points in the output.
+    public: VoxelGrid(const double _leafSize, const std::size_t _maxPoints);
+
+    /// \brief Filter a packed cloud.
+    /// \param[in] _data Start of the first point.
+    /// \param[in] _count Number of points.
+    /// \param[in] _layout Layout of each point, its step must be large
+    /// enough to hold all of its attributes.
+    /// \param[out] _out Filtered points, whose buffers are reused.
+    public: void Filter(const uint8_t *_data, const std::size_t _count,
+        const PointLayout &_layout, PackedPoints &_out);
+
+    /// \brief Get the requested leaf size.
+    /// \return Leaf size in meters.
+    public: double LeafSize() const;
+
+    /// \brief Get the leaf size which will be used for the next cloud,
+    /// which is larger than requested while clouds overflow.
+    /// \return Leaf size in meters.
+    public: double EffectiveLeafSize() const;
+
+    /// \brief Get the maximum number of points in the output.
+    /// \return Number of points.
+    public: std::size_t MaxPoints() const;
+
+    /// \brief Get the number of bytes allocated by the grid.
+    /// \return Bytes.
+    public: std::size_t MemoryUsage() const;
+
+    /// \brief Voxel accumulating points
+    private: struct Voxel
+    {
+      /// \brief Sum of positions
+      double sum[3];
+
+      /// \brief Sum of color channels, from 0 to 255
+      float color[4];
+
+      /// \brief Number of points
+      uint32_t count;
+    };
+
+    /// \brief Hash table slot
+    private: struct Slot
+    {
+      /// \brief Packed voxel coordinates
+      uint64_t key;
+
+      /// \brief Index of the voxel
+      uint32_t voxel;
+
+      /// \brief Generation which wrote the slot, older slots are empty
+      uint32_t generation;
+    };
+
+    /// \brief Sample at a regular stride
+    /// \param[in] _data Start of the first point.
+    /// \param[in] _count Number of points.
+    /// \param[in] _layout Layout of each point.
+    /// \param[out] _out Sampled points.
+    private: void Sample(const uint8_t *_data, const std::size_t _count,
+        const PointLayout &_layout, PackedPoints &_out) const;
+
+    /// \brief Requested leaf size
+    private: double leafSize;
+
+    /// \brief Leaf size used for the next cloud
+    private: double effectiveLeafSize;
+
+    /// \brief Maximum number of points
+    private: std::size_t maxPoints;
+
+    /// \brief Hash table, its size is a power of two
+    private: std::vector<Slot> slots;
+
+    /// \brief Voxels of the current cloud
+    private: std::vector<Voxel> voxels;
+
+    /// \brief Current generation
+    private: uint32_t generation{0u};
+  };
+}
+}
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "VoxelGrid.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/// \brief Point as published by sensors, with padding after the position
+struct TestPoint
+{
+  float x;
+  float y;
+  float z;
+  float padding;
+  uint32_t rgb;
+};
+
+/////////////////////////////////////////////////
+/// \brief Layout of TestPoint
+/// \param[in] _color Whether to read colors
+/// \return Layout
+static PointLayout testLayout(const bool _color)
+{
+  PointLayout layout;
+  layout.step = sizeof(TestPoint);
+  layout.x = offsetof(TestPoint, x);
+  layout.y = offsetof(TestPoint, y);
+  layout.z = offsetof(TestPoint, z);
+  layout.color = _color ? static_cast<int>(offsetof(TestPoint, rgb)) : -1;
+  return layout;
+}
+
+/////////////////////////////////////////////////
+/// \brief Make a cube of points, spaced evenly
+/// \param[in] _side Number of points along each side
+/// \param[in] _spacing Distance between points
+/// \return Points
+static std::vector<TestPoint> cube(const int _side, const float _spacing)
+{
+  std::vector<TestPoint> points;
+  for (int i = 0; i < _side; ++i)
+    for (int j = 0; j < _side; ++j)
+      for (int k = 0; k < _side; ++k)
+        points.push_back({i * _spacing, j * _spacing, k * _spacing, 0.0f,
+            0x00FF0000u});
+  return points;
+}
+
+/////////////////////////////////////////////////
+TEST(VoxelGridTest, Centroids)
+{
+  std::vector<TestPoint> points{
+      {0.1f, 0.1f, 0.1f, 0.0f, 0x00FF0000u},
+      {0.3f, 0.5f, 0.9f, 0.0f, 0x000000FFu},
+      {1.5f, 0.5f, 0.5f, 0.0f, 0x0000FF00u},
+      {-0.5f, 0.5f, 0.5f, 0.0f, 0x0000FF00u},
+      {std::numeric_limits<float>::quiet_NaN(), 0.0f, 0.0f, 0.0f, 0u},
+      {1e30f, 0.0f, 0.0f, 0.0f, 0u}};
+
+  VoxelGrid grid(1.0, 100);
+  PackedPoints out;
+  grid.Filter(reinterpret_cast<const uint8_t *>(points.data()),
+      points.size(), testLayout(true), out);
+
+  EXPECT_EQ(6u, out.input);
+  EXPECT_EQ(2u, out.skipped);
+  EXPECT_EQ(0u, out.dropped);
+  EXPECT_DOUBLE_EQ(1.0, out.leafSize);
+  ASSERT_EQ(9u, out.positions.size());
+  ASSERT_EQ(12u, out.colors.size());
+
+  // Voxels in the order they were first seen
+  EXPECT_FLOAT_EQ(0.2f, out.positions[0]);
+  EXPECT_FLOAT_EQ(0.3f, out.positions[1]);
+  EXPECT_FLOAT_EQ(0.5f, out.positions[2]);
+  EXPECT_FLOAT_EQ(0.5f, out.colors[0]);
+  EXPECT_FLOAT_EQ(0.0f, out.colors[1]);
+  EXPECT_FLOAT_EQ(0.5f, out.colors[2]);
+  EXPECT_FLOAT_EQ(1.0f, out.colors[3]);
+
+  EXPECT_FLOAT_EQ(1.5f, out.positions[3]);
+  EXPECT_FLOAT_EQ(1.0f, out.colors[5]);
+
+  EXPECT_FLOAT_EQ(-0.5f, out.positions[6]);
+
+  // The same grid filters the next cloud from scratch, without colors
+  points.resize(1);
+  grid.Filter(reinterpret_cast<const uint8_t *>(points.data()),
+      points.size(), testLayout(false), out);
+  EXPECT_EQ(3u, out.positions.size());
+  EXPECT_TRUE(out.colors.empty());
+  EXPECT_FLOAT_EQ(0.1f, out.positions[0]);
+}
+
+/////////////////////////////////////////////////
+TEST(VoxelGridTest, Bounded)
+{
+  // 8000 points, 2 per voxel along each axis, so 1000 voxels
+  auto points = cube(20, 0.125f);
+
+  VoxelGrid grid(0.25, 1000);
+  PackedPoints out;
+  grid.Filter(reinterpret_cast<const uint8_t *>(points.data()),
+      points.size(), testLayout(true), out);
+  EXPECT_EQ(3000u, out.positions.size());
+  EXPECT_EQ(0u, out.dropped);
+  EXPECT_DOUBLE_EQ(0.25, grid.EffectiveLeafSize());
+
+  // Memory doesn't grow with the clouds
+  auto memory = grid.MemoryUsage();
+  EXPECT_GT(memory, 0u);
+
+  // Four times as many voxels overflow, and the leaf grows until they fit
+  auto dense = cube(40, 0.125f);
+  grid.Filter(reinterpret_cast<const uint8_t *>(dense.data()),
+      dense.size(), testLayout(true), out);
+  EXPECT_EQ(3000u, out.positions.size());
+  EXPECT_GT(out.dropped, 0u);
+  EXPECT_GT(grid.EffectiveLeafSize(), 0.25);
+
+  int frames{1};
+  while (out.dropped > 0u && frames < 10)
+  {
+    grid.Filter(reinterpret_cast<const uint8_t *>(dense.data()),
+        dense.size(), testLayout(true), out);
+    ++frames;
+  }
+  EXPECT_EQ(0u, out.dropped);
+  EXPECT_LE(out.positions.size(), 3000u);
+  EXPECT_LT(frames, 10);
+  EXPECT_EQ(memory, grid.MemoryUsage());
+
+  // And shrinks back once clouds are sparse
+  points = cube(5, 0.125f);
+  for (int i = 0; i < 10; ++i)
+  {
+    grid.Filter(reinterpret_cast<const uint8_t *>(points.data()),
+        points.size(), testLayout(true), out);
+  }
+  EXPECT_DOUBLE_EQ(0.25, grid.EffectiveLeafSize());
+  EXPECT_EQ(memory, grid.MemoryUsage());
+}
+
+/////////////////////////////////////////////////
+TEST(VoxelGridTest, Sample)
+{
+  auto points = cube(10, 1.0f);
+  points[0].x = std::numeric_limits<float>::infinity();
+
+  VoxelGrid grid(0.0, 300);
+  PackedPoints out;
+  grid.Filter(reinterpret_cast<const uint8_t *>(points.data()),
+      points.size(), testLayout(true), out);
+
+  // Every 4th point, the first of which isn't finite
+  EXPECT_EQ(1000u, out.input);
+  EXPECT_EQ(750u, out.dropped);
+  EXPECT_EQ(1u, out.skipped);
+  EXPECT_EQ(249u * 3u, out.positions.size());
+  EXPECT_EQ(249u * 4u, out.colors.size());
+  EXPECT_FLOAT_EQ(points[4].z, out.positions[2]);
+  EXPECT_EQ(0u, grid.MemoryUsage());
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+
+#include "PoseTrail.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+PoseTrail::PoseTrail(const std::size_t _capacity, const double _minDistance,
+    const double _minInterval)
+  : capacity(std::max<std::size_t>(1u, _capacity)),
+    minDistance(_minDistance), minInterval(_minInterval)
+{
+}
+
+/////////////////////////////////////////////////
+bool PoseTrail::Add(const math::Vector3d &_position, const double _time)
+{
+  // Every segment starts collapsed on the first position
+  if (this->samples == 0u)
+  {
+    this->vertices.assign((this->capacity + 1) * 2, _position);
+    this->last = _position;
+    this->lastTime = _time;
+    this->samples = 1u;
+    this->allChanged = true;
+    return true;
+  }
+
+  const std::size_t head = this->capacity;
+  if (_position == this->last ||
+      _position.Distance(this->last) < this->minDistance ||
+      _time - this->lastTime < this->minInterval)
+  {
+    // Follow the entity until the next sample
+    if (this->vertices[head * 2 + 1] != _position)
+    {
+      this->SetSegment(head, this->last, _position);
+      this->headChanged = true;
+    }
+    return false;
+  }
+
+  // Replaces the oldest segment once the ring is full
+  this->SetSegment(this->written % this->capacity, this->last, _position);
+  ++this->written;
+  this->pending = std::min(this->pending + 1, this->capacity);
+
+  this->SetSegment(head, _position, _position);
+  this->headChanged = true;
+
+  this->last = _position;
+  this->lastTime = _time;
+  ++this->samples;
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::size_t PoseTrail::Capacity() const
+{
+  return this->capacity;
+}
+
+/////////////////////////////////////////////////
+uint64_t PoseTrail::SampleCount() const
+{
+  return this->samples;
+}
+
+/////////////////////////////////////////////////
+std::size_t PoseTrail::VertexCount() const
+{
+  return this->vertices.size();
+}
+
+/////////////////////////////////////////////////
+const math::Vector3d &PoseTrail::Vertex(const std::size_t _index) const
+{
+  return this->vertices[_index];
+}
+
+/////////////////////////////////////////////////
+void PoseTrail::TakeChanged(std::vector<std::size_t> &_segments)
+{
+  if (this->allChanged)
+  {
+    for (std::size_t s = 0; s <= this->capacity; ++s)
+      _segments.push_back(s);
+  }
+  else
+  {
+    for (std::size_t i = this->pending; i > 0u; --i)
+      _segments.push_back((this->written - i) % this->capacity);
+    if (this->headChanged)
+      _segments.push_back(this->capacity);
+  }
+
+  this->allChanged = false;
+  this->headChanged = false;
+  this->pending = 0u;
+}
+
+/////////////////////////////////////////////////
+void PoseTrail::SetSegment(const std::size_t _segment,
+    const math::Vector3d &_start, const math::Vector3d &_end)
+{
+  this->vertices[_segment * 2] = _start;
+  this->vertices[_segment * 2 + 1] = _end;
+}
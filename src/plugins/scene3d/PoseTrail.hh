@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_GUI_PLUGINS_POSETRAIL_HH_
+#define IGNITION_GUI_PLUGINS_POSETRAIL_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+namespace ignition
+{
+namespace gui
+{
+namespace plugins
+{
+  /// \brief Path followed by an entity, as a fixed number of line segments
+  /// between positions sampled as it moves.
+  ///
+  /// Segments are kept in a ring, so once it's full each new segment
+  /// replaces the oldest one in place, and a last segment follows the
+  /// entity from the latest sample. Vertices are laid out as a line list,
+  /// two per segment, so that only the vertices of changed segments need to
+  /// be sent to the scene, whatever the length of the trail.
+  ///
+  /// Not thread safe.
+  class PoseTrail
+  {
+    /// \brief Constructor.
+    /// \param[in] _capacity Number of segments kept, at least 1.
+    /// \param[in] _minDistance Positions closer than this to the latest
+    /// sample aren't sampled.
+    /// \param[in] _minInterval Positions less than this many seconds after
+    /// the latest sample aren't sampled.
+    public: PoseTrail(const std::size_t _capacity, const double _minDistance,
+        const double _minInterval);
+
+    /// \brief Add the entity's current position.
+    /// \param[in] _position Position.
+    /// \param[in] _time Time, in seconds.
+    /// \return True if the position was sampled.
+    public: bool Add(const math::Vector3d &_position, const double _time);
+
+    /// \brief Get the number of segments kept, excluding the one following
+    /// the entity.
+    /// \return Number of segments.
+    public: std::size_t Capacity() const;
+
+    /// \brief Get the number of positions sampled so far.
+    /// \return Number of samples.
+    public: uint64_t SampleCount() const;
+
+    /// \brief Get the number of vertices, two per segment, including the
+    /// one following the entity, which is last.
+    /// \return Number of vertices, 0 before the first position is added.
+    public: std::size_t VertexCount() const;
+
+    /// \brief Get a vertex.
+    /// \param[in] _index Index, less than VertexCount().
+    /// \return Vertex.
+    public: const math::Vector3d &Vertex(const std::size_t _index) const;
+
+    /// \brief Take the segments which changed since this was last called.
+    /// \param[out] _segments Segments are appended here, Capacity() being
+    /// the one following the entity.
+    public: void TakeChanged(std::vector<std::size_t> &_segments);
+
+    /// \brief Set a segment's vertices
+    /// \param[in] _segment Segment
+    /// \param[in] _start Start
+    /// \param[in] _end End
+    private: void SetSegment(const std::size_t _segment,
+        const math::Vector3d &_start, const math::Vector3d &_end);
+
+    /// \brief Number of segments
+    private: std::size_t capacity;
+
+    /// \brief Minimum distance between samples
+    private: double minDistance;
+
+    /// \brief Minimum time between samples, in seconds
+    private: double minInterval;
+
+    /// \brief Vertices, two per segment
+    private: std::vector<math::Vector3d> vertices;
+
+    /// \brief Latest sample
+    private: math::Vector3d last;
+
+    /// \brief Time of the latest sample
+    private: double lastTime{0.0};
+
+    /// \brief Number of samples
+    private: uint64_t samples{0u};
+
+    /// \brief Number of segments written
+    private: uint64_t written{0u};
+
+    /// \brief Number of segments written since changes were last taken, up
+    /// to capacity
+    private: std::size_t pending{0u};
+
+    /// \brief Whether the segment following the entity changed
+    private: bool headChanged{false};
+
+    /// \brief Whether all segments changed
+    private: bool allChanged{false};
+  };
+}
+}
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "PoseTrail.hh"
+
+using namespace ignition;
+using namespace gui;
+using namespace plugins;
+
+/////////////////////////////////////////////////
+TEST(PoseTrailTest, Ring)
+{
+  PoseTrail trail(3, 0.0, 0.0);
+  EXPECT_EQ(0u, trail.VertexCount());
+
+  // All segments start collapsed on the first position
+  EXPECT_TRUE(trail.Add(math::Vector3d(0, 0, 0), 0.0));
+  EXPECT_EQ(8u, trail.VertexCount());
+  std::vector<std::size_t> segments;
+  trail.TakeChanged(segments);
+  EXPECT_EQ((std::vector<std::size_t>{0, 1, 2, 3}), segments);
+
+  // Standing still changes nothing
+  EXPECT_FALSE(trail.Add(math::Vector3d(0, 0, 0), 1.0));
+  segments.clear();
+  trail.TakeChanged(segments);
+  EXPECT_TRUE(segments.empty());
+
+  EXPECT_TRUE(trail.Add(math::Vector3d(1, 0, 0), 2.0));
+  EXPECT_TRUE(trail.Add(math::Vector3d(2, 0, 0), 3.0));
+  segments.clear();
+  trail.TakeChanged(segments);
+  EXPECT_EQ((std::vector<std::size_t>{0, 1, 3}), segments);
+  EXPECT_EQ(math::Vector3d(1, 0, 0), trail.Vertex(2));
+  EXPECT_EQ(math::Vector3d(2, 0, 0), trail.Vertex(3));
+
+  // The oldest segment is replaced in place
+  trail.Add(math::Vector3d(3, 0, 0), 4.0);
+  trail.Add(math::Vector3d(4, 0, 0), 5.0);
+  segments.clear();
+  trail.TakeChanged(segments);
+  EXPECT_EQ((std::vector<std::size_t>{2, 0, 3}), segments);
+  EXPECT_EQ(math::Vector3d(3, 0, 0), trail.Vertex(0));
+  EXPECT_EQ(math::Vector3d(4, 0, 0), trail.Vertex(1));
+  EXPECT_EQ(5u, trail.SampleCount());
+
+  // Many samples at once change each segment once
+  for (int i = 5; i < 20; ++i)
+    trail.Add(math::Vector3d(i, 0, 0), i);
+  segments.clear();
+  trail.TakeChanged(segments);
+  EXPECT_EQ(4u, segments.size());
+}
+
+/////////////////////////////////////////////////
+TEST(PoseTrailTest, Decimation)
+{
+  PoseTrail trail(10, 1.0, 0.5);
+  trail.Add(math::Vector3d(0, 0, 0), 0.0);
+
+  // Too close, the last segment follows the entity
+  EXPECT_FALSE(trail.Add(math::Vector3d(0.5, 0, 0), 1.0));
+  std::vector<std::size_t> segments;
+  trail.TakeChanged(segments);
+  segments.clear();
+  trail.TakeChanged(segments);
+  EXPECT_TRUE(segments.empty());
+  EXPECT_FALSE(trail.Add(math::Vector3d(0.6, 0, 0), 1.1));
+  trail.TakeChanged(segments);
+  EXPECT_EQ((std::vector<std::size_t>{10}), segments);
+  EXPECT_EQ(math::Vector3d(0, 0, 0), trail.Vertex(20));
+  EXPECT_EQ(math::Vector3d(0.6, 0, 0), trail.Vertex(21));
+
+  // Too soon
+  EXPECT_FALSE(trail.Add(math::Vector3d(2, 0, 0), 0.2));
+
+  EXPECT_TRUE(trail.Add(math::Vector3d(2, 0, 0), 1.2));
+  EXPECT_EQ(2u, trail.SampleCount());
+  EXPECT_EQ(math::Vector3d(2, 0, 0), trail.Vertex(20));
+  EXPECT_EQ(math::Vector3d(2, 0, 0), trail.Vertex(21));
+}
@@ -15,10 +15,17 @@
  *
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <functional>
 #include <map>
+#include <memory>
+#include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Console.hh>
@@ -35,7 +42,14 @@
 
 #include <ignition/transport/Node.hh>
 
+#include "ignition/gui/Application.hh"
 #include "ignition/gui/Conversions.hh"
+#include "ignition/gui/FrameTree.hh"
+#include "ignition/gui/InputQueue.hh"
+#include "ignition/gui/LatencyHistogram.hh"
+#include "ignition/gui/Request.hh"
+#include "ignition/gui/SceneMutationQueue.hh"
+#include "PoseTrail.hh"
 #include "Scene3D.hh"
 
 namespace ignition
@@ -44,6 +58,98 @@ namespace gui
 {
 namespace plugins
 {
+  /// \brief Follows poses stamped with their publication time through the
+  /// render pipeline. Poses are applied and rendered on the render thread,
+  /// and their frame is displayed on the scene graph thread. Only one frame
+  /// is in flight at a time, since the render thread waits for the previous
+  /// texture to be in use before rendering the next one. Mouse events
+  /// handled by the renderer are reported too.
+  class PoseLatency
+  {
+    /// \brief Function receiving the latencies
+    public: using Callback = std::function<void(const std::string &,
+        const std::chrono::steady_clock::duration &)>;
+
+    /// \brief Set the function receiving the latencies
+    /// \param[in] _callback Function, null to stop reporting
+    public: void SetCallback(Callback _callback);
+
+    /// \brief Stop following poses while the scene isn't rendered, or
+    /// start again, ignoring poses published before that.
+    /// \param[in] _suspended True to stop
+    public: void SetSuspended(const bool _suspended);
+
+    /// \brief Get whether poses are being followed
+    /// \return True while suspended
+    public: bool Suspended() const;
+
+    /// \brief Poses published at the given times were applied to the scene
+    /// \param[in] _published Publication times
+    public: void Applied(
+        const std::vector<std::chrono::system_clock::time_point> &_published);
+
+    /// \brief A frame was rendered, including all poses applied so far
+    public: void Rendered();
+
+    /// \brief The rendered frame was handed to the scene graph
+    public: void Displayed();
+
+    /// \brief A frame was rendered after handling mouse events
+    /// \param[in] _received Times at which the events were received
+    public: void InputRendered(
+        const std::vector<std::chrono::steady_clock::time_point> &_received);
+
+    /// \brief Report the latency of each publication time, with the mutex
+    /// locked
+    /// \param[in] _stage Stage name
+    /// \param[in] _published Publication times
+    private: void Report(const std::string &_stage,
+        const std::vector<std::chrono::system_clock::time_point> &_published);
+
+    /// \brief Protects all members, and keeps the callback alive while
+    /// it's being called
+    private: std::mutex mutex;
+
+    /// \brief Function receiving the latencies
+    private: Callback callback;
+
+    /// \brief Publication times of poses applied since the last frame
+    private: std::vector<std::chrono::system_clock::time_point> applied;
+
+    /// \brief Publication times of poses in the frame waiting to be
+    /// displayed
+    private: std::vector<std::chrono::system_clock::time_point> rendered;
+
+    /// \brief True while suspended
+    private: std::atomic<bool> suspended{false};
+
+    /// \brief Poses published before this are ignored
+    private: std::chrono::system_clock::time_point resumed;
+  };
+
+  /// \brief Trail drawn behind an entity
+  struct EntityTrail
+  {
+    /// \brief Constructor
+    /// \param[in] _options How the trail is sampled
+    explicit EntityTrail(const TrailOptions &_options)
+      : trail(_options.capacity, _options.minDistance, _options.minInterval)
+    {
+    }
+
+    /// \brief Entity followed
+    rendering::VisualPtr::weak_type entity;
+
+    /// \brief Sampled positions
+    PoseTrail trail;
+
+    /// \brief Visual holding the lines
+    rendering::VisualPtr visual;
+
+    /// \brief Lines, updated in place
+    rendering::MarkerPtr marker;
+  };
+
   /// \brief Scene manager class for loading and managing objects in the scene
   class SceneManager
   {
@@ -62,6 +168,9 @@ namespace plugins
                          const std::string &_sceneTopic,
                          rendering::ScenePtr _scene);
 
+    /// \brief Destructor, cancels the scene request if still pending
+    public: ~SceneManager();
+
     /// \brief Load the scene manager
     /// \param[in] _service Ign transport service name
     /// \param[in] _poseTopic Ign transport pose topic name
@@ -74,7 +183,25 @@ namespace plugins
                       const std::string &_sceneTopic,
                       rendering::ScenePtr _scene);
 
-    /// \brief Make the scene service request and populate the scene
+    /// \brief Set the maximum rate at which pose messages are received.
+    /// Must be called before Request.
+    /// \param[in] _rate Maximum messages per second, zero for unlimited.
+    public: void SetPoseMaxRate(const uint64_t _rate);
+
+    /// \brief Set the tracker which stamped poses are reported to. Must be
+    /// called before Request.
+    /// \param[in] _latency Tracker, null to not track poses.
+    public: void SetPoseLatency(std::shared_ptr<PoseLatency> _latency);
+
+    /// \brief Set the models whose trails are drawn. Must be called before
+    /// Request.
+    /// \param[in] _entities Names of the models
+    /// \param[in] _options How trails are sampled and drawn
+    public: void SetTrails(const std::vector<std::string> &_entities,
+        const TrailOptions &_options);
+
+    /// \brief Make the scene service request and populate the scene once
+    /// it replies. Doesn't block while waiting for the service.
     public: void Request();
 
     /// \brief Update the scene based on pose msgs received
@@ -102,18 +229,32 @@ namespace plugins
 
     /// \brief Load the model from a model msg
     /// \param[in] _msg Model msg
+    /// \param[in] _parent Id of the parent model, FrameTree::kWorld if none
     /// \return Model visual created from the msg
-    private: rendering::VisualPtr LoadModel(const msgs::Model &_msg);
+    private: rendering::VisualPtr LoadModel(const msgs::Model &_msg,
+        const unsigned int _parent = FrameTree::kWorld);
 
     /// \brief Load a link from a link msg
     /// \param[in] _msg Link msg
+    /// \param[in] _parent Id of the model
     /// \return Link visual created from the msg
-    private: rendering::VisualPtr LoadLink(const msgs::Link &_msg);
+    private: rendering::VisualPtr LoadLink(const msgs::Link &_msg,
+        const unsigned int _parent);
 
     /// \brief Load a visual from a visual msg
     /// \param[in] _msg Visual msg
+    /// \param[in] _parent Id of the link
     /// \return Visual visual created from the msg
-    private: rendering::VisualPtr LoadVisual(const msgs::Visual &_msg);
+    private: rendering::VisualPtr LoadVisual(const msgs::Visual &_msg,
+        const unsigned int _parent);
+
+    /// \brief Add an entity to the frame tree, scoped by its parent's name
+    /// \param[in] _id Entity id
+    /// \param[in] _name Entity name
+    /// \param[in] _visual Entity visual, whose local pose is used
+    /// \param[in] _parent Id of the parent, FrameTree::kWorld if none
+    private: void AddFrame(const unsigned int _id, const std::string &_name,
+        const rendering::VisualPtr &_visual, const unsigned int _parent);
 
     /// \brief Load a geometry from a geometry msg
     /// \param[in] _msg Geometry msg
@@ -138,6 +279,14 @@ namespace plugins
     /// \param[in] _entity Entity to delete
     private: void DeleteEntity(const unsigned int _entity);
 
+    /// \brief Sample the positions of entities with trails and update the
+    /// segments of their trails which changed
+    private: void UpdateTrails();
+
+    /// \brief Remove an entity's trail from the scene
+    /// \param[in] _entity Entity followed
+    private: void DestroyTrail(const unsigned int _entity);
+
     //// \brief Ign-transport scene service name
     private: std::string service;
 
@@ -150,15 +299,35 @@ namespace plugins
     //// \brief Ign-transport scene topic name
     private: std::string sceneTopic;
 
+    /// \brief Maximum rate for pose messages, zero means unlimited. Deletion
+    /// and scene messages are never throttled, since dropping them would
+    /// leave the scene out of sync.
+    private: uint64_t poseMaxRate{0u};
+
     //// \brief Pointer to the rendering scene
     private: rendering::ScenePtr scene;
 
+    /// \brief Coordinate frames of the scene's entities, shared with other
+    /// plugins through the application. May be null.
+    private: FrameTree *frames{nullptr};
+
     //// \brief Mutex to protect the pose msgs
     private: std::mutex mutex;
 
     /// \brief Map of entity id to pose
     private: std::map<unsigned int, math::Pose3d> poses;
 
+    /// \brief Poses of the latest pose message, seven doubles each, kept
+    /// to reuse its capacity
+    private: std::vector<double> poseData;
+
+    /// \brief Tracker for stamped poses, may be null
+    private: std::shared_ptr<PoseLatency> poseLatency;
+
+    /// \brief Publication times of the oldest and newest pose messages
+    /// received since the last update
+    private: std::vector<std::chrono::system_clock::time_point> publishTimes;
+
     /// \brief Map of entity id to initial local poses
     /// This is currently used to handle the normal vector in plane visuals. In
     /// general, this can be used to store any local transforms between the
@@ -177,6 +346,24 @@ namespace plugins
     /// \brief Keeps the a list of unprocessed scene messages
     private: std::vector<msgs::Scene> sceneMsgs;
 
+    /// \brief Pending scene service request
+    private: RequestFuture<msgs::Scene> sceneRequest;
+
+    /// \brief Names of the models whose trails are drawn
+    private: std::set<std::string> trailNames;
+
+    /// \brief How trails are sampled and drawn
+    private: TrailOptions trailOptions;
+
+    /// \brief Map of entity id to trail
+    private: std::map<unsigned int, std::unique_ptr<EntityTrail>> trails;
+
+    /// \brief Material of all trails
+    private: rendering::MaterialPtr trailMaterial;
+
+    /// \brief Segments of a trail which changed, kept to reuse its capacity
+    private: std::vector<std::size_t> trailSegments;
+
     /// \brief Transport node for making service request and subscribing to
     /// pose topic
     private: ignition::transport::Node node;
@@ -185,17 +372,16 @@ namespace plugins
   /// \brief Private data class for IgnRenderer
   class IgnRendererPrivate
   {
-    /// \brief Flag to indicate if mouse event is dirty
-    public: bool mouseDirty = false;
-
-    /// \brief Mouse event
-    public: common::MouseEvent mouseEvent;
+    /// \brief Mouse events from the GUI thread, drained once per frame
+    public: InputQueue inputQueue;
 
-    /// \brief Mouse move distance since last event.
-    public: math::Vector2d drag;
+    /// \brief Mouse events handled in the current frame, kept to reuse
+    /// their capacity
+    public: std::vector<InputEvent> inputEvents;
 
-    /// \brief Mutex to protect mouse events
-    public: std::mutex mutex;
+    /// \brief Times at which the mouse events handled in the current frame
+    /// were received
+    public: std::vector<std::chrono::steady_clock::time_point> inputTimes;
 
     /// \brief User camera
     public: rendering::CameraPtr camera;
@@ -222,6 +408,10 @@ namespace plugins
     /// \brief Render thread
     public : RenderThread *renderThread = nullptr;
 
+    /// \brief Follows stamped poses from the renderer to the texture node
+    public: std::shared_ptr<PoseLatency> poseLatency =
+        std::make_shared<PoseLatency>();
+
     //// \brief List of threads
     public: static QList<QThread *> threads;
   };
@@ -240,6 +430,109 @@ using namespace plugins;
 
 QList<QThread *> RenderWindowItemPrivate::threads;
 
+/////////////////////////////////////////////////
+void PoseLatency::SetCallback(Callback _callback)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->callback = std::move(_callback);
+}
+
+/////////////////////////////////////////////////
+void PoseLatency::SetSuspended(const bool _suspended)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->suspended = _suspended;
+  if (_suspended)
+  {
+    this->applied.clear();
+    this->rendered.clear();
+  }
+  else
+  {
+    this->resumed = std::chrono::system_clock::now();
+  }
+}
+
+/////////////////////////////////////////////////
+bool PoseLatency::Suspended() const
+{
+  return this->suspended;
+}
+
+/////////////////////////////////////////////////
+void PoseLatency::Applied(
+    const std::vector<std::chrono::system_clock::time_point> &_published)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->suspended)
+    return;
+
+  // Poses received before suspending may be applied after resuming
+  std::vector<std::chrono::system_clock::time_point> published;
+  published.reserve(_published.size());
+  for (const auto &time : _published)
+  {
+    if (time >= this->resumed)
+      published.push_back(time);
+  }
+
+  this->Report("pose_applied", published);
+  this->applied.insert(this->applied.end(), published.begin(),
+      published.end());
+}
+
+/////////////////////////////////////////////////
+void PoseLatency::Rendered()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (this->applied.empty())
+    return;
+
+  this->Report("frame_rendered", this->applied);
+  this->rendered.insert(this->rendered.end(), this->applied.begin(),
+      this->applied.end());
+  this->applied.clear();
+}
+
+/////////////////////////////////////////////////
+void PoseLatency::Displayed()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->Report("pose_to_pixel", this->rendered);
+  this->rendered.clear();
+}
+
+/////////////////////////////////////////////////
+void PoseLatency::InputRendered(
+    const std::vector<std::chrono::steady_clock::time_point> &_received)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!this->callback)
+    return;
+
+  auto now = std::chrono::steady_clock::now();
+  for (const auto &received : _received)
+    this->callback("input_to_frame", now - received);
+}
+
+/////////////////////////////////////////////////
+void PoseLatency::Report(const std::string &_stage,
+    const std::vector<std::chrono::system_clock::time_point> &_published)
+{
+  if (!this->callback)
+    return;
+
+  // Publication times come from another process, so they're compared with
+  // the wall clock
+  auto now = std::chrono::system_clock::now();
+  for (const auto &published : _published)
+  {
+    this->callback(_stage,
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        now - published));
+  }
+}
+
 /////////////////////////////////////////////////
 SceneManager::SceneManager()
 {
@@ -255,6 +548,19 @@ SceneManager::SceneManager(const std::string &_service,
   this->Load(_service, _poseTopic, _deletionTopic, _sceneTopic, _scene);
 }
 
+/////////////////////////////////////////////////
+SceneManager::~SceneManager()
+{
+  this->sceneRequest.Cancel();
+
+  // The tree outlives the scene manager. Look it up again, since the
+  // application may have dropped it already.
+  auto frames = App() && this->scene ? App()->Frames(this->scene->Name()) :
+      nullptr;
+  if (frames)
+    frames->Clear();
+}
+
 /////////////////////////////////////////////////
 void SceneManager::Load(const std::string &_service,
                         const std::string &_poseTopic,
@@ -267,38 +573,77 @@ void SceneManager::Load(const std::string &_service,
   this->deletionTopic = _deletionTopic;
   this->sceneTopic = _sceneTopic;
   this->scene = _scene;
+  this->frames = App() && _scene ? App()->Frames(_scene->Name()) : nullptr;
+}
+
+/////////////////////////////////////////////////
+void SceneManager::SetPoseMaxRate(const uint64_t _rate)
+{
+  this->poseMaxRate = _rate;
+}
+
+/////////////////////////////////////////////////
+void SceneManager::SetPoseLatency(std::shared_ptr<PoseLatency> _latency)
+{
+  this->poseLatency = std::move(_latency);
+}
+
+/////////////////////////////////////////////////
+void SceneManager::SetTrails(const std::vector<std::string> &_entities,
+    const TrailOptions &_options)
+{
+  this->trailNames = std::set<std::string>(_entities.begin(),
+      _entities.end());
+  this->trailOptions = _options;
 }
 
 /////////////////////////////////////////////////
 void SceneManager::Request()
 {
-  // wait for the service to be advertized
-  std::vector<transport::ServicePublisher> publishers;
-  const std::chrono::duration<double> sleepDuration{1.0};
-  const std::size_t tries = 30;
-  for (std::size_t i = 0; i < tries; ++i)
-  {
-    this->node.ServiceInfo(this->service, publishers);
-    if (publishers.size() > 0)
-      break;
-    std::this_thread::sleep_for(sleepDuration);
-    igndbg << "Waiting for service " << this->service << "\n";
-  }
+  // The request goes out once the service is advertised, and the reply is
+  // handed to the render thread through sceneMsgs
+  this->sceneRequest = gui::request<msgs::Scene>(this->node, this->service,
+      msgs::Empty(), std::chrono::seconds(30), inlineExecutor());
 
-  if (publishers.empty() ||
-      !this->node.Request(this->service, &SceneManager::OnSceneSrvMsg, this))
-  {
-    ignerr << "Error making service request to " << this->service << std::endl;
-  }
+  this->sceneRequest.Then(
+      [this](const msgs::Scene &_msg, const RequestStatus _status)
+      {
+        if (_status == RequestStatus::kTimedOut)
+        {
+          ignerr << "Timed out waiting for service [" << this->service
+                 << "]" << std::endl;
+          return;
+        }
+        this->OnSceneSrvMsg(_msg, _status == RequestStatus::kOk);
+      });
 }
 
 /////////////////////////////////////////////////
 void SceneManager::OnPoseVMsg(const msgs::Pose_V &_msg)
 {
   std::lock_guard<std::mutex> lock(this->mutex);
+
+  // Only the oldest and newest stamps are kept until the next update, so
+  // they don't pile up when frames are slower than messages
+  std::chrono::system_clock::time_point published;
+  if (this->poseLatency && !this->poseLatency->Suspended() &&
+      _msg.has_header() && publishTime(_msg.header(), published))
+  {
+    if (this->publishTimes.size() < 2u)
+      this->publishTimes.push_back(published);
+    else
+      this->publishTimes.back() = published;
+  }
+
+  convert(_msg.pose(), this->poseData);
   for (int i = 0; i < _msg.pose_size(); ++i)
   {
-    math::Pose3d pose = msgs::Convert(_msg.pose(i));
+    const double *data = &this->poseData[i * 7];
+    math::Pose3d pose(data[0], data[1], data[2],
+        data[3], data[4], data[5], data[6]);
+
+    // Normalize like msgs::Convert, so unset orientations are identity
+    pose.Correct();
 
     // apply additional local poses if available
     const auto it = this->localPoses.find(_msg.pose(i).id());
@@ -347,9 +692,13 @@ void SceneManager::Update()
       if (visual)
       {
         visual->SetLocalPose(pIt->second);
+        if (this->frames)
+          this->frames->SetLocalPose(pIt->first, pIt->second);
       }
       else
       {
+        if (this->frames)
+          this->frames->Remove(pIt->first);
         this->visuals.erase(vIt);
       }
       this->poses.erase(pIt++);
@@ -380,6 +729,14 @@ void SceneManager::Update()
   // Note we are clearing the pose msgs here but later on we may need to
   // consider the case where pose msgs arrive before scene/visual msgs
   this->poses.clear();
+
+  this->UpdateTrails();
+
+  if (!this->publishTimes.empty())
+  {
+    this->poseLatency->Applied(this->publishTimes);
+    this->publishTimes.clear();
+  }
 }
 
 
@@ -407,7 +764,12 @@ void SceneManager::OnSceneSrvMsg(const msgs::Scene &_msg, const bool result)
 
   if (!this->poseTopic.empty())
   {
-    if (!this->node.Subscribe(this->poseTopic, &SceneManager::OnPoseVMsg, this))
+    transport::SubscribeOptions opts;
+    if (this->poseMaxRate > 0u)
+      opts.SetMsgsPerSec(this->poseMaxRate);
+
+    if (!this->node.Subscribe(this->poseTopic, &SceneManager::OnPoseVMsg, this,
+          opts))
     {
       ignerr << "Error subscribing to pose topic: " << this->poseTopic
         << std::endl;
@@ -457,6 +819,18 @@ void SceneManager::LoadScene(const msgs::Scene &_msg)
 {
   rendering::VisualPtr rootVis = this->scene->RootVisual();
 
+  // Drop frames of models which aren't loaded anymore, such as those left
+  // in the tree by a previous scene
+  if (this->frames)
+  {
+    for (auto id : this->frames->Children(FrameTree::kWorld))
+    {
+      auto it = this->visuals.find(id);
+      if (it == this->visuals.end() || it->second.expired())
+        this->frames->Remove(id);
+    }
+  }
+
   // load models
   for (int i = 0; i < _msg.model_size(); ++i)
   {
@@ -486,17 +860,27 @@ void SceneManager::LoadScene(const msgs::Scene &_msg)
 }
 
 /////////////////////////////////////////////////
-rendering::VisualPtr SceneManager::LoadModel(const msgs::Model &_msg)
+rendering::VisualPtr SceneManager::LoadModel(const msgs::Model &_msg,
+    const unsigned int _parent)
 {
   rendering::VisualPtr modelVis = this->scene->CreateVisual();
   if (_msg.has_pose())
     modelVis->SetLocalPose(msgs::Convert(_msg.pose()));
   this->visuals[_msg.id()] = modelVis;
+  this->AddFrame(_msg.id(), _msg.name(), modelVis, _parent);
+
+  if (this->trailNames.count(_msg.name()) > 0u)
+  {
+    this->DestroyTrail(_msg.id());
+    auto trail = std::make_unique<EntityTrail>(this->trailOptions);
+    trail->entity = modelVis;
+    this->trails[_msg.id()] = std::move(trail);
+  }
 
   // load links
   for (int i = 0; i < _msg.link_size(); ++i)
   {
-    rendering::VisualPtr linkVis = this->LoadLink(_msg.link(i));
+    rendering::VisualPtr linkVis = this->LoadLink(_msg.link(i), _msg.id());
     if (linkVis)
       modelVis->AddChild(linkVis);
     else
@@ -506,7 +890,8 @@ rendering::VisualPtr SceneManager::LoadModel(const msgs::Model &_msg)
   // load nested models
   for (int i = 0; i < _msg.model_size(); ++i)
   {
-    rendering::VisualPtr nestedModelVis = this->LoadModel(_msg.model(i));
+    rendering::VisualPtr nestedModelVis = this->LoadModel(_msg.model(i),
+        _msg.id());
     if (nestedModelVis)
       modelVis->AddChild(nestedModelVis);
     else
@@ -518,17 +903,20 @@ rendering::VisualPtr SceneManager::LoadModel(const msgs::Model &_msg)
 }
 
 /////////////////////////////////////////////////
-rendering::VisualPtr SceneManager::LoadLink(const msgs::Link &_msg)
+rendering::VisualPtr SceneManager::LoadLink(const msgs::Link &_msg,
+    const unsigned int _parent)
 {
   rendering::VisualPtr linkVis = this->scene->CreateVisual();
   if (_msg.has_pose())
     linkVis->SetLocalPose(msgs::Convert(_msg.pose()));
   this->visuals[_msg.id()] = linkVis;
+  this->AddFrame(_msg.id(), _msg.name(), linkVis, _parent);
 
   // load visuals
   for (int i = 0; i < _msg.visual_size(); ++i)
   {
-    rendering::VisualPtr visualVis = this->LoadVisual(_msg.visual(i));
+    rendering::VisualPtr visualVis = this->LoadVisual(_msg.visual(i),
+        _msg.id());
     if (visualVis)
       linkVis->AddChild(visualVis);
     else
@@ -549,7 +937,8 @@ rendering::VisualPtr SceneManager::LoadLink(const msgs::Link &_msg)
 }
 
 /////////////////////////////////////////////////
-rendering::VisualPtr SceneManager::LoadVisual(const msgs::Visual &_msg)
+rendering::VisualPtr SceneManager::LoadVisual(const msgs::Visual &_msg,
+    const unsigned int _parent)
 {
   if (!_msg.has_geometry())
     return rendering::VisualPtr();
@@ -566,6 +955,7 @@ rendering::VisualPtr SceneManager::LoadVisual(const msgs::Visual &_msg)
     visualVis->SetLocalPose(msgs::Convert(_msg.pose()) * localPose);
   else
     visualVis->SetLocalPose(localPose);
+  this->AddFrame(_msg.id(), _msg.name(), visualVis, _parent);
 
   if (geom)
   {
@@ -777,6 +1167,10 @@ rendering::LightPtr SceneManager::LoadLight(const msgs::Light &_msg)
 /////////////////////////////////////////////////
 void SceneManager::DeleteEntity(const unsigned int _entity)
 {
+  this->DestroyTrail(_entity);
+  if (this->frames)
+    this->frames->Remove(_entity);
+
   if (this->visuals.find(_entity) != this->visuals.end())
   {
     auto visual = this->visuals[_entity].lock();
@@ -797,6 +1191,102 @@ void SceneManager::DeleteEntity(const unsigned int _entity)
   }
 }
 
+/////////////////////////////////////////////////
+void SceneManager::AddFrame(const unsigned int _id, const std::string &_name,
+    const rendering::VisualPtr &_visual, const unsigned int _parent)
+{
+  if (!this->frames)
+    return;
+
+  std::string name = _name;
+  if (_parent != FrameTree::kWorld)
+    name = this->frames->Name(_parent) + "::" + _name;
+
+  if (!this->frames->Add(_id, name, _visual->LocalPose(), _parent))
+  {
+    ignwarn << "Failed to add frame [" << name << "] to the frame tree."
+            << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void SceneManager::UpdateTrails()
+{
+  if (this->trails.empty())
+    return;
+
+  const double now = std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+
+  // Only the segments which changed are updated, so the cost per frame
+  // doesn't depend on the length of the trails
+  for (auto it = this->trails.begin(); it != this->trails.end();)
+  {
+    auto entity = it->second->entity.lock();
+    if (!entity)
+    {
+      auto id = (it++)->first;
+      this->DestroyTrail(id);
+      continue;
+    }
+
+    auto &trail = *it->second;
+    auto id = (it++)->first;
+
+    // Cached unless the entity or its ancestors moved
+    math::Pose3d pose;
+    if (this->frames && this->frames->WorldPose(id, pose))
+      trail.trail.Add(pose.Pos(), now);
+    else
+      trail.trail.Add(entity->WorldPosition(), now);
+    this->trailSegments.clear();
+    trail.trail.TakeChanged(this->trailSegments);
+    if (this->trailSegments.empty())
+      continue;
+
+    if (!trail.marker)
+    {
+      if (!this->trailMaterial)
+      {
+        const auto &color = this->trailOptions.color;
+        this->trailMaterial = this->scene->CreateMaterial();
+        this->trailMaterial->SetAmbient(color);
+        this->trailMaterial->SetDiffuse(color);
+        this->trailMaterial->SetEmissive(color);
+      }
+
+      trail.marker = this->scene->CreateMarker();
+      trail.marker->SetType(rendering::MarkerType::MT_LINE_LIST);
+      for (std::size_t v = 0; v < trail.trail.VertexCount(); ++v)
+        trail.marker->AddPoint(trail.trail.Vertex(v), this->trailOptions.color);
+      trail.visual = this->scene->CreateVisual();
+      trail.visual->AddGeometry(trail.marker);
+      trail.visual->SetMaterial(this->trailMaterial, false);
+      this->scene->RootVisual()->AddChild(trail.visual);
+      continue;
+    }
+
+    for (auto segment : this->trailSegments)
+    {
+      trail.marker->SetPoint(segment * 2, trail.trail.Vertex(segment * 2));
+      trail.marker->SetPoint(segment * 2 + 1,
+          trail.trail.Vertex(segment * 2 + 1));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void SceneManager::DestroyTrail(const unsigned int _entity)
+{
+  auto it = this->trails.find(_entity);
+  if (it == this->trails.end())
+    return;
+
+  if (it->second->visual)
+    this->scene->DestroyVisual(it->second->visual);
+  this->trails.erase(it);
+}
+
 /////////////////////////////////////////////////
 IgnRenderer::IgnRenderer()
   : dataPtr(new IgnRendererPrivate)
@@ -824,69 +1314,89 @@ void IgnRenderer::Render()
     this->textureDirty = false;
   }
 
+  // changes posted by other plugins, such as sensor data visuals
+  if (App() && App()->SceneMutations())
+    App()->SceneMutations()->Run(this->sceneName);
+
   // update the scene
   this->dataPtr->sceneManager.Update();
 
   // view control
-  this->HandleMouseEvent();
+  this->HandleMouseEvents();
 
   // update and render to texture
   this->dataPtr->camera->Update();
+
+  if (this->poseLatency)
+  {
+    this->poseLatency->Rendered();
+    if (!this->dataPtr->inputTimes.empty())
+      this->poseLatency->InputRendered(this->dataPtr->inputTimes);
+  }
 }
 
 /////////////////////////////////////////////////
-void IgnRenderer::HandleMouseEvent()
+void IgnRenderer::HandleMouseEvents()
 {
-  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
-  if (!this->dataPtr->mouseDirty)
+  this->dataPtr->inputTimes.clear();
+  if (this->dataPtr->inputQueue.Drain(this->dataPtr->inputEvents) == 0u)
     return;
 
   this->dataPtr->viewControl.SetCamera(this->dataPtr->camera);
 
-  if (this->dataPtr->mouseEvent.Type() == common::MouseEvent::SCROLL)
+  // Presses and releases are handled in order, with the moves and scrolls
+  // between them coalesced
+  for (const auto &input : this->dataPtr->inputEvents)
+  {
+    this->HandleMouseEvent(input.event, input.drag);
+    this->dataPtr->inputTimes.push_back(input.time);
+  }
+}
+
+/////////////////////////////////////////////////
+void IgnRenderer::HandleMouseEvent(const common::MouseEvent &_e,
+    const math::Vector2d &_drag)
+{
+  if (_e.Type() == common::MouseEvent::SCROLL)
   {
-    this->dataPtr->target =
-        this->ScreenToScene(this->dataPtr->mouseEvent.Pos());
+    this->dataPtr->target = this->ScreenToScene(_e.Pos());
     this->dataPtr->viewControl.SetTarget(this->dataPtr->target);
     double distance = this->dataPtr->camera->WorldPosition().Distance(
         this->dataPtr->target);
-    double amount = -this->dataPtr->drag.Y() * distance / 5.0;
+    double amount = -_drag.Y() * distance / 5.0;
     this->dataPtr->viewControl.Zoom(amount);
   }
   else
   {
-    if (this->dataPtr->drag == math::Vector2d::Zero)
+    if (_drag == math::Vector2d::Zero)
     {
-      this->dataPtr->target = this->ScreenToScene(
-          this->dataPtr->mouseEvent.PressPos());
+      this->dataPtr->target = this->ScreenToScene(_e.PressPos());
       this->dataPtr->viewControl.SetTarget(this->dataPtr->target);
     }
 
     // Pan with left button
-    if (this->dataPtr->mouseEvent.Buttons() & common::MouseEvent::LEFT)
+    if (_e.Buttons() & common::MouseEvent::LEFT)
     {
-      this->dataPtr->viewControl.Pan(this->dataPtr->drag);
+      this->dataPtr->viewControl.Pan(_drag);
     }
     // Orbit with middle button
-    else if (this->dataPtr->mouseEvent.Buttons() & common::MouseEvent::MIDDLE)
+    else if (_e.Buttons() & common::MouseEvent::MIDDLE)
     {
-      this->dataPtr->viewControl.Orbit(this->dataPtr->drag);
+      this->dataPtr->viewControl.Orbit(_drag);
     }
-    else if (this->dataPtr->mouseEvent.Buttons() & common::MouseEvent::RIGHT)
+    else if (_e.Buttons() & common::MouseEvent::RIGHT)
     {
       double hfov = this->dataPtr->camera->HFOV().Radian();
       double vfov = 2.0f * atan(tan(hfov / 2.0f) /
           this->dataPtr->camera->AspectRatio());
       double distance = this->dataPtr->camera->WorldPosition().Distance(
           this->dataPtr->target);
-      double amount = ((-this->dataPtr->drag.Y() /
+      double amount = ((-_drag.Y() /
           static_cast<double>(this->dataPtr->camera->ImageHeight()))
           * distance * tan(vfov/2.0) * 6.0);
       this->dataPtr->viewControl.Zoom(amount);
     }
   }
-  this->dataPtr->drag = 0;
-  this->dataPtr->mouseDirty = false;
 }
 
 /////////////////////////////////////////////////
@@ -936,6 +1446,10 @@ void IgnRenderer::Initialize()
     this->dataPtr->sceneManager.Load(this->sceneService, this->poseTopic,
                                      this->deletionTopic, this->sceneTopic,
                                      scene);
+    this->dataPtr->sceneManager.SetPoseMaxRate(this->poseTopicMaxRate);
+    this->dataPtr->sceneManager.SetPoseLatency(this->poseLatency);
+    this->dataPtr->sceneManager.SetTrails(this->trailEntities,
+        this->trailOptions);
     this->dataPtr->sceneManager.Request();
   }
 
@@ -970,10 +1484,13 @@ void IgnRenderer::Destroy()
 void IgnRenderer::NewMouseEvent(const common::MouseEvent &_e,
     const math::Vector2d &_drag)
 {
-  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
-  this->dataPtr->mouseEvent = _e;
-  this->dataPtr->drag += _drag;
-  this->dataPtr->mouseDirty = true;
+  this->dataPtr->inputQueue.Push(_e, _drag);
+}
+
+/////////////////////////////////////////////////
+void IgnRenderer::FlushMouseEvents()
+{
+  this->dataPtr->inputQueue.Flush();
 }
 
 /////////////////////////////////////////////////
@@ -1009,6 +1526,16 @@ RenderThread::RenderThread()
 /////////////////////////////////////////////////
 void RenderThread::RenderNext()
 {
+  {
+    std::lock_guard<std::mutex> lock(this->suspendMutex);
+    if (this->suspended)
+    {
+      // Let the loop stall, it's restarted by SetSuspended
+      this->stalled = true;
+      return;
+    }
+  }
+
   this->context->makeCurrent(this->surface);
 
   if (!this->ignRenderer.initialized)
@@ -1029,6 +1556,19 @@ void RenderThread::RenderNext()
   emit TextureReady(this->ignRenderer.textureId, this->ignRenderer.textureSize);
 }
 
+/////////////////////////////////////////////////
+void RenderThread::SetSuspended(const bool _suspended)
+{
+  std::lock_guard<std::mutex> lock(this->suspendMutex);
+  this->suspended = _suspended;
+
+  if (!this->suspended && this->stalled)
+  {
+    this->stalled = false;
+    QMetaObject::invokeMethod(this, "RenderNext", Qt::QueuedConnection);
+  }
+}
+
 /////////////////////////////////////////////////
 void RenderThread::ShutDown()
 {
@@ -1111,6 +1651,9 @@ void TextureNode::PrepareNode()
 
     this->markDirty(DirtyMaterial);
 
+    if (this->poseLatency)
+      this->poseLatency->Displayed();
+
     // This will notify the rendering thread that the texture is now being
     // rendered and it can start rendering to the other one.
     emit TextureInUse();
@@ -1124,6 +1667,8 @@ RenderWindowItem::RenderWindowItem(QQuickItem *_parent)
   this->setAcceptedMouseButtons(Qt::AllButtons);
   this->setFlag(ItemHasContents);
   this->dataPtr->renderThread = new RenderThread();
+  this->dataPtr->renderThread->ignRenderer.poseLatency =
+      this->dataPtr->poseLatency;
 }
 
 /////////////////////////////////////////////////
@@ -1153,6 +1698,12 @@ void RenderWindowItem::Ready()
   this->connect(this, &QQuickItem::heightChanged,
       this->dataPtr->renderThread, &RenderThread::SizeChanged);
 
+  // Once per frame on this thread, the mouse events' producer
+  this->connect(this->window(), &QQuickWindow::afterAnimating, this, [this]()
+  {
+    this->dataPtr->renderThread->ignRenderer.FlushMouseEvents();
+  });
+
   this->dataPtr->renderThread->start();
   this->update();
 }
@@ -1187,6 +1738,7 @@ QSGNode *RenderWindowItem::updatePaintNode(QSGNode *_node,
   if (!node)
   {
     node = new TextureNode(this->window());
+    node->poseLatency = this->dataPtr->poseLatency;
 
     // Set up connections to get the production of render texture in sync with
     // vsync on the rendering thread.
@@ -1266,6 +1818,20 @@ void RenderWindowItem::SetPoseTopic(const std::string &_topic)
   this->dataPtr->renderThread->ignRenderer.poseTopic = _topic;
 }
 
+/////////////////////////////////////////////////
+void RenderWindowItem::SetPoseTopicMaxRate(const uint64_t _rate)
+{
+  this->dataPtr->renderThread->ignRenderer.poseTopicMaxRate = _rate;
+}
+
+/////////////////////////////////////////////////
+void RenderWindowItem::SetTrails(const std::vector<std::string> &_entities,
+    const TrailOptions &_options)
+{
+  this->dataPtr->renderThread->ignRenderer.trailEntities = _entities;
+  this->dataPtr->renderThread->ignRenderer.trailOptions = _options;
+}
+
 /////////////////////////////////////////////////
 void RenderWindowItem::SetDeletionTopic(const std::string &_topic)
 {
@@ -1278,6 +1844,21 @@ void RenderWindowItem::SetSceneTopic(const std::string &_topic)
   this->dataPtr->renderThread->ignRenderer.sceneTopic = _topic;
 }
 
+/////////////////////////////////////////////////
+void RenderWindowItem::SetLatencyCallback(
+    std::function<void(const std::string &,
+    const std::chrono::steady_clock::duration &)> _callback)
+{
+  this->dataPtr->poseLatency->SetCallback(std::move(_callback));
+}
+
+/////////////////////////////////////////////////
+void RenderWindowItem::SetSuspended(const bool _suspended)
+{
+  this->dataPtr->poseLatency->SetSuspended(_suspended);
+  this->dataPtr->renderThread->SetSuspended(_suspended);
+}
+
 /////////////////////////////////////////////////
 Scene3D::Scene3D()
   : Plugin(), dataPtr(new Scene3DPrivate)
@@ -1289,6 +1870,11 @@ Scene3D::Scene3D()
 /////////////////////////////////////////////////
 Scene3D::~Scene3D()
 {
+  // The render threads may outlive the plugin
+  auto renderWindow = this->PluginItem() ?
+      this->PluginItem()->findChild<RenderWindowItem *>() : nullptr;
+  if (renderWindow)
+    renderWindow->SetLatencyCallback(nullptr);
 }
 
 /////////////////////////////////////////////////
@@ -1306,6 +1892,26 @@ void Scene3D::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
   if (this->title.empty())
     this->title = "3D Scene";
 
+  // The RGBA render texture follows the item's size
+  auto updateTextureMemory = [this, renderWindow]()
+  {
+    this->SetMemoryUsage("textures",
+        static_cast<uint64_t>(std::max(0.0, renderWindow->width())) *
+        static_cast<uint64_t>(std::max(0.0, renderWindow->height())) * 4u);
+  };
+  this->connect(renderWindow, &QQuickItem::widthChanged, this,
+      updateTextureMemory);
+  this->connect(renderWindow, &QQuickItem::heightChanged, this,
+      updateTextureMemory);
+  updateTextureMemory();
+
+  renderWindow->SetLatencyCallback(
+      [this](const std::string &_stage,
+      const std::chrono::steady_clock::duration &_latency)
+      {
+        this->RecordLatency(_stage, _latency);
+      });
+
   // Custom parameters
   if (_pluginElem)
   {
@@ -1366,6 +1972,7 @@ void Scene3D::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
     {
       std::string topic = elem->GetText();
       renderWindow->SetPoseTopic(topic);
+      renderWindow->SetPoseTopicMaxRate(this->MaxRate(topic));
     }
 
     elem = _pluginElem->FirstChildElement("deletion_topic");
@@ -1381,9 +1988,59 @@ void Scene3D::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
       std::string topic = elem->GetText();
       renderWindow->SetSceneTopic(topic);
     }
+
+    elem = _pluginElem->FirstChildElement("trails");
+    if (nullptr != elem)
+    {
+      std::vector<std::string> entities;
+      for (auto entityElem = elem->FirstChildElement("entity");
+          entityElem != nullptr;
+          entityElem = entityElem->NextSiblingElement("entity"))
+      {
+        if (nullptr != entityElem->GetText())
+          entities.push_back(entityElem->GetText());
+      }
+
+      TrailOptions options;
+      unsigned int capacity = options.capacity;
+      if (auto capacityElem = elem->FirstChildElement("capacity"))
+        capacityElem->QueryUnsignedText(&capacity);
+      options.capacity = capacity;
+
+      if (auto distanceElem = elem->FirstChildElement("min_distance"))
+        distanceElem->QueryDoubleText(&options.minDistance);
+
+      if (auto intervalElem = elem->FirstChildElement("min_interval"))
+        intervalElem->QueryDoubleText(&options.minInterval);
+
+      auto colorElem = elem->FirstChildElement("color");
+      if (nullptr != colorElem && nullptr != colorElem->GetText())
+      {
+        std::stringstream colorStr;
+        colorStr << std::string(colorElem->GetText());
+        colorStr >> options.color;
+      }
+
+      renderWindow->SetTrails(entities, options);
+    }
   }
 }
 
+/////////////////////////////////////////////////
+void Scene3D::Suspend()
+{
+  auto renderWindow = this->PluginItem()->findChild<RenderWindowItem *>();
+  if (renderWindow)
+    renderWindow->SetSuspended(true);
+}
+
+/////////////////////////////////////////////////
+void Scene3D::Resume()
+{
+  auto renderWindow = this->PluginItem()->findChild<RenderWindowItem *>();
+  if (renderWindow)
+    renderWindow->SetSuspended(false);
+}
 
 /////////////////////////////////////////////////
 void RenderWindowItem::mousePressEvent(QMouseEvent *_e)
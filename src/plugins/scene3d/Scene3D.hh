@@ -18,9 +18,12 @@
 #ifndef IGNITION_GUI_PLUGINS_SCENE3D_HH_
 #define IGNITION_GUI_PLUGINS_SCENE3D_HH_
 
+#include <chrono>
+#include <functional>
 #include <string>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include <ignition/math/Color.hh>
 #include <ignition/math/Pose3.hh>
@@ -42,6 +45,7 @@ namespace gui
 namespace plugins
 {
   class IgnRendererPrivate;
+  class PoseLatency;
   class RenderWindowItemPrivate;
   class Scene3DPrivate;
 
@@ -61,6 +65,42 @@ namespace plugins
   ///                          (0.3, 0.3, 0.3, 1.0)
   /// * \<camera_pose\> : Optional starting pose for the camera, defaults to
   ///                     (0, 0, 5, 0, 0, 0)
+  /// * \<trails\> : Optional trails drawn behind models as they move:
+  ///   * \<entity\> : Name of a model, may be repeated.
+  ///   * \<capacity\> : Number of segments of each trail, defaults to 1000.
+  ///   * \<min_distance\> : Minimum distance between trail points, in
+  ///                        meters, defaults to 0.05.
+  ///   * \<min_interval\> : Minimum time between trail points, in seconds,
+  ///                        defaults to 0.
+  ///   * \<color\> : Color of the trails, defaults to white.
+  ///
+  /// ## Frames
+  ///
+  /// The models, links and visuals loaded from the scene service, and their
+  /// poses, are mirrored in the scene's FrameTree, available through
+  /// Application::Frames, so other plugins can get their world poses.
+  ///
+  /// ## Latency
+  ///
+  /// Pose messages whose header holds a publication time, set with
+  /// ignition::gui::stampPublishTime, are followed through the render
+  /// pipeline. The time from publication to each stage is reported through
+  /// Plugin::Latencies:
+  ///
+  /// * "pose_applied" : The pose was set on the visual in the render thread.
+  /// * "frame_rendered" : A frame including the pose was rendered.
+  /// * "pose_to_pixel" : That frame's texture was handed to the scene graph
+  ///                     to be displayed.
+  ///
+  /// Of the messages applied in the same frame, only the oldest and newest
+  /// are reported. Nothing is reported while the plugin is suspended, nor
+  /// for messages published before it resumed.
+  ///
+  /// Mouse events are reported too, from the time they're received on the
+  /// GUI thread:
+  ///
+  /// * "input_to_frame" : A frame was rendered after handling the event.
+  ///                      Coalesced events report their earliest time.
   class Scene3D : public Plugin
   {
     Q_OBJECT
@@ -75,11 +115,33 @@ namespace plugins
     public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem)
         override;
 
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<Scene3DPrivate> dataPtr;
   };
 
+  /// \brief How the trails of entities are sampled and drawn
+  struct TrailOptions
+  {
+    /// \brief Number of segments of each trail
+    std::size_t capacity{1000u};
+
+    /// \brief Minimum distance between trail points, in meters
+    double minDistance{0.05};
+
+    /// \brief Minimum time between trail points, in seconds
+    double minInterval{0.0};
+
+    /// \brief Color of the trails
+    math::Color color{math::Color::White};
+  };
+
   /// \brief Ign-rendering renderer.
   /// All ign-rendering calls should be performed inside this class as it makes
   /// sure that opengl calls in the underlying render engine do not interfere
@@ -103,14 +165,27 @@ namespace plugins
     /// \brief Destroy camera associated with this renderer
     public: void Destroy();
 
-    /// \brief New mouse event triggered
+    /// \brief New mouse event triggered. Events are queued without
+    /// locking and handled on the next frame, with consecutive moves and
+    /// scrolls coalesced. Must only be called from the GUI thread.
     /// \param[in] _e New mouse event
     /// \param[in] _drag Mouse move distance
     public: void NewMouseEvent(const common::MouseEvent &_e,
         const math::Vector2d &_drag = math::Vector2d::Zero);
 
-    /// \brief Handle mouse event for view control
-    private: void HandleMouseEvent();
+    /// \brief Queue mouse events which didn't fit when they were received.
+    /// Must only be called from the GUI thread, once per frame.
+    public: void FlushMouseEvents();
+
+    /// \brief Handle the mouse events received since the previous frame
+    /// for view control
+    private: void HandleMouseEvents();
+
+    /// \brief Handle a mouse event for view control
+    /// \param[in] _e Mouse event
+    /// \param[in] _drag Mouse move or scroll distance
+    private: void HandleMouseEvent(const common::MouseEvent &_e,
+        const math::Vector2d &_drag);
 
     /// \brief Retrieve the first point on a surface in the 3D scene hit by a
     /// ray cast from the given 2D screen coordinates.
@@ -155,6 +230,10 @@ namespace plugins
     /// topic to get pose updates of objects in the scene
     public: std::string poseTopic;
 
+    /// \brief Maximum rate at which pose messages are received, zero means
+    /// unlimited.
+    public: uint64_t poseTopicMaxRate = 0u;
+
     /// \brief Ign-transport deletion topic name
     public: std::string deletionTopic;
 
@@ -163,6 +242,16 @@ namespace plugins
     /// added
     public: std::string sceneTopic;
 
+    /// \brief Follows stamped poses through the render pipeline, shared with
+    /// the texture node.
+    public: std::shared_ptr<PoseLatency> poseLatency;
+
+    /// \brief Names of the models whose trails are drawn
+    public: std::vector<std::string> trailEntities;
+
+    /// \brief How trails are sampled and drawn
+    public: TrailOptions trailOptions;
+
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<IgnRendererPrivate> dataPtr;
@@ -185,6 +274,12 @@ namespace plugins
     /// \brief Slot called to update render texture size
     public slots: void SizeChanged();
 
+    /// \brief Stop or restart the render loop. While suspended, frames are
+    /// not rendered and the loop stalls until resumed. Can be called from any
+    /// thread.
+    /// \param[in] _suspended True to suspend.
+    public: void SetSuspended(const bool _suspended);
+
     /// \brief Signal to indicate that a frame has been rendered and ready
     /// to be displayed
     /// \param[in] _id GLuid of the opengl texture
@@ -199,6 +294,16 @@ namespace plugins
 
     /// \brief Ign-rendering renderer
     public: IgnRenderer ignRenderer;
+
+    /// \brief Protects suspended and stalled
+    private: std::mutex suspendMutex;
+
+    /// \brief True while rendering is suspended
+    private: bool suspended = false;
+
+    /// \brief True if a frame was skipped because of suspension, which
+    /// means the render loop must be restarted on resume
+    private: bool stalled = false;
   };
 
 
@@ -246,6 +351,10 @@ namespace plugins
     /// \param[in] _topic Pose topic
     public: void SetPoseTopic(const std::string &_topic);
 
+    /// \brief Set the maximum rate at which pose messages are received
+    /// \param[in] _rate Maximum messages per second, zero for unlimited.
+    public: void SetPoseTopicMaxRate(const uint64_t _rate);
+
     /// \brief Set deletion topic to use for deleting objects from the scene
     /// The renderer will subscribe to this topic to get notified when entities
     /// in the scene get deleted
@@ -257,6 +366,24 @@ namespace plugins
     /// \param[in] _topic Scene topic
     public: void SetSceneTopic(const std::string &_topic);
 
+    /// \brief Set the models whose trails are drawn
+    /// \param[in] _entities Names of the models
+    /// \param[in] _options How trails are sampled and drawn
+    public: void SetTrails(const std::vector<std::string> &_entities,
+        const TrailOptions &_options);
+
+    /// \brief Set the function which receives pose latencies. It's called
+    /// from the render and scene graph threads.
+    /// \param[in] _callback Function taking the stage name and latency, null
+    /// to stop reporting.
+    public: void SetLatencyCallback(std::function<void(const std::string &,
+        const std::chrono::steady_clock::duration &)> _callback);
+
+    /// \brief Stop or restart rendering, for example while the item can't
+    /// be seen.
+    /// \param[in] _suspended True to stop rendering.
+    public: void SetSuspended(const bool _suspended);
+
     /// \brief Slot called when thread is ready to be started
     public Q_SLOTS: void Ready();
 
@@ -330,6 +457,10 @@ namespace plugins
 
     /// \brief Qt quick window
     public: QQuickWindow *window = nullptr;
+
+    /// \brief Follows stamped poses through the render pipeline, shared with
+    /// the renderer.
+    public: std::shared_ptr<PoseLatency> poseLatency;
   };
 }
 }
@@ -15,6 +15,8 @@
  *
 */
 
+#include <algorithm>
+#include <deque>
 #include <iostream>
 #include <ignition/common/Console.hh>
 #include <ignition/plugin/Register.hh>
@@ -44,6 +46,21 @@ namespace plugins
     /// \brief Flag used to pause message parsing.
     public: bool paused{false};
 
+    /// \brief Topic being echoed while the echo button is checked, even if
+    /// the plugin is suspended and not subscribed. Empty otherwise.
+    public: std::string echoTopic;
+
+    /// \brief Memory held by the messages in msgList, in bytes.
+    public: uint64_t msgBytes{0u};
+
+    /// \brief Messages received but not yet added to msgList. Older
+    /// messages which wouldn't fit the buffer are dropped.
+    public: std::deque<QString> pending;
+
+    /// \brief Protects pending, which is filled from transport threads, and
+    /// buffer, which is written on the GUI thread.
+    public: std::mutex pendingMutex;
+
     /// \brief Mutex to protect message buffer.
     public: std::mutex mutex;
 
@@ -88,8 +105,11 @@ void TopicEcho::Stop()
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
   // Erase all previous messages
-  this->dataPtr->msgList.removeRows(0,
-      this->dataPtr->msgList.rowCount());
+  this->RemoveMsgs(this->dataPtr->msgList.rowCount());
+  {
+    std::lock_guard<std::mutex> pendingLock(this->dataPtr->pendingMutex);
+    this->dataPtr->pending.clear();
+  }
 
   // Unsubscribe
   for (auto const &sub : this->dataPtr->node.SubscribedTopics())
@@ -101,14 +121,42 @@ void TopicEcho::OnEcho(const bool _checked)
 {
   this->Stop();
 
-  if (!_checked)
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  auto topic = this->dataPtr->topic.toStdString();
+  this->dataPtr->echoTopic = _checked ? topic : std::string();
+  if (!_checked || this->Suspended())
     return;
 
+  // Subscribe to new topic
+  if (!this->dataPtr->node.Subscribe(topic, &TopicEcho::OnMessage, this,
+      this->SubscribeOptions(topic)))
+  {
+    ignerr << "Invalid topic [" << topic << "]" << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void TopicEcho::Suspend()
+{
   std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
 
-  // Subscribe to new topic
-  auto topic = this->dataPtr->topic.toStdString();
-  if (!this->dataPtr->node.Subscribe(topic, &TopicEcho::OnMessage, this))
+  // Keep the messages received so far, but stop formatting new ones
+  for (auto const &sub : this->dataPtr->node.SubscribedTopics())
+    this->dataPtr->node.Unsubscribe(sub);
+}
+
+/////////////////////////////////////////////////
+void TopicEcho::Resume()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  auto topic = this->dataPtr->echoTopic;
+  if (topic.empty())
+    return;
+
+  if (!this->dataPtr->node.Subscribe(topic, &TopicEcho::OnMessage, this,
+      this->SubscribeOptions(topic)))
   {
     ignerr << "Invalid topic [" << topic << "]" << std::endl;
   }
@@ -120,9 +168,25 @@ void TopicEcho::OnMessage(const google::protobuf::Message &_msg)
   if (this->dataPtr->paused)
     return;
 
-  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto msg = QString::fromStdString(_msg.DebugString());
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->pendingMutex);
+    this->dataPtr->pending.push_back(msg);
+    while (this->dataPtr->pending.size() > this->dataPtr->buffer)
+      this->dataPtr->pending.pop_front();
+  }
 
-  this->AddMsg(QString::fromStdString(_msg.DebugString()));
+  // A flood of messages is added in a single call
+  this->PostToGuiThread([this]()
+  {
+    std::deque<QString> pending;
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->pendingMutex);
+      std::swap(pending, this->dataPtr->pending);
+    }
+    for (const auto &msg : pending)
+      this->OnAddMsg(msg);
+  }, DeliveryLane::kBulk, "messages");
 }
 
 /////////////////////////////////////////////////
@@ -136,12 +200,57 @@ void TopicEcho::OnAddMsg(QString _msg)
     auto index = this->dataPtr->msgList.index(
         this->dataPtr->msgList.rowCount() - 1, 0);
     this->dataPtr->msgList.setData(index, _msg);
+    this->dataPtr->msgBytes += _msg.size() * sizeof(QChar);
   }
 
   // Remove items if the list is too long.
   auto diff = this->dataPtr->msgList.rowCount() -
       this->dataPtr->buffer;
-  this->dataPtr->msgList.removeRows(0, diff);
+  this->RemoveMsgs(diff);
+}
+
+/////////////////////////////////////////////////
+void TopicEcho::RemoveMsgs(const int _count)
+{
+  for (int i = 0; i < _count && i < this->dataPtr->msgList.rowCount(); ++i)
+  {
+    auto msg = this->dataPtr->msgList.data(this->dataPtr->msgList.index(i, 0))
+        .toString();
+    this->dataPtr->msgBytes -= msg.size() * sizeof(QChar);
+  }
+  if (_count > 0)
+    this->dataPtr->msgList.removeRows(0, _count);
+
+  this->SetMemoryUsage("messages", this->dataPtr->msgBytes);
+}
+
+/////////////////////////////////////////////////
+void TopicEcho::ShrinkMemory(const uint64_t _budget)
+{
+  int buffer;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+    // Drop the oldest messages and keep the buffer at the size that fits
+    int count{0};
+    uint64_t bytes = this->dataPtr->msgBytes;
+    while (bytes > _budget && count < this->dataPtr->msgList.rowCount() - 1)
+    {
+      auto msg = this->dataPtr->msgList.data(
+          this->dataPtr->msgList.index(count, 0)).toString();
+      bytes -= msg.size() * sizeof(QChar);
+      ++count;
+    }
+
+    this->RemoveMsgs(count);
+    buffer = std::max(1, this->dataPtr->msgList.rowCount());
+  }
+
+  ignwarn << "Reducing topic echo buffer to [" << buffer
+          << "] messages to stay within the memory budget." << std::endl;
+
+  // Updates the spin box
+  this->SetBuffer(buffer);
 }
 
 /////////////////////////////////////////////////
@@ -160,7 +269,26 @@ void TopicEcho::SetTopic(const QString &_topic)
 /////////////////////////////////////////////////
 void TopicEcho::OnBuffer(const unsigned int _buffer)
 {
-  this->dataPtr->buffer = _buffer;
+  this->SetBuffer(static_cast<int>(_buffer));
+}
+
+/////////////////////////////////////////////////
+int TopicEcho::Buffer() const
+{
+  return static_cast<int>(this->dataPtr->buffer);
+}
+
+/////////////////////////////////////////////////
+void TopicEcho::SetBuffer(const int _buffer)
+{
+  auto buffer = static_cast<unsigned int>(std::max(1, _buffer));
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->pendingMutex);
+    if (buffer == this->dataPtr->buffer)
+      return;
+    this->dataPtr->buffer = buffer;
+  }
+  this->BufferChanged();
 }
 
 /////////////////////////////////////////////////
@@ -54,6 +54,14 @@ namespace plugins
       NOTIFY TopicChanged
     )
 
+    /// \brief Maximum number of messages kept
+    Q_PROPERTY(
+      int buffer
+      READ Buffer
+      WRITE SetBuffer
+      NOTIFY BufferChanged
+    )
+
     /// \brief Paused
     Q_PROPERTY(
       bool paused
@@ -71,6 +79,15 @@ namespace plugins
     // Documentation inherited
     public: virtual void LoadConfig(const tinyxml2::XMLElement *_pluginElem);
 
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
+    // Documentation inherited
+    protected: void ShrinkMemory(const uint64_t _budget) override;
+
     /// \brief Get the topic as a string, for example
     /// '/echo'
     /// \return Topic
@@ -86,6 +103,18 @@ namespace plugins
 
     public slots: void OnBuffer(const unsigned int _steps);
 
+    /// \brief Get the maximum number of messages kept
+    /// \return Number of messages
+    public: Q_INVOKABLE int Buffer() const;
+
+    /// \brief Set the maximum number of messages kept
+    /// \param[in] _buffer Number of messages
+    public: Q_INVOKABLE void SetBuffer(const int _buffer);
+
+    /// \brief Notify that the buffer size has changed, such as when it's
+    /// reduced to stay within the memory budget
+    signals: void BufferChanged();
+
     /// \brief Get whether it is paused
     /// \return True if paused
     public: Q_INVOKABLE bool Paused() const;
@@ -115,6 +144,11 @@ namespace plugins
     /// \param[in] _msg Message to add to the list.
     private slots: void OnAddMsg(QString _msg);
 
+    /// \brief Remove the oldest messages from the list and report the
+    /// memory left. Must be called with the mutex locked.
+    /// \param[in] _count Number of messages to remove.
+    private: void RemoveMsgs(const int _count);
+
     /// \internal
     /// \brief Pointer to private data.
     private: std::unique_ptr<TopicEchoPrivate> dataPtr;
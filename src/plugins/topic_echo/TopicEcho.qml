@@ -64,9 +64,10 @@ Rectangle {
 
     SpinBox {
       id: bufferField
-      value: 10
-      onValueChanged: {
-        TopicEcho.OnBuffer(value)
+      from: 1
+      value: TopicEcho.buffer
+      onValueModified: {
+        TopicEcho.SetBuffer(value)
       }
     }
 
@@ -15,6 +15,8 @@
  *
 */
 
+#include <chrono>
+
 #include <ignition/common/Console.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/common/Time.hh>
@@ -41,11 +43,26 @@ namespace plugins
     /// \brief Communication node
     public: ignition::transport::Node node;
 
+    /// \brief World statistics topic, used to keep the play / pause state
+    /// in sync
+    public: std::string statsTopic;
+
     /// \brief The multi step value
     public: unsigned int multiStep = 1u;
 
     /// \brief True for paused
     public: bool pause{true};
+
+    /// \brief When play or pause was last pressed
+    public: std::chrono::steady_clock::time_point pressTime;
+
+    /// \brief Check the world's reply to a button press, and log how long
+    /// it took from the press to the world confirming the new state.
+    /// \param[in] _state New state, such as "playing".
+    /// \param[in] _status Status of the request.
+    /// \return True if the world confirmed the new state.
+    public: bool Confirm(const std::string &_state,
+        const RequestStatus _status) const;
   };
 }
 }
@@ -55,6 +72,26 @@ using namespace ignition;
 using namespace gui;
 using namespace plugins;
 
+/////////////////////////////////////////////////
+bool WorldControlPrivate::Confirm(const std::string &_state,
+    const RequestStatus _status) const
+{
+  if (_status != RequestStatus::kOk)
+  {
+    ignwarn << "World not " << _state << ", request to ["
+            << this->controlService << "] "
+            << (_status == RequestStatus::kTimedOut ? "timed out." : "failed.")
+            << std::endl;
+    return false;
+  }
+
+  auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - this->pressTime);
+  igndbg << "World " << _state << " [" << latency.count() / 1000.0
+         << "] ms after the button was pressed." << std::endl;
+  return true;
+}
+
 /////////////////////////////////////////////////
 WorldControl::WorldControl()
   : Plugin(), dataPtr(new WorldControlPrivate)
@@ -123,7 +160,7 @@ void WorldControl::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
   }
 
   // Subscribe to world stats
-  std::string statsTopic;
+  auto &statsTopic = this->dataPtr->statsTopic;
   auto statsTopicElem = _pluginElem->FirstChildElement("stats_topic");
   if (nullptr != statsTopicElem && nullptr != statsTopicElem->GetText())
     statsTopic = statsTopicElem->GetText();
@@ -132,13 +169,37 @@ void WorldControl::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
   {
     // Subscribe to world_stats
     if (!this->dataPtr->node.Subscribe(statsTopic,
-        &WorldControl::OnWorldStatsMsg, this))
+        &WorldControl::OnWorldStatsMsg, this,
+        this->SubscribeOptions(statsTopic)))
     {
       ignerr << "Failed to subscribe to [" << statsTopic << "]" << std::endl;
     }
   }
 }
 
+/////////////////////////////////////////////////
+void WorldControl::Suspend()
+{
+  if (!this->dataPtr->statsTopic.empty())
+    this->dataPtr->node.Unsubscribe(this->dataPtr->statsTopic);
+}
+
+/////////////////////////////////////////////////
+void WorldControl::Resume()
+{
+  if (this->dataPtr->statsTopic.empty())
+    return;
+
+  // The play / pause state will be synced on the next message
+  if (!this->dataPtr->node.Subscribe(this->dataPtr->statsTopic,
+      &WorldControl::OnWorldStatsMsg, this,
+      this->SubscribeOptions(this->dataPtr->statsTopic)))
+  {
+    ignerr << "Failed to subscribe to [" << this->dataPtr->statsTopic << "]"
+           << std::endl;
+  }
+}
+
 /////////////////////////////////////////////////
 void WorldControl::ProcessMsg()
 {
@@ -157,39 +218,45 @@ void WorldControl::OnWorldStatsMsg(const ignition::msgs::WorldStatistics &_msg)
   std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
 
   this->dataPtr->msg.CopyFrom(_msg);
-  QMetaObject::invokeMethod(this, "ProcessMsg");
+
+  // The play / pause state is what the user is waiting on, don't let it
+  // queue behind other plugins' data
+  this->PostToGuiThread([this]() {this->ProcessMsg();},
+      DeliveryLane::kControl);
 }
 
 /////////////////////////////////////////////////
 void WorldControl::OnPlay()
 {
-  std::function<void(const ignition::msgs::Boolean &, const bool)> cb =
-      [this](const ignition::msgs::Boolean &/*_rep*/, const bool _result)
-  {
-    if (_result)
-      QMetaObject::invokeMethod(this, "playing");
-  };
-
   ignition::msgs::WorldControl req;
   req.set_pause(false);
   this->dataPtr->pause = false;
-  this->dataPtr->node.Request(this->dataPtr->controlService, req, cb);
+  this->dataPtr->pressTime = std::chrono::steady_clock::now();
+
+  this->Request<msgs::Boolean>(this->dataPtr->node,
+      this->dataPtr->controlService, req).Then(
+      [this](const msgs::Boolean &, const RequestStatus _status)
+      {
+        if (this->dataPtr->Confirm("playing", _status))
+          this->playing();
+      });
 }
 
 /////////////////////////////////////////////////
 void WorldControl::OnPause()
 {
-  std::function<void(const ignition::msgs::Boolean &, const bool)> cb =
-      [this](const ignition::msgs::Boolean &/*_rep*/, const bool _result)
-  {
-    if (_result)
-      QMetaObject::invokeMethod(this, "paused");
-  };
-
   ignition::msgs::WorldControl req;
   req.set_pause(true);
   this->dataPtr->pause = true;
-  this->dataPtr->node.Request(this->dataPtr->controlService, req, cb);
+  this->dataPtr->pressTime = std::chrono::steady_clock::now();
+
+  this->Request<msgs::Boolean>(this->dataPtr->node,
+      this->dataPtr->controlService, req).Then(
+      [this](const msgs::Boolean &, const RequestStatus _status)
+      {
+        if (this->dataPtr->Confirm("paused", _status))
+          this->paused();
+      });
 }
 
 /////////////////////////////////////////////////
@@ -201,15 +268,20 @@ void WorldControl::OnStepCount(const unsigned int _steps)
 /////////////////////////////////////////////////
 void WorldControl::OnStep()
 {
-  std::function<void(const ignition::msgs::Boolean &, const bool)> cb =
-      [](const ignition::msgs::Boolean &/*_rep*/, const bool /*_result*/)
-  {
-  };
-
   ignition::msgs::WorldControl req;
   req.set_pause(this->dataPtr->pause);
   req.set_multi_step(this->dataPtr->multiStep);
-  this->dataPtr->node.Request(this->dataPtr->controlService, req, cb);
+
+  this->Request<msgs::Boolean>(this->dataPtr->node,
+      this->dataPtr->controlService, req).Then(
+      [this](const msgs::Boolean &, const RequestStatus _status)
+      {
+        if (_status != RequestStatus::kOk)
+        {
+          ignwarn << "Failed to step world through ["
+                  << this->dataPtr->controlService << "]" << std::endl;
+        }
+      });
 }
 
 // Register this plugin
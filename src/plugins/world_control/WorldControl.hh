@@ -66,6 +66,12 @@ namespace plugins
     // Documentation inherited
     public: void LoadConfig(const tinyxml2::XMLElement *_pluginElem);
 
+    // Documentation inherited
+    protected: void Suspend() override;
+
+    // Documentation inherited
+    protected: void Resume() override;
+
     /// \brief Callback in main thread when diagnostics come in
     public slots: void ProcessMsg();
 
@@ -38,6 +38,9 @@ namespace plugins
     /// \brief Communication node
     public: ignition::transport::Node node;
 
+    /// \brief World statistics topic
+    public: std::string topic;
+
     /// \brief Holds real time factor
     public: QString realTimeFactor;
 
@@ -84,7 +87,7 @@ void WorldStats::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
   }
 
   // Subscribe
-  std::string topic;
+  auto &topic = this->dataPtr->topic;
   auto topicElem = _pluginElem->FirstChildElement("topic");
   if (nullptr != topicElem && nullptr != topicElem->GetText())
     topic = topicElem->GetText();
@@ -97,7 +100,7 @@ void WorldStats::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
   }
 
   if (!this->dataPtr->node.Subscribe(topic, &WorldStats::OnWorldStatsMsg,
-      this))
+      this, this->SubscribeOptions(topic)))
   {
     ignerr << "Failed to subscribe to [" << topic << "]" << std::endl;
     return;
@@ -146,6 +149,28 @@ void WorldStats::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
   }
 }
 
+/////////////////////////////////////////////////
+void WorldStats::Suspend()
+{
+  if (!this->dataPtr->topic.empty())
+    this->dataPtr->node.Unsubscribe(this->dataPtr->topic);
+}
+
+/////////////////////////////////////////////////
+void WorldStats::Resume()
+{
+  if (this->dataPtr->topic.empty())
+    return;
+
+  if (!this->dataPtr->node.Subscribe(this->dataPtr->topic,
+      &WorldStats::OnWorldStatsMsg, this,
+      this->SubscribeOptions(this->dataPtr->topic)))
+  {
+    ignerr << "Failed to subscribe to [" << this->dataPtr->topic << "]"
+           << std::endl;
+  }
+}
+
 /////////////////////////////////////////////////
 void WorldStats::ProcessMsg()
 {
@@ -186,7 +211,10 @@ void WorldStats::OnWorldStatsMsg(const ignition::msgs::WorldStatistics &_msg)
   std::lock_guard<std::recursive_mutex> lock(this->dataPtr->mutex);
 
   this->dataPtr->msg.CopyFrom(_msg);
-  QMetaObject::invokeMethod(this, "ProcessMsg");
+
+  // Keep the clock moving even while other plugins are flooded with data
+  this->PostToGuiThread([this]() {this->ProcessMsg();},
+      DeliveryLane::kControl);
 }
 
 /////////////////////////////////////////////////
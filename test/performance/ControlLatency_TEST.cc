@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/GuiDispatcher.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/// \brief How long each run lasts
+static const std::chrono::seconds kDuration{3};
+
+/// \brief Time between images, faster than the GUI thread can handle them
+static const std::chrono::milliseconds kImagePeriod{2};
+
+/// \brief GUI thread time spent handling each image
+static const std::chrono::milliseconds kImageCost{4};
+
+/// \brief Time between simulated button presses
+static const std::chrono::milliseconds kPressPeriod{50};
+
+/////////////////////////////////////////////////
+/// \brief Keep the current thread busy, like an image upload would
+/// \param[in] _duration How long to spin
+void spin(const std::chrono::steady_clock::duration &_duration)
+{
+  auto end = std::chrono::steady_clock::now() + _duration;
+  while (std::chrono::steady_clock::now() < end)
+  {
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Flood the GUI thread with images while replies to button presses
+/// arrive, and measure how long each reply takes to change the state.
+/// \param[in] _lanes True to use the dispatcher's lanes, false to queue
+/// everything with QMetaObject::invokeMethod
+/// \return Latency of each press, in milliseconds, sorted
+std::vector<double> run(const bool _lanes)
+{
+  auto dispatcher = App()->Dispatcher();
+
+  QObject context;
+  std::vector<double> latencies;
+  std::atomic<bool> stop{false};
+
+  // Camera, from a transport thread
+  std::thread images([&]()
+  {
+    while (!stop)
+    {
+      auto display = [] {spin(kImageCost);};
+      if (_lanes)
+        dispatcher->Post(&context, display, DeliveryLane::kBulk, "image");
+      else
+        QMetaObject::invokeMethod(&context, display, Qt::QueuedConnection);
+      std::this_thread::sleep_for(kImagePeriod);
+    }
+  });
+
+  // Service replies to play / pause, from another transport thread
+  std::thread replies([&]()
+  {
+    while (!stop)
+    {
+      auto pressed = std::chrono::steady_clock::now();
+      auto changeState = [&latencies, pressed]
+      {
+        latencies.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - pressed).count());
+      };
+      if (_lanes)
+        dispatcher->Post(&context, changeState, DeliveryLane::kControl);
+      else
+        QMetaObject::invokeMethod(&context, changeState, Qt::QueuedConnection);
+      std::this_thread::sleep_for(kPressPeriod);
+    }
+  });
+
+  auto end = std::chrono::steady_clock::now() + kDuration;
+  while (std::chrono::steady_clock::now() < end)
+    QCoreApplication::processEvents();
+
+  stop = true;
+  images.join();
+  replies.join();
+
+  // Drop whatever is still queued
+  dispatcher->Cancel(&context);
+  QCoreApplication::removePostedEvents(&context);
+
+  std::sort(latencies.begin(), latencies.end());
+  return latencies;
+}
+
+/////////////////////////////////////////////////
+/// \brief Print latencies
+/// \param[in] _name Name of the run
+/// \param[in] _latencies Sorted latencies, in milliseconds
+void print(const std::string &_name, const std::vector<double> &_latencies)
+{
+  auto percentile = [&_latencies](const double _p)
+  {
+    if (_latencies.empty())
+      return 0.0;
+    return _latencies[static_cast<std::size_t>(_p * (_latencies.size() - 1))];
+  };
+
+  std::cout << std::fixed << std::setprecision(1)
+            << std::setw(8) << _name
+            << "  presses " << std::setw(4) << _latencies.size()
+            << "  press to state p50 " << std::setw(8) << percentile(0.5)
+            << " ms  p99 " << std::setw(8) << percentile(0.99)
+            << " ms  max " << std::setw(8) << percentile(1.0) << " ms"
+            << std::endl;
+}
+
+/////////////////////////////////////////////////
+TEST(ControlLatencyTest, UnderImageLoad)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv, WindowType::kHeadless);
+  ASSERT_NE(nullptr, app.Dispatcher());
+
+  std::cout << "Images every " << kImagePeriod.count() << " ms costing "
+            << kImageCost.count() << " ms each, presses every "
+            << kPressPeriod.count() << " ms" << std::endl;
+
+  auto queued = run(false);
+  print("queued", queued);
+
+  auto lanes = run(true);
+  print("lanes", lanes);
+
+  auto bulk = app.Dispatcher()->Stats(DeliveryLane::kBulk);
+  std::cout << "Bulk calls run " << bulk.count << ", coalesced "
+            << bulk.coalesced << std::endl;
+
+  ASSERT_FALSE(queued.empty());
+  ASSERT_FALSE(lanes.empty());
+
+  // Queued replies wait behind a backlog which keeps growing
+  EXPECT_LT(lanes[lanes.size() / 2], queued[queued.size() / 2]);
+}
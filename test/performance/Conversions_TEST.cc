@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/msgs/pose_v.pb.h>
+#include <ignition/msgs/Utility.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Conversions.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/// \brief Number of times each conversion is repeated
+static const int kRepetitions{200};
+
+/////////////////////////////////////////////////
+/// \brief Time a conversion, taking the fastest of several repetitions so
+/// that warming up and preemption don't count.
+/// \param[in] _count Number of elements converted on each call.
+/// \param[in] _func Conversion.
+/// \return Nanoseconds per element.
+double nsPerElement(const int _count, const std::function<void()> &_func)
+{
+  double fastest{0.0};
+  for (int i = 0; i < kRepetitions; ++i)
+  {
+    auto start = std::chrono::steady_clock::now();
+    _func();
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    fastest = i == 0 ? ns : std::min(fastest, ns);
+  }
+  return fastest / _count;
+}
+
+/////////////////////////////////////////////////
+/// \brief Print a row of results
+/// \param[in] _name What was converted.
+/// \param[in] _single Nanoseconds per element, one at a time.
+/// \param[in] _bulk Nanoseconds per element, in bulk.
+void print(const std::string &_name, const double _single,
+    const double _bulk)
+{
+  std::cout << std::fixed << std::setprecision(2)
+            << std::setw(12) << _name << std::setw(14) << _single
+            << std::setw(14) << _bulk << std::endl;
+}
+
+/////////////////////////////////////////////////
+TEST(ConversionsTest, Bulk)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  std::cout << std::setw(12) << "ns/element" << std::setw(14) << "single"
+            << std::setw(14) << "bulk" << std::endl;
+
+  // Poses, like the ones Scene3D receives for every update
+  {
+    const int count{10000};
+    msgs::Pose_V msg;
+    for (int i = 0; i < count; ++i)
+      msgs::Set(msg.add_pose(), math::Pose3d(i, -i, 0.5 * i, 0.1, 0.2, 0.3));
+
+    std::vector<math::Pose3d> poses(count);
+    auto single = nsPerElement(count, [&]()
+    {
+      for (int i = 0; i < msg.pose_size(); ++i)
+        poses[i] = msgs::Convert(msg.pose(i));
+    });
+
+    std::vector<double> data;
+    auto bulk = nsPerElement(count, [&]()
+    {
+      convert(msg.pose(), data);
+    });
+    print("pose", single, bulk);
+
+    ASSERT_EQ(count * 7u, data.size());
+    EXPECT_DOUBLE_EQ(poses.back().Pos().X(), data[(count - 1) * 7]);
+    EXPECT_LT(bulk, single * 2.0);
+  }
+
+  // Points, like the ones of a marker
+  {
+    const int count{100000};
+    google::protobuf::RepeatedPtrField<msgs::Vector3d> points;
+    for (int i = 0; i < count; ++i)
+      msgs::Set(points.Add(), math::Vector3d(i, 2 * i, 3 * i));
+
+    std::vector<math::Vector3d> vectors(count);
+    auto single = nsPerElement(count, [&]()
+    {
+      for (int i = 0; i < points.size(); ++i)
+        vectors[i] = msgs::Convert(points.Get(i));
+    });
+
+    std::vector<float> data;
+    auto bulk = nsPerElement(count, [&]()
+    {
+      convert(points, data);
+    });
+    print("point", single, bulk);
+
+    ASSERT_EQ(count * 3u, data.size());
+    EXPECT_LT(bulk, single * 2.0);
+  }
+
+  // Ranges, like the ones of a laser scan
+  {
+    const int count{100000};
+    google::protobuf::RepeatedField<double> ranges;
+    for (int i = 0; i < count; ++i)
+      ranges.Add(i * 0.001);
+
+    std::vector<float> scalar(count);
+    auto single = nsPerElement(count, [&]()
+    {
+      for (int i = 0; i < ranges.size(); ++i)
+        scalar[i] = static_cast<float>(ranges.Get(i));
+    });
+
+    std::vector<float> data;
+    auto bulk = nsPerElement(count, [&]()
+    {
+      convert(ranges, data);
+    });
+    print("range", single, bulk);
+
+    EXPECT_EQ(scalar, data);
+    EXPECT_LT(bulk, single * 2.0);
+  }
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/msgs/image.pb.h>
+#include <ignition/transport/Node.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/SharedImage.hh"
+#include "ignition/gui/SharedRing.hh"
+
+using namespace ignition;
+using namespace gui;
+
+/// \brief Image width
+static const unsigned int kWidth{1920u};
+
+/// \brief Image height
+static const unsigned int kHeight{1080u};
+
+/// \brief Number of images published
+static const unsigned int kImageCount{300u};
+
+/// \brief Time between images
+static const std::chrono::milliseconds kPeriod{16};
+
+/// \brief Results of one run
+struct Results
+{
+  /// \brief Latency of each image received, from publication to having the
+  /// pixels available, in microseconds
+  std::vector<double> latencies;
+
+  /// \brief CPU time of the subscriber, in seconds
+  double subscriberCpu{0.0};
+
+  /// \brief CPU time of the publisher, in seconds
+  double publisherCpu{0.0};
+};
+
+#ifndef _WIN32
+/////////////////////////////////////////////////
+/// \brief Get the CPU time used so far
+/// \param[in] _who RUSAGE_SELF or RUSAGE_CHILDREN
+/// \return User and system time, in seconds
+double cpuTime(const int _who)
+{
+  rusage usage;
+  getrusage(_who, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+      (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+/////////////////////////////////////////////////
+/// \brief Publish images from the current process
+/// \param[in] _topic Topic to publish on
+/// \param[in] _shared True to publish through shared memory
+void publish(const std::string &_topic, const bool _shared)
+{
+  msgs::Image msg;
+  msg.set_width(kWidth);
+  msg.set_height(kHeight);
+  msg.set_step(kWidth * 3);
+  msg.set_pixel_format_type(msgs::PixelFormatType::RGB_INT8);
+  msg.mutable_data()->assign(kWidth * kHeight * 3, '\x80');
+
+  transport::Node node;
+  transport::Node::Publisher pub;
+  SharedImagePublisher sharedPub;
+  if (_shared)
+    sharedPub.Advertise(_topic, msg.data().size());
+  else
+    pub = node.Advertise<msgs::Image>(_topic);
+
+  // Wait for discovery
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  for (unsigned int i = 0; i < kImageCount; ++i)
+  {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    auto sec = std::chrono::duration_cast<std::chrono::seconds>(now);
+    auto stamp = msg.mutable_header()->mutable_stamp();
+    stamp->set_sec(sec.count());
+    stamp->set_nsec(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        now - sec).count());
+
+    if (_shared)
+      sharedPub.Publish(msg);
+    else
+      pub.Publish(msg);
+
+    std::this_thread::sleep_for(kPeriod);
+  }
+
+  // Let the subscriber catch up before the ring goes away
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the topic of a run
+/// \param[in] _shared True to publish through shared memory
+/// \return Topic name
+std::string topicName(const bool _shared)
+{
+  return std::string("/image_transport_benchmark_") +
+      (_shared ? "shared" : "regular");
+}
+
+/// \brief Child process which publishes images once told to
+struct Publisher
+{
+  /// \brief Process id
+  pid_t pid{-1};
+
+  /// \brief Writing to it starts publishing
+  int startFd{-1};
+};
+
+/////////////////////////////////////////////////
+/// \brief Fork a child process which publishes images once started. Forking
+/// is only safe before any transport object exists in this process, since
+/// the child wouldn't get transport's threads, so all publishers are forked
+/// first.
+/// \param[in] _shared True to publish through shared memory
+/// \return The publisher
+Publisher forkPublisher(const bool _shared)
+{
+  Publisher publisher;
+  int fds[2];
+  if (pipe(fds) != 0)
+    return publisher;
+
+  publisher.pid = fork();
+  if (publisher.pid == 0)
+  {
+    close(fds[1]);
+    char start;
+    if (read(fds[0], &start, 1) == 1)
+      publish(topicName(_shared), _shared);
+    _exit(0);
+  }
+
+  close(fds[0]);
+  publisher.startFd = fds[1];
+  return publisher;
+}
+
+/////////////////////////////////////////////////
+/// \brief Receive images published by a child process
+/// \param[in] _shared True if published through shared memory
+/// \param[in] _publisher Publisher, which is started and waited for
+/// \return Results
+Results run(const bool _shared, const Publisher &_publisher)
+{
+  auto topic = topicName(_shared);
+
+  Results results;
+  std::mutex mutex;
+  SharedRing ring;
+
+  auto cb = [&](const msgs::Image &_msg)
+  {
+    const char *pixels{nullptr};
+    std::size_t size{0u};
+
+    auto key = SharedImageKey(_msg);
+    if (key.empty())
+    {
+      pixels = _msg.data().data();
+      size = _msg.data().size();
+    }
+    else
+    {
+      if (!ring.Valid() && !ring.Attach(key))
+        return;
+
+      auto slot = static_cast<const char *>(ring.BeginRead(size, true));
+      if (!slot)
+        return;
+      pixels = slot + sizeof(SharedImageHeader);
+      size -= sizeof(SharedImageHeader);
+    }
+
+    // Touch the pixels, as a display would
+    volatile char sink = pixels[0] ^ pixels[size - 1];
+    static_cast<void>(sink);
+
+    if (!key.empty())
+      ring.EndRead();
+
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    auto stamp = std::chrono::seconds(_msg.header().stamp().sec()) +
+        std::chrono::nanoseconds(_msg.header().stamp().nsec());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    results.latencies.push_back(
+        std::chrono::duration<double, std::micro>(now - stamp).count());
+  };
+
+  auto subscriberStart = cpuTime(RUSAGE_SELF);
+  auto publisherStart = cpuTime(RUSAGE_CHILDREN);
+
+  {
+    transport::Node node;
+    node.Subscribe<msgs::Image>(topic, cb);
+
+    char start{1};
+    if (write(_publisher.startFd, &start, 1) != 1)
+      ignerr << "Failed to start publisher" << std::endl;
+    close(_publisher.startFd);
+
+    int status;
+    waitpid(_publisher.pid, &status, 0);
+  }
+
+  results.subscriberCpu = cpuTime(RUSAGE_SELF) - subscriberStart;
+  results.publisherCpu = cpuTime(RUSAGE_CHILDREN) - publisherStart;
+
+  return results;
+}
+
+/////////////////////////////////////////////////
+/// \brief Print results
+/// \param[in] _name Name of the run
+/// \param[in] _results Results
+void print(const std::string &_name, Results &_results)
+{
+  auto &latencies = _results.latencies;
+  std::sort(latencies.begin(), latencies.end());
+
+  auto percentile = [&latencies](const double _p)
+  {
+    if (latencies.empty())
+      return 0.0;
+    return latencies[static_cast<std::size_t>(_p * (latencies.size() - 1))];
+  };
+
+  std::cout << std::fixed << std::setprecision(1)
+            << std::setw(10) << _name
+            << " received " << std::setw(4) << latencies.size()
+            << "/" << kImageCount
+            << "  latency p50 " << std::setw(8) << percentile(0.5) << " us"
+            << "  p99 " << std::setw(8) << percentile(0.99) << " us"
+            << "  CPU publisher " << std::setw(6)
+            << _results.publisherCpu * 1e3 << " ms"
+            << "  subscriber " << std::setw(6)
+            << _results.subscriberCpu * 1e3 << " ms" << std::endl;
+}
+
+/////////////////////////////////////////////////
+TEST(ImageTransportTest, RegularVersusShared)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  std::cout << kImageCount << " RGB images of " << kWidth << "x" << kHeight
+            << " published every " << kPeriod.count() << " ms" << std::endl;
+
+  auto regularPublisher = forkPublisher(false);
+  auto sharedPublisher = forkPublisher(true);
+  ASSERT_GT(regularPublisher.pid, 0);
+  ASSERT_GT(sharedPublisher.pid, 0);
+
+  auto regular = run(false, regularPublisher);
+  print("regular", regular);
+
+  auto shared = run(true, sharedPublisher);
+  print("shared", shared);
+
+  EXPECT_FALSE(regular.latencies.empty());
+  EXPECT_FALSE(shared.latencies.empty());
+}
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Benchmark.hh"
+#include "ignition/gui/MainWindow.hh"
+#include "ignition/gui/Plugin.hh"
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+using namespace ignition;
+using namespace gui;
+
+/////////////////////////////////////////////////
+TEST(PluginFramesTest, ExampleConfig)
+{
+  ignition::common::Console::SetVerbosity(3);
+
+  // No display or GPU needed
+  useOffscreenPlatform();
+
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+  ASSERT_NE(nullptr, app.findChild<MainWindow *>());
+
+  Benchmark benchmark;
+  ASSERT_TRUE(benchmark.Load(std::string(PROJECT_SOURCE_PATH) +
+      "/examples/config/benchmark.config"));
+
+  auto report = benchmark.Run();
+  std::cout << benchmarkReportText(report);
+
+  EXPECT_EQ(benchmark.Frames(), report.frames);
+
+  // 30 Hz and 60 Hz over 600 frames of 16 ms
+  EXPECT_EQ(288u, report.published["/benchmark/camera"]);
+  EXPECT_EQ(576u, report.published["/benchmark/stats"]);
+  EXPECT_EQ(2u, report.plugins.size());
+}
+
+/////////////////////////////////////////////////
+/// \brief Run a benchmark config offscreen
+/// \param[in] _config Config file name, in the examples' config directory
+/// \param[out] _suspended Number of plugins suspended at the end
+/// \return Report
+BenchmarkReport runConfig(const std::string &_config,
+    unsigned int &_suspended)
+{
+  Application app(g_argc, g_argv);
+  app.AddPluginPath(std::string(PROJECT_BINARY_PATH) + "/lib");
+
+  Benchmark benchmark;
+  EXPECT_TRUE(benchmark.Load(std::string(PROJECT_SOURCE_PATH) +
+      "/examples/config/" + _config));
+
+  auto report = benchmark.Run();
+  std::cout << _config << std::endl << benchmarkReportText(report);
+
+  _suspended = 0u;
+  for (auto plugin : app.findChildren<Plugin *>())
+  {
+    if (plugin->Suspended())
+      ++_suspended;
+  }
+  return report;
+}
+
+/////////////////////////////////////////////////
+TEST(PluginFramesTest, HiddenCards)
+{
+  ignition::common::Console::SetVerbosity(3);
+
+  useOffscreenPlatform();
+
+  unsigned int suspended{0u};
+  auto visible = runConfig("benchmark.config", suspended);
+  EXPECT_EQ(0u, suspended);
+
+  auto hidden = runConfig("benchmark_hidden.config", suspended);
+  EXPECT_EQ(2u, suspended);
+
+  // Both get the same messages
+  EXPECT_EQ(visible.published, hidden.published);
+
+  auto toMs = [](const std::chrono::steady_clock::duration &_duration)
+  {
+    return std::chrono::duration<double, std::milli>(_duration).count();
+  };
+  std::cout << "CPU time with cards visible " << toMs(visible.cpuTime)
+            << " ms, hidden " << toMs(hidden.cpuTime) << " ms" << std::endl;
+}
@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+
+#include "test_config.h"  // NOLINT(build/include)
+#include "ignition/gui/Application.hh"
+#include "ignition/gui/Enums.hh"
+#include "ignition/gui/SearchModel.hh"
+
+using namespace ignition;
+using namespace gui;
+
+int g_argc = 1;
+char **g_argv = new char *[g_argc];
+
+/// \brief Searches typed one keystroke at a time
+static const std::vector<QString> kKeystrokes{
+    "m", "mo", "mod", "model", "model_1", "model_12", "model_12 ",
+    "model_12 l", "model_12 li", "model_12 link_3"};
+
+/// \brief Filters like SearchModel did before it had an index, by walking
+/// the tree for each row.
+class WalkingSearchModel : public SearchModel
+{
+  // Documentation inherited
+  public: bool filterAcceptsRow(const int _srcRow,
+      const QModelIndex &_srcParent) const override
+  {
+    auto id = this->sourceModel()->index(_srcRow, 0, _srcParent);
+    if (this->sourceModel()->data(id, DataRole::TYPE).toString() == "title")
+      return false;
+
+    this->SetExpand(id, false);
+
+    if (this->search.isEmpty())
+      return true;
+
+    for (auto word : this->search.split(" "))
+    {
+      if (word.isEmpty())
+        continue;
+
+      if (this->HasChildAcceptsItself(id, word))
+        this->SetExpand(id, true);
+
+      if (this->HasAcceptedChildren(_srcRow, _srcParent))
+        continue;
+
+      if (this->FilterAcceptsRowItself(_srcRow, _srcParent, word))
+        continue;
+
+      bool parentAccepted = false;
+      for (auto parent = _srcParent; parent.isValid();
+          parent = parent.parent())
+      {
+        if (this->FilterAcceptsRowItself(parent.row(), parent.parent(), word))
+        {
+          parentAccepted = true;
+          break;
+        }
+      }
+      if (parentAccepted)
+        continue;
+
+      return false;
+    }
+    return true;
+  }
+
+  /// \brief Check if row contains the word on itself.
+  /// \param[in] _srcRow Row on the source model.
+  /// \param[in] _srcParent Parent on the source model.
+  /// \param[in] _word Word to be checked.
+  /// \return True if row matches.
+  private: bool FilterAcceptsRowItself(const int _srcRow,
+      const QModelIndex &_srcParent, const QString &_word) const
+  {
+    auto id = this->sourceModel()->index(_srcRow, 0, _srcParent);
+
+    return (this->sourceModel()->data(id,
+        this->filterRole()).toString().contains(_word, Qt::CaseInsensitive));
+  }
+
+  /// \brief Check if any of the children accepts a specific word.
+  /// \param[in] _srcParent Parent on the source model.
+  /// \param[in] _word Word to be checked.
+  /// \return True if any of the children match.
+  private: bool HasChildAcceptsItself(const QModelIndex &_srcParent,
+      const QString &_word) const
+  {
+    for (int i = 0; i < this->sourceModel()->rowCount(_srcParent); ++i)
+    {
+      // Check immediate children.
+      if (this->FilterAcceptsRowItself(i, _srcParent, _word))
+        return true;
+
+      // Check grandchildren.
+      auto item = this->sourceModel()->index(i, 0, _srcParent);
+      if (this->HasChildAcceptsItself(item, _word))
+        return true;
+    }
+
+    return false;
+  }
+
+  /// \brief Set whether a row should be expanded
+  /// \param[in] _id Row on the source model
+  /// \param[in] _expand True to expand
+  private: void SetExpand(const QModelIndex &_id, const bool _expand) const
+  {
+    this->sourceModel()->blockSignals(true);
+    this->sourceModel()->setData(_id, _expand, DataRole::TO_EXPAND);
+    this->sourceModel()->blockSignals(false);
+  }
+};
+
+/////////////////////////////////////////////////
+/// \brief Build an entity tree, breadth first, with names which repeat at
+/// every level below the top one, like links and visuals do.
+/// \param[in] _size Number of rows.
+/// \param[in] _depth Number of levels.
+/// \return Model, owned by the caller.
+QStandardItemModel *buildTree(const int _size, const int _depth)
+{
+  auto model = new QStandardItemModel();
+
+  auto branching = std::max(2, static_cast<int>(
+      std::ceil(std::pow(_size, 1.0 / _depth))));
+
+  // Item and its level
+  std::queue<std::pair<QStandardItem *, int>> parents;
+  parents.emplace(model->invisibleRootItem(), 0);
+
+  int count{0};
+  while (count < _size && !parents.empty())
+  {
+    auto parent = parents.front();
+    parents.pop();
+
+    for (int i = 0; i < branching && count < _size; ++i, ++count)
+    {
+      auto item = new QStandardItem();
+      if (parent.second == 0)
+        item->setData(QString("model_%1").arg(count), DataRole::DISPLAY_NAME);
+      else
+        item->setData(QString("link_%1").arg(i), DataRole::DISPLAY_NAME);
+      parent.first->appendRow(item);
+
+      if (parent.second + 1 < _depth)
+        parents.emplace(item, parent.second + 1);
+    }
+  }
+
+  return model;
+}
+
+/////////////////////////////////////////////////
+/// \brief Count the rows shown by a view which expands rows as told.
+/// \param[in] _model Search model.
+/// \param[in] _index Parent index.
+/// \return Number of visible rows.
+int visibleRows(const QAbstractItemModel *_model,
+    const QModelIndex &_index = QModelIndex())
+{
+  int count{0};
+  for (int r = 0; r < _model->rowCount(_index); ++r)
+  {
+    ++count;
+    auto child = _model->index(r, 0, _index);
+    if (_model->data(child, DataRole::TO_EXPAND).toBool())
+      count += visibleRows(_model, child);
+  }
+  return count;
+}
+
+/////////////////////////////////////////////////
+/// \brief Type the keystrokes into a search model, refreshing the view
+/// after each one.
+/// \param[in] _searchModel Search model, its source model is set.
+/// \param[out] _visible Visible rows after the last keystroke.
+/// \return Slowest keystroke, in milliseconds.
+double type(SearchModel &_searchModel, int &_visible)
+{
+  double slowest{0.0};
+  for (const auto &keystroke : kKeystrokes)
+  {
+    auto start = std::chrono::steady_clock::now();
+
+    _searchModel.SetSearch(keystroke);
+    _visible = visibleRows(&_searchModel);
+
+    slowest = std::max(slowest, std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count());
+  }
+  _searchModel.SetSearch("");
+  return slowest;
+}
+
+/////////////////////////////////////////////////
+TEST(SearchModelTest, TreeSizesAndDepths)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  std::cout << std::fixed << std::setprecision(1)
+            << std::setw(8) << "rows" << std::setw(8) << "depth"
+            << std::setw(16) << "indexed ms" << std::setw(16) << "walking ms"
+            << std::endl;
+
+  for (auto size : {1000, 10000, 50000})
+  {
+    for (auto depth : {2, 6, 20})
+    {
+      auto sourceModel = buildTree(size, depth);
+
+      SearchModel searchModel;
+      searchModel.setFilterRole(DataRole::DISPLAY_NAME);
+      searchModel.setSourceModel(sourceModel);
+
+      int visible{0};
+      auto indexed = type(searchModel, visible);
+      EXPECT_EQ(size, searchModel.IndexedRowCount());
+
+      // The walking search takes too long on larger trees
+      std::cout << std::setw(8) << size << std::setw(8) << depth
+                << std::setw(16) << indexed;
+      if (size <= 1000)
+      {
+        WalkingSearchModel walkingModel;
+        walkingModel.setFilterRole(DataRole::DISPLAY_NAME);
+        walkingModel.setSourceModel(sourceModel);
+
+        int walkingVisible{0};
+        auto walking = type(walkingModel, walkingVisible);
+        std::cout << std::setw(16) << walking;
+
+        // Same results either way
+        EXPECT_EQ(walkingVisible, visible);
+      }
+      std::cout << std::endl;
+
+      // Typing stays interactive
+      EXPECT_LT(indexed, 1000.0) << size << " rows, depth " << depth;
+
+      delete sourceModel;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(SearchModelTest, Background)
+{
+  ignition::common::Console::SetVerbosity(4);
+
+  Application app(g_argc, g_argv);
+
+  std::cout << std::fixed << std::setprecision(1)
+            << std::setw(8) << "rows" << std::setw(16) << "blocked ms"
+            << std::setw(16) << "applied ms" << std::endl;
+
+  for (auto size : {10000, 50000})
+  {
+    // Reference result, searched on this thread
+    auto syncSourceModel = buildTree(size, 6);
+    SearchModel syncModel;
+    syncModel.SetBackgroundThreshold(0);
+    syncModel.setFilterRole(DataRole::DISPLAY_NAME);
+    syncModel.setSourceModel(syncSourceModel);
+    int syncVisible{0};
+    type(syncModel, syncVisible);
+
+    auto sourceModel = buildTree(size, 6);
+    SearchModel searchModel;
+    searchModel.SetBackgroundThreshold(1);
+    searchModel.setFilterRole(DataRole::DISPLAY_NAME);
+    searchModel.setSourceModel(sourceModel);
+
+    // Index built up front, like it would be by a previous search
+    searchModel.SetSearch("-");
+    while (searchModel.Searching())
+      QCoreApplication::processEvents();
+
+    // Typed faster than searches finish, the GUI thread only queues them
+    double blocked{0.0};
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &keystroke : kKeystrokes)
+    {
+      auto keyStart = std::chrono::steady_clock::now();
+      searchModel.SetSearch(keystroke);
+      QCoreApplication::processEvents();
+      blocked = std::max(blocked, std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - keyStart).count());
+    }
+
+    while (searchModel.Searching())
+    {
+      QCoreApplication::processEvents();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto applied = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::setw(8) << size << std::setw(16) << blocked
+              << std::setw(16) << applied << std::endl;
+
+    // Same result as searching on this thread
+    EXPECT_EQ(syncVisible, visibleRows(&searchModel));
+
+    // Typing doesn't wait on the search, only on applying results
+    EXPECT_LT(blocked, 250.0) << size << " rows";
+
+    delete sourceModel;
+    delete syncSourceModel;
+  }
+}
@@ -15,9 +15,13 @@
  *
 */
 
+#include <chrono>
+
 #include <ignition/common/Console.hh>
 #include <ignition/plugin/Register.hh>
 
+#include <ignition/gui/SharedRing.hh>
+
 #include "TestPlugin.hh"
 
 using namespace ignition;
@@ -34,6 +38,71 @@ TestPlugin::~TestPlugin()
 {
 }
 
+/////////////////////////////////////////////////
+void TestPlugin::ReportMemory(const QString &_category, const int _bytes)
+{
+  this->SetMemoryUsage(_category.toStdString(), _bytes);
+}
+
+/////////////////////////////////////////////////
+void TestPlugin::ReportLatency(const QString &_stage, const int _ms)
+{
+  this->RecordLatency(_stage.toStdString(), std::chrono::milliseconds(_ms));
+}
+
+/////////////////////////////////////////////////
+int TestPlugin::ShrinkBudget() const
+{
+  return this->shrinkBudget;
+}
+
+/////////////////////////////////////////////////
+int TestPlugin::ResumeCount() const
+{
+  return this->resumeCount;
+}
+
+/////////////////////////////////////////////////
+void TestPlugin::Resume()
+{
+  ++this->resumeCount;
+}
+
+/////////////////////////////////////////////////
+void TestPlugin::ShrinkMemory(const uint64_t _budget)
+{
+  this->shrinkBudget = static_cast<int>(_budget);
+  this->SetMemoryUsage("test", 0u);
+}
+
+/////////////////////////////////////////////////
+QString TestPlugin::RingKey() const
+{
+  auto ring = this->HelperRing();
+  return ring ? QString::fromStdString(ring->Key()) : QString();
+}
+
+/////////////////////////////////////////////////
+QString TestPlugin::HelperData() const
+{
+  return this->helperData;
+}
+
+/////////////////////////////////////////////////
+void TestPlugin::OnHelperData(const void *_data, const std::size_t _size)
+{
+  this->helperData = QString::fromUtf8(static_cast<const char *>(_data),
+      static_cast<int>(_size));
+}
+
+/////////////////////////////////////////////////
+void TestPlugin::OnProxyMessage(const std::string &_message)
+{
+  // Echo messages back to the proxy
+  if (auto ring = this->HelperRing())
+    ring->Write(_message.data(), _message.size());
+}
+
 // Register this plugin
 IGNITION_ADD_PLUGIN(ignition::gui::TestPlugin,
                     ignition::gui::Plugin)
@@ -37,6 +37,56 @@ namespace ignition
 
       /// \brief Destructor
       public: virtual ~TestPlugin();
+
+      /// \brief Report memory usage, used to test SetMemoryUsage.
+      /// \param[in] _category Buffer category.
+      /// \param[in] _bytes Memory in bytes.
+      public: Q_INVOKABLE void ReportMemory(const QString &_category,
+          const int _bytes);
+
+      /// \brief Report a latency, used to test RecordLatency.
+      /// \param[in] _stage Stage name.
+      /// \param[in] _ms Latency in milliseconds.
+      public: Q_INVOKABLE void ReportLatency(const QString &_stage,
+          const int _ms);
+
+      /// \brief Get the budget passed to the latest ShrinkMemory call.
+      /// \return Budget in bytes, or -1 if ShrinkMemory wasn't called.
+      public: Q_INVOKABLE int ShrinkBudget() const;
+
+      /// \brief Get the key of the ring shared with the helper process.
+      /// \return Key, empty if the plugin isn't a proxy or a helper.
+      public: Q_INVOKABLE QString RingKey() const;
+
+      /// \brief Get the latest data received from the helper process.
+      /// \return Data, as text.
+      public: Q_INVOKABLE QString HelperData() const;
+
+      /// \brief Get the number of times Resume was called.
+      /// \return Number of calls.
+      public: Q_INVOKABLE int ResumeCount() const;
+
+      // Documentation inherited
+      protected: void Resume() override;
+
+      // Documentation inherited
+      protected: void ShrinkMemory(const uint64_t _budget) override;
+
+      // Documentation inherited
+      protected: void OnHelperData(const void *_data, const std::size_t _size)
+          override;
+
+      // Documentation inherited
+      protected: void OnProxyMessage(const std::string &_message) override;
+
+      /// \brief Budget passed to the latest ShrinkMemory call.
+      private: int shrinkBudget{-1};
+
+      /// \brief Latest data received from the helper process.
+      private: QString helperData;
+
+      /// \brief Number of times Resume was called.
+      private: int resumeCount{0};
     };
   }
 }